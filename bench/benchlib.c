@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Microbenchmarks for the readers and parsers in lib/.
+ *
+ * The benchmarks read the live proc and sysfs filesystems, or the trees
+ * pointed by NPL_PROC_ROOT and NPL_SYS_ROOT (see tests/mkfixtures.sh).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchutils.h"
+#include "collection.h"
+#include "common.h"
+#include "cpustats.h"
+#include "cputopology.h"
+#include "files.h"
+#include "interrupts.h"
+#include "json_helpers.h"
+#include "mountlist.h"
+#include "processes.h"
+#include "procparser.h"
+#include "sysio.h"
+#include "tcpinfo.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+
+/* procparser() on /proc/meminfo */
+
+static unsigned long kb_main_total, kb_main_free, kb_main_available,
+		     kb_main_buffers, kb_main_cached,
+		     kb_swap_total, kb_swap_free;
+
+static const proc_table_struct meminfo_table[] = {
+  {"Buffers", &kb_main_buffers},
+  {"Cached", &kb_main_cached},
+  {"MemAvailable", &kb_main_available},
+  {"MemFree", &kb_main_free},
+  {"MemTotal", &kb_main_total},
+  {"SwapFree", &kb_swap_free},
+  {"SwapTotal", &kb_swap_total}
+};
+
+static void
+bench_procparser_meminfo (void *data)
+{
+  (void) data;
+  procparser (PATH_PROC "/meminfo", meminfo_table,
+	      sizeof meminfo_table / sizeof meminfo_table[0], ':');
+}
+
+/* cpu_stats_get_time() on /proc/stat, for all the cpus */
+
+struct cpustats_data
+{
+  unsigned int lines;
+  struct cpu_time *cputime;
+};
+
+static void
+bench_cpu_stats_get_time (void *data)
+{
+  struct cpustats_data *d = data;
+  unsigned int i;
+
+  cpu_stats_get_time (d->cputime, d->lines);
+  for (i = 0; i < d->lines; i++)
+    free ((char *) d->cputime[i].cpuname);
+}
+
+/* proc_interrupts_get_nintr_per_cpu() on /proc/interrupts */
+
+static void
+bench_interrupts (void *data)
+{
+  unsigned int ncpus;
+  unsigned long *vintr;
+  (void) data;
+
+  vintr = proc_interrupts_get_nintr_per_cpu (&ncpus);
+  free (vintr);
+}
+
+/* procparser_tcp() on /proc/net/tcp and /proc/net/tcp6 */
+
+static void
+bench_tcptable (void *data)
+{
+  struct proc_tcptable *tcptable = NULL;
+  int flags = *(int *) data;
+
+  proc_tcptable_new (&tcptable);
+  proc_tcptable_read (tcptable, flags);
+  proc_tcptable_unref (tcptable);
+}
+
+/* procs_list_getall() on /proc/<pid>/status */
+
+static void
+bench_procs_list_getall (void *data)
+{
+  int flags = *(int *) data;
+  procs_list_getall (flags);
+}
+
+/* files_filecount() on a sysfs directory */
+
+static void
+bench_files_filecount (void *data)
+{
+  struct files_types *filecount = NULL;
+  const char *dir = data;
+
+  files_filecount (dir, FILES_RECURSIVE | FILES_INCLUDE_HIDDEN, 0, 0, NULL,
+		   &filecount);
+  free (filecount);
+}
+
+/* read_file_system_list() */
+
+static void
+bench_read_file_system_list (void *data)
+{
+  struct mount_entry *me, *next;
+  (void) data;
+
+  for (me = read_file_system_list (true); me; me = next)
+    {
+      next = me->me_next;
+      free (me->me_devname);
+      free (me->me_mountdir);
+      free (me->me_type);
+      free (me->me_opts);
+      free (me);
+    }
+}
+
+/* json_tokenise() on a synthetic Docker API answer */
+
+#define BENCH_JSON_CONTAINERS	1000
+
+static char *
+bench_json_build (unsigned int ncontainers)
+{
+  char *json, *p;
+  size_t size = 64 + ncontainers * 256;
+  unsigned int i;
+
+  p = json = xmalloc (size);
+  *p++ = '[';
+  for (i = 0; i < ncontainers; i++)
+    p += sprintf (p,
+		  "%s{\"Id\":\"%064x\",\"Image\":\"registry/app%u:latest\","
+		  "\"Command\":\"/bin/run\",\"Created\":%u,"
+		  "\"State\":\"running\",\"Labels\":{\"tier\":\"web\"},"
+		  "\"Ports\":[{\"PrivatePort\":%u,\"Type\":\"tcp\"}]}",
+		  i ? "," : "", i, i % 16, 1700000000 + i, 8000 + i % 100);
+  *p++ = ']';
+  *p = '\0';
+
+  return json;
+}
+
+static void
+bench_json_tokenise (void *data)
+{
+  size_t ntoken;
+  jsmntok_t *tokens = json_tokenise (data, &ntoken);
+  free (tokens);
+}
+
+/* collection.c counters */
+
+#define BENCH_COUNTER_KEYS	997
+#define BENCH_COUNTER_PUTS	10000
+
+static void
+bench_counters (void *data)
+{
+  char **keys = data;
+  hashtable_t *ht = counter_create ();
+  unsigned int i;
+
+  for (i = 0; i < BENCH_COUNTER_PUTS; i++)
+    counter_put (ht, keys[i % BENCH_COUNTER_KEYS], 1);
+  for (i = 0; i < BENCH_COUNTER_KEYS; i++)
+    counter_lookup (ht, keys[i]);
+
+  counter_free (ht);
+}
+
+static int
+mymain (void)
+{
+  int ret = 0, flags;
+  char sysfs_cpu_dir[PATH_MAX];
+  const char *dir;
+
+# define DO_BENCH(NAME, FUNC, DATA)                      \
+  do                                                     \
+    {                                                    \
+      if (bench_run (NAME, FUNC, DATA) < 0)              \
+        ret = -1;                                        \
+    }                                                    \
+  while (0)
+
+  DO_BENCH ("procparser/meminfo", bench_procparser_meminfo, NULL);
+
+  if (bench_selected ("cpu_stats_get_time"))
+    {
+      int ncpus = get_processor_number_total ();
+      struct cpustats_data cpustats = {
+	.lines = (ncpus > 0 ? ncpus : 1) + 1
+      };
+      cpustats.cputime = xnmalloc (cpustats.lines, sizeof (struct cpu_time));
+      DO_BENCH ("cpu_stats_get_time", bench_cpu_stats_get_time, &cpustats);
+      free (cpustats.cputime);
+    }
+
+  DO_BENCH ("proc_interrupts_get_nintr_per_cpu", bench_interrupts, NULL);
+
+  flags = TCP_v4 | TCP_v6;
+  DO_BENCH ("procparser_tcp", bench_tcptable, &flags);
+
+  flags = NBPROCS_NONE;
+  DO_BENCH ("procs_list_getall", bench_procs_list_getall, &flags);
+  flags = NBPROCS_THREADS;
+  DO_BENCH ("procs_list_getall/threads", bench_procs_list_getall, &flags);
+
+  dir = sysio_path (PATH_SYS "/devices/system/cpu", sysfs_cpu_dir,
+		    sizeof sysfs_cpu_dir);
+  if (dir)
+    DO_BENCH ("files_filecount/sysfs_cpu", bench_files_filecount,
+	      (void *) dir);
+
+  DO_BENCH ("read_file_system_list", bench_read_file_system_list, NULL);
+
+  if (bench_selected ("json_tokenise"))
+    {
+      char *json = bench_json_build (BENCH_JSON_CONTAINERS);
+      DO_BENCH ("json_tokenise/docker_containers", bench_json_tokenise, json);
+      free (json);
+    }
+
+  if (bench_selected ("counter"))
+    {
+      char *keys[BENCH_COUNTER_KEYS];
+      unsigned int i;
+
+      for (i = 0; i < BENCH_COUNTER_KEYS; i++)
+	keys[i] = xasprintf ("registry.example.com/image%u:latest", i);
+      DO_BENCH ("counter_put", bench_counters, keys);
+      for (i = 0; i < BENCH_COUNTER_KEYS; i++)
+	free (keys[i]);
+    }
+
+  return ret;
+}
+
+BENCH_MAIN (mymain)
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library preloaded by 'benchplugins --preload' in the plugins, so that
+ * the intentional waits between two samples do not hide the time spent
+ * collecting and processing the data.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <time.h>
+#include <unistd.h>
+
+unsigned int
+sleep (unsigned int seconds)
+{
+  (void) seconds;
+  return 0;
+}
+
+int
+usleep (useconds_t usec)
+{
+  (void) usec;
+  return 0;
+}
+
+int
+nanosleep (const struct timespec *req, struct timespec *rem)
+{
+  (void) req;
+  if (rem)
+    rem->tv_sec = rem->tv_nsec = 0;
+  return 0;
+}
+
+int
+clock_nanosleep (clockid_t clockid, int flags, const struct timespec *req,
+		 struct timespec *rem)
+{
+  (void) clockid;
+  (void) flags;
+  (void) req;
+  if (rem)
+    rem->tv_sec = rem->tv_nsec = 0;
+  return 0;
+}
@@ -0,0 +1,567 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * End-to-end latency benchmark of the plugins.
+ *
+ * Every command line listed in the input file is executed many times, and
+ * the exec-to-exit wall time, the user and system CPU time, the maximum
+ * resident set size, the page faults, and (when the perf counters are
+ * available) the number of syscalls are measured.
+ * The results can be saved as a baseline, or compared with a previously
+ * saved baseline: the program exits with a non-zero status if a metric
+ * regressed beyond the selected tolerance.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if HAVE_LINUX_PERF_EVENT_H
+# include <linux/perf_event.h>
+#endif
+
+#include "benchutils.h"
+#include "common.h"
+#include "messages.h"
+#include "progname.h"
+#include "string-macros.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+
+#define BENCH_DEFAULT_ITERATIONS	1000
+#define BENCH_DEFAULT_MAX_TIME		10	/* seconds per command line */
+#define BENCH_DEFAULT_TOLERANCE		20	/* percent */
+#define BENCH_MIN_ITERATIONS		10
+#define BENCH_MAX_ARGS			32
+
+/* The metrics compared with the baseline.  A regression is reported only
+ * when the difference is also bigger than the noise floor.  */
+enum bench_metric
+{
+  METRIC_WALL_US,
+  METRIC_CPU_US,
+  METRIC_MAXRSS_KB,
+  METRIC_MINFLT,
+  METRIC_SYSCALLS,
+  METRIC_COUNT
+};
+
+static const struct
+{
+  const char *name;
+  double noise_floor;
+} bench_metrics[METRIC_COUNT] = {
+  [METRIC_WALL_US]   = { "wall_us", 100 },
+  [METRIC_CPU_US]    = { "cpu_us", 100 },
+  [METRIC_MAXRSS_KB] = { "maxrss_kb", 256 },
+  [METRIC_MINFLT]    = { "minflt", 16 },
+  [METRIC_SYSCALLS]  = { "syscalls", 8 }
+};
+
+struct bench_result
+{
+  char *cmdline;
+  int exit_status;
+  unsigned int iterations;
+  double wall_us_median;
+  double wall_us_p95;
+  double user_us;
+  double sys_us;
+  double majflt;
+  double metric[METRIC_COUNT];	/* -1 means not available */
+  struct bench_result *next;
+};
+
+static const char *plugindir = ".";
+static const char *preload = NULL;
+static unsigned int iterations = BENCH_DEFAULT_ITERATIONS;
+static unsigned int warmup = BENCH_DEFAULT_WARMUP;
+static double max_time = BENCH_DEFAULT_MAX_TIME;
+static double tolerance = BENCH_DEFAULT_TOLERANCE;
+static const char *filter = NULL;
+static bool output_json = true;
+
+static inline double
+bench_now_us (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double
+bench_timeval_us (const struct timeval *tv)
+{
+  return tv->tv_sec * 1e6 + tv->tv_usec;
+}
+
+static int
+bench_compare_double (const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/* Execute the plugin once and wait for its termination.
+   The run is aborted if the plugin cannot be executed or does not return
+   a check result (for instance because of wrong arguments), so that the
+   time spent printing the usage message is never measured.  */
+static int
+bench_exec (char *const argv[], struct rusage *ru)
+{
+  int status, exit_status;
+  pid_t pid = fork ();
+
+  if (pid < 0)
+    plugin_error (STATE_UNKNOWN, errno, "fork() failed");
+
+  if (pid == 0)
+    {
+      int devnull = open ("/dev/null", O_WRONLY);
+      if (devnull >= 0)
+	{
+	  dup2 (devnull, STDOUT_FILENO);
+	  dup2 (devnull, STDERR_FILENO);
+	  close (devnull);
+	}
+      if (preload)
+	setenv ("LD_PRELOAD", preload, 1);
+      execv (argv[0], argv);
+      _exit (127);
+    }
+
+  if (wait4 (pid, &status, 0, ru) < 0)
+    plugin_error (STATE_UNKNOWN, errno, "wait4() failed");
+
+  exit_status =
+    WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+  if (exit_status == 127)
+    plugin_error (STATE_UNKNOWN, 0, "cannot execute %s", argv[0]);
+  else if (exit_status > STATE_CRITICAL)
+    plugin_error (STATE_UNKNOWN, 0, "%s exited with status %d", argv[0],
+		  exit_status);
+
+  return exit_status;
+}
+
+static void
+bench_perf_enable (int fd, bool enable)
+{
+#if HAVE_LINUX_PERF_EVENT_H
+  if (fd >= 0)
+    ioctl (fd, enable ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+#else
+  (void) fd;
+  (void) enable;
+#endif
+}
+
+static struct bench_result *
+bench_cmdline (const char *cmdline)
+{
+  struct bench_result *result;
+  char *args, *token, *saveptr, *argv[BENCH_MAX_ARGS + 1];
+  double *wall, start, budget_end;
+  double user_us = 0, sys_us = 0, minflt = 0, majflt = 0, maxrss = 0;
+  int64_t syscalls_before, syscalls_after;
+  unsigned int argc = 0, i, n;
+  int perf_fd;
+
+  args = xstrdup (cmdline);
+  for (token = strtok_r (args, " \t", &saveptr); token;
+       token = strtok_r (NULL, " \t", &saveptr))
+    {
+      if (argc == BENCH_MAX_ARGS)
+	plugin_error (STATE_UNKNOWN, 0, "too many arguments: %s", cmdline);
+      argv[argc] = argc ? token : xasprintf ("%s/%s", plugindir, token);
+      argc++;
+    }
+  argv[argc] = NULL;
+  if (argc == 0)
+    return NULL;
+
+  result = xmalloc (sizeof (struct bench_result));
+  result->cmdline = xstrdup (cmdline);
+  result->next = NULL;
+  wall = xnmalloc (iterations, sizeof (double));
+
+  for (i = 0; i < warmup; i++)
+    {
+      struct rusage ru;
+      result->exit_status = bench_exec (argv, &ru);
+    }
+
+  /* the counter also includes the few syscalls needed by fork and wait */
+  perf_fd = bench_perf_syscalls_open (true);
+  bench_perf_enable (perf_fd, true);
+  syscalls_before = bench_perf_read (perf_fd);
+
+  budget_end = bench_now_us () + max_time * 1e6;
+  for (n = 0; n < iterations; n++)
+    {
+      struct rusage ru;
+
+      start = bench_now_us ();
+      result->exit_status = bench_exec (argv, &ru);
+      wall[n] = bench_now_us () - start;
+
+      user_us += bench_timeval_us (&ru.ru_utime);
+      sys_us += bench_timeval_us (&ru.ru_stime);
+      minflt += ru.ru_minflt;
+      majflt += ru.ru_majflt;
+      if (ru.ru_maxrss > maxrss)
+	maxrss = ru.ru_maxrss;
+
+      if (n + 1 >= BENCH_MIN_ITERATIONS && bench_now_us () > budget_end)
+	{
+	  n++;
+	  break;
+	}
+    }
+
+  syscalls_after = bench_perf_read (perf_fd);
+  bench_perf_enable (perf_fd, false);
+  if (perf_fd >= 0)
+    close (perf_fd);
+
+  qsort (wall, n, sizeof (double), bench_compare_double);
+
+  result->iterations = n;
+  result->wall_us_median = wall[n / 2];
+  result->wall_us_p95 = wall[(n * 95) / 100];
+  result->user_us = user_us / n;
+  result->sys_us = sys_us / n;
+  result->majflt = majflt / n;
+  result->metric[METRIC_WALL_US] = result->wall_us_median;
+  result->metric[METRIC_CPU_US] = (user_us + sys_us) / n;
+  result->metric[METRIC_MAXRSS_KB] = maxrss;
+  result->metric[METRIC_MINFLT] = minflt / n;
+  result->metric[METRIC_SYSCALLS] =
+    (syscalls_before < 0 || syscalls_after < 0) ? -1 :
+    (double) (syscalls_after - syscalls_before) / n;
+
+  free (wall);
+  free (argv[0]);
+  free (args);
+
+  return result;
+}
+
+static void
+bench_print_result (const struct bench_result *r)
+{
+  int m;
+
+  if (output_json)
+    {
+      printf ("{\"plugin\":\"%s\",\"exit_status\":%d,\"iterations\":%u,"
+	      "\"wall_us_median\":%.1f,\"wall_us_p95\":%.1f,"
+	      "\"user_us\":%.1f,\"sys_us\":%.1f,\"majflt\":%.2f"
+	      , r->cmdline, r->exit_status, r->iterations
+	      , r->wall_us_median, r->wall_us_p95
+	      , r->user_us, r->sys_us, r->majflt);
+      for (m = 0; m < METRIC_COUNT; m++)
+	if (r->metric[m] < 0)
+	  printf (",\"%s\":null", bench_metrics[m].name);
+	else
+	  printf (",\"%s\":%.1f", bench_metrics[m].name, r->metric[m]);
+      puts ("}");
+    }
+  else
+    {
+      printf ("%-32s %5u runs %9.1f us (p95 %9.1f) cpu %8.1f us"
+	      " rss %6.0f kB %7.1f minflt"
+	      , r->cmdline, r->iterations
+	      , r->wall_us_median, r->wall_us_p95
+	      , r->metric[METRIC_CPU_US], r->metric[METRIC_MAXRSS_KB]
+	      , r->metric[METRIC_MINFLT]);
+      if (r->metric[METRIC_SYSCALLS] >= 0)
+	printf (" %7.1f syscalls", r->metric[METRIC_SYSCALLS]);
+      putchar ('\n');
+    }
+  fflush (stdout);
+}
+
+/* Baselines are stored in a tab-separated file:
+ *   cmdline <TAB> wall_us <TAB> cpu_us <TAB> maxrss_kb <TAB> minflt
+ *           <TAB> syscalls   */
+
+static void
+bench_baseline_save (const char *filename, struct bench_result *results)
+{
+  char *tmpfile = xasprintf ("%s.tmp", filename);
+  struct bench_result *r;
+  FILE *fp;
+  int m;
+
+  if ((fp = fopen (tmpfile, "w")) == NULL)
+    plugin_error (STATE_UNKNOWN, errno, "cannot create %s", tmpfile);
+
+  fputs ("# plugin", fp);
+  for (m = 0; m < METRIC_COUNT; m++)
+    fprintf (fp, "\t%s", bench_metrics[m].name);
+  fputc ('\n', fp);
+
+  for (r = results; r; r = r->next)
+    {
+      fputs (r->cmdline, fp);
+      for (m = 0; m < METRIC_COUNT; m++)
+	fprintf (fp, "\t%.1f", r->metric[m]);
+      fputc ('\n', fp);
+    }
+
+  if (fclose (fp) != 0 || rename (tmpfile, filename) < 0)
+    plugin_error (STATE_UNKNOWN, errno, "cannot save %s", filename);
+
+  free (tmpfile);
+}
+
+static bool
+bench_baseline_lookup (FILE *fp, const char *cmdline,
+		       double baseline[METRIC_COUNT])
+{
+  char *line = NULL, *p, *end;
+  size_t len = 0, cmdlen = strlen (cmdline);
+  bool found = false;
+  int m;
+
+  rewind (fp);
+  while (!found && getline (&line, &len, fp) != -1)
+    {
+      if (line[0] == '#' || strncmp (line, cmdline, cmdlen)
+	  || line[cmdlen] != '\t')
+	continue;
+
+      p = line + cmdlen;
+      for (m = 0; m < METRIC_COUNT; m++)
+	{
+	  baseline[m] = strtod (p, &end);
+	  if (end == p)
+	    break;
+	  p = end;
+	}
+      found = (m == METRIC_COUNT);
+    }
+
+  free (line);
+  return found;
+}
+
+/* Return the number of metrics that regressed */
+static int
+bench_baseline_compare (FILE *fp, const struct bench_result *r)
+{
+  double baseline[METRIC_COUNT];
+  int m, regressions = 0;
+
+  if (!bench_baseline_lookup (fp, r->cmdline, baseline))
+    {
+      fprintf (stderr, "NEW         %s: not found in the baseline\n",
+	       r->cmdline);
+      return 0;
+    }
+
+  for (m = 0; m < METRIC_COUNT; m++)
+    {
+      double limit = baseline[m] * (1 + tolerance / 100);
+
+      if (r->metric[m] < 0 || baseline[m] < 0)
+	continue;
+      if (r->metric[m] > limit
+	  && r->metric[m] - baseline[m] > bench_metrics[m].noise_floor)
+	{
+	  fprintf (stderr, "REGRESSION  %s: %s %.1f -> %.1f (%+.1f%%, "
+		   "tolerance %.0f%%)\n", r->cmdline, bench_metrics[m].name,
+		   baseline[m], r->metric[m],
+		   baseline[m] > 0 ?
+		     (r->metric[m] - baseline[m]) * 100 / baseline[m] : 100,
+		   tolerance);
+	  regressions++;
+	}
+    }
+
+  return regressions;
+}
+
+static void __attribute__ ((__noreturn__))
+usage (FILE * out)
+{
+  fprintf (out, "%s, version %s - end-to-end plugins benchmark.\n",
+	   program_name, PACKAGE_VERSION);
+  fputs ("Usage:\n", out);
+  fprintf (out, "  %s [OPTION]... FILE\n", program_name);
+  fputs ("Where FILE contains the plugin command lines to be run, one per "
+	 "line.\n", out);
+  fputs ("Options:\n", out);
+  fputs ("  -b, --baseline FILE  compare the results with the baseline "
+	 "FILE\n", out);
+  fputs ("  -d, --dir DIR        the directory containing the plugins\n",
+	 out);
+  fputs ("  -f, --filter TEXT    only run the command lines containing "
+	 "TEXT\n", out);
+  fprintf (out, "  -n, --iterations N   maximum number of executions "
+	   "(default: %d)\n", BENCH_DEFAULT_ITERATIONS);
+  fputs ("  -o, --output FORMAT  output format: json (default) or text\n",
+	 out);
+  fputs ("  -p, --preload LIB    preload LIB in the plugins (for instance "
+	 "the no-sleep library)\n", out);
+  fputs ("  -s, --save FILE      save the results as a baseline in FILE\n",
+	 out);
+  fprintf (out, "  -t, --tolerance PERC accepted regression in percent "
+	   "(default: %d)\n", BENCH_DEFAULT_TOLERANCE);
+  fprintf (out, "  -T, --max-time SEC   time budget per command line "
+	   "(default: %d)\n", BENCH_DEFAULT_MAX_TIME);
+  fputs ("  -h, --help           display this help and exit\n", out);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static const struct option longopts[] = {
+  {(char *) "baseline", required_argument, NULL, 'b'},
+  {(char *) "dir", required_argument, NULL, 'd'},
+  {(char *) "filter", required_argument, NULL, 'f'},
+  {(char *) "iterations", required_argument, NULL, 'n'},
+  {(char *) "output", required_argument, NULL, 'o'},
+  {(char *) "preload", required_argument, NULL, 'p'},
+  {(char *) "save", required_argument, NULL, 's'},
+  {(char *) "tolerance", required_argument, NULL, 't'},
+  {(char *) "max-time", required_argument, NULL, 'T'},
+  {(char *) "help", no_argument, NULL, 'h'},
+  {NULL, 0, NULL, 0}
+};
+
+int
+main (int argc, char **argv)
+{
+  struct bench_result *results = NULL, **tail = &results;
+  const char *baseline = NULL, *save = NULL;
+  char *line = NULL;
+  size_t len = 0;
+  ssize_t chread;
+  FILE *fp, *fp_baseline = NULL;
+  int c, regressions = 0;
+
+  set_program_name (argv[0]);
+
+  while ((c = getopt_long (argc, argv, "b:d:f:n:o:p:s:t:T:h", longopts,
+			   NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'b':
+	  baseline = optarg;
+	  break;
+	case 'd':
+	  plugindir = optarg;
+	  break;
+	case 'f':
+	  filter = optarg;
+	  break;
+	case 'n':
+	  iterations = strtoul (optarg, NULL, 10);
+	  if (iterations == 0)
+	    usage (stderr);
+	  break;
+	case 'o':
+	  if (STREQ (optarg, "json"))
+	    output_json = true;
+	  else if (STREQ (optarg, "text"))
+	    output_json = false;
+	  else
+	    usage (stderr);
+	  break;
+	case 'p':
+	  preload = optarg;
+	  break;
+	case 's':
+	  save = optarg;
+	  break;
+	case 't':
+	  tolerance = strtod (optarg, NULL);
+	  break;
+	case 'T':
+	  max_time = strtod (optarg, NULL);
+	  break;
+	case 'h':
+	  usage (stdout);
+	}
+    }
+
+  if (argc - optind != 1)
+    usage (stderr);
+
+  if ((fp = fopen (argv[optind], "r")) == NULL)
+    plugin_error (STATE_UNKNOWN, errno, "cannot open %s", argv[optind]);
+
+  if (baseline && (fp_baseline = fopen (baseline, "r")) == NULL)
+    plugin_error (STATE_UNKNOWN, errno, "cannot open %s", baseline);
+
+  while ((chread = getline (&line, &len, fp)) != -1)
+    {
+      struct bench_result *r;
+
+      line[strcspn (line, "#\n")] = '\0';
+      if (line[strspn (line, " \t")] == '\0')
+	continue;
+      if (filter && !strstr (line, filter))
+	continue;
+
+      if ((r = bench_cmdline (line)) == NULL)
+	continue;
+      bench_print_result (r);
+      if (fp_baseline)
+	regressions += bench_baseline_compare (fp_baseline, r);
+
+      *tail = r;
+      tail = &r->next;
+    }
+
+  free (line);
+  fclose (fp);
+
+  if (save)
+    bench_baseline_save (save, results);
+
+  if (fp_baseline)
+    {
+      fclose (fp_baseline);
+      fprintf (stderr, "%d regression(s) found (tolerance: %.0f%%)\n",
+	       regressions, tolerance);
+    }
+
+  return regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
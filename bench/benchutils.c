@@ -0,0 +1,449 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A small framework for the microbenchmarks.
+ *
+ * Each benchmark is run a few times for warming up the caches, then
+ * repeatedly for measuring the time spent per operation.  The harness also
+ * reports the allocations (by interposing malloc and friends, when the glibc
+ * entry points are available), the syscalls and the instructions executed
+ * (through perf counters, when the kernel allows it), and the resource
+ * usage reported by getrusage().
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if HAVE_LINUX_PERF_EVENT_H
+# include <linux/perf_event.h>
+#endif
+
+#include "benchutils.h"
+#include "common.h"
+#include "progname.h"
+#include "string-macros.h"
+#include "sysio.h"
+#include "xalloc.h"
+
+static unsigned int repetitions = BENCH_DEFAULT_REPETITIONS;
+static unsigned int warmup = BENCH_DEFAULT_WARMUP;
+static const char *filter = NULL;
+static bool output_json = true;
+
+/* Allocation accounting  */
+
+#if HAVE___LIBC_MALLOC
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void __libc_free (void *ptr);
+
+static int64_t alloc_count;
+static int64_t alloc_bytes;
+
+void *
+malloc (size_t size)
+{
+  alloc_count++;
+  alloc_bytes += size;
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+  alloc_count++;
+  alloc_bytes += nmemb * size;
+  return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+  alloc_count++;
+  alloc_bytes += size;
+#if ENABLE_XALLOC_ARENA
+  if (ptr && xalloc_arena_owns (ptr))
+    return xalloc_arena_realloc (ptr, size);
+#endif
+  return __libc_realloc (ptr, size);
+}
+
+/* These wrappers replace the ones in lib/xalloc_arena.c */
+void
+free (void *ptr)
+{
+#if ENABLE_XALLOC_ARENA
+  if (xalloc_arena_owns (ptr))
+    return;
+#endif
+  __libc_free (ptr);
+}
+
+#endif		/* HAVE___LIBC_MALLOC */
+
+/* Perf counters  */
+
+static int perf_fd_syscalls = -1;
+static int perf_fd_instructions = -1;
+
+#if HAVE_LINUX_PERF_EVENT_H
+
+static int
+bench_perf_open (uint32_t type, uint64_t config, bool user_only,
+		 bool inherit)
+{
+  struct perf_event_attr attr;
+
+  memset (&attr, 0, sizeof attr);
+  attr.size = sizeof attr;
+  attr.type = type;
+  attr.config = config;
+  attr.exclude_kernel = user_only;
+  attr.exclude_hv = 1;
+  attr.inherit = inherit;
+
+  return syscall (__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static long
+bench_perf_tracepoint_id (const char *event)
+{
+  const char *tracefs[] = {
+    "/sys/kernel/tracing/events",
+    "/sys/kernel/debug/tracing/events"
+  };
+  char path[256];
+  long id = -1;
+  size_t i;
+
+  for (i = 0; i < sizeof tracefs / sizeof tracefs[0] && id < 0; i++)
+    {
+      FILE *fp;
+      snprintf (path, sizeof path, "%s/%s/id", tracefs[i], event);
+      /* the tracefs of the running kernel, never a fixture */
+      if ((fp = fopen (path, "r")) == NULL)
+	continue;
+      if (fscanf (fp, "%ld", &id) != 1)
+	id = -1;
+      fclose (fp);
+    }
+
+  return id;
+}
+
+#endif		/* HAVE_LINUX_PERF_EVENT_H */
+
+int
+bench_perf_syscalls_open (bool inherit)
+{
+#if HAVE_LINUX_PERF_EVENT_H
+  long id = bench_perf_tracepoint_id ("raw_syscalls/sys_enter");
+
+  if (id >= 0)
+    return bench_perf_open (PERF_TYPE_TRACEPOINT, id, false, inherit);
+#else
+  (void) inherit;
+#endif
+  return -1;
+}
+
+static void
+bench_perf_init (void)
+{
+  perf_fd_syscalls = bench_perf_syscalls_open (false);
+#if HAVE_LINUX_PERF_EVENT_H
+  perf_fd_instructions =
+    bench_perf_open (PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, true,
+		     false);
+#endif
+}
+
+int64_t
+bench_perf_read (int fd)
+{
+  uint64_t value;
+
+  if (fd < 0 || read (fd, &value, sizeof value) != sizeof value)
+    return -1;
+
+  return (int64_t) value;
+}
+
+void
+bench_counters_read (struct bench_counters *counters)
+{
+  struct xalloc_stats xstats;
+
+#if HAVE___LIBC_MALLOC
+  counters->allocs = alloc_count;
+  counters->alloc_bytes = alloc_bytes;
+#else
+  counters->allocs = counters->alloc_bytes = -1;
+#endif
+  xalloc_stats_get (&xstats);
+  counters->xallocs = xstats.allocs;
+  counters->xalloc_bytes = xstats.bytes;
+  counters->arena_bytes = xstats.arena_bytes;
+  counters->syscalls = bench_perf_read (perf_fd_syscalls);
+  counters->instructions = bench_perf_read (perf_fd_instructions);
+}
+
+/* Timing and reporting  */
+
+static inline uint64_t
+bench_now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int
+bench_compare_u64 (const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+static double
+bench_timeval_us (const struct timeval *after, const struct timeval *before)
+{
+  return (after->tv_sec - before->tv_sec) * 1e6
+	 + (after->tv_usec - before->tv_usec);
+}
+
+static void
+bench_print_json_string (const char *key, const char *value)
+{
+  const char *p;
+
+  printf ("\"%s\":\"", key);
+  for (p = value; *p; p++)
+    {
+      if (*p == '"' || *p == '\\')
+	putchar ('\\');
+      putchar (*p);
+    }
+  putchar ('"');
+}
+
+static void
+bench_print_json_rate (const char *key, int64_t after, int64_t before,
+		       unsigned int reps)
+{
+  if (after < 0 || before < 0)
+    printf (",\"%s\":null", key);
+  else
+    printf (",\"%s\":%.2f", key, (double) (after - before) / reps);
+}
+
+bool
+bench_selected (const char *name)
+{
+  return (NULL == filter || strstr (name, filter) != NULL);
+}
+
+int
+bench_run (const char *name, bench_func_t func, void *data)
+{
+  struct bench_counters before, after;
+  struct rusage ru_before, ru_after;
+  uint64_t *elapsed, total = 0;
+  unsigned int i;
+
+  if (!bench_selected (name))
+    return 0;
+
+  if (NULL == (elapsed = calloc (repetitions, sizeof (uint64_t))))
+    return -1;
+
+  for (i = 0; i < warmup; i++)
+    func (data);
+
+  getrusage (RUSAGE_SELF, &ru_before);
+  bench_counters_read (&before);
+
+  for (i = 0; i < repetitions; i++)
+    {
+      uint64_t start = bench_now_ns ();
+      func (data);
+      elapsed[i] = bench_now_ns () - start;
+    }
+
+  bench_counters_read (&after);
+  getrusage (RUSAGE_SELF, &ru_after);
+
+  for (i = 0; i < repetitions; i++)
+    total += elapsed[i];
+  qsort (elapsed, repetitions, sizeof (uint64_t), bench_compare_u64);
+
+  if (output_json)
+    {
+      putchar ('{');
+      bench_print_json_string ("benchmark", name);
+      putchar (',');
+      bench_print_json_string ("proc_root", sysio_proc_root ());
+      putchar (',');
+      bench_print_json_string ("sys_root", sysio_sys_root ());
+      printf (",\"repetitions\":%u"
+	      ",\"ns_per_op\":%.0f,\"ns_min\":%llu,\"ns_median\":%llu"
+	      ",\"ns_max\":%llu"
+	      , repetitions
+	      , (double) total / repetitions
+	      , (unsigned long long) elapsed[0]
+	      , (unsigned long long) elapsed[repetitions / 2]
+	      , (unsigned long long) elapsed[repetitions - 1]);
+      bench_print_json_rate ("allocs_per_op",
+			     after.allocs, before.allocs, repetitions);
+      bench_print_json_rate ("bytes_per_op",
+			     after.alloc_bytes, before.alloc_bytes,
+			     repetitions);
+      bench_print_json_rate ("xallocs_per_op",
+			     after.xallocs, before.xallocs, repetitions);
+      bench_print_json_rate ("xalloc_bytes_per_op",
+			     after.xalloc_bytes, before.xalloc_bytes,
+			     repetitions);
+      bench_print_json_rate ("arena_bytes_per_op",
+			     after.arena_bytes, before.arena_bytes,
+			     repetitions);
+      bench_print_json_rate ("syscalls_per_op",
+			     after.syscalls, before.syscalls, repetitions);
+      bench_print_json_rate ("instructions_per_op",
+			     after.instructions, before.instructions,
+			     repetitions);
+      printf (",\"minflt_per_op\":%.2f,\"utime_us\":%.0f,\"stime_us\":%.0f"
+	      ",\"nvcsw\":%ld,\"nivcsw\":%ld,\"maxrss_kb\":%ld}\n"
+	      , (double) (ru_after.ru_minflt - ru_before.ru_minflt)
+		/ repetitions
+	      , bench_timeval_us (&ru_after.ru_utime, &ru_before.ru_utime)
+	      , bench_timeval_us (&ru_after.ru_stime, &ru_before.ru_stime)
+	      , ru_after.ru_nvcsw - ru_before.ru_nvcsw
+	      , ru_after.ru_nivcsw - ru_before.ru_nivcsw
+	      , ru_after.ru_maxrss);
+    }
+  else
+    {
+      printf ("%-36s %12.0f ns/op", name, (double) total / repetitions);
+      if (after.allocs >= 0)
+	printf (" %10.1f allocs/op %12.1f B/op"
+		, (double) (after.allocs - before.allocs) / repetitions
+		, (double) (after.alloc_bytes - before.alloc_bytes)
+		  / repetitions);
+      printf (" %10.1f xallocs/op"
+	      , (double) (after.xallocs - before.xallocs) / repetitions);
+      if (after.syscalls >= 0)
+	printf (" %8.1f syscalls/op"
+		, (double) (after.syscalls - before.syscalls) / repetitions);
+      putchar ('\n');
+    }
+
+  fflush (stdout);
+  free (elapsed);
+  return 0;
+}
+
+static void __attribute__ ((__noreturn__))
+usage (FILE * out)
+{
+  fprintf (out, "%s, version %s - run the microbenchmarks.\n",
+	   program_name, PACKAGE_VERSION);
+  fputs ("Usage:\n", out);
+  fprintf (out, "  %s [-f FILTER] [-o json|text] [-r REPS] [-w WARMUP]\n",
+	   program_name);
+  fputs ("Options:\n", out);
+  fputs ("  -f, --filter   only run the benchmarks whose name contains "
+	 "FILTER\n", out);
+  fputs ("  -o, --output   output format: json (default) or text\n", out);
+  fprintf (out, "  -r, --reps     number of measured repetitions "
+	   "(default: %d)\n", BENCH_DEFAULT_REPETITIONS);
+  fprintf (out, "  -w, --warmup   number of warmup runs (default: %d)\n",
+	   BENCH_DEFAULT_WARMUP);
+  fputs ("  -h, --help     display this help and exit\n", out);
+  fputs ("Environment:\n", out);
+  fputs ("  NPL_PROC_ROOT, NPL_SYS_ROOT  run against a fixture tree "
+	 "(see tests/mkfixtures.sh)\n", out);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static const struct option longopts[] = {
+  {(char *) "filter", required_argument, NULL, 'f'},
+  {(char *) "output", required_argument, NULL, 'o'},
+  {(char *) "reps", required_argument, NULL, 'r'},
+  {(char *) "warmup", required_argument, NULL, 'w'},
+  {(char *) "help", no_argument, NULL, 'h'},
+  {NULL, 0, NULL, 0}
+};
+
+int
+bench_main (int argc, char **argv, int (*func) (void))
+{
+  int c;
+
+  set_program_name (argv[0]);
+
+  while ((c = getopt_long (argc, argv, "f:o:r:w:h", longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'f':
+	  filter = optarg;
+	  break;
+	case 'o':
+	  if (STREQ (optarg, "json"))
+	    output_json = true;
+	  else if (STREQ (optarg, "text"))
+	    output_json = false;
+	  else
+	    usage (stderr);
+	  break;
+	case 'r':
+	  repetitions = strtoul (optarg, NULL, 10);
+	  if (repetitions == 0)
+	    usage (stderr);
+	  break;
+	case 'w':
+	  warmup = strtoul (optarg, NULL, 10);
+	  break;
+	case 'h':
+	  usage (stdout);
+	}
+    }
+
+  bench_perf_init ();
+
+  return func () == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* benchutils.h -- a small framework for the microbenchmarks
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _BENCHUTILS_H
+#define _BENCHUTILS_H
+
+#include <stdint.h>
+
+#include "system.h"
+
+#define BENCH_DEFAULT_REPETITIONS	50
+#define BENCH_DEFAULT_WARMUP		3
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* A benchmarked operation.  DATA is the pointer given to bench_run().  */
+  typedef void (*bench_func_t) (void *data);
+
+  /* Counters sampled before and after each benchmark.
+   * A counter set to -1 is not available on this system.  */
+  struct bench_counters
+  {
+    int64_t allocs;		/* number of calls to malloc and friends */
+    int64_t alloc_bytes;	/* number of bytes requested */
+    int64_t xallocs;		/* number of calls to xmalloc and xrealloc */
+    int64_t xalloc_bytes;	/* number of bytes requested to them */
+    int64_t arena_bytes;	/* bytes taken from the xmalloc arena */
+    int64_t syscalls;		/* perf tracepoint raw_syscalls:sys_enter */
+    int64_t instructions;	/* perf hardware counter (user space only) */
+  };
+
+  /* Run FUNC after a warmup phase and print the results, as a line of JSON
+   * or as plain text, to stdout.
+   * Returns 0 on success (or if the benchmark has been filtered out).  */
+  int bench_run (const char *name, bench_func_t func, void *data);
+
+  /* Return true if the benchmark NAME has been selected by the user.  */
+  bool bench_selected (const char *name);
+
+  /* Sample the allocation and perf counters.  */
+  void bench_counters_read (struct bench_counters *counters);
+
+  /* Open a perf counter of the syscalls issued by the calling process, and
+   * by the children created after this call if INHERIT is true.
+   * Returns -1 if the kernel does not allow it.  */
+  int bench_perf_syscalls_open (bool inherit);
+
+  /* Read the value of a perf counter, or -1 on error.  */
+  int64_t bench_perf_read (int fd);
+
+  int bench_main (int argc, char **argv, int (*func) (void));
+
+# define BENCH_MAIN(func)                                           \
+    int main (int argc, char **argv)                                \
+    {                                                               \
+      return bench_main (argc, argv, func);                         \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _BENCHUTILS_H */
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* cgroup.h -- a library for reading the cgroup v2 CPU controller
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _CGROUP_H
+#define _CGROUP_H
+
+#include "system.h"
+#include "sysio.h"
+
+#define PATH_SYS_CGROUP  PATH_SYS "/fs/cgroup"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* The CPU capacity available to a cgroup, in CPUs.  */
+  struct cgroup_cpu_capacity
+  {
+    double quota;		/* cpu.max quota/period, 0 if unlimited */
+    unsigned int cpuset;	/* CPUs in cpuset.cpus.effective, or 0 */
+    unsigned int online;	/* online CPUs of the host, or 0 */
+    double capacity;		/* the smallest of the above */
+  };
+
+  /* The content of cpu.stat (the times are in microseconds).  */
+  struct cgroup_cpu_stat
+  {
+    unsigned long long usage_usec;
+    unsigned long long user_usec;
+    unsigned long long system_usec;
+    unsigned long long nr_periods;
+    unsigned long long nr_throttled;
+    unsigned long long throttled_usec;
+  };
+
+  /* The "some" line of cpu.pressure.  */
+  struct cgroup_cpu_pressure
+  {
+    double avg10;
+    double avg60;
+    double avg300;
+    unsigned long long total;	/* microseconds */
+  };
+
+  /* Return the path of a cgroup v2 directory, or NULL if the unified
+   * hierarchy is not mounted.  If NAME is NULL the cgroup of the calling
+   * process (read from /proc/self/cgroup) is returned, otherwise NAME is
+   * taken as a path relative to the root of the hierarchy.
+   * The string must be freed by the caller.  */
+  char *cgroup_path (const char *name);
+
+  /* Call FN with the path of CGROUP and of each of its descendants, the
+   * parents first.  The walk stops when FN returns a non-zero value, that
+   * is returned.  Return 0, or -1 with errno set if CGROUP cannot be read.
+   * The subdirectories that cannot be read are skipped.  */
+  int cgroup_walk (const char *cgroup,
+		   int (*fn) (const char *path, void *data), void *data);
+
+  /* Compute the CPU capacity of the cgroup CGROUP: the quotas set in
+   * cpu.max by the cgroup and its ancestors, the CPUs it can run on,
+   * and the online CPUs.  Return 0, or -1 if none of them is known.  */
+  int cgroup_cpu_capacity (const char *cgroup,
+			   struct cgroup_cpu_capacity *capacity);
+
+  /* Read the cpu.stat and cpu.pressure files of CGROUP.
+   * Return 0, or -1 with errno set on error.  */
+  int cgroup_cpu_stat (const char *cgroup, struct cgroup_cpu_stat *stat);
+  int cgroup_cpu_pressure (const char *cgroup,
+			   struct cgroup_cpu_pressure *pressure);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _CGROUP_H */
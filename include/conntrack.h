@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* conntrack.h -- a library for checking the netfilter connection tracking
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _CONNTRACK_H
+#define _CONNTRACK_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* Read the number of the entries of the connection tracking table and
+   * the size of the table.  Return 0, or -1 with errno set if the
+   * nf_conntrack module is not loaded.  */
+  int conntrack_usage (unsigned long long *count, unsigned long long *max);
+
+  /* The counters of /proc/net/stat/nf_conntrack summed over the CPUs */
+  enum conntrack_counter
+  {
+    CONNTRACK_INSERT_FAILED,	/* entries not inserted in the table */
+    CONNTRACK_DROP,		/* packets dropped for a failed tracking */
+    CONNTRACK_EARLY_DROP,	/* entries evicted because the table is full */
+    CONNTRACK_SEARCH_RESTART,	/* lookups restarted (since Linux 4.10) */
+    CONNTRACK_COUNTERS
+  };
+
+  /* Return the name of COUNTER, as in /proc/net/stat/nf_conntrack.  */
+  const char *conntrack_counter_name (enum conntrack_counter counter);
+
+  /* Read the CONNTRACK_COUNTERS counters in COUNTERS, the missing ones
+   * being set to 0.  Return 0, or -1 with errno set on error.  */
+  int conntrack_stat_read (unsigned long long *counters);
+
+  /* The entries of the table by protocol, and the TCP ones by state */
+  enum conntrack_proto
+  {
+    CONNTRACK_PROTO_TCP,
+    CONNTRACK_PROTO_UDP,
+    CONNTRACK_PROTO_ICMP,
+    CONNTRACK_PROTO_ICMPV6,
+    CONNTRACK_PROTO_OTHER,
+    CONNTRACK_PROTOS
+  };
+
+#define CONNTRACK_TCP_STATES  10
+
+  struct conntrack_table
+  {
+    unsigned long entries;
+    unsigned long proto[CONNTRACK_PROTOS];
+    unsigned long tcp_state[CONNTRACK_TCP_STATES];
+  };
+
+  /* Return the name of PROTO ("tcp", ...).  */
+  const char *conntrack_proto_name (enum conntrack_proto proto);
+
+  /* Return the name of the TCP conntrack STATE ("established", ...).  */
+  const char *conntrack_tcp_state_name (unsigned int state);
+
+  /* Count the entries of the connection tracking table in TABLE with a
+   * ctnetlink dump, which requires CAP_NET_ADMIN.  The entries are not
+   * stored.  Return 0, or -1 with errno set on error.  */
+  int conntrack_table_read (struct conntrack_table *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _CONNTRACK_H */
@@ -80,8 +80,12 @@ extern "C"
   long long docker_memory_get_total_pgpgout (
     struct docker_memory_desc *memdesc);
 
+  struct metrics;
+
+  /* Count the running containers, of the image IMAGE only if not NULL,
+   * and add to METRICS the number of containers of each image.  */
   int docker_running_containers (unsigned int *count, const char *image,
-				 char **perfdata, bool verbose);
+				 struct metrics *metrics, bool verbose);
 
 #ifdef __cplusplus
 }
@@ -96,13 +96,18 @@ extern "C"
    * reaches zero, the resources of the context will be released.  */
   podman_varlink_t *podman_varlink_unref (podman_varlink_t *pv);
 
+  struct metrics;
+
+  /* Count the running containers, of the image IMAGE only if not NULL,
+   * and add their number to METRICS, per image or per status.  */
   int podman_running_containers (podman_varlink_t *pv, unsigned int *count,
-				 const char *image, char **perfdata);
+				 const char *image, struct metrics *metrics);
 
-  /* Report the containers statistics.  */
+  /* Report the containers statistics, and add them to METRICS.  */
   void podman_stats (podman_varlink_t *pv, stats_type which_stats,
 		     bool report_perc, total_t *total, unit_shift shift,
-		     const char *image_name, char **status, char **perfdata);
+		     const char *image_name, char **status,
+		     struct metrics *metrics);
 
   /* Return a string valid for Nagios performance data output.  */
   char* podman_image_name_normalize (const char *image);
@@ -63,10 +63,22 @@ extern "C"
   /* Get the cpu time statistics
    *  lines = 1 --> 'cpu' only
    *  lines = 3 --> 'cpu', 'cpu0', 'cpu1'
-   * and so on  */
+   * and so on
+   * The plugin exits on error.  */
   void cpu_stats_get_time (struct cpu_time * __restrict cputime,
 			   unsigned int lines);
 
+  /* Same as cpu_stats_get_time(), but return 0, or -1 with errno set on
+   * error (ENODATA if the 'cpu' line is missing, ERANGE if there are more
+   * cpus than LINES - 1).  The cpu names are not allocated on error.  */
+  int cpu_stats_read_time (struct cpu_time * __restrict cputime,
+			   unsigned int lines);
+
+  /* Read in VALUE the first number of the line of /proc/stat starting with
+   * PATTERN (for instance "ctxt ").  Return 0, or -1 with errno set on
+   * error (ENODATA if there is no such line).  */
+  int cpu_stats_read_value (const char *pattern, unsigned long long *value);
+
   /* Get the number of context switches that the system underwent */
   unsigned long long cpu_stats_get_cswch ();
 
@@ -79,6 +91,11 @@ extern "C"
    * (since Linux 2.6.0-test4) */
   unsigned long long cpu_stats_get_softirq ();
 
+  /* Get the number of processes in runnable state, and the number of
+   * processes blocked waiting for I/O to complete (since Linux 2.5.45) */
+  unsigned long long cpu_stats_get_procs_running ();
+  unsigned long long cpu_stats_get_procs_blocked ();
+
 #ifdef __cplusplus
 }
 #endif
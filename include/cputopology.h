@@ -69,6 +69,20 @@ extern "C"
   /* Get the maximum cpu index allowed by the kernel configuration. */
   int get_processor_number_kernel_max ();
 
+  /* Parse a list of CPUs ("0-3,8,10-11") and fill the cpu set SET. */
+  int cpulist_parse (const char *str, cpu_set_t *set, size_t setsize);
+
+  /* Allocate a cpu set large enough for all the CPUs supported by the
+   * kernel, and fill it with the list of CPUs STR.  The size of the set
+   * is stored in SETSIZE and the number of CPUs in NCPUS.
+   * Return NULL if STR is not valid or on allocation error.  */
+  cpu_set_t *cpulist_alloc (const char *str, size_t *setsize, int *ncpus);
+
+  /* Same as cpulist_alloc(), for the list of CPUs read from the sysfs file
+   * /sys/devices/system/cpu/NAME ("online", "isolated", "nohz_full", ...).
+   * Return NULL if the file cannot be read.  */
+  cpu_set_t *get_cpulist (const char *name, size_t *setsize, int *ncpus);
+
   /* Get the number of sockets, cores, and threads. */
   int get_cputopology_nthreads ();
   void get_cputopology_read (unsigned int *nsockets, unsigned int *ncores,
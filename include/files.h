@@ -45,6 +45,18 @@ extern "C"
     int64_t unknown;
   };
 
+  /* The errors returned by files_filecount() */
+  enum files_error
+  {
+    FILES_ERROR_OPENDIR = -1,	/* DIR cannot be opened */
+    FILES_ERROR_READDIR = -2,	/* a directory cannot be read */
+    FILES_ERROR_LSTAT = -3	/* the status of a file cannot be read */
+  };
+
+  /* Count the files in DIR matching FLAGS, AGE, SIZE, and PATTERN.
+   * The counters are added to FILECOUNT, allocated if NULL.
+   * The subdirectories that cannot be opened are skipped.
+   * Returns 0, or one of the negative files_error values with errno set.  */
   int files_filecount (const char *dir, unsigned int flags,
 		       int64_t age, int64_t size, const char *pattern,
 		       struct files_types **filecount);
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* fsstats.h -- a library for reading the runtime statistics of XFS and ext4
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _FSSTATS_H
+#define _FSSTATS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* The counters read, the XFS ones first */
+  enum fsstats_counter
+  {
+    FSSTATS_LOG_WRITES,		/* XFS: the log buffers written */
+    FSSTATS_LOG_FORCES,		/* XFS: the log forces */
+    FSSTATS_LOG_FORCE_SLEEPS,	/* XFS: the log forces that had to wait */
+    FSSTATS_LOGSPACE_SLEEPS,	/* XFS: the waits for the log space */
+    FSSTATS_BUF_GETS,		/* XFS: the buffers looked up */
+    FSSTATS_BUF_MISSES,		/* XFS: the buffers not found in memory */
+    FSSTATS_ERRORS,		/* ext4: the errors since the creation */
+    FSSTATS_WRITE_KBYTES,	/* ext4: the kilobytes written */
+    FSSTATS_COUNTERS
+  };
+
+#define FSSTATS_XFS_FIRST   FSSTATS_LOG_WRITES
+#define FSSTATS_XFS_LAST    FSSTATS_BUF_MISSES
+#define FSSTATS_EXT4_FIRST  FSSTATS_ERRORS
+#define FSSTATS_EXT4_LAST   FSSTATS_WRITE_KBYTES
+
+  /* Return the name of COUNTER ("log_forces", ...).  */
+  const char *fsstats_counter_name (enum fsstats_counter counter);
+
+  /* Return in BUF the name in sysfs of the block device DEVNAME, following
+   * the symbolic links like /dev/mapper/NAME, or its base name if it
+   * cannot be resolved.  */
+  const char *fsstats_devname (const char *devname, char *buf, size_t size);
+
+  /* Read the XFS counters of the device NAME (for instance "sda1") from
+   * /sys/fs/xfs/NAME/stats/stats or, if NAME is NULL, the global ones of
+   * /proc/fs/xfs/stat.  The ext4 counters are set to 0.
+   * Return 0, or -1 with errno set on error.  */
+  int fsstats_xfs_read (const char *name, unsigned long long *counters);
+
+  /* Read the ext4 counters of the device NAME from /sys/fs/ext4/NAME.
+   * The XFS counters are set to 0.
+   * Return 0, or -1 with errno set on error.  */
+  int fsstats_ext4_read (const char *name, unsigned long long *counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _FSSTATS_H */
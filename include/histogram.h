@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* histogram.h -- streaming histograms with log-scale buckets
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _HISTOGRAM_H
+#define _HISTOGRAM_H
+
+/* Each power of two is split in 2^HISTOGRAM_SUB_BITS buckets, so the
+ * quantiles are returned with a relative error lower than 1/16.
+ * The values lower than 2^(HISTOGRAM_SUB_BITS + 1) have a bucket each.  */
+#define HISTOGRAM_SUB_BITS  3
+#define HISTOGRAM_BUCKETS   ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  struct histogram
+  {
+    unsigned long long count[HISTOGRAM_BUCKETS];
+    unsigned long long n;	/* the number of values added */
+    unsigned long long max;
+  };
+
+  /* Add VALUE to the histogram H, which must be zeroed before the first
+   * use.  */
+  void histogram_add (struct histogram *h, unsigned long long value);
+
+  /* Return the quantile Q (0..1) of the values added to H, that is the
+   * middle of the bucket holding it, or 0 if H is empty.  */
+  unsigned long long histogram_quantile (const struct histogram *h,
+					 double q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _HISTOGRAM_H */
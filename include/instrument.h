@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* instrument.h -- self-timing and resource instrumentation of the plugins
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _INSTRUMENT_H
+#define _INSTRUMENT_H
+
+#include <stdio.h>
+
+#include "system.h"
+
+/* The instrumentation is enabled by setting the environment variable
+ * NPL_INSTRUMENT to "perfdata" (or "1"), that appends the "npl_*" metrics
+ * to the plugin perfdata, or to "debug", that prints them to stderr.
+ * They are printed to stderr as well when NPL_OUTPUT selects another
+ * format than perfdata.  */
+#define NPL_INSTRUMENT_ENV  "NPL_INSTRUMENT"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* The time is accounted to the innermost active phase.  */
+  enum npl_phase
+  {
+    NPL_PHASE_COMPUTE,		/* everything else (the default phase) */
+    NPL_PHASE_OPEN,		/* opening files, directories and sockets */
+    NPL_PHASE_READ,		/* reading data from the kernel or a daemon */
+    NPL_PHASE_PARSE,		/* parsing the data read */
+    NPL_PHASE_OUTPUT,		/* flushing the plugin output */
+    NPL_PHASE_COUNT
+  };
+
+  /* Check the environment and, if the instrumentation has been requested,
+   * start the clock and register the exit handler printing the metrics.
+   * This function is called by set_program_name().  */
+  void instrument_init (void);
+
+  /* Return true if the instrumentation is active.  */
+  bool instrument_enabled (void);
+
+  /* Enter and leave a phase.  The calls can be nested.  */
+  void instrument_phase_push (enum npl_phase phase);
+  void instrument_phase_pop (void);
+
+  /* Account SYSCALLS syscalls transferring BYTES bytes of data,
+   * for the I/O not done through instrument_fopen().  */
+  void instrument_count_io (unsigned long syscalls, unsigned long long bytes);
+
+  /* Open PATH for reading, with a stream that measures the time spent in
+   * open, read, and close and the bytes read.  */
+  FILE *instrument_fopen (const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _INSTRUMENT_H */
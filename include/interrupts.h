@@ -17,6 +17,8 @@
 #ifndef _INTERRUPTS_H
 #define _INTERRUPTS_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -28,6 +30,31 @@ extern "C"
    * with a device as such).  */
   unsigned long *proc_interrupts_get_nintr_per_cpu (unsigned int *ncpus);
 
+  /* The per-cpu counters of /proc/interrupts or /proc/softirqs.  */
+  struct irq_table
+  {
+    unsigned int ncpus;		/* the number of CPU columns */
+    unsigned int *cpu;		/* the CPU of each column */
+    size_t nrows;
+    struct irq_row
+    {
+      char *name;		/* "24", "LOC", "TIMER", ... */
+      char *device;		/* the device of a numbered irq, or NULL */
+      unsigned long long *count;	/* the counters of the columns */
+    } *row;
+  };
+
+  /* Read all the rows of /proc/interrupts or of /proc/softirqs.
+   * Return NULL if the file cannot be read.  */
+  struct irq_table *proc_interrupts_read (void);
+  struct irq_table *proc_softirqs_read (void);
+
+  /* Return the column of the counters of CPU, or -1 if CPU is not listed
+   * (offline CPUs are not).  */
+  int irq_table_column (const struct irq_table *table, unsigned int cpu);
+
+  void irq_table_free (struct irq_table *table);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* lazylib.h -- load optional shared libraries at run time
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _LAZYLIB_H
+#define _LAZYLIB_H
+
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* Open the first library found in the NULL terminated list SONAMES.
+   * The plugin exits with an UNKNOWN status if none can be loaded.  */
+  void *lazylib_open (const char *const sonames[]);
+
+  /* Return the address of the symbol NAME in the library HANDLE.
+   * The plugin exits with an UNKNOWN status if it cannot be found.  */
+  void *lazylib_sym (void *handle, const char *name);
+
+  /* Store the address of the function NAME in the member MEMBER of the
+   * structure API, a table of function pointers.  The address is copied
+   * with memcpy, because a store through a (void **) cast of the member
+   * breaks the strict aliasing rules.  */
+# define LAZYLIB_SYM(handle, api, member, name)                         \
+    do                                                                  \
+      {                                                                 \
+	void *lazylib_addr_ = lazylib_sym (handle, name);               \
+	memcpy (&(api).member, &lazylib_addr_, sizeof (void *));        \
+      }                                                                 \
+    while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _LAZYLIB_H */
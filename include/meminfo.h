@@ -36,8 +36,9 @@ extern "C"
   int proc_sysmem_new (struct proc_sysmem **sysmem);
 
   /* Fill the proc_sysmem structure pointed with the values found in the
-   * proc filesystem.  */
-  void proc_sysmem_read (struct proc_sysmem *sysmem);
+   * proc filesystem.
+   * Returns 0 if all went ok. Errors are returned as negative values.  */
+  int proc_sysmem_read (struct proc_sysmem *sysmem);
 
   /* Drop a reference of the memory library context. If the refcount of
    * reaches zero, the resources of the context will be released.  */
@@ -19,6 +19,16 @@
 
 #include "common.h"
 
+/* The note of the plugins saving their counters with statefile_save()
+   (NPL_STATE_DIR_ENV is defined in statefile.h) */
+#define USAGE_STATEFILE \
+  "  The counters read are saved, and the next execution of the plugin " \
+  "computes\n" \
+  "  the values since then, without waiting \"delay\" seconds if at least " \
+  "as many\n" \
+  "  seconds have passed.\n" \
+  "  See the environment variable " NPL_STATE_DIR_ENV ".\n"
+
 #ifdef __cplusplus
 extern "C"
 {
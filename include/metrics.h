@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* metrics.h -- output of the plugin metrics in several formats
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _METRICS_H
+#define _METRICS_H 1
+
+#include "common.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* The environment variable selecting the output format */
+#define NPL_OUTPUT_ENV  "NPL_OUTPUT"
+
+  enum metrics_format
+  {
+    METRICS_FORMAT_PERFDATA,	/* Nagios status line and perfdata */
+    METRICS_FORMAT_OPENMETRICS,	/* OpenMetrics text exposition format */
+    METRICS_FORMAT_JSON		/* one JSON object per line */
+  };
+
+  /* A sample.  In the perfdata format, the sample is printed as
+   *   [LABEL_VALUE_]NAME=VALUE[UNIT][;WARNING;CRITICAL;MIN;MAX]
+   * (or PERFDATA_LABEL=VALUE... if set), and in the other formats as a time
+   * series named after the plugin and NAME, with the label LABEL set to
+   * LABEL_VALUE.  */
+  struct metric
+  {
+    const char *name;		/* "user", "rxbyte/s", ... */
+    const char *label;		/* "cpu", "ifname", ..., or NULL */
+    const char *label_value;	/* "cpu0", "eth0", ..., or NULL */
+    const char *unit;		/* perfdata unit ("%", "B", ...), or NULL */
+    int precision;		/* number of decimal digits of the value */
+    const char *warning;	/* thresholds, or NULL */
+    const char *critical;
+    const char *min;		/* range of the values, or NULL */
+    const char *max;
+    const char *perfdata_label;	/* the perfdata label, or NULL */
+  };
+
+  struct metrics;
+
+  /* Return the output format selected by the environment variable
+   * NPL_OUTPUT, or -1 if it is not valid.  */
+  int metrics_format_get (void);
+
+  /* Create a new set of metrics for PLUGIN ("cpu", "network", ...), to be
+   * printed in the format selected by the environment variable NPL_OUTPUT
+   * ("perfdata", the default, "openmetrics", or "json").
+   * NSAMPLES is the expected number of samples, used to size the buffers.  */
+  struct metrics *metrics_new (const char *plugin, size_t nsamples);
+
+  enum metrics_format metrics_format (const struct metrics *metrics);
+
+  /* Add a sample.  The strings of METRIC are copied.  */
+  void metrics_add (struct metrics *metrics, const struct metric *metric,
+		    double value);
+
+  /* Render the plugin STATUS, the status line MESSAGE and all the samples
+   * into a single buffer, and write it to the standard output with one
+   * write(2) call.  The metrics are released.  */
+  void metrics_write (struct metrics *metrics, nagstatus status,
+		      const char *message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _METRICS_H */
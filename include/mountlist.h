@@ -38,4 +38,36 @@ struct mount_entry
 
 struct mount_entry *read_file_system_list (bool need_fs_type);
 
+/* A file system type to select or to omit. */
+struct fs_type_list
+{
+  char *fs_name;
+  struct fs_type_list *fs_next;
+};
+
+/* The mounted file systems to be checked.
+ * If 'fs_select_list' is NULL, select all types.  */
+struct mount_filter
+{
+  struct fs_type_list *fs_select_list;	/* file system types to select */
+  struct fs_type_list *fs_exclude_list;	/* file system types to omit */
+  bool show_all_fs;		/* include the dummy file systems */
+  bool show_local_fs;		/* select the local file systems only */
+};
+
+/* Add FSTYPE to the file system types to select, or to omit.  */
+void mount_filter_add_type (struct mount_filter *filter, const char *fstype);
+void mount_filter_exclude_type (struct mount_filter *filter,
+				const char *fstype);
+
+/* Return a file system type both selected and omitted, or NULL.  */
+const char *mount_filter_conflict (const struct mount_filter *filter);
+
+/* Return true if the file system types are needed by the filter.  */
+bool mount_filter_need_fs_type (const struct mount_filter *filter);
+
+/* Return true if the mounted file system ME is not selected by FILTER.  */
+bool mount_filter_skip (const struct mount_filter *filter,
+			const struct mount_entry *me);
+
 #endif /* mountlist.h */
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* mountstats.h -- a library for reading the RPC statistics of the NFS mounts
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _MOUNTSTATS_H
+#define _MOUNTSTATS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* The NFS operations whose statistics are read */
+  enum mountstats_op
+  {
+    MOUNTSTATS_OP_READ,
+    MOUNTSTATS_OP_WRITE,
+    MOUNTSTATS_OP_GETATTR,
+    MOUNTSTATS_OP_LOOKUP,
+    MOUNTSTATS_OPS
+  };
+
+  /* The cumulative counters of each operation, the times being in
+   * milliseconds */
+  enum mountstats_counter
+  {
+    MOUNTSTATS_CALLS,		/* the operations requested */
+    MOUNTSTATS_RETRANS,		/* the transmissions beyond the first one */
+    MOUNTSTATS_TIMEOUTS,	/* the major timeouts */
+    MOUNTSTATS_QUEUE_MS,	/* waiting to be transmitted */
+    MOUNTSTATS_RTT_MS,		/* waiting for the reply of the server */
+    MOUNTSTATS_EXECUTE_MS,	/* from the request to the completion */
+    MOUNTSTATS_COUNTERS
+  };
+
+  /* The statistics of a NFS mount, the strings being valid until the
+   * callback of mountstats_read() returns.  */
+  struct mountstats
+  {
+    const char *devname;
+    const char *mountdir;
+    const char *fstype;
+    unsigned long long counter[MOUNTSTATS_OPS][MOUNTSTATS_COUNTERS];
+  };
+
+  /* Return the name of OP, as in /proc/self/mountstats ("READ", ...).  */
+  const char *mountstats_op_name (enum mountstats_op op);
+
+  /* Return the name of COUNTER ("calls", "retrans", ...).  */
+  const char *mountstats_counter_name (enum mountstats_counter counter);
+
+  /* Parse /proc/self/mountstats in a single pass, calling FN (MS, DATA)
+   * for each mount with per-operation RPC statistics (the NFS ones), the
+   * missing operations being zeroed.  Only the current mount is kept in
+   * memory.  Return 0, or -1 with errno set on error.  */
+  int mountstats_read (void (*fn) (const struct mountstats *ms, void *data),
+		       void *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _MOUNTSTATS_H */
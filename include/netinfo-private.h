@@ -42,6 +42,7 @@ extern "C"
   typedef struct iflist
   {
     char *ifname;
+    int ifindex;
     uint8_t duplex;	   /* the duplex as defined in <linux/ethtool.h> */
     uint32_t speed;	   /* the link speed in Mbps */
     unsigned int flags;
@@ -49,6 +50,9 @@ extern "C"
     struct iflist *next;
   } iflist_t;
 
+  /* The names of the duplex modes, indexed by DUPLEX_HALF and DUPLEX_FULL */
+  extern const char *const duplex_table[];
+
   struct iflist *get_netinfo_snapshot (unsigned int options,
 				       const regex_t *iface_regex);
 
@@ -58,6 +58,16 @@ extern "C"
 
   struct iflist *netinfo (unsigned int options, const char *ifname_regex,
 			  unsigned int seconds, unsigned int *ninterfaces);
+
+  struct netns;
+  /* The same as netinfo(), for the NNETNS network namespaces NETNS (see
+   * netns.h), with a single delay.  The interfaces are named
+   * "IFNAME@NAMESPACE" outside the namespace of the plugin.  */
+  struct iflist *netinfo_netns (const struct netns *netns, size_t nnetns,
+				unsigned int options, const char *ifname_regex,
+				unsigned int seconds,
+				unsigned int *ninterfaces);
+
   struct iflist *iflist_get_next (struct iflist *ifentry);
 #define iflist_foreach(list_entry, list) \
 	for (list_entry = list; list_entry != NULL; \
@@ -65,6 +75,7 @@ extern "C"
 
   /* Accessing the values from struct iflist */
   const char *iflist_get_ifname (struct iflist *ifentry);
+  int iflist_get_ifindex (struct iflist *ifentry);
   uint8_t iflist_get_duplex (struct iflist *ifentry);
   uint32_t iflist_get_speed (struct iflist *ifentry);
   unsigned int iflist_get_tx_packets (struct iflist *ifentry);
@@ -79,6 +90,35 @@ extern "C"
   unsigned int iflist_get_flags (struct iflist *ifentry);
   unsigned int iflist_get_multicast (struct iflist *ifentry);
 
+  /* The counters of the queueing disciplines (TCA_STATS2) */
+  enum qdisc_counter
+  {
+    QDISC_BYTES,
+    QDISC_PACKETS,
+    QDISC_DROPS,
+    QDISC_OVERLIMITS,
+    QDISC_REQUEUES,
+    QDISC_COUNTERS
+  };
+
+  struct qdisc_stats
+  {
+    int ifindex;
+    uint32_t handle;
+    char kind[16];		/* "fq_codel", "mq", "htb", ... */
+    unsigned long long counter[QDISC_COUNTERS];
+    unsigned int backlog;	/* the bytes queued */
+    unsigned int qlen;		/* the packets queued */
+  };
+
+  /* Return the name of COUNTER ("bytes", "drops", ...).  */
+  const char *qdisc_counter_name (enum qdisc_counter counter);
+
+  /* Return the root (egress) queueing disciplines of all the interfaces,
+   * dumped with a single RTM_GETQDISC request, and their number in
+   * NQDISCS.  The array must be freed by the caller.  */
+  struct qdisc_stats *qdisc_read (size_t *nqdiscs);
+
   void print_ifname_debug (struct iflist *iflhead, unsigned int options);
   void freeiflist (struct iflist *iflhead);
 
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* netns.h -- a library for running some code in the network namespaces
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _NETNS_H
+#define _NETNS_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "system.h"
+
+#define PATH_RUN_NETNS  "/run/netns"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  struct netns
+  {
+    char *name;		/* the name in /run/netns, "pidN", or "" */
+    char *path;		/* the file to be opened for entering it */
+    dev_t dev;
+    ino_t ino;
+    bool self;		/* the namespace of the plugin */
+  };
+
+  /* List the network namespaces: the one of the plugin first, named "",
+   * then the ones bound in /run/netns (by "ip netns add"), and the ones of
+   * the processes (/proc/PID/ns/net), named "pidPID" after the first
+   * process found in them.  The namespaces are deduplicated by inode.
+   * Return NULL with errno set on error.  */
+  struct netns *netns_list (size_t *nnetns);
+
+  void netns_list_free (struct netns *netns, size_t nnetns);
+
+  /* Call FN (DATA) in the namespace NS, from a worker thread that joins
+   * it, and wait for it to return.  FN is called by the current thread if
+   * NS is the namespace of the plugin.  Entering another namespace
+   * requires CAP_SYS_ADMIN.  Return 0, or -1 with errno set if the
+   * namespace cannot be entered.  */
+  int netns_run (const struct netns *ns, void (*fn) (void *data),
+		 void *data);
+
+  /* Return "NAME@NSNAME", or a copy of NAME in the namespace of the
+   * plugin.  The string must be freed by the caller.  */
+  char *netns_label (const struct netns *ns, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _NETNS_H */
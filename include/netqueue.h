@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* netqueue.h -- a library for reading the statistics of the NIC queues
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _NETQUEUE_H
+#define _NETQUEUE_H
+
+#include "system.h"
+
+/* The per-queue statistics of the drivers beyond this limit are ignored */
+#define NETQUEUE_MAX_QUEUES  1024
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* The counters of each queue, taken from the ethtool statistics */
+  enum netqueue_counter
+  {
+    NETQUEUE_RX_PACKETS,
+    NETQUEUE_RX_DROPS,
+    NETQUEUE_TX_PACKETS,
+    NETQUEUE_TX_DROPS,
+    NETQUEUE_COUNTERS
+  };
+
+  struct netqueue;
+
+  /* Return the name of COUNTER ("rxpck", "rxdrop", ...).  */
+  const char *netqueue_counter_name (enum netqueue_counter counter);
+
+  /* Read the queues of the interface IFNAME in sysfs and map the names of
+   * the ethtool statistics of its driver to the queue counters, so that
+   * the statistics can then be read with netqueue_read() without fetching
+   * the names again.  Return NULL with errno set on error, or EOPNOTSUPP
+   * if the driver does not report any per-queue statistics.  */
+  struct netqueue *netqueue_open (const char *ifname);
+
+  /* The number of the RX and TX queues in sysfs, and the number of the
+   * queues having some statistics (at least the largest of them).  */
+  unsigned int netqueue_rx_queues (const struct netqueue *nq);
+  unsigned int netqueue_tx_queues (const struct netqueue *nq);
+  unsigned int netqueue_queues (const struct netqueue *nq);
+
+  /* Return true if the driver reports COUNTER for the queues.  */
+  bool netqueue_has_counter (const struct netqueue *nq,
+			     enum netqueue_counter counter);
+
+  /* Read the counters of the queues in COUNTERS, an array of
+   * netqueue_queues() * NETQUEUE_COUNTERS elements, the counter C of the
+   * queue Q being at Q * NETQUEUE_COUNTERS + C.
+   * Return 0, or -1 with errno set on error.  */
+  int netqueue_read (struct netqueue *nq, unsigned long long *counters);
+
+  void netqueue_free (struct netqueue *nq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _NETQUEUE_H */
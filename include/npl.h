@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* npl.h -- public interface of the libnpl shared library
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _NPL_H
+#define _NPL_H 1
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* The collectors of the plugins callable in-process: system memory,
+   * virtual memory, CPU time and counters, and file counting.
+   *
+   * Unless stated otherwise, the functions return 0 on success and a
+   * negative errno value on failure: they do not exit the calling process,
+   * unless the memory is exhausted.
+   * npl_last_error() returns a description of the last failure.
+   *
+   * The thread safety of each function is documented as follows:
+   *   MT-Safe      the function can be called concurrently by any thread;
+   *   MT-Safe ctx  the function can be called concurrently, provided that
+   *                the threads do not share the context passed as argument.
+   *
+   * The environment is read at every call (NPL_PROC_ROOT and NPL_SYS_ROOT
+   * redirect the proc and sysfs filesystems): it must not be modified
+   * while the library is in use.  */
+
+#define NPL_API_VERSION 1
+
+  /* Return the version of the package.  MT-Safe.  */
+  const char *npl_version (void);
+
+  /* Return the description of the last failure in the calling thread, or
+     an empty string if the last call succeeded.  MT-Safe.  */
+  const char *npl_last_error (void);
+
+  /* System memory and swap (/proc/meminfo), in kB.  */
+
+  struct proc_sysmem;
+
+  enum npl_sysmem_item
+  {
+    NPL_SYSMEM_ACTIVE,
+    NPL_SYSMEM_ANON_PAGES,
+    NPL_SYSMEM_COMMITTED_AS,
+    NPL_SYSMEM_DIRTY,
+    NPL_SYSMEM_INACTIVE,
+    NPL_SYSMEM_MAIN_AVAILABLE,
+    NPL_SYSMEM_MAIN_BUFFERS,
+    NPL_SYSMEM_MAIN_CACHED,
+    NPL_SYSMEM_MAIN_FREE,
+    NPL_SYSMEM_MAIN_SHARED,
+    NPL_SYSMEM_MAIN_TOTAL,
+    NPL_SYSMEM_MAIN_USED,
+    NPL_SYSMEM_SWAP_CACHED,
+    NPL_SYSMEM_SWAP_FREE,
+    NPL_SYSMEM_SWAP_TOTAL,
+    NPL_SYSMEM_SWAP_USED
+  };
+
+  /* Allocate a new context owned by the caller.  MT-Safe.  */
+  int npl_sysmem_new (struct proc_sysmem **sysmem);
+
+  /* Refresh the values of SYSMEM.  MT-Safe ctx.  */
+  int npl_sysmem_read (struct proc_sysmem *sysmem);
+
+  /* Return the value of ITEM read by the last npl_sysmem_read(), or 0 if
+     ITEM is unknown.  MT-Safe ctx.  */
+  unsigned long npl_sysmem_get (struct proc_sysmem *sysmem,
+				enum npl_sysmem_item item);
+
+  /* Release SYSMEM.  MT-Safe ctx.  */
+  void npl_sysmem_unref (struct proc_sysmem *sysmem);
+
+  /* Virtual memory statistics (/proc/vmstat).  */
+
+  struct proc_vmem;
+
+  enum npl_vmem_item
+  {
+    NPL_VMEM_PGALLOC,
+    NPL_VMEM_PGFAULT,
+    NPL_VMEM_PGFREE,
+    NPL_VMEM_PGMAJFAULT,
+    NPL_VMEM_PGPGIN,
+    NPL_VMEM_PGPGOUT,
+    NPL_VMEM_PGREFILL,
+    NPL_VMEM_PGSCAN,
+    NPL_VMEM_PGSCAND,
+    NPL_VMEM_PGSCANK,
+    NPL_VMEM_PGSTEAL,
+    NPL_VMEM_PSWPIN,
+    NPL_VMEM_PSWPOUT
+  };
+
+  /* Allocate a new context owned by the caller.  MT-Safe.  */
+  int npl_vmem_new (struct proc_vmem **vmem);
+
+  /* Refresh the values of VMEM.  MT-Safe ctx.  */
+  int npl_vmem_read (struct proc_vmem *vmem);
+
+  /* Return the value of ITEM read by the last npl_vmem_read(), or 0 if
+     ITEM is unknown.  MT-Safe ctx.  */
+  unsigned long npl_vmem_get (struct proc_vmem *vmem,
+			      enum npl_vmem_item item);
+
+  /* Release VMEM.  MT-Safe ctx.  */
+  void npl_vmem_unref (struct proc_vmem *vmem);
+
+  /* CPU time and counters (/proc/stat), in jiffies.  */
+
+  struct npl_cpu_time
+  {
+    unsigned long long user;
+    unsigned long long nice;
+    unsigned long long system;
+    unsigned long long idle;
+    unsigned long long iowait;
+    unsigned long long irq;
+    unsigned long long softirq;
+    unsigned long long steal;
+    unsigned long long guest;
+    unsigned long long guestn;
+  };
+
+  struct npl_cpu_counters
+  {
+    unsigned long long cswch;	/* context switches */
+    unsigned long long intr;	/* interrupts serviced */
+    unsigned long long softirq;	/* softirqs serviced */
+  };
+
+  /* Read the time spent by all the CPUs in each mode.  MT-Safe.  */
+  int npl_cpu_time_read (struct npl_cpu_time *cputime);
+
+  /* Read the number of context switches, interrupts and softirqs since
+     boot time.  MT-Safe.  */
+  int npl_cpu_counters_read (struct npl_cpu_counters *counters);
+
+  /* File counting (see check_filecount).  */
+
+  enum
+  {
+    NPL_FILES_DEFAULT = 0,
+    NPL_FILES_DIRECTORIES_ONLY = (1 << 0),
+    NPL_FILES_IGNORE_SYMLINKS  = (1 << 1),
+    NPL_FILES_IGNORE_UNKNOWN   = (1 << 2),
+    NPL_FILES_INCLUDE_HIDDEN   = (1 << 3),
+    NPL_FILES_RECURSIVE        = (1 << 4),
+    NPL_FILES_REGULAR_ONLY     = (1 << 5)
+  };
+
+  struct npl_filecount
+  {
+    int64_t directory;
+    int64_t hidden;
+    int64_t special_file;
+    int64_t symlink;
+    int64_t regular_file;
+    int64_t total;
+    int64_t unknown;
+  };
+
+  /* Count the files in DIR matching FLAGS, the AGE and SIZE filters (as in
+     check_filecount, 0 to disable them), and the shell PATTERN (NULL to
+     match any file).  MT-Safe.  */
+  int npl_filecount (const char *dir, unsigned int flags,
+		     int64_t age, int64_t size, const char *pattern,
+		     struct npl_filecount *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _NPL_H */
@@ -28,8 +28,11 @@ extern "C"
     unsigned long *slot;	/* slot in return struct */
   } proc_table_struct;
 
-  void procparser (const char *filename, const proc_table_struct * proc_table,
-		   int proc_table_count, char separator);
+  /* Parse the file FILENAME made of "name<SEPARATOR>value" lines and store
+   * the values of the names listed in PROC_TABLE (sorted by name).
+   * Return 0, or -1 with errno set if the file cannot be opened.  */
+  int procparser (const char *filename, const proc_table_struct * proc_table,
+		  int proc_table_count, char separator);
 
   /* Lookup a pattern and get the value from line
    * Format is:
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* result_cache.h -- cache of the plugin results shared by identical checks
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _RESULT_CACHE_H
+#define _RESULT_CACHE_H
+
+#include "system.h"
+
+/* The cache is enabled by setting the environment variable NPL_CACHE_TTL
+ * to the number of seconds a result can be reused for.  The results are
+ * stored in NPL_CACHE_DIR, by default /dev/shm/npl-cache-<uid>.  */
+#define NPL_CACHE_TTL_ENV  "NPL_CACHE_TTL"
+#define NPL_CACHE_DIR_ENV  "NPL_CACHE_DIR"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* Look for the result of a previous execution of the plugin with the
+   * same arguments and by the same user, not older than NPL_CACHE_TTL
+   * seconds.  If found, print its output and exit with its status.
+   * Otherwise, capture the standard output of the plugin and store it,
+   * along with the exit status, when the plugin exits.
+   * This function must be called after set_program_name() and before
+   * the command line is parsed.  */
+  void result_cache_init (int argc, char **argv);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _RESULT_CACHE_H */
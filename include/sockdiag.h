@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* sockdiag.h -- a library for dumping the sockets with NETLINK_SOCK_DIAG
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _SOCKDIAG_H
+#define _SOCKDIAG_H
+
+#include <stddef.h>
+
+/* The states of the sockets of all the families are numbered as the TCP
+   states in the kernel, from 1 (ESTABLISHED) to 11 (CLOSING).  */
+#define SOCK_NSTATES  12
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  struct nlmsghdr;
+  struct inet_diag_msg;
+  struct rtattr;
+
+  /* Called for each message of a netlink dump, the message H.  */
+  typedef void (*netlink_dump_fn) (const struct nlmsghdr *h, void *data);
+
+  /* Called for each socket of an AF_INET or AF_INET6 dump, with the
+   * attributes of MSG indexed by type (INET_DIAG_MAX + 1 entries).  */
+  typedef void (*inet_diag_fn) (const struct inet_diag_msg *msg,
+				struct rtattr *attrs[], void *data);
+
+  /* Open a NETLINK_SOCK_DIAG socket.  Return -1 with errno set on error.  */
+  int sock_diag_open (void);
+
+  /* Send the dump REQUEST of LEN bytes, a netlink message, to the netlink
+   * socket FD and call FN for each message of the replies.  This is shared
+   * by the NETLINK_SOCK_DIAG and the NETLINK_NETFILTER dumps.
+   * Return 0, or -1 with errno set on error.  */
+  int netlink_dump (int fd, const void *request, size_t len,
+		    netlink_dump_fn fn, void *data);
+
+  /* Dump the sockets of FAMILY and PROTOCOL in the STATES (a mask of
+   * 1 << state), filtered by the inet_diag BYTECODE if BCLEN is not 0,
+   * with the extensions EXT, and call FN for each of them.
+   * Return 0, or -1 with errno set on error.  */
+  int inet_diag_dump (int fd, int family, int protocol, unsigned int states,
+		      unsigned char ext, const void *bytecode, size_t bclen,
+		      inet_diag_fn fn, void *data);
+
+  /* The kinds of sockets counted by sock_count_read() */
+  enum sock_kind
+  {
+    SOCK_KIND_UDP,
+    SOCK_KIND_UDP6,
+    SOCK_KIND_RAW,
+    SOCK_KIND_RAW6,
+    SOCK_KIND_UNIX_STREAM,
+    SOCK_KIND_UNIX_DGRAM,
+    SOCK_KIND_UNIX_SEQPACKET,
+    SOCK_KINDS
+  };
+
+#define SOCK_KIND_UNIX \
+  ((1 << SOCK_KIND_UNIX_STREAM) | (1 << SOCK_KIND_UNIX_DGRAM) \
+   | (1 << SOCK_KIND_UNIX_SEQPACKET))
+
+  struct sock_count
+  {
+    unsigned long sockets;
+    unsigned long state[SOCK_NSTATES];	/* the sockets by state */
+    unsigned long queued;	/* the sockets with data to be read */
+    unsigned long long rqueue;	/* the bytes queued to be read */
+    unsigned long long max_rqueue;	/* the longest queue, in bytes */
+  };
+
+  /* Return the name of KIND ("udp", "unix_stream", ...).  */
+  const char *sock_kind_name (enum sock_kind kind);
+
+  /* Count the sockets of the KINDS (a mask of 1 << kind) in the array
+   * COUNT of SOCK_KINDS elements, dumping them with NETLINK_SOCK_DIAG.
+   * The listening sockets are not accounted in the receive queues.
+   * Return 0, or -1 with errno set on error.  */
+  int sock_count_read (unsigned int kinds, struct sock_count *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _SOCKDIAG_H */
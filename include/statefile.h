@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* statefile.h -- samples persisted between two executions of a plugin
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _STATEFILE_H
+#define _STATEFILE_H
+
+#include <stddef.h>
+
+#include "system.h"
+
+/* The state files are stored in NPL_STATE_DIR, by default
+ * /dev/shm/npl-state-<uid>.  */
+#define NPL_STATE_DIR_ENV  "NPL_STATE_DIR"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  struct statefile;
+
+  /* Load the samples saved by the last execution of the plugin for the
+   * check ID (for instance the object being monitored).  Each sample is
+   * made of NVALUES counters and is identified by a key.
+   * The samples are discarded if they were taken before the last boot or
+   * with a different NVALUES.  */
+  struct statefile *statefile_open (const char *id, size_t nvalues);
+
+  /* Return the number of seconds elapsed since the samples loaded by
+   * statefile_open() were saved, or 0 if there are none.  */
+  double statefile_elapsed (const struct statefile *state);
+
+  /* Return the values saved for KEY, or NULL.  */
+  const unsigned long long *statefile_get (const struct statefile *state,
+					   const char *key);
+
+  /* Set the values of KEY to be saved.  */
+  void statefile_put (struct statefile *state, const char *key,
+		      const unsigned long long *values);
+
+  /* Return the seconds elapsed since the previous sample of the counters
+   * just read by the plugin.  This is the sample loaded by
+   * statefile_open() if there is one at least DELAY seconds old with the
+   * values of all the NKEYS KEYS (the NULL ones being skipped).
+   * Otherwise the counters are read again by RESAMPLE (DATA) after DELAY
+   * seconds, the ones read before becoming the previous sample.  */
+  double statefile_sample (const struct statefile *state,
+			   unsigned long delay, const char *const keys[],
+			   size_t nkeys, void (*resample) (void *data),
+			   void *data);
+
+  /* Like statefile_sample(), for the NSTATES states opened by a plugin
+   * checking several objects that share the delay, each state being
+   * required to have the values of KEY.  The counters of all the objects
+   * are read again by RESAMPLE (DATA) if at least one state has no such
+   * sample.  Store in ELAPSED[i] the seconds elapsed since the previous
+   * sample of STATES[i], and return true if the counters were read
+   * again.  */
+  bool statefile_sample_states (struct statefile *const states[],
+				size_t nstates, unsigned long delay,
+				const char *key, double elapsed[],
+				void (*resample) (void *data), void *data);
+
+  /* Replace the state file with the samples set by statefile_put().
+   * Return 0, or -1 with errno set on error.  */
+  int statefile_save (struct statefile *state);
+
+  void statefile_free (struct statefile *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _STATEFILE_H */
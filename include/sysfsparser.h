@@ -20,8 +20,7 @@
 #include <dirent.h>
 #include <limits.h>
 #include "system.h"
-
-#define PATH_SYS  "/sys"
+#include "sysio.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -33,16 +32,23 @@ extern "C"
   void sysfsparser_check_for_sysfs(void);
   bool sysfsparser_path_exist (const char *path, ...)
        _attribute_format_printf_(1, 2);
-  void sysfsparser_opendir(DIR **dirp, const char *path, ...)
+  void sysfsparser_opendir(struct sysio_dir **dirp, const char *path, ...)
        _attribute_format_printf_(2, 3);
-  void sysfsparser_closedir(DIR *dirp);
-  struct dirent *sysfsparser_readfilename(DIR *dirp, unsigned int flags);
+  void sysfsparser_closedir(struct sysio_dir *dirp);
+  struct dirent *sysfsparser_readfilename(struct sysio_dir *dirp,
+					  unsigned int flags);
 
   char *sysfsparser_getline (const char *filename, ...)
        _attribute_format_printf_(1, 2);
   unsigned long long sysfsparser_getvalue (const char *filename, ...)
        _attribute_format_printf_(1, 2);
 
+  /* Read the N numeric attributes NAMES of the directory DIR into VALUES,
+   * with no memory allocation.  The attributes that cannot be read or
+   * parsed are set to 0.  Return the number of attributes read.  */
+  size_t sysfsparser_getvalues (const char *dir, const char *const names[],
+				unsigned long long values[], size_t n);
+
   /* Lookup a pattern and get the value from line
    * Format is:
    *     "<pattern> <numeric-key>"
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* sysio.h -- access to the proc and sysfs filesystems
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _SYSIO_H
+#define _SYSIO_H
+
+#include <sys/types.h>
+#include <dirent.h>
+#include <stdio.h>
+
+#include "system.h"
+
+#define PATH_PROC  "/proc"
+#define PATH_SYS   "/sys"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  /* Return the directory where the proc filesystem can be found: "/proc",
+   * or the content of the environment variable "NPL_PROC_ROOT" if set.  */
+  const char *sysio_proc_root (void);
+
+  /* Return the directory where the sysfs filesystem can be found: "/sys",
+   * or the content of the environment variable "NPL_SYS_ROOT" if set.  */
+  const char *sysio_sys_root (void);
+
+  /* Return true if the proc or the sysfs root has been redirected.  */
+  bool sysio_proc_root_is_set (void);
+  bool sysio_sys_root_is_set (void);
+
+  /* Map PATH, an absolute path starting with "/proc" or "/sys", to the
+   * configured proc or sysfs root.  PATH itself is returned when no mapping
+   * is needed, otherwise the new path is stored in BUF.
+   * NULL is returned (and errno set to ENAMETOOLONG) if BUF is too short. */
+  const char *sysio_path (const char *path, char *buf, size_t size);
+
+  /* Wrappers around fopen (read-only), opendir, access, and scandir, that
+   * resolve PATH with sysio_path(), and are recorded and replayed as
+   * described in sysio_record.h.  */
+  FILE *sysio_fopen (const char *path);
+
+  /* Read at most SIZE - 1 bytes of the file PATH into BUF, and terminate
+   * them with a NUL byte.  This function does not allocate memory and does
+   * not use a stdio stream, and is meant for reading many small files like
+   * the sysfs attributes.  Return the number of bytes read, or -1 with
+   * errno set.  */
+  ssize_t sysio_read (const char *path, char *buf, size_t size);
+
+  /* A directory opened with sysio_opendir().  Its entries are read with
+   * sysio_readdir(), that returns NULL at the end of the directory, and
+   * it is released with sysio_closedir().  */
+  struct sysio_dir;
+
+  struct sysio_dir *sysio_opendir (const char *path);
+  struct dirent *sysio_readdir (struct sysio_dir *dir);
+  void sysio_closedir (struct sysio_dir *dir);
+
+  int sysio_access (const char *path, int mode);
+  int sysio_scandir (const char *path, struct dirent ***namelist,
+		     int (*filter) (const struct dirent *),
+		     int (*compar) (const struct dirent **,
+				    const struct dirent **));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _SYSIO_H */
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/* sysio_record.h -- record and replay of the proc and sysfs reads
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _SYSIO_RECORD_H
+#define _SYSIO_RECORD_H
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "system.h"
+
+/* Setting NPL_RECORD to a file name appends every file read, directory
+ * listing, and access check done through sysio to this file.  Setting NPL_REPLAY to a file
+ * written this way serves the same reads from it, in the same order.  */
+#define NPL_RECORD_ENV  "NPL_RECORD"
+#define NPL_REPLAY_ENV  "NPL_REPLAY"
+
+/* The file starts with SYSIO_RECORD_MAGIC, followed by the records.  */
+#define SYSIO_RECORD_MAGIC  "NPLREC1\n"
+
+/* A record is made of this header, in the host byte order, followed by
+ * PATHLEN bytes of path (not NUL terminated) and DATALEN bytes of data.  */
+struct sysio_record_header
+{
+  uint32_t type;		/* enum sysio_record_type */
+  uint32_t pathlen;
+  uint32_t datalen;
+  int32_t error;		/* errno, or zero if the call succeeded */
+  int64_t time_ns;		/* CLOCK_REALTIME, in nanoseconds */
+};
+
+enum sysio_record_type
+{
+  SYSIO_RECORD_FILE = 1,	/* the content of a file */
+  SYSIO_RECORD_ACCESS = 2,	/* the result of access(2); data is the mode */
+  SYSIO_RECORD_DIR = 3		/* a directory listing; data is the d_type
+				   byte and the NUL terminated name of each
+				   entry */
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+  enum sysio_record_mode
+  {
+    SYSIO_RECORD_OFF,
+    SYSIO_RECORD_ON,
+    SYSIO_RECORD_REPLAY
+  };
+
+  /* Return the mode selected by the environment.  */
+  enum sysio_record_mode sysio_record_mode (void);
+
+  /* Read the whole file SYSPATH, append it to the record file under the
+   * name PATH, and return a stream serving the data read.  */
+  FILE *sysio_record_fopen (const char *path, const char *syspath);
+
+  /* Read the file SYSPATH into BUF, like sysio_read(), and record it under
+   * the name PATH.  */
+  ssize_t sysio_record_read (const char *path, const char *syspath,
+			     char *buf, size_t size);
+
+  /* Record the result of access(SYSPATH, MODE) under the name PATH.  */
+  int sysio_record_access (const char *path, const char *syspath, int mode);
+
+  /* Read the directory SYSPATH and record its listing under the name PATH.
+   * Return the listing, in the SYSIO_RECORD_DIR format, and store its size
+   * in LEN.  The listing must be freed by the caller.  */
+  char *sysio_record_listdir (const char *path, const char *syspath,
+			      size_t *len);
+
+  /* Return a stream serving the next content recorded for PATH, or NULL
+   * with errno set to the recorded error (ENOENT if PATH was not read).  */
+  FILE *sysio_replay_fopen (const char *path);
+
+  /* Copy the next content recorded for PATH into BUF, like sysio_read().  */
+  ssize_t sysio_replay_read (const char *path, char *buf, size_t size);
+
+  /* Return the recorded result of access(PATH, MODE).  */
+  int sysio_replay_access (const char *path, int mode);
+
+  /* Return the next listing recorded for the directory PATH, and store its
+   * size in LEN, or return NULL with errno set, as sysio_replay_fopen().  */
+  const char *sysio_replay_listdir (const char *path, size_t *len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif				/* _SYSIO_RECORD_H */
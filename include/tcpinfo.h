@@ -17,6 +17,8 @@
 #ifndef _TCPINFO_H_
 #define _TCPINFO_H_
 
+#include "histogram.h"
+
 #define TCP_UNSET   0
 #define TCP_VERBOSE (1 << 1)
 #define TCP_v4      (1 << 2)
@@ -39,7 +41,7 @@ extern "C"
 
   /* Drop a reference of the tcptable library context. If the refcount of
    * reaches zero, the resources of the context will be released.  */
-  struct proc_cputable *proc_tcptable_unref (struct proc_tcptable *tcptable);
+  struct proc_tcptable *proc_tcptable_unref (struct proc_tcptable *tcptable);
 
   /* Accessing the values from proc_tcptable */
 
@@ -55,6 +57,109 @@ extern "C"
   unsigned long proc_tcp_get_tcp_listen (struct proc_tcptable *tcptable);
   unsigned long proc_tcp_get_tcp_closing (struct proc_tcptable *tcptable);
 
+  /* The TCP states are numbered as in the kernel, from 1 (ESTABLISHED)
+   * to TCP_NSTATES - 1 (CLOSING).  */
+#define TCP_NSTATES  12
+
+  /* Return the name of STATE ("ESTABLISHED", ...), or NULL.  */
+  const char *tcp_state_name (unsigned int state);
+
+  /* Return the state named NAME, case insensitively, or -1.  */
+  int tcp_state_lookup (const char *name);
+
+  /* The sockets bound to a local port, by state */
+  struct tcp_port_conn
+  {
+    unsigned int port;
+    unsigned int state[TCP_NSTATES];
+    unsigned long total;
+  };
+
+  /* The connections, in any state but LISTEN, with a remote address.
+   * The IPv4 addresses are stored in the first 4 bytes of ADDR.  */
+  struct tcp_peer_conn
+  {
+    int family;
+    unsigned char addr[16];
+    unsigned long connections;
+  };
+
+  struct tcp_conntable;
+
+  /* Allocate an empty table of the sockets by local port and by remote
+   * address, that grows with the number of the distinct keys only.  */
+  struct tcp_conntable *tcp_conntable_new (void);
+  void tcp_conntable_free (struct tcp_conntable *table);
+
+  /* Add the sockets of the families selected by FLAGS to TABLE, reading
+   * /proc/net/tcp{,6} or dumping them with NETLINK_SOCK_DIAG.
+   * tcp_conntable_read_diag() returns -1 with errno set and an empty
+   * TABLE on error.  */
+  void tcp_conntable_read_proc (struct tcp_conntable *table, int flags);
+  int tcp_conntable_read_diag (struct tcp_conntable *table, int flags);
+
+  /* Return the sockets of the local PORT, or NULL if there are none.  */
+  const struct tcp_port_conn *
+    tcp_conntable_port (const struct tcp_conntable *table, unsigned int port);
+
+  /* Return in PORTS the local ports sorted, and their number.
+   * PORTS must be freed by the caller.  */
+  size_t tcp_conntable_ports (const struct tcp_conntable *table,
+			      struct tcp_port_conn **ports);
+
+  /* Return in PEERS the N remote addresses with more connections, in
+   * decreasing order, and their number.  PEERS must be freed by the
+   * caller.  */
+  size_t tcp_conntable_top_peers (const struct tcp_conntable *table,
+				  size_t n, struct tcp_peer_conn **peers);
+
+  /* The listening sockets bound to a TCP port */
+  struct tcp_listen_port
+  {
+    unsigned int port;
+    unsigned int sockets;	/* the number of listening sockets */
+    unsigned long backlog;	/* the connections waiting to be accepted */
+    unsigned long max_backlog;	/* the sum of the accept queue lengths */
+    double fill;		/* the highest fill ratio of a socket (%) */
+  };
+
+  /* Dump the listening sockets of the families selected by FLAGS (TCP_v4,
+   * TCP_v6) with NETLINK_SOCK_DIAG, and group them by port.  The ports are
+   * returned sorted in PORTS, which must be freed by the caller.
+   * Return the number of ports, or -1 with errno set on error.  */
+  int tcp_listen_read (int flags, struct tcp_listen_port **ports);
+
+  /* The established connections of a service port, that is the local
+   * port of each connection if a socket listens on it, and the remote port
+   * otherwise (the local one if it has been selected).  The connections of
+   * the ports exceeding TCP_QUALITY_PORTS_MAX are accounted to the port 0,
+   * so the memory used does not depend on the number of connections.  */
+#define TCP_QUALITY_PORTS_MAX  64
+
+  struct tcp_port_quality
+  {
+    unsigned int port;
+    unsigned long connections;
+    struct histogram rtt;	/* smoothed round trip time, in usec */
+    struct histogram unacked;	/* segments not acknowledged yet */
+    struct histogram cwnd;	/* congestion window, in segments */
+    unsigned long long retrans;	/* segments retransmitted */
+    unsigned long long segs_out;	/* segments sent (since Linux 4.2) */
+  };
+
+  /* Dump the established connections of the families selected by FLAGS
+   * with their tcp_info, keeping only the ones with the local port SPORT
+   * and the remote port DPORT (0 for any) with an in-kernel filter.
+   * The ports are returned sorted in PORTS, which must be freed by the
+   * caller.  Return the number of ports, or -1 with errno set on error.  */
+  int tcp_quality_read (int flags, unsigned int sport, unsigned int dport,
+			struct tcp_port_quality **ports);
+
+  /* Read the ListenOverflows and ListenDrops counters of /proc/net/netstat.
+   * Return 0, or -1 if they cannot be read.  */
+  int proc_tcp_listen_drops (unsigned long long *overflows,
+			     unsigned long long *drops);
+
 #ifdef __cplusplus
 }
 #endif
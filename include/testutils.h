@@ -67,6 +67,33 @@ extern "C"
 {
 #endif
 
+  /* An entry of a fake proc or sys file system: a directory if CONTENT
+   * and TARGET are NULL, a hard link to the file TARGET (relative to the
+   * base directory), or a file with the text CONTENT.  */
+  struct test_tree_entry
+  {
+    const char *path;
+    const char *content;
+    const char *target;
+  };
+
+# define TEST_TREE_SIZE(tree)  (sizeof (tree) / sizeof ((tree)[0]))
+
+  /* Write CONTENT in the file NAME of the directory BASEDIR.
+     returns: -1 = error, 0 = success  */
+  int test_write (const char *basedir, const char *name,
+		  const char *content);
+
+  /* Create the NENTRIES entries of TREE, in this order, in BASEDIR.
+     returns: -1 = error, 0 = success  */
+  int test_tree_create (const char *basedir,
+			const struct test_tree_entry *tree, size_t nentries);
+
+  /* Remove the entries of TREE, possibly created in part only, and
+     BASEDIR.  */
+  void test_tree_remove (const char *basedir,
+			 const struct test_tree_entry *tree, size_t nentries);
+
   char * test_fstringify (const char * filename);
   int test_main (int argc, char **argv, int (*func) (void), ...);
 
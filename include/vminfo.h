@@ -34,8 +34,9 @@ extern "C"
   int proc_vmem_new (struct proc_vmem **vmem);
 
   /* Fill the proc_vmem structure pointed with the values found in the
-   * proc filesystem.  */
-  void proc_vmem_read (struct proc_vmem *vmem);
+   * proc filesystem.
+   * Returns 0 if all went ok. Errors are returned as negative values.  */
+  int proc_vmem_read (struct proc_vmem *vmem);
 
   /* Drop a reference of the virtual memory library context. If the refcount
    * of reaches zero, the resources of the context will be released.  */
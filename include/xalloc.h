@@ -36,6 +36,27 @@ extern "C" {
   void *xrealloc (void *p, const size_t s)
 	_attribute_malloc_ _attribute_alloc_size_ ((2));
 
+  /* Number of calls to xmalloc and xrealloc, bytes requested, and bytes
+     taken from the bump arena (only with --enable-xalloc-arena).  */
+  struct xalloc_stats
+  {
+    unsigned long long allocs;
+    unsigned long long bytes;
+    unsigned long long arena_bytes;
+  };
+
+  void xalloc_stats_get (struct xalloc_stats *stats);
+
+#if ENABLE_XALLOC_ARENA
+# include <stdbool.h>
+
+  /* Return true if P has been allocated from the arena.  */
+  bool xalloc_arena_owns (const void *p);
+
+  /* Resize the block P allocated from the arena.  */
+  void *xalloc_arena_realloc (void *p, size_t n);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
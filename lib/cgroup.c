@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for reading the CPU controller of the cgroup v2 hierarchy.
+ *
+ * See the kernel documentation: Documentation/admin-guide/cgroup-v2.rst
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cgroup.h"
+#include "cputopology.h"
+#include "logging.h"
+#include "string-macros.h"
+#include "sysio.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+
+#define PATH_PROC_SELF_CGROUP  PATH_PROC "/self/cgroup"
+
+/* Read the file NAME of the cgroup directory CGROUP into BUF.  */
+static ssize_t
+cgroup_read (const char *cgroup, const char *name, char *buf, size_t size)
+{
+  char path[PATH_MAX];
+  int len = snprintf (path, sizeof path, "%s/%s", cgroup, name);
+
+  if (len < 0 || (size_t) len >= sizeof path)
+    {
+      errno = ENAMETOOLONG;
+      return -1;
+    }
+
+  return sysio_read (path, buf, size);
+}
+
+char *
+cgroup_path (const char *name)
+{
+  char buf[PATH_MAX], *line, *path;
+
+  if (sysio_access (PATH_SYS_CGROUP "/cgroup.controllers", F_OK) < 0)
+    {
+      dbg ("the cgroup v2 hierarchy is not mounted\n");
+      return NULL;
+    }
+
+  if (name)
+    {
+      while (*name == '/')
+	name++;
+      return *name ?
+	xasprintf ("%s/%s", PATH_SYS_CGROUP, name) : xstrdup (PATH_SYS_CGROUP);
+    }
+
+  /* with the unified hierarchy, the line is "0::/path/of/the/cgroup" */
+  if (sysio_read (PATH_PROC_SELF_CGROUP, buf, sizeof buf) < 0)
+    return NULL;
+  for (line = buf; line && *line; line = strchr (line, '\n'))
+    {
+      if (*line == '\n')
+	line++;
+      if (STRPREFIX (line, "0::/"))
+	break;
+    }
+  if (NULL == line || !*line)
+    return NULL;
+
+  line += 4;
+  line[strcspn (line, "\n")] = '\0';
+  /* the processes of a container in a cgroup namespace see "/" */
+  path = *line ?
+    xasprintf ("%s/%s", PATH_SYS_CGROUP, line) : xstrdup (PATH_SYS_CGROUP);
+
+  dbg ("cgroup of the plugin: %s\n", path);
+  return path;
+}
+
+static int
+cgroup_walk_dir (const char *cgroup, struct sysio_dir *dirp,
+		 int (*fn) (const char *path, void *data), void *data)
+{
+  struct dirent *dp;
+  int ret;
+
+  if ((ret = fn (cgroup, data)))
+    return ret;
+
+  while ((dp = sysio_readdir (dirp)) != NULL)
+    {
+      char *path;
+      struct sysio_dir *subdirp;
+
+      /* the cgroup filesystem always reports the file types */
+      if (dp->d_type != DT_DIR || STREQ (dp->d_name, ".")
+	  || STREQ (dp->d_name, ".."))
+	continue;
+
+      path = xasprintf ("%s/%s", cgroup, dp->d_name);
+      if ((subdirp = sysio_opendir (path)))
+	{
+	  ret = cgroup_walk_dir (path, subdirp, fn, data);
+	  sysio_closedir (subdirp);
+	}
+      free (path);
+      if (ret)
+	return ret;
+    }
+
+  return 0;
+}
+
+int
+cgroup_walk (const char *cgroup, int (*fn) (const char *path, void *data),
+	     void *data)
+{
+  struct sysio_dir *dirp;
+  int ret;
+
+  if (NULL == (dirp = sysio_opendir (cgroup)))
+    return -1;
+
+  ret = cgroup_walk_dir (cgroup, dirp, fn, data);
+  sysio_closedir (dirp);
+
+  return ret;
+}
+
+/* Return the number of CPUs in the cpu list STR, or 0 on error.  */
+static unsigned int
+cgroup_cpulist_count (const char *str)
+{
+  cpu_set_t *set;
+  size_t setsize;
+  int ncpus;
+
+  if (!(set = cpulist_alloc (str, &setsize, &ncpus)))
+    return 0;
+
+  CPU_FREE (set);
+  return ncpus;
+}
+
+int
+cgroup_cpu_capacity (const char *cgroup, struct cgroup_cpu_capacity *capacity)
+{
+  char buf[4096], *dir, *slash;
+  int online;
+
+  memset (capacity, 0, sizeof (struct cgroup_cpu_capacity));
+
+  /* the quota of a cgroup is also limited by the quotas of its ancestors */
+  dir = xstrdup (cgroup);
+  for (;;)
+    {
+      unsigned long long quota, period;
+
+      if (cgroup_read (dir, "cpu.max", buf, sizeof buf) > 0
+	  && sscanf (buf, "%llu %llu", &quota, &period) == 2 && period > 0)
+	{
+	  double cpus = (double) quota / period;
+
+	  dbg ("%s/cpu.max: %llu %llu\n", dir, quota, period);
+	  if (capacity->quota == 0 || cpus < capacity->quota)
+	    capacity->quota = cpus;
+	}
+
+      if (STREQ (dir, PATH_SYS_CGROUP)
+	  || !STRPREFIX (dir, PATH_SYS_CGROUP "/")
+	  || NULL == (slash = strrchr (dir, '/')))
+	break;
+      *slash = '\0';
+    }
+  free (dir);
+
+  /* the effective cpuset already accounts for the ancestors */
+  if (cgroup_read (cgroup, "cpuset.cpus.effective", buf, sizeof buf) > 0)
+    capacity->cpuset = cgroup_cpulist_count (buf);
+
+  if ((online = get_processor_number_online ()) > 0)
+    capacity->online = online;
+
+  capacity->capacity = capacity->online;
+  if (capacity->cpuset > 0
+      && (capacity->capacity == 0 || capacity->cpuset < capacity->capacity))
+    capacity->capacity = capacity->cpuset;
+  if (capacity->quota > 0
+      && (capacity->capacity == 0 || capacity->quota < capacity->capacity))
+    capacity->capacity = capacity->quota;
+
+  dbg ("cpu capacity: quota %g, cpuset %u, online %u -> %g\n",
+       capacity->quota, capacity->cpuset, capacity->online,
+       capacity->capacity);
+
+  return capacity->capacity > 0 ? 0 : -1;
+}
+
+int
+cgroup_cpu_stat (const char *cgroup, struct cgroup_cpu_stat *stat)
+{
+  static const struct
+  {
+    const char *key;
+    size_t offset;
+  } keys[] = {
+    { "usage_usec", offsetof (struct cgroup_cpu_stat, usage_usec) },
+    { "user_usec", offsetof (struct cgroup_cpu_stat, user_usec) },
+    { "system_usec", offsetof (struct cgroup_cpu_stat, system_usec) },
+    { "nr_periods", offsetof (struct cgroup_cpu_stat, nr_periods) },
+    { "nr_throttled", offsetof (struct cgroup_cpu_stat, nr_throttled) },
+    { "throttled_usec", offsetof (struct cgroup_cpu_stat, throttled_usec) }
+  };
+  char buf[1024], *line, *eol;
+  size_t i;
+
+  memset (stat, 0, sizeof (struct cgroup_cpu_stat));
+  if (cgroup_read (cgroup, "cpu.stat", buf, sizeof buf) < 0)
+    return -1;
+
+  for (line = buf; *line; line = eol)
+    {
+      if ((eol = strchr (line, '\n')))
+	*eol++ = '\0';
+      else
+	eol = line + strlen (line);
+
+      for (i = 0; i < sizeof (keys) / sizeof (keys[0]); i++)
+	{
+	  size_t len = strlen (keys[i].key);
+	  if (STREQLEN (line, keys[i].key, len) && line[len] == ' ')
+	    {
+	      *(unsigned long long *) ((char *) stat + keys[i].offset) =
+		strtoull (line + len + 1, NULL, 10);
+	      break;
+	    }
+	}
+    }
+
+  return 0;
+}
+
+int
+cgroup_cpu_pressure (const char *cgroup, struct cgroup_cpu_pressure *pressure)
+{
+  char buf[256];
+
+  memset (pressure, 0, sizeof (struct cgroup_cpu_pressure));
+  if (cgroup_read (cgroup, "cpu.pressure", buf, sizeof buf) < 0)
+    return -1;
+
+  if (sscanf (buf, "some avg10=%lf avg60=%lf avg300=%lf total=%llu",
+	      &pressure->avg10, &pressure->avg60, &pressure->avg300,
+	      &pressure->total) != 4)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,298 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for checking the netfilter connection tracking table
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if HAVE_NETINET_IN_H
+# include <netinet/in.h>
+#endif
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#if HAVE_LINUX_NETFILTER_NFNETLINK_CONNTRACK_H
+# include <linux/netfilter/nfnetlink.h>
+# include <linux/netfilter/nfnetlink_conntrack.h>
+#endif
+
+#include "conntrack.h"
+#include "instrument.h"
+#include "logging.h"
+#include "sockdiag.h"
+#include "string-macros.h"
+#include "sysio.h"
+#include "xalloc.h"
+
+#define PATH_CONNTRACK_COUNT  PATH_PROC "/sys/net/netfilter/nf_conntrack_count"
+#define PATH_CONNTRACK_MAX    PATH_PROC "/sys/net/netfilter/nf_conntrack_max"
+#define PATH_CONNTRACK_STAT   PATH_PROC "/net/stat/nf_conntrack"
+
+static const char *conntrack_counter_names[CONNTRACK_COUNTERS] = {
+  [CONNTRACK_INSERT_FAILED] = "insert_failed",
+  [CONNTRACK_DROP] = "drop",
+  [CONNTRACK_EARLY_DROP] = "early_drop",
+  [CONNTRACK_SEARCH_RESTART] = "search_restart"
+};
+
+static const char *conntrack_proto_names[CONNTRACK_PROTOS] = {
+  [CONNTRACK_PROTO_TCP] = "tcp",
+  [CONNTRACK_PROTO_UDP] = "udp",
+  [CONNTRACK_PROTO_ICMP] = "icmp",
+  [CONNTRACK_PROTO_ICMPV6] = "icmpv6",
+  [CONNTRACK_PROTO_OTHER] = "other"
+};
+
+/* enum tcp_conntrack of linux/netfilter/nf_conntrack_tcp.h */
+static const char *conntrack_tcp_state_names[CONNTRACK_TCP_STATES] = {
+  "none", "syn_sent", "syn_recv", "established", "fin_wait", "close_wait",
+  "last_ack", "time_wait", "close", "syn_sent2"
+};
+
+const char *
+conntrack_counter_name (enum conntrack_counter counter)
+{
+  return (counter < CONNTRACK_COUNTERS) ?
+    conntrack_counter_names[counter] : NULL;
+}
+
+const char *
+conntrack_proto_name (enum conntrack_proto proto)
+{
+  return (proto < CONNTRACK_PROTOS) ? conntrack_proto_names[proto] : NULL;
+}
+
+const char *
+conntrack_tcp_state_name (unsigned int state)
+{
+  return (state < CONNTRACK_TCP_STATES) ?
+    conntrack_tcp_state_names[state] : NULL;
+}
+
+static int
+conntrack_read_value (const char *path, unsigned long long *value)
+{
+  char buf[32], *end;
+
+  if (sysio_read (path, buf, sizeof (buf)) < 0)
+    return -1;
+
+  errno = 0;
+  *value = strtoull (buf, &end, 10);
+  if (errno != 0 || end == buf)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+  return 0;
+}
+
+int
+conntrack_usage (unsigned long long *count, unsigned long long *max)
+{
+  if (conntrack_read_value (PATH_CONNTRACK_COUNT, count) < 0
+      || conntrack_read_value (PATH_CONNTRACK_MAX, max) < 0)
+    return -1;
+
+  dbg ("conntrack table: %llu/%llu entries\n", *count, *max);
+  return 0;
+}
+
+/* Parses /proc/net/stat/nf_conntrack, a line with the names of the
+ * counters followed by a line of hexadecimal values per CPU.  */
+
+int
+conntrack_stat_read (unsigned long long *counters)
+{
+  FILE *fp;
+  char *line = NULL, *name, *saveptr;
+  size_t len = 0, ncolumns = 0, i;
+  int *column = NULL, ret = -1;
+
+  memset (counters, 0, CONNTRACK_COUNTERS * sizeof (unsigned long long));
+  if ((fp = sysio_fopen (PATH_CONNTRACK_STAT)) == NULL)
+    return -1;
+
+  instrument_phase_push (NPL_PHASE_PARSE);
+  if (getline (&line, &len, fp) == -1)
+    goto out;
+
+  /* the counter of each column, or -1 if not needed */
+  for (name = strtok_r (line, " \t\n", &saveptr); name;
+       name = strtok_r (NULL, " \t\n", &saveptr))
+    {
+      column = xrealloc (column, (ncolumns + 1) * sizeof (int));
+      column[ncolumns] = -1;
+      for (i = 0; i < CONNTRACK_COUNTERS; i++)
+	if (STREQ (name, conntrack_counter_names[i]))
+	  column[ncolumns] = i;
+      ncolumns++;
+    }
+
+  while (getline (&line, &len, fp) != -1)
+    {
+      char *value = strtok_r (line, " \t\n", &saveptr);
+
+      for (i = 0; i < ncolumns && value;
+	   i++, value = strtok_r (NULL, " \t\n", &saveptr))
+	if (column[i] >= 0)
+	  counters[column[i]] += strtoull (value, NULL, 16);
+    }
+  ret = 0;
+
+out:
+  free (column);
+  free (line);
+  fclose (fp);
+  instrument_phase_pop ();
+
+  return ret;
+}
+
+#if HAVE_LINUX_NETFILTER_NFNETLINK_CONNTRACK_H
+
+/* The attributes of the kernel set NLA_F_NESTED on the nested ones */
+#define CONNTRACK_ATTR_TYPE(rta)  ((rta)->rta_type & NLA_TYPE_MASK)
+
+/* Return the attribute TYPE among the LEN bytes of attributes at RTA.  */
+
+static struct rtattr *
+conntrack_attr (struct rtattr *rta, int len, unsigned short type)
+{
+  for (; RTA_OK (rta, len); rta = RTA_NEXT (rta, len))
+    if (CONNTRACK_ATTR_TYPE (rta) == type)
+      return rta;
+  return NULL;
+}
+
+static struct rtattr *
+conntrack_nested_attr (struct rtattr *rta, unsigned short type)
+{
+  return rta ? conntrack_attr (RTA_DATA (rta), RTA_PAYLOAD (rta), type)
+	     : NULL;
+}
+
+/* Account the entry H, looking for the protocol in the original tuple and
+   for the state of the TCP ones.  */
+
+static void
+conntrack_table_add (const struct nlmsghdr *h, void *data)
+{
+  struct conntrack_table *table = data;
+  struct rtattr *attrs, *rta;
+  int len;
+
+  if (NFNL_MSG_TYPE (h->nlmsg_type) != IPCTNL_MSG_CT_NEW)
+    return;
+
+  attrs = (struct rtattr *) ((char *) NLMSG_DATA (h)
+			     + NLMSG_ALIGN (sizeof (struct nfgenmsg)));
+  len = h->nlmsg_len - NLMSG_SPACE (sizeof (struct nfgenmsg));
+
+  table->entries++;
+  rta = conntrack_nested_attr (conntrack_nested_attr
+			       (conntrack_attr (attrs, len, CTA_TUPLE_ORIG),
+				CTA_TUPLE_PROTO), CTA_PROTO_NUM);
+  switch (rta ? *(unsigned char *) RTA_DATA (rta) : 0)
+    {
+    case IPPROTO_TCP:
+      table->proto[CONNTRACK_PROTO_TCP]++;
+      rta = conntrack_nested_attr (conntrack_nested_attr
+				   (conntrack_attr (attrs, len,
+						    CTA_PROTOINFO),
+				    CTA_PROTOINFO_TCP),
+				   CTA_PROTOINFO_TCP_STATE);
+      if (rta && *(unsigned char *) RTA_DATA (rta) < CONNTRACK_TCP_STATES)
+	table->tcp_state[*(unsigned char *) RTA_DATA (rta)]++;
+      break;
+    case IPPROTO_UDP:
+      table->proto[CONNTRACK_PROTO_UDP]++;
+      break;
+    case IPPROTO_ICMP:
+      table->proto[CONNTRACK_PROTO_ICMP]++;
+      break;
+    case IPPROTO_ICMPV6:
+      table->proto[CONNTRACK_PROTO_ICMPV6]++;
+      break;
+    default:
+      table->proto[CONNTRACK_PROTO_OTHER]++;
+      break;
+    }
+}
+
+/* The entries of all the families are dumped with AF_UNSPEC, and counted
+   while the replies are read, so the memory used does not depend on the
+   size of the table.  */
+
+int
+conntrack_table_read (struct conntrack_table *table)
+{
+  struct
+  {
+    struct nlmsghdr nlh;
+    struct nfgenmsg nfmsg;
+  } request;
+  int fd, ret;
+
+  memset (table, 0, sizeof (struct conntrack_table));
+  if ((fd = socket (AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC,
+		    NETLINK_NETFILTER)) < 0)
+    return -1;
+
+  memset (&request, 0, sizeof (request));
+  request.nlh.nlmsg_len = NLMSG_LENGTH (sizeof (request.nfmsg));
+  request.nlh.nlmsg_type = (NFNL_SUBSYS_CTNETLINK << 8) | IPCTNL_MSG_CT_GET;
+  request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.nfmsg.nfgen_family = AF_UNSPEC;
+  request.nfmsg.version = NFNETLINK_V0;
+
+  ret = netlink_dump (fd, &request, request.nlh.nlmsg_len,
+		      conntrack_table_add, table);
+  if (ret < 0)
+    {
+      int saved_errno = errno;
+      close (fd);
+      errno = saved_errno;
+      return -1;
+    }
+
+  close (fd);
+  return 0;
+}
+
+#undef CONNTRACK_ATTR_TYPE
+
+#else
+
+int
+conntrack_table_read (struct conntrack_table *table)
+{
+  memset (table, 0, sizeof (struct conntrack_table));
+  errno = ENOSYS;
+  return -1;
+}
+
+#endif
@@ -40,9 +40,12 @@ static const char *docker_socket = DOCKER_SOCKET;
 #include "common.h"
 #include "collection.h"
 #include "container_docker.h"
+#include "instrument.h"
 #include "json_helpers.h"
+#include "lazylib.h"
 #include "logging.h"
 #include "messages.h"
+#include "metrics.h"
 #include "string-macros.h"
 #include "system.h"
 #include "url_encode.h"
@@ -89,6 +92,57 @@ docker_json_parser (const char *json, const char *token, unsigned long increment
 
 #if !defined NPL_TESTING && defined HAVE_LIBCURL
 
+#if ENABLE_LAZY_LIBS
+
+/* libcurl is only loaded when the Docker API is queried */
+
+static struct
+{
+  __typeof__ (curl_global_init) *global_init;
+  __typeof__ (curl_global_cleanup) *global_cleanup;
+  __typeof__ (curl_easy_init) *easy_init;
+  __typeof__ (curl_easy_setopt) *easy_setopt;
+  __typeof__ (curl_easy_perform) *easy_perform;
+  __typeof__ (curl_easy_strerror) *easy_strerror;
+  __typeof__ (curl_easy_cleanup) *easy_cleanup;
+} curl_api;
+
+static void
+curl_api_load (void)
+{
+  static const char *const sonames[] = {
+    "libcurl.so.4", "libcurl-gnutls.so.4", "libcurl-nss.so.4", NULL
+  };
+  void *handle;
+
+  if (curl_api.global_init)
+    return;
+
+  handle = lazylib_open (sonames);
+  LAZYLIB_SYM (handle, curl_api, global_init, "curl_global_init");
+  LAZYLIB_SYM (handle, curl_api, global_cleanup, "curl_global_cleanup");
+  LAZYLIB_SYM (handle, curl_api, easy_init, "curl_easy_init");
+  LAZYLIB_SYM (handle, curl_api, easy_setopt, "curl_easy_setopt");
+  LAZYLIB_SYM (handle, curl_api, easy_perform, "curl_easy_perform");
+  LAZYLIB_SYM (handle, curl_api, easy_strerror, "curl_easy_strerror");
+  LAZYLIB_SYM (handle, curl_api, easy_cleanup, "curl_easy_cleanup");
+}
+
+# undef curl_easy_setopt
+# define curl_global_init	(*curl_api.global_init)
+# define curl_global_cleanup	(*curl_api.global_cleanup)
+# define curl_easy_init		(*curl_api.easy_init)
+# define curl_easy_setopt	(*curl_api.easy_setopt)
+# define curl_easy_perform	(*curl_api.easy_perform)
+# define curl_easy_strerror	(*curl_api.easy_strerror)
+# define curl_easy_cleanup	(*curl_api.easy_cleanup)
+
+#else
+
+# define curl_api_load()
+
+#endif		/* ENABLE_LAZY_LIBS */
+
 static size_t
 write_memory_callback (void *contents, size_t size, size_t nmemb, void *userp)
 {
@@ -112,7 +166,10 @@ docker_init (CURL ** curl_handle, chunk_t * chunk)
   chunk->memory = malloc (1);	/* will be grown as needed by the realloc above */
   chunk->size = 0;		/* no data at this point */
 
-  curl_global_init (CURL_GLOBAL_ALL);
+  curl_api_load ();
+  /* the Docker API is reached through a unix socket: skip the costly
+     initialization of the TLS stack */
+  curl_global_init (CURL_GLOBAL_NOTHING);
 
   /* init the curl session */
   *curl_handle = curl_easy_init ();
@@ -156,7 +213,9 @@ docker_get (CURL * curl_handle, const int query)
   dbg ("docker rest url: %s\n", url);
 
   curl_easy_setopt (curl_handle, CURLOPT_URL, url);
+  instrument_phase_push (NPL_PHASE_READ);
   res = curl_easy_perform (curl_handle);
+  instrument_phase_pop ();
 
   free (filter);
   free (url);
@@ -182,8 +241,10 @@ docker_close (CURL * curl_handle, chunk_t * chunk)
 
 int
 docker_running_containers (unsigned int *count, const char *image,
-			   char **perfdata, bool verbose)
+			   struct metrics *metrics, bool verbose)
 {
+  struct metric metric = { .name = "containers", .label = "image" };
+  char *name;
   chunk_t chunk;
   hashtable_t *hashtable;
   unsigned int running_containers = 0;
@@ -225,22 +286,27 @@ docker_running_containers (unsigned int *count, const char *image,
       hashable_t *np = counter_lookup (hashtable, image);
       assert (NULL != np);
       running_containers = np ? np->count : 0;
-      *perfdata = xasprintf ("containers_%s=%u", image, running_containers);
+      metric.label_value = image;
+      metric.perfdata_label = name = xasprintf ("containers_%s", image);
+      metrics_add (metrics, &metric, running_containers);
+      free (name);
     }
   else
     {
       running_containers = counter_get_elements (hashtable);
-      size_t size;
-      FILE *stream = open_memstream (perfdata, &size);
       for (unsigned int j = 0; j < hashtable->uniq; j++)
 	{
 	  hashable_t *np = counter_lookup (hashtable, hashtable->keys[j]);
 	  assert (NULL != np);
-	  fprintf (stream, "containers_%s=%lu ",
-		   hashtable->keys[j], np->count);
+	  metric.label_value = hashtable->keys[j];
+	  metric.perfdata_label = name =
+	    xasprintf ("containers_%s", hashtable->keys[j]);
+	  metrics_add (metrics, &metric, np->count);
+	  free (name);
 	}
-      fprintf (stream, "containers_total=%u", hashtable->elements);
-      fclose (stream);
+      metric.name = "containers_total";
+      metric.label = metric.label_value = metric.perfdata_label = NULL;
+      metrics_add (metrics, &metric, hashtable->elements);
     }
 
   *count = running_containers;
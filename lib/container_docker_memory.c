@@ -28,6 +28,7 @@
 #include "logging.h"
 #include "messages.h"
 #include "sysfsparser.h"
+#include "sysio.h"
 #include "xasprintf.h"
 
 #ifndef NPL_TESTING
@@ -94,7 +95,7 @@ docker_memory_desc_read (struct docker_memory_desc *__restrict memdesc)
   if (NULL == syspath)
     plugin_error (STATE_UNKNOWN, errno, "sysfs file not found: memory.stat");
 
-  if ((fp = fopen (syspath, "r")) == NULL)
+  if ((fp = sysio_fopen (syspath)) == NULL)
     plugin_error (STATE_UNKNOWN, errno, "error opening %s", syspath);
 
   dbg ("parsing the file \"%s\"...\n", syspath);
@@ -27,20 +27,20 @@
 #include "container_podman.h"
 #include "logging.h"
 #include "messages.h"
+#include "metrics.h"
 #include "string-macros.h"
 
 int
 podman_running_containers (struct podman_varlink *pv, unsigned int *count,
-			   const char *image, char **perfdata)
+			   const char *image, struct metrics *metrics)
 {
   char *errmsg = NULL;
   long ret;
-  size_t size;
   unsigned int configured_containers, exited_containers,
 	       running_containers;
   unsigned long elements, i;
+  struct metric metric = { .name = NULL };
 
-  FILE *stream = open_memstream (perfdata, &size);
   hashtable_t *ht_running;
   VarlinkArray *list;
 
@@ -91,23 +91,33 @@ podman_running_containers (struct podman_varlink *pv, unsigned int *count,
        running_containers, configured_containers, exited_containers);
 
   if (image)
-    fprintf (stream, "configured=%u exited=%u running=%u",
-	     configured_containers, exited_containers,
-	     running_containers);
+    {
+      metric.name = "configured";
+      metrics_add (metrics, &metric, configured_containers);
+      metric.name = "exited";
+      metrics_add (metrics, &metric, exited_containers);
+      metric.name = "running";
+      metrics_add (metrics, &metric, running_containers);
+    }
   else
-    for (unsigned int j = 0; j < ht_running->uniq; j++)
-      {
-	char *image_norm =
-	  podman_image_name_normalize (ht_running->keys[j]);
-	hashable_t *np = counter_lookup (ht_running, ht_running->keys[j]);
-	assert (NULL != np);
-	fprintf (stream, "%s=%lu ", image_norm, np->count);
-	free (image_norm);
-      }
+    {
+      metric.name = "running";
+      metric.label = "image";
+      for (unsigned int j = 0; j < ht_running->uniq; j++)
+	{
+	  char *image_norm =
+	    podman_image_name_normalize (ht_running->keys[j]);
+	  hashable_t *np = counter_lookup (ht_running, ht_running->keys[j]);
+	  assert (NULL != np);
+	  metric.label_value = ht_running->keys[j];
+	  metric.perfdata_label = image_norm;
+	  metrics_add (metrics, &metric, np->count);
+	  free (image_norm);
+	}
+    }
 
   *count = running_containers;
 
-  fclose (stream);
   counter_free (ht_running);
   free (errmsg);
 
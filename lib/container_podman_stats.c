@@ -27,18 +27,19 @@
 #include "container_podman.h"
 #include "logging.h"
 #include "messages.h"
+#include "metrics.h"
 #include "string-macros.h"
 #include "xasprintf.h"
 
 void
 podman_stats (podman_varlink_t *pv, stats_type which_stats,
 	      bool report_perc, total_t *total, unit_shift shift,
-	      const char *image, char **status, char **perfdata)
+	      const char *image, char **status, struct metrics *metrics)
 {
-  char *errmsg = NULL, *total_str;
+  char *errmsg = NULL, *total_str, limit[32];
   long ret;
-  size_t size;
   unsigned long containers = 0, count, i;
+  struct metric metric = { .label = "container" };
   VarlinkArray *list;
 
   /* see the enum type 'stats_type' declared in container_podman.h */
@@ -51,9 +52,19 @@ podman_stats (podman_varlink_t *pv, stats_type which_stats,
      "network output",
      "pids"
   };
+  /* the names of the metrics, in the same order */
+  char const * which_stats_name[] = {
+     "block_input",
+     "block_output",
+     "cpu",
+     "memory",
+     "network_input",
+     "network_output",
+     "pids"
+  };
   assert (sizeof (which_stats_str) / sizeof (char *) != last_stats);
 
-  FILE *stream = open_memstream (perfdata, &size);
+  metric.name = which_stats_name[which_stats];
 
   if (which_stats == cpu_stats)
     total->lf = 0.0;
@@ -96,6 +107,7 @@ podman_stats (podman_varlink_t *pv, stats_type which_stats,
 	continue;
 
       containers++;
+      metric.label_value = metric.perfdata_label = stats.name;
 
       ret = podman_varlink_stats (pv, shortid, &stats, &errmsg);
       if (ret < 0)
@@ -108,38 +120,52 @@ podman_stats (podman_varlink_t *pv, stats_type which_stats,
 	  plugin_error (STATE_UNKNOWN, 0, "unknown podman container metric");
 	  break;
 	case block_in_stats:
-	  fprintf (stream, "%s=%ldkB ", stats.name, (stats.block_input / 1000));
+	  metric.unit = "kB";
+	  metrics_add (metrics, &metric, stats.block_input / 1000);
 	  total->llu += stats.block_input;
 	  break;
 	case block_out_stats:
-	  fprintf (stream, "%s=%ldkB ",
-		   stats.name, (stats.block_output / 1000));
+	  metric.unit = "kB";
+	  metrics_add (metrics, &metric, stats.block_output / 1000);
 	  total->llu += stats.block_output;
 	  break;
 	case cpu_stats:
-	  fprintf (stream, "%s=%.2lf%% ", stats.name, stats.cpu);
+	  metric.unit = "%";
+	  metric.precision = 2;
+	  metrics_add (metrics, &metric, stats.cpu);
 	  total->lf += stats.cpu;
 	  break;
 	case memory_stats:
 	  if (report_perc)
-	    fprintf
-	      (stream, "%s=%.2f%% ", stats.name,
-	        ((double)(stats.mem_usage) / (double)(stats.mem_limit)) * 100);
+	    {
+	      metric.unit = "%";
+	      metric.precision = 2;
+	      metrics_add (metrics, &metric,
+			   ((double)(stats.mem_usage) /
+			    (double)(stats.mem_limit)) * 100);
+	    }
 	  else
-	    fprintf (stream, "%s=%ldkB;;;0;%ld ", stats.name,
-		     (stats.mem_usage / 1000), (stats.mem_limit / 1000));
+	    {
+	      snprintf (limit, sizeof limit, "%ld", stats.mem_limit / 1000);
+	      metric.unit = "kB";
+	      metric.min = "0";
+	      metric.max = limit;
+	      metrics_add (metrics, &metric, stats.mem_usage / 1000);
+	    }
 	  total->llu += stats.mem_usage;
 	  break;
 	case network_in_stats:
-	  fprintf (stream, "%s=%ldB ", stats.name, stats.net_input);
+	  metric.unit = "B";
+	  metrics_add (metrics, &metric, stats.net_input);
 	  total->llu += stats.net_input;
 	  break;
 	case network_out_stats:
-	  fprintf (stream, "%s=%ldB ", stats.name, stats.net_output);
+	  metric.unit = "B";
+	  metrics_add (metrics, &metric, stats.net_output);
 	  total->llu += stats.net_output;
 	  break;
 	case pids_stats:
-	  fprintf (stream, "%s=%ld ", stats.name, stats.pids);
+	  metrics_add (metrics, &metric, stats.pids);
 	  total->llu += stats.pids;
 	  break;
 	}
@@ -147,8 +173,6 @@ podman_stats (podman_varlink_t *pv, stats_type which_stats,
       free (stats.name);
     }
 
-  fclose (stream);
-
   if ((which_stats != pids_stats) && (which_stats != cpu_stats))
     switch (shift)
       {
@@ -35,10 +35,11 @@
 #include "messages.h"
 #include "procparser.h"
 #include "sysfsparser.h"
+#include "sysio.h"
 #include "system.h"
 #include "xalloc.h"
 
-#define PATH_PROC_CPUINFO	"/proc/cpuinfo"
+#define PATH_PROC_CPUINFO	PATH_PROC "/cpuinfo"
 
 #define PATH_SYS_SYSTEM		PATH_SYS "/devices/system"
 #define PATH_SYS_CPU		PATH_SYS_SYSTEM "/cpu"
@@ -116,7 +117,7 @@ cpu_desc_read (struct cpu_desc *cpudesc)
   if (cpudesc == NULL)
     return;
 
-  if ((fp = fopen (PATH_PROC_CPUINFO,  "r")) == NULL)
+  if ((fp = sysio_fopen (PATH_PROC_CPUINFO)) == NULL)
     plugin_error (STATE_UNKNOWN, errno, "error opening %s", PATH_PROC_CPUINFO);
 
   if (uname (&utsbuf) == -1)
@@ -34,9 +34,11 @@
 #include "common.h"
 #include "cpustats.h"
 #include "getenv.h"
+#include "instrument.h"
 #include "logging.h"
 #include "messages.h"
 #include "procparser.h"
+#include "sysio.h"
 #include "system.h"
 #include "xalloc.h"
 #include "xasprintf.h"
@@ -48,25 +50,26 @@ get_path_proc_stat ()
   if (env_procstat)
     return env_procstat;
 
-  return "/proc/stat";
+  return PATH_PROC "/stat";
 }
 
 /* Fill the cpu_stats structure pointed with the values found in the
  * proc filesystem */
 
-void
-cpu_stats_get_time (struct cpu_time * __restrict cputime, unsigned int lines)
+int
+cpu_stats_read_time (struct cpu_time * __restrict cputime, unsigned int lines)
 {
   FILE *fp;
   size_t len = 0;
   ssize_t chread;
   char *line = NULL;
   bool found;
-  const char *procpath = get_path_proc_stat ();
+  int err = 0;
 
-  if ((fp = fopen (procpath, "r")) == NULL)
-    plugin_error (STATE_UNKNOWN, errno, "error opening %s", procpath);
+  if ((fp = sysio_fopen (get_path_proc_stat ())) == NULL)
+    return -1;
 
+  instrument_phase_push (NPL_PHASE_PARSE);
   memset (cputime, '\0', lines * sizeof (struct cpu_time));
 
   found = false;
@@ -93,9 +96,12 @@ cpu_stats_get_time (struct cpu_time * __restrict cputime, unsigned int lines)
 	  char *endptr;
 	  unsigned int cpunum = strtol (line + 3, &endptr, 10);
 	  if (lines <= cpunum + 1)
-	    plugin_error (STATE_UNKNOWN, 0,
-			  "BUG: %s(): lines(%u) <= cpunum(%u) + 1",
-			  __FUNCTION__, lines, cpunum);
+	    {
+	      dbg ("BUG: %s(): lines(%u) <= cpunum(%u) + 1\n",
+		   __FUNCTION__, lines, cpunum);
+	      err = ERANGE;
+	      break;
+	    }
 
 	  unsigned int i = cpunum + 1;
 	  cputime[i].cpuname = xasprintf ("cpu%u", cpunum);
@@ -114,35 +120,67 @@ cpu_stats_get_time (struct cpu_time * __restrict cputime, unsigned int lines)
 
   free (line);
   fclose (fp);
+  instrument_phase_pop ();
 
-  if (!found)
-    plugin_error (STATE_UNKNOWN, 0,
-		  "%s: pattern not found: 'cpu '", procpath);
+  if (!err && !found)
+    err = ENODATA;
+  if (err)
+    {
+      for (unsigned int i = 0; i < lines; i++)
+	{
+	  free ((char *) cputime[i].cpuname);
+	  cputime[i].cpuname = NULL;
+	}
+      errno = err;
+      return -1;
+    }
+
+  return 0;
 }
 
-static unsigned long long
-cpu_stats_get_value_with_pattern (const char *pattern, bool mandatory)
+void
+cpu_stats_get_time (struct cpu_time * __restrict cputime, unsigned int lines)
+{
+  const char *procpath = get_path_proc_stat ();
+
+  if (cpu_stats_read_time (cputime, lines) == 0)
+    return;
+
+  switch (errno)
+    {
+    case ENODATA:
+      plugin_error (STATE_UNKNOWN, 0,
+		    "%s: pattern not found: 'cpu '", procpath);
+    case ERANGE:
+      plugin_error (STATE_UNKNOWN, 0,
+		    "BUG: %s(): more cpus than the %u lines", __FUNCTION__,
+		    lines);
+    default:
+      plugin_error (STATE_UNKNOWN, errno, "error opening %s", procpath);
+    }
+}
+
+int
+cpu_stats_read_value (const char *pattern, unsigned long long *value)
 {
   FILE *fp;
   size_t len = 0;
   ssize_t chread;
   char *line = NULL;
   bool found;
-  unsigned long long value;
-  const char *procpath = get_path_proc_stat ();
 
-  if ((fp = fopen (procpath, "r")) == NULL)
-    plugin_error (STATE_UNKNOWN, errno, "error opening %s", procpath);
+  if ((fp = sysio_fopen (get_path_proc_stat ())) == NULL)
+    return -1;
 
-  value = 0;
+  *value = 0;
   found = false;
 
   while ((chread = getline (&line, &len, fp)) != -1)
     {
       if (!strncmp (line, pattern, strlen (pattern)))
 	{
-	  sscanf (line + strlen (pattern), "%llu", &value);
-	  dbg ("line: %s \\ value for '%s': %llu\n", line, pattern, value);
+	  sscanf (line + strlen (pattern), "%llu", value);
+	  dbg ("line: %s \\ value for '%s': %llu\n", line, pattern, *value);
 	  found = true;
 	  break;
 	}
@@ -151,9 +189,29 @@ cpu_stats_get_value_with_pattern (const char *pattern, bool mandatory)
   free (line);
   fclose (fp);
 
-  if (!found && mandatory)
-    plugin_error (STATE_UNKNOWN, 0,
-		  "%s: pattern not found: '%s'", procpath, pattern);
+  if (!found)
+    {
+      errno = ENODATA;
+      return -1;
+    }
+
+  return 0;
+}
+
+static unsigned long long
+cpu_stats_get_value_with_pattern (const char *pattern, bool mandatory)
+{
+  unsigned long long value;
+  const char *procpath = get_path_proc_stat ();
+
+  if (cpu_stats_read_value (pattern, &value) < 0)
+    {
+      if (errno != ENODATA)
+	plugin_error (STATE_UNKNOWN, errno, "error opening %s", procpath);
+      else if (mandatory)
+	plugin_error (STATE_UNKNOWN, 0,
+		      "%s: pattern not found: '%s'", procpath, pattern);
+    }
 
   return value;
 }
@@ -178,3 +236,15 @@ cpu_stats_get_softirq ()
   /* Not separated out until the 2.6.0-test4, hence 'false' */
   return cpu_stats_get_value_with_pattern ("softirq ", false);
 }
+
+unsigned long long
+cpu_stats_get_procs_running ()
+{
+  return cpu_stats_get_value_with_pattern ("procs_running ", false);
+}
+
+unsigned long long
+cpu_stats_get_procs_blocked ()
+{
+  return cpu_stats_get_value_with_pattern ("procs_blocked ", false);
+}
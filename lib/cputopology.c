@@ -33,6 +33,7 @@
 #include <sys/sysinfo.h>
 
 #include <ctype.h>
+#include <errno.h>
 #include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,6 +42,7 @@
 #include "common.h"
 #include "cputopology.h"
 #include "sysfsparser.h"
+#include "sysio.h"
 
 #define PATH_SYS_SYSTEM		PATH_SYS "/devices/system"
 #define PATH_SYS_CPU		PATH_SYS_SYSTEM "/cpu"
@@ -90,9 +92,29 @@ __cpuset_count_s (size_t setsize, const cpu_set_t * set)
  * In some situations these file systems are not mounted, and the sysconf
  * call returns 1, which does not reflect the reality.   */
 
+/* Return the number of CPUs listed in the sysfs file PATH_SYS_CPU/NAME, or -1
+ * on error.  Used when the sysfs root has been redirected, because the glibc
+ * functions always read the real sysfs.  */
+static int
+get_processor_number_from_cpulist (const char *name)
+{
+  cpu_set_t *set;
+  size_t setsize;
+  int ncpus;
+
+  if (NULL == (set = get_cpulist (name, &setsize, &ncpus)))
+    return -1;
+
+  CPU_FREE (set);
+  return ncpus;
+}
+
 int
 get_processor_number_total (void)
 {
+  if (sysio_sys_root_is_set ())
+    return get_processor_number_from_cpulist ("present");
+
   /* The number of CPUs configured in the system.   */
   return
 #if defined (HAVE_GET_NPROCS_CONF)
@@ -107,6 +129,9 @@ get_processor_number_total (void)
 int
 get_processor_number_online (void)
 {
+  if (sysio_sys_root_is_set ())
+    return get_processor_number_from_cpulist ("online");
+
   /* The number of CPUs available to the scheduler.   */
   return
 #if defined (HAVE_GET_NPROCS)
@@ -186,6 +211,89 @@ cpumask_parse (const char *str, cpu_set_t *set, size_t setsize)
   return CPU_COUNT_S (setsize, set);
 }
 
+/* Parses a string with a list of CPUs in the format used by the kernel
+ * (for instance "0-3,8,10-11") and return the number of CPUs in the list,
+ * or -1 if the string is not valid or lists a CPU not fitting in SET.  */
+
+int
+cpulist_parse (const char *str, cpu_set_t *set, size_t setsize)
+{
+  const char *p = str;
+  char *end;
+
+  if (!str)
+    return -1;
+
+  CPU_ZERO_S (setsize, set);
+
+  while (*p && *p != '\n')
+    {
+      unsigned long first, last, cpu;
+
+      errno = 0;
+      first = last = strtoul (p, &end, 10);
+      if (end == p || errno == ERANGE)
+	return -1;
+      p = end;
+
+      if (*p == '-')
+	{
+	  p++;
+	  last = strtoul (p, &end, 10);
+	  if (end == p || errno == ERANGE || last < first)
+	    return -1;
+	  p = end;
+	}
+      if (last >= 8 * setsize)
+	return -1;
+
+      for (cpu = first; cpu <= last; cpu++)
+	CPU_SET_S (cpu, setsize, set);
+
+      if (*p == ',')
+	p++;
+      else if (*p && *p != '\n')
+	return -1;
+    }
+
+  return CPU_COUNT_S (setsize, set);
+}
+
+cpu_set_t *
+cpulist_alloc (const char *str, size_t *setsize, int *ncpus)
+{
+  size_t maxcpus = get_processor_number_kernel_max ();
+  cpu_set_t *set;
+
+  if (maxcpus <= 1)
+    maxcpus = CPU_SETSIZE;
+  if (!(set = CPU_ALLOC (maxcpus)))
+    return NULL;
+  *setsize = CPU_ALLOC_SIZE (maxcpus);
+
+  if ((*ncpus = cpulist_parse (str, set, *setsize)) < 0)
+    {
+      CPU_FREE (set);
+      return NULL;
+    }
+
+  return set;
+}
+
+cpu_set_t *
+get_cpulist (const char *name, size_t *setsize, int *ncpus)
+{
+  cpu_set_t *set;
+  char *cpulist;
+
+  if (NULL == (cpulist = sysfsparser_getline (PATH_SYS_CPU "/%s", name)))
+    return NULL;
+
+  set = cpulist_alloc (cpulist, setsize, ncpus);
+  free (cpulist);
+  return set;
+}
+
 /* Get the number of threads within one core */
 
 void
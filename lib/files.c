@@ -31,14 +31,11 @@
 
 #include "files.h"
 #include "logging.h"
-#include "messages.h"
 #include "string-macros.h"
 #include "system.h"
 #include "xalloc.h"
 #include "xasprintf.h"
 
-static int deep = 0;
-
 static void
 files_data_init (struct files_types **filecount)
 {
@@ -103,12 +100,16 @@ files_check_size (int64_t size, off_t filesize)
 	  ((size > 0) && (filesize > abs_size)));
 }
 
-int
-files_filecount (const char *dir, unsigned int flags,
-		 int64_t age, int64_t size, const char *pattern,
-		 struct files_types **filecount)
+/* Scan the directory DIR, DEPTH levels below the directory given to
+   files_filecount().  The depth is only used by the debug messages.
+   Return 0, or a files_error value with errno set.  */
+
+static int
+files_filecount_depth (const char *dir, unsigned int flags,
+		       int64_t age, int64_t size, const char *pattern,
+		       struct files_types **filecount, int depth)
 {
-  int status;
+  int status, ret;
   DIR *dirp;
   time_t now;
 
@@ -116,7 +117,7 @@ files_filecount (const char *dir, unsigned int flags,
   if ((dirp = opendir (dir)) == NULL)
     {
       dbg ("(e) cannot open %s (%s)\n", dir, strerror (errno));
-      return -1;
+      return FILES_ERROR_OPENDIR;
     }
 
   files_data_init (filecount);
@@ -134,9 +135,12 @@ files_filecount (const char *dir, unsigned int flags,
       if ((dp = readdir (dirp)) == NULL)
 	{
 	  if (errno != 0)
-	    plugin_error (STATE_UNKNOWN, errno, "readdir() failure");
-	  else
-	    break;		/* end-of-directory */
+	    {
+	      dbg ("(e) readdir() failure in %s (%s)\n", dir, strerror (errno));
+	      ret = FILES_ERROR_READDIR;
+	      goto error;
+	    }
+	  break;		/* end-of-directory */
 	}
 
       /* ignore directory entries */
@@ -151,11 +155,15 @@ files_filecount (const char *dir, unsigned int flags,
 
       status = lstat (abs_path, &statbuf);
       if (status != 0)
-	plugin_error (STATE_UNKNOWN, errno, "lstat (%s) failed", abs_path);
+	{
+	  dbg ("(e) lstat (%s) failed (%s)\n", abs_path, strerror (errno));
+	  ret = FILES_ERROR_LSTAT;
+	  goto error;
+	}
 
       if (S_IFDIR == (statbuf.st_mode & S_IFMT))
 	{
-	  dbg ("(%d) %s (%sdirectory)\n", deep, abs_path,
+	  dbg ("(%d) %s (%sdirectory)\n", depth, abs_path,
 	       is_hidden ? "hidden " : "");
 	  if (flags & FILES_RECURSIVE)
 	    {
@@ -169,17 +177,19 @@ files_filecount (const char *dir, unsigned int flags,
 		      if (is_hidden)
 			(*filecount)->hidden++;
 		    }
-		  dbg ("(%d)  --> #%lu\n", deep,
+		  dbg ("(%d)  --> #%lu\n", depth,
 		       (unsigned long)(*filecount)->total);
 		}
 
-	      deep++;
 	      dbg ("+ recursive call of files_filecount for %s\n", subdir);
-	      files_filecount (subdir, flags, age, size,
-			       pattern, filecount);
-	      dbg ("(%d)  --> #%lu\n", deep,
-		   (unsigned long)(*filecount)->total);
+	      ret = files_filecount_depth (subdir, flags, age, size,
+					   pattern, filecount, depth + 1);
 	      free (subdir);
+	      /* the subdirectories that cannot be opened are skipped */
+	      if (ret < 0 && ret != FILES_ERROR_OPENDIR)
+		goto error;
+	      dbg ("(%d)  --> #%lu\n", depth,
+		   (unsigned long)(*filecount)->total);
 	      continue;
 	    }
 	  if (flags & FILES_REGULAR_ONLY)
@@ -188,14 +198,14 @@ files_filecount (const char *dir, unsigned int flags,
 
       if (0 != files_filematch (pattern, dp->d_name))
 	{
-	  dbg ("(%d) %s does not match the pattern\n", deep, abs_path);
+	  dbg ("(%d) %s does not match the pattern\n", depth, abs_path);
 	  continue;
 	}
 
       switch (statbuf.st_mode & S_IFMT)
 	{
 	default:
-	  dbg ("(%d) %s (unknown file)\n", deep, abs_path);
+	  dbg ("(%d) %s (unknown file)\n", depth, abs_path);
 	  (*filecount)->unknown++;
 	  if (flags & FILES_IGNORE_UNKNOWN)
 	    continue;
@@ -204,13 +214,13 @@ files_filecount (const char *dir, unsigned int flags,
 	case S_IFCHR:
 	case S_IFIFO:
 	case S_IFSOCK:
-	  dbg ("(%d) %s (special file)\n", deep, abs_path);
+	  dbg ("(%d) %s (special file)\n", depth, abs_path);
 	  (*filecount)->special_file++;
 	  if (flags & FILES_REGULAR_ONLY)
 	    continue;
 	  break;
 	case S_IFLNK:
-	  dbg ("(%d) %s (symlink)\n", deep, abs_path);
+	  dbg ("(%d) %s (symlink)\n", depth, abs_path);
 	  if (flags & (FILES_IGNORE_SYMLINKS | FILES_REGULAR_ONLY))
 	    continue;
 	  (*filecount)->symlink++;
@@ -220,7 +230,7 @@ files_filecount (const char *dir, unsigned int flags,
 	  size_match = files_check_size (size, statbuf.st_size);
 	  dbg ("(%d) %s (%s file), touched %.2f days ago (%s)"
 	       " with size %lu bytes (%s)\n"
-	       , deep
+	       , depth
 	       , abs_path
 	       , is_hidden ? "hidden" : "regular"
 	       , (long)(now - statbuf.st_mtime) / 60.0 / 60.0 / 24.0
@@ -242,11 +252,24 @@ files_filecount (const char *dir, unsigned int flags,
 	continue;
 
       (*filecount)->total++;
-      dbg ("(%d)  --> #%lu\n", deep, (unsigned long)(*filecount)->total);
+      dbg ("(%d)  --> #%lu\n", depth, (unsigned long)(*filecount)->total);
     }
 
   dbg ("- return #%lu (%s)\n", (unsigned long)(*filecount)->total, dir);
-  deep--;
   closedir (dirp);
   return 0;
+
+error:
+  status = errno;
+  closedir (dirp);
+  errno = status;
+  return ret;
+}
+
+int
+files_filecount (const char *dir, unsigned int flags,
+		 int64_t age, int64_t size, const char *pattern,
+		 struct files_types **filecount)
+{
+  return files_filecount_depth (dir, flags, age, size, pattern, filecount, 0);
 }
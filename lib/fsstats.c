@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for reading the runtime statistics of the XFS and ext4 file
+ * systems
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fsstats.h"
+#include "instrument.h"
+#include "logging.h"
+#include "string-macros.h"
+#include "sysfsparser.h"
+#include "sysio.h"
+
+#define PATH_PROC_XFS_STAT  PATH_PROC "/fs/xfs/stat"
+#define PATH_SYS_FS_XFS     PATH_SYS "/fs/xfs"
+#define PATH_SYS_FS_EXT4    PATH_SYS "/fs/ext4"
+
+static const char *fsstats_counter_names[FSSTATS_COUNTERS] = {
+  [FSSTATS_LOG_WRITES] = "log_writes",
+  [FSSTATS_LOG_FORCES] = "log_forces",
+  [FSSTATS_LOG_FORCE_SLEEPS] = "log_force_sleeps",
+  [FSSTATS_LOGSPACE_SLEEPS] = "logspace_sleeps",
+  [FSSTATS_BUF_GETS] = "buf_gets",
+  [FSSTATS_BUF_MISSES] = "buf_misses",
+  [FSSTATS_ERRORS] = "errors",
+  [FSSTATS_WRITE_KBYTES] = "write_kbytes"
+};
+
+/* The XFS counters, by line of the statistics and column (from 0) */
+static const struct
+{
+  const char *line;
+  unsigned int column;
+  enum fsstats_counter counter;
+} fsstats_xfs_columns[] = {
+  { "log", 0, FSSTATS_LOG_WRITES },
+  { "log", 3, FSSTATS_LOG_FORCES },
+  { "log", 4, FSSTATS_LOG_FORCE_SLEEPS },
+  { "push_ail", 1, FSSTATS_LOGSPACE_SLEEPS },
+  { "buf", 0, FSSTATS_BUF_GETS },
+  { "buf", 5, FSSTATS_BUF_MISSES }
+};
+
+#define FSSTATS_XFS_COLUMNS \
+  (sizeof (fsstats_xfs_columns) / sizeof (fsstats_xfs_columns[0]))
+
+/* The ext4 attributes, in the order of the counters */
+static const char *const fsstats_ext4_attrs[] = {
+  "errors_count", "lifetime_write_kbytes"
+};
+
+const char *
+fsstats_counter_name (enum fsstats_counter counter)
+{
+  return (counter < FSSTATS_COUNTERS) ?
+    fsstats_counter_names[counter] : NULL;
+}
+
+const char *
+fsstats_devname (const char *devname, char *buf, size_t size)
+{
+  char path[PATH_MAX];
+  const char *name = devname, *p;
+
+  if (realpath (devname, path))
+    name = path;
+  if ((p = strrchr (name, '/')))
+    name = p + 1;
+
+  STRNCPY_TERMINATED (buf, name, size);
+  return buf;
+}
+
+/* The statistics are made of lines like "log 10 20 0 30 5", the name of a
+   group of counters followed by their values.  */
+
+int
+fsstats_xfs_read (const char *name, unsigned long long *counters)
+{
+  char path[PATH_MAX], *line = NULL, *saveptr, *token;
+  size_t len = 0, i;
+  FILE *fp;
+
+  memset (counters, 0, FSSTATS_COUNTERS * sizeof (unsigned long long));
+  if (name)
+    snprintf (path, sizeof path, PATH_SYS_FS_XFS "/%s/stats/stats", name);
+  else
+    snprintf (path, sizeof path, PATH_PROC_XFS_STAT);
+  if ((fp = sysio_fopen (path)) == NULL)
+    return -1;
+
+  instrument_phase_push (NPL_PHASE_PARSE);
+  while (getline (&line, &len, fp) != -1)
+    {
+      unsigned long long value;
+      unsigned int column = 0;
+      char *group = strtok_r (line, " \t\n", &saveptr);
+
+      if (NULL == group)
+	continue;
+      for (i = 0; i < FSSTATS_XFS_COLUMNS; i++)
+	if (STREQ (group, fsstats_xfs_columns[i].line))
+	  break;
+      if (i == FSSTATS_XFS_COLUMNS)
+	continue;
+
+      for (token = strtok_r (NULL, " \t\n", &saveptr); token;
+	   token = strtok_r (NULL, " \t\n", &saveptr), column++)
+	{
+	  value = strtoull (token, NULL, 10);
+	  for (i = 0; i < FSSTATS_XFS_COLUMNS; i++)
+	    if (fsstats_xfs_columns[i].column == column
+		&& STREQ (group, fsstats_xfs_columns[i].line))
+	      counters[fsstats_xfs_columns[i].counter] = value;
+	}
+    }
+
+  free (line);
+  fclose (fp);
+  instrument_phase_pop ();
+
+  dbg ("xfs %s: %llu log forces, %llu buffer misses\n",
+       name ? name : "(global)", counters[FSSTATS_LOG_FORCES],
+       counters[FSSTATS_BUF_MISSES]);
+  return 0;
+}
+
+int
+fsstats_ext4_read (const char *name, unsigned long long *counters)
+{
+  char dir[PATH_MAX];
+  const size_t n = sizeof (fsstats_ext4_attrs) / sizeof (*fsstats_ext4_attrs);
+
+  memset (counters, 0, FSSTATS_COUNTERS * sizeof (unsigned long long));
+  snprintf (dir, sizeof dir, PATH_SYS_FS_EXT4 "/%s", name);
+
+  /* the attributes are missing if the file system is not ext4 */
+  if (sysfsparser_getvalues (dir, fsstats_ext4_attrs,
+			     counters + FSSTATS_EXT4_FIRST, n) == 0)
+    {
+      errno = ENOENT;
+      return -1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for computing the quantiles of a stream of values in a fixed
+ * amount of memory, using histograms with log-scale buckets.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include "histogram.h"
+
+#define SUB_BUCKETS  (1U << HISTOGRAM_SUB_BITS)
+
+/* The values with the same most significant bit and the same following
+   HISTOGRAM_SUB_BITS bits share a bucket.  */
+
+static unsigned int
+histogram_bucket (unsigned long long value)
+{
+  unsigned int msb;
+
+  if (value < 2 * SUB_BUCKETS)
+    return value;
+
+  msb = 63 - __builtin_clzll (value);
+  return ((msb - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+    + ((value >> (msb - HISTOGRAM_SUB_BITS)) & (SUB_BUCKETS - 1));
+}
+
+/* Return the middle of the range of values of BUCKET.  */
+
+static unsigned long long
+histogram_bucket_value (unsigned int bucket)
+{
+  unsigned int shift;
+  unsigned long long lower, width;
+
+  if (bucket < 2 * SUB_BUCKETS)
+    return bucket;
+
+  shift = (bucket >> HISTOGRAM_SUB_BITS) - 1;
+  lower = (unsigned long long) (SUB_BUCKETS + (bucket & (SUB_BUCKETS - 1)))
+    << shift;
+  width = 1ULL << shift;
+
+  return lower + (width - 1) / 2;
+}
+
+void
+histogram_add (struct histogram *h, unsigned long long value)
+{
+  h->count[histogram_bucket (value)]++;
+  h->n++;
+  if (value > h->max)
+    h->max = value;
+}
+
+unsigned long long
+histogram_quantile (const struct histogram *h, double q)
+{
+  unsigned long long rank, seen = 0;
+
+  if (0 == h->n)
+    return 0;
+
+  /* the smallest value not lower than the fraction Q of the values */
+  rank = q * h->n;
+  if (rank < q * h->n || rank < 1)
+    rank++;
+  if (rank >= h->n)
+    return h->max;
+
+  for (unsigned int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+      seen += h->count[i];
+      if (seen >= rank)
+	{
+	  unsigned long long value = histogram_bucket_value (i);
+	  return value < h->max ? value : h->max;
+	}
+    }
+
+  return h->max;
+}
@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for measuring where the time of a plugin execution goes
+ * (open, read, parse, compute, and output), along with the bytes read,
+ * the I/O syscalls issued, and the allocations made through xmalloc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "getenv.h"
+#include "instrument.h"
+#include "metrics.h"
+#include "string-macros.h"
+#include "xalloc.h"
+
+#define INSTRUMENT_MAX_DEPTH	16
+
+enum instrument_mode
+{
+  INSTRUMENT_OFF,
+  INSTRUMENT_PERFDATA,
+  INSTRUMENT_DEBUG
+};
+
+static const char *const phase_name[NPL_PHASE_COUNT] = {
+  [NPL_PHASE_COMPUTE] = "compute",
+  [NPL_PHASE_OPEN] = "open",
+  [NPL_PHASE_READ] = "read",
+  [NPL_PHASE_PARSE] = "parse",
+  [NPL_PHASE_OUTPUT] = "output"
+};
+
+static enum instrument_mode mode = INSTRUMENT_OFF;
+
+static struct
+{
+  unsigned long long start_ns;		/* when the instrumentation started */
+  unsigned long long mark_ns;		/* last phase transition */
+  unsigned long long phase_ns[NPL_PHASE_COUNT];
+  enum npl_phase stack[INSTRUMENT_MAX_DEPTH];
+  unsigned int depth;			/* can be bigger than the stack size */
+  unsigned long files;			/* files opened for reading */
+  unsigned long syscalls;		/* I/O syscalls */
+  unsigned long long bytes;		/* bytes read */
+} instr;
+
+static inline unsigned long long
+instrument_now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline enum npl_phase
+instrument_current_phase (void)
+{
+  if (instr.depth == 0)
+    return NPL_PHASE_COMPUTE;
+  if (instr.depth > INSTRUMENT_MAX_DEPTH)
+    return instr.stack[INSTRUMENT_MAX_DEPTH - 1];
+  return instr.stack[instr.depth - 1];
+}
+
+/* Account the time elapsed since the last transition to the current phase */
+static void
+instrument_mark (void)
+{
+  unsigned long long now = instrument_now_ns ();
+
+  instr.phase_ns[instrument_current_phase ()] += now - instr.mark_ns;
+  instr.mark_ns = now;
+}
+
+bool
+instrument_enabled (void)
+{
+  return mode != INSTRUMENT_OFF;
+}
+
+void
+instrument_phase_push (enum npl_phase phase)
+{
+  if (mode == INSTRUMENT_OFF)
+    return;
+
+  instrument_mark ();
+  if (instr.depth < INSTRUMENT_MAX_DEPTH)
+    instr.stack[instr.depth] = phase;
+  instr.depth++;
+}
+
+void
+instrument_phase_pop (void)
+{
+  if (mode == INSTRUMENT_OFF || instr.depth == 0)
+    return;
+
+  instrument_mark ();
+  instr.depth--;
+}
+
+void
+instrument_count_io (unsigned long syscalls, unsigned long long bytes)
+{
+  instr.syscalls += syscalls;
+  instr.bytes += bytes;
+}
+
+/* The custom stream returned by instrument_fopen() */
+
+static ssize_t
+instrument_cookie_read (void *cookie, char *buf, size_t size)
+{
+  ssize_t nread;
+
+  instrument_phase_push (NPL_PHASE_READ);
+  nread = read (*(int *) cookie, buf, size);
+  instrument_phase_pop ();
+
+  instrument_count_io (1, nread > 0 ? nread : 0);
+  return nread;
+}
+
+static int
+instrument_cookie_close (void *cookie)
+{
+  int ret;
+
+  instrument_phase_push (NPL_PHASE_OPEN);
+  ret = close (*(int *) cookie);
+  instrument_phase_pop ();
+
+  instrument_count_io (1, 0);
+  free (cookie);
+  return ret;
+}
+
+FILE *
+instrument_fopen (const char *path)
+{
+  cookie_io_functions_t io_funcs = {
+    .read = instrument_cookie_read,
+    .write = NULL,
+    .seek = NULL,
+    .close = instrument_cookie_close
+  };
+  FILE *fp;
+  int fd, *cookie;
+
+  instrument_phase_push (NPL_PHASE_OPEN);
+  fd = open (path, O_RDONLY | O_CLOEXEC);
+  instrument_phase_pop ();
+
+  instrument_count_io (1, 0);
+  if (fd < 0)
+    return NULL;
+  instr.files++;
+
+  cookie = xmalloc (sizeof (int));
+  *cookie = fd;
+  if ((fp = fopencookie (cookie, "r", io_funcs)) == NULL)
+    {
+      int saved_errno = errno;
+      close (fd);
+      free (cookie);
+      errno = saved_errno;
+    }
+
+  return fp;
+}
+
+/* Print the metrics when the plugin exits */
+
+static void
+instrument_report (void)
+{
+  unsigned long long total_ns;
+  struct xalloc_stats xstats;
+  struct rusage usage;
+  FILE *out;
+  int i;
+
+  instrument_phase_push (NPL_PHASE_OUTPUT);
+  fflush (stdout);
+  instrument_phase_pop ();
+
+  total_ns = instr.mark_ns - instr.start_ns;
+  xalloc_stats_get (&xstats);
+  getrusage (RUSAGE_SELF, &usage);
+
+  if (mode == INSTRUMENT_DEBUG)
+    {
+      out = stderr;
+      fputs ("npl instrumentation:", out);
+    }
+  else
+    {
+      out = stdout;
+      fputs ("|", out);
+    }
+
+  fprintf (out, " npl_time_total=%.6fs", total_ns / 1e9);
+  for (i = 0; i < NPL_PHASE_COUNT; i++)
+    fprintf (out, " npl_time_%s=%.6fs", phase_name[i],
+	     instr.phase_ns[i] / 1e9);
+  fprintf (out, " npl_time_user=%.6fs npl_time_system=%.6fs"
+	   , usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+	   , usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6);
+  fprintf (out, " npl_files_opened=%lu npl_io_syscalls=%lu npl_read=%lluB"
+	   , instr.files, instr.syscalls, instr.bytes);
+  fprintf (out, " npl_allocs=%llu npl_alloc_size=%lluB"
+	   , xstats.allocs, xstats.bytes);
+  if (xstats.arena_bytes > 0)
+    fprintf (out, " npl_arena_size=%lluB", xstats.arena_bytes);
+  fprintf (out, " npl_maxrss=%ldKB\n", usage.ru_maxrss);
+  fflush (out);
+}
+
+void
+instrument_init (void)
+{
+  const char *value = secure_getenv (NPL_INSTRUMENT_ENV);
+
+  if (mode != INSTRUMENT_OFF || value == NULL || *value == '\0')
+    return;
+
+  if (STREQ (value, "debug"))
+    mode = INSTRUMENT_DEBUG;
+  else if (STREQ (value, "perfdata") || STREQ (value, "1"))
+    /* the perfdata syntax would break the other output formats */
+    mode = (metrics_format_get () == METRICS_FORMAT_PERFDATA) ?
+      INSTRUMENT_PERFDATA : INSTRUMENT_DEBUG;
+  else
+    return;
+
+  instr.start_ns = instr.mark_ns = instrument_now_ns ();
+  atexit (instrument_report);
+}
@@ -22,18 +22,40 @@
 # define _GNU_SOURCE /* activate extra prototypes for glibc */
 #endif
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "common.h"
 #include "cputopology.h"
+#include "instrument.h"
+#include "interrupts.h"
 #include "logging.h"
+#include "sysio.h"
 #include "system.h"
 #include "xalloc.h"
 
-#define PROC_ROOT	"/proc"
-#define PROC_INTR	PROC_ROOT "/interrupts"
+#define PROC_INTR	PATH_PROC "/interrupts"
+#define PROC_SOFTIRQS	PATH_PROC "/softirqs"
+
+/* Return the number of CPU columns listed in the heading line of
+ * /proc/interrupts ("           CPU0       CPU1  ...").  Offline CPUs are
+ * not displayed, so this is the number of online CPUs.  */
+static unsigned int
+proc_interrupts_count_cpus (const char *header)
+{
+  unsigned int ncpus = 0;
+  const char *p = header;
+
+  while ((p = strstr (p, "CPU")))
+    {
+      ncpus++;
+      p += 3;
+    }
+
+  return ncpus;
+}
 
 /* Return an array containing the number of interrupts per cpu per IO device.
  * Since Linux 2.6.24, for the i386 and x86_64 architectures at least,
@@ -46,25 +68,31 @@ proc_interrupts_get_nintr_per_cpu (unsigned int *ncpus)
   char *p, *end, *line = NULL;
   size_t len = 0;
   ssize_t chread;
-  bool header = true;
   unsigned int cpu;
+  unsigned long value, *vintr;
 
-  if ((fp = fopen (PROC_INTR, "r")) == NULL)
+  if ((fp = sysio_fopen (PROC_INTR)) == NULL)
     return NULL;
 
-  *ncpus = get_processor_number_online ();
-  unsigned long value,
-		*vintr = xnmalloc (*ncpus, sizeof (unsigned long));
+  instrument_phase_push (NPL_PHASE_PARSE);
+  if ((chread = getline (&line, &len, fp)) == -1)
+    {
+      free (line);
+      fclose (fp);
+      instrument_phase_pop ();
+      return NULL;
+    }
+
+  *ncpus = proc_interrupts_count_cpus (line);
+  if (*ncpus == 0)
+    {
+      int ncpus_online = get_processor_number_online ();
+      *ncpus = ncpus_online > 0 ? ncpus_online : 1;
+    }
+  vintr = xnmalloc (*ncpus, sizeof (unsigned long));
 
   while ((chread = getline (&line, &len, fp)) != -1)
     {
-      /* skip the first line */
-      if (header)
-	{
-	  header = false;
-	  continue;
-	}
-
       p = strchr(line, ':');
       if (NULL == p)	/* this should never happen */
 	continue;
@@ -83,6 +111,134 @@ proc_interrupts_get_nintr_per_cpu (unsigned int *ncpus)
     }
 
   free (line);
+  fclose (fp);
+  instrument_phase_pop ();
 
   return vintr;
 }
+
+/* Parse the file PATH, made of a heading line listing the CPU columns and of
+ * the rows "NAME: COUNTER... [DESCRIPTION]".  */
+static struct irq_table *
+irq_table_read (const char *path)
+{
+  FILE *fp;
+  char *p, *end, *line = NULL;
+  size_t len = 0, size = 0;
+  unsigned int col;
+  struct irq_table *table;
+
+  if ((fp = sysio_fopen (path)) == NULL)
+    return NULL;
+
+  instrument_phase_push (NPL_PHASE_PARSE);
+  if (getline (&line, &len, fp) == -1)
+    {
+      free (line);
+      fclose (fp);
+      instrument_phase_pop ();
+      return NULL;
+    }
+
+  table = xmalloc (sizeof (struct irq_table));
+  table->ncpus = proc_interrupts_count_cpus (line);
+  table->cpu = xnmalloc (table->ncpus + 1, sizeof (unsigned int));
+  for (p = line, col = 0; col < table->ncpus && (p = strstr (p, "CPU"));
+       col++)
+    {
+      table->cpu[col] = strtoul (p + 3, &end, 10);
+      p = end;
+    }
+
+  while (getline (&line, &len, fp) != -1)
+    {
+      struct irq_row *row;
+      char *colon = strchr (line, ':');
+
+      if (NULL == colon)
+	continue;
+
+      if (table->nrows == size)
+	{
+	  size = size ? size * 2 : 64;
+	  table->row = xrealloc (table->row, size * sizeof (struct irq_row));
+	}
+      row = &table->row[table->nrows++];
+
+      *colon = '\0';
+      row->name = xstrdup (line + strspn (line, " "));
+      row->device = NULL;
+      row->count = xnmalloc (table->ncpus + 1, sizeof (unsigned long long));
+
+      /* some rows, like "ERR" and "MIS", have a single counter */
+      for (p = colon + 1, col = 0; col < table->ncpus; col++)
+	{
+	  unsigned long long value = strtoull (p, &end, 10);
+	  if (end == p)
+	    break;
+	  row->count[col] = value;
+	  p = end;
+	}
+
+      /* "IR-PCI-MSI 327680-edge      xhci_hcd": keep the device name */
+      if (isdigit ((unsigned char) row->name[0]))
+	{
+	  char *device;
+
+	  end = p + strlen (p);
+	  while (end > p && isspace ((unsigned char) end[-1]))
+	    *--end = '\0';
+	  device = strrchr (p, ' ');
+	  device = device ? device + 1 : p + strspn (p, " ");
+	  if (*device)
+	    row->device = xstrdup (device);
+	}
+      dbg ("%s: %s (%s)\n", path, row->name,
+	   row->device ? row->device : "-");
+    }
+
+  free (line);
+  fclose (fp);
+  instrument_phase_pop ();
+
+  return table;
+}
+
+struct irq_table *
+proc_interrupts_read (void)
+{
+  return irq_table_read (PROC_INTR);
+}
+
+struct irq_table *
+proc_softirqs_read (void)
+{
+  return irq_table_read (PROC_SOFTIRQS);
+}
+
+int
+irq_table_column (const struct irq_table *table, unsigned int cpu)
+{
+  for (unsigned int col = 0; col < table->ncpus; col++)
+    if (table->cpu[col] == cpu)
+      return col;
+
+  return -1;
+}
+
+void
+irq_table_free (struct irq_table *table)
+{
+  if (NULL == table)
+    return;
+
+  for (size_t i = 0; i < table->nrows; i++)
+    {
+      free (table->row[i].name);
+      free (table->row[i].device);
+      free (table->row[i].count);
+    }
+  free (table->row);
+  free (table->cpu);
+  free (table);
+}
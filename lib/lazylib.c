@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for loading the optional libraries (libcurl) only when a plugin
+ * actually needs them, instead of paying the dynamic linking and relocation
+ * costs at every execution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <dlfcn.h>
+#include <stddef.h>
+
+#include "common.h"
+#include "lazylib.h"
+#include "logging.h"
+#include "messages.h"
+
+void *
+lazylib_open (const char *const sonames[])
+{
+  const char *const *soname;
+  void *handle;
+
+  for (soname = sonames; *soname; soname++)
+    {
+      dbg ("loading %s...\n", *soname);
+      if ((handle = dlopen (*soname, RTLD_NOW | RTLD_LOCAL)))
+	return handle;
+    }
+
+  plugin_error (STATE_UNKNOWN, 0, "cannot load %s: %s", sonames[0],
+		dlerror ());
+}
+
+void *
+lazylib_sym (void *handle, const char *name)
+{
+  void *addr;
+
+  dlerror ();
+  if ((addr = dlsym (handle, name)) == NULL)
+    plugin_error (STATE_UNKNOWN, 0, "cannot resolve %s: %s", name,
+		  dlerror ());
+
+  return addr;
+}
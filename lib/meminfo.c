@@ -34,12 +34,13 @@
 #include "meminfo.h"
 #include "procparser.h"
 #include "sysfsparser.h"
+#include "sysio.h"
 #include "system.h"
 #include "units.h"
 
 #define MEMINFO_UNSET ~0UL
 
-#define PATH_PROC_SYS		"/proc/sys"
+#define PATH_PROC_SYS		PATH_PROC "/sys"
 #define PATH_VM_MIN_FREE_KB	PATH_PROC_SYS "/vm/min_free_kbytes"
 
 typedef struct proc_sysmem_data
@@ -136,10 +137,10 @@ proc_sysmem_new (struct proc_sysmem **sysmem)
 /* Fill the proc_sysmem structure pointed will the values found in the
  * proc filesystem. */
 
-void proc_sysmem_read (struct proc_sysmem *sysmem)
+int proc_sysmem_read (struct proc_sysmem *sysmem)
 {
   if (sysmem == NULL)
-    return;
+    return -EINVAL;
 
   struct proc_sysmem_data *data = sysmem->data;
 
@@ -175,7 +176,9 @@ void proc_sysmem_read (struct proc_sysmem *sysmem)
   data->kb_low_total = MEMINFO_UNSET;
   data->kb_main_available = MEMINFO_UNSET;
 
-  procparser (get_path_proc_meminfo (), sysmem_table, sysmem_table_count, ':');
+  if (procparser (get_path_proc_meminfo (), sysmem_table, sysmem_table_count,
+		  ':') < 0)
+    return -errno;
 
   if (!data->kb_low_total)
     {			       /* low==main except with large-memory support */
@@ -227,6 +230,8 @@ void proc_sysmem_read (struct proc_sysmem *sysmem)
   data->kb_main_used =
     data->kb_main_total - data->kb_main_free - data->kb_main_cached -
     data->kb_main_buffers;
+
+  return 0;
 }
 
 /* Drop a reference of the memory library context. If the refcount of
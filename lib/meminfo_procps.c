@@ -49,9 +49,10 @@ proc_sysmem_new (struct proc_sysmem **sysmem)
   return 0;
 }
 
-void
+int
 proc_sysmem_read (struct proc_sysmem *sysmem __attribute__ ((unused)))
 {
+  return 0;
 }
 
 struct proc_sysmem *
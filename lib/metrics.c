@@ -0,0 +1,570 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A common output layer for the plugins metrics.
+ *
+ * The samples are collected in memory, then rendered as Nagios perfdata,
+ * OpenMetrics text, or line-delimited JSON into a single buffer that is
+ * written to the standard output with one write(2).
+ * Collecting the samples first allows the OpenMetrics output to group the
+ * samples of the same metric family, as required by the specification.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "getenv.h"
+#include "instrument.h"
+#include "logging.h"
+#include "messages.h"
+#include "metrics.h"
+#include "string-macros.h"
+#include "xalloc.h"
+
+/* The strings of the samples are stored in a pool, and referenced by their
+   offset: the offset 0 is reserved for the NULL strings.  */
+typedef size_t strref;
+
+struct sample
+{
+  strref name;
+  strref label;
+  strref label_value;
+  strref unit;
+  strref limits[4];		/* warning, critical, min, max */
+  strref perfdata_label;
+  unsigned int family;
+  int precision;
+  double value;
+};
+
+struct family
+{
+  strref name;
+  strref unit;
+};
+
+struct metrics
+{
+  enum metrics_format format;
+  char *plugin;
+
+  struct sample *samples;
+  size_t nsamples, samples_size;
+
+  struct family *families;	/* the distinct sample names and units */
+  size_t nfamilies, families_size;
+
+  char *pool;
+  size_t pool_len, pool_size;
+};
+
+/* A growing output buffer */
+struct buffer
+{
+  char *data;
+  size_t len, size;
+};
+
+static void
+buffer_reserve (struct buffer *buf, size_t n)
+{
+  if (buf->len + n + 1 <= buf->size)
+    return;
+
+  while (buf->len + n + 1 > buf->size)
+    buf->size *= 2;
+  buf->data = xrealloc (buf->data, buf->size);
+}
+
+static void
+buffer_putc (struct buffer *buf, char c)
+{
+  buffer_reserve (buf, 1);
+  buf->data[buf->len++] = c;
+}
+
+static void
+buffer_puts (struct buffer *buf, const char *s)
+{
+  size_t n = strlen (s);
+
+  buffer_reserve (buf, n);
+  memcpy (buf->data + buf->len, s, n);
+  buf->len += n;
+}
+
+static void _attribute_format_printf_ (2, 3)
+buffer_printf (struct buffer *buf, const char *format, ...)
+{
+  va_list args;
+  int n;
+
+  va_start (args, format);
+  n = vsnprintf (buf->data + buf->len, buf->size - buf->len, format, args);
+  va_end (args);
+  if (n < 0)
+    return;
+
+  if ((size_t) n >= buf->size - buf->len)
+    {
+      buffer_reserve (buf, n);
+      va_start (args, format);
+      vsnprintf (buf->data + buf->len, buf->size - buf->len, format, args);
+      va_end (args);
+    }
+  buf->len += n;
+}
+
+/* Append S with the escapes required by the JSON strings, or by the
+   OpenMetrics label values if JSON is false.  */
+
+static void
+buffer_puts_escaped (struct buffer *buf, const char *s, bool json)
+{
+  for (; *s; s++)
+    switch (*s)
+      {
+      case '"':
+	buffer_puts (buf, "\\\"");
+	break;
+      case '\\':
+	buffer_puts (buf, "\\\\");
+	break;
+      case '\n':
+	buffer_puts (buf, "\\n");
+	break;
+      default:
+	if (json && (unsigned char) *s < 0x20)
+	  buffer_printf (buf, "\\u%04x", (unsigned char) *s);
+	else
+	  buffer_putc (buf, *s);
+      }
+}
+
+static strref
+metrics_strdup (struct metrics *metrics, const char *s)
+{
+  size_t n;
+  strref ref;
+
+  if (s == NULL)
+    return 0;
+
+  n = strlen (s) + 1;
+  if (metrics->pool_len + n > metrics->pool_size)
+    {
+      while (metrics->pool_len + n > metrics->pool_size)
+	metrics->pool_size *= 2;
+      metrics->pool = xrealloc (metrics->pool, metrics->pool_size);
+    }
+
+  ref = metrics->pool_len;
+  memcpy (metrics->pool + ref, s, n);
+  metrics->pool_len += n;
+
+  return ref;
+}
+
+static inline const char *
+metrics_str (const struct metrics *metrics, strref ref)
+{
+  return ref ? metrics->pool + ref : NULL;
+}
+
+int
+metrics_format_get (void)
+{
+  const char *format = secure_getenv (NPL_OUTPUT_ENV);
+
+  if (format == NULL || *format == '\0' || STREQ (format, "perfdata"))
+    return METRICS_FORMAT_PERFDATA;
+  else if (STREQ (format, "openmetrics"))
+    return METRICS_FORMAT_OPENMETRICS;
+  else if (STREQ (format, "json"))
+    return METRICS_FORMAT_JSON;
+  return -1;
+}
+
+struct metrics *
+metrics_new (const char *plugin, size_t nsamples)
+{
+  struct metrics *metrics = xmalloc (sizeof (struct metrics));
+  int format = metrics_format_get ();
+
+  if (format < 0)
+    plugin_error (STATE_UNKNOWN, 0, "unknown output format: %s",
+		  secure_getenv (NPL_OUTPUT_ENV));
+  metrics->format = format;
+
+  metrics->plugin = xstrdup (plugin);
+
+  metrics->samples_size = nsamples > 0 ? nsamples : 16;
+  metrics->samples =
+    xnmalloc (metrics->samples_size, sizeof (struct sample));
+
+  metrics->families_size = 8;
+  metrics->families =
+    xnmalloc (metrics->families_size, sizeof (struct family));
+
+  /* about 32 characters per sample for the names, labels, and limits */
+  metrics->pool_size = 32 * metrics->samples_size;
+  metrics->pool = xmalloc (metrics->pool_size);
+  metrics->pool_len = 1;
+
+  return metrics;
+}
+
+enum metrics_format
+metrics_format (const struct metrics *metrics)
+{
+  return metrics->format;
+}
+
+/* Return the family of the samples with the given NAME and UNIT, that
+   share the same OpenMetrics name.  */
+
+static unsigned int
+metrics_family (struct metrics *metrics, const char *name, const char *unit)
+{
+  size_t i;
+
+  for (i = 0; i < metrics->nfamilies; i++)
+    {
+      const struct family *f = &metrics->families[i];
+      const char *funit = metrics_str (metrics, f->unit);
+
+      if (STREQ (metrics_str (metrics, f->name), name)
+	  && (funit == unit || (funit && unit && STREQ (funit, unit))))
+	return i;
+    }
+
+  if (metrics->nfamilies == metrics->families_size)
+    {
+      metrics->families_size *= 2;
+      metrics->families =
+	xrealloc (metrics->families,
+		  metrics->families_size * sizeof (struct family));
+    }
+
+  metrics->families[i].name = metrics_strdup (metrics, name);
+  metrics->families[i].unit = metrics_strdup (metrics, unit);
+  return metrics->nfamilies++;
+}
+
+void
+metrics_add (struct metrics *metrics, const struct metric *metric,
+	     double value)
+{
+  struct sample *sample;
+
+  if (metrics->nsamples == metrics->samples_size)
+    {
+      metrics->samples_size *= 2;
+      metrics->samples =
+	xrealloc (metrics->samples,
+		  metrics->samples_size * sizeof (struct sample));
+    }
+
+  sample = &metrics->samples[metrics->nsamples++];
+  sample->family = metrics_family (metrics, metric->name, metric->unit);
+  sample->name = metrics->families[sample->family].name;
+  sample->unit = metrics->families[sample->family].unit;
+  sample->label = metrics_strdup (metrics, metric->label);
+  sample->label_value = metrics_strdup (metrics, metric->label_value);
+  sample->limits[0] = metrics_strdup (metrics, metric->warning);
+  sample->limits[1] = metrics_strdup (metrics, metric->critical);
+  sample->limits[2] = metrics_strdup (metrics, metric->min);
+  sample->limits[3] = metrics_strdup (metrics, metric->max);
+  sample->perfdata_label = metrics_strdup (metrics, metric->perfdata_label);
+  sample->precision = metric->precision;
+  sample->value = value;
+}
+
+/* Nagios perfdata:
+ *   MESSAGE | [label_value_]name=value[unit][;warn;crit;min;max] ...  */
+
+static void
+metrics_render_perfdata (const struct metrics *metrics, struct buffer *buf,
+			 const char *message)
+{
+  size_t i;
+  int j, last;
+
+  buffer_puts (buf, message);
+  if (metrics->nsamples > 0)
+    buffer_puts (buf, " |");
+
+  for (i = 0; i < metrics->nsamples; i++)
+    {
+      const struct sample *s = &metrics->samples[i];
+      const char *label_value = metrics_str (metrics, s->label_value);
+
+      buffer_putc (buf, ' ');
+      if (s->perfdata_label)
+	buffer_puts (buf, metrics_str (metrics, s->perfdata_label));
+      else if (label_value)
+	buffer_printf (buf, "%s_%s", label_value,
+		       metrics_str (metrics, s->name));
+      else
+	buffer_puts (buf, metrics_str (metrics, s->name));
+      buffer_printf (buf, "=%.*f%s", s->precision, s->value,
+		     s->unit ? metrics_str (metrics, s->unit) : "");
+
+      for (last = 3; last >= 0 && !s->limits[last]; last--)
+	;
+      for (j = 0; j <= last; j++)
+	buffer_printf (buf, ";%s",
+		       s->limits[j] ? metrics_str (metrics, s->limits[j]) : "");
+    }
+
+  buffer_putc (buf, '\n');
+}
+
+/* Append the OpenMetrics name of the samples of FAMILY:
+ *   npl_<plugin>_<name>[_<unit>]
+ * where the characters not allowed are replaced by '_' and a trailing "/s"
+ * becomes "_per_second".  */
+
+static void
+metrics_openmetrics_name (const struct metrics *metrics, struct buffer *buf,
+			  const struct sample *s)
+{
+  const char *name = metrics_str (metrics, s->name);
+  const char *unit = metrics_str (metrics, s->unit);
+  size_t len = strlen (name);
+  bool per_second = len > 2 && STREQ (name + len - 2, "/s");
+  const char *p;
+
+  buffer_printf (buf, "npl_%s_", metrics->plugin);
+  for (p = name; p < name + len - (per_second ? 2 : 0); p++)
+    buffer_putc (buf, isalnum ((unsigned char) *p) ? *p : '_');
+
+  if (unit == NULL)
+    ;
+  else if (STREQ (unit, "%"))
+    buffer_puts (buf, "_percent");
+  else if (STREQ (unit, "B"))
+    buffer_puts (buf, "_bytes");
+  else if (STREQ (unit, "s"))
+    buffer_puts (buf, "_seconds");
+
+  if (per_second)
+    buffer_puts (buf, "_per_second");
+}
+
+static void
+metrics_render_value (struct buffer *buf, int precision, double value,
+		      bool json)
+{
+  if (isfinite (value))
+    buffer_printf (buf, "%.*f", precision, value);
+  else if (json)
+    buffer_puts (buf, "null");
+  else
+    buffer_puts (buf, isnan (value) ? "NaN" : value > 0 ? "+Inf" : "-Inf");
+}
+
+static void
+metrics_render_openmetrics (const struct metrics *metrics,
+			    struct buffer *buf, nagstatus status)
+{
+  size_t f, i;
+
+  buffer_printf (buf,
+		 "# TYPE npl_%s_status gauge\n"
+		 "npl_%s_status{state=\"%s\"} %d\n",
+		 metrics->plugin, metrics->plugin, state_text (status),
+		 (int) status);
+
+  for (f = 0; f < metrics->nfamilies; f++)
+    {
+      bool header = true;
+
+      for (i = 0; i < metrics->nsamples; i++)
+	{
+	  const struct sample *s = &metrics->samples[i];
+
+	  if (s->family != f)
+	    continue;
+	  if (header)
+	    {
+	      buffer_puts (buf, "# TYPE ");
+	      metrics_openmetrics_name (metrics, buf, s);
+	      buffer_puts (buf, " gauge\n");
+	      header = false;
+	    }
+
+	  metrics_openmetrics_name (metrics, buf, s);
+	  if (s->label && s->label_value)
+	    {
+	      buffer_printf (buf, "{%s=\"", metrics_str (metrics, s->label));
+	      buffer_puts_escaped (buf, metrics_str (metrics, s->label_value),
+				   false);
+	      buffer_puts (buf, "\"}");
+	    }
+	  buffer_putc (buf, ' ');
+	  metrics_render_value (buf, s->precision, s->value, false);
+	  buffer_putc (buf, '\n');
+	}
+    }
+
+  buffer_puts (buf, "# EOF\n");
+}
+
+static void
+metrics_render_json_string (struct buffer *buf, const char *key,
+			    const char *value)
+{
+  buffer_printf (buf, ",\"%s\":\"", key);
+  buffer_puts_escaped (buf, value, true);
+  buffer_putc (buf, '"');
+}
+
+/* Line-delimited JSON: the plugin status, then one object per sample.  */
+
+static void
+metrics_render_json (const struct metrics *metrics, struct buffer *buf,
+		     nagstatus status, const char *message)
+{
+  static const char *const limit_key[] = {
+    "warning", "critical", "min", "max"
+  };
+  size_t i;
+  int j;
+
+  buffer_printf (buf, "{\"plugin\":\"%s\",\"status\":\"%s\",\"code\":%d",
+		 metrics->plugin, state_text (status), (int) status);
+  metrics_render_json_string (buf, "message", message);
+  buffer_puts (buf, "}\n");
+
+  for (i = 0; i < metrics->nsamples; i++)
+    {
+      const struct sample *s = &metrics->samples[i];
+
+      buffer_printf (buf, "{\"plugin\":\"%s\"", metrics->plugin);
+      metrics_render_json_string (buf, "metric",
+				  metrics_str (metrics, s->name));
+      if (s->label && s->label_value)
+	{
+	  buffer_puts (buf, ",\"labels\":{");
+	  buffer_putc (buf, '"');
+	  buffer_puts_escaped (buf, metrics_str (metrics, s->label), true);
+	  buffer_puts (buf, "\":\"");
+	  buffer_puts_escaped (buf, metrics_str (metrics, s->label_value),
+			       true);
+	  buffer_puts (buf, "\"}");
+	}
+      buffer_puts (buf, ",\"value\":");
+      metrics_render_value (buf, s->precision, s->value, true);
+      if (s->unit)
+	metrics_render_json_string (buf, "unit",
+				    metrics_str (metrics, s->unit));
+      for (j = 0; j < 4; j++)
+	if (s->limits[j])
+	  metrics_render_json_string (buf, limit_key[j],
+				      metrics_str (metrics, s->limits[j]));
+      buffer_puts (buf, "}\n");
+    }
+}
+
+static void
+metrics_free (struct metrics *metrics)
+{
+  free (metrics->plugin);
+  free (metrics->samples);
+  free (metrics->families);
+  free (metrics->pool);
+  free (metrics);
+}
+
+#ifndef NPL_TESTING
+static void
+metrics_flush (const char *data, size_t len)
+{
+  ssize_t n;
+
+  fflush (stdout);
+  while (len > 0)
+    {
+      n = write (STDOUT_FILENO, data, len);
+      if (n < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  dbg ("write() failure (%s)\n", strerror (errno));
+	  return;
+	}
+      data += n;
+      len -= n;
+    }
+}
+#endif
+
+/* Render the metrics into BUF, allocated by the function.  */
+
+static void
+metrics_render (const struct metrics *metrics, struct buffer *buf,
+		nagstatus status, const char *message)
+{
+  /* a preallocation large enough for most of the outputs */
+  buf->size = 256 + strlen (message) + 128 * metrics->nsamples;
+  buf->data = xmalloc (buf->size);
+  buf->len = 0;
+
+  switch (metrics->format)
+    {
+    default:
+      metrics_render_perfdata (metrics, buf, message);
+      break;
+    case METRICS_FORMAT_OPENMETRICS:
+      metrics_render_openmetrics (metrics, buf, status);
+      break;
+    case METRICS_FORMAT_JSON:
+      metrics_render_json (metrics, buf, status, message);
+      break;
+    }
+  buf->data[buf->len] = '\0';
+}
+
+#ifndef NPL_TESTING
+void
+metrics_write (struct metrics *metrics, nagstatus status,
+	       const char *message)
+{
+  struct buffer buf;
+
+  instrument_phase_push (NPL_PHASE_OUTPUT);
+  metrics_render (metrics, &buf, status, message);
+  metrics_flush (buf.data, buf.len);
+  instrument_phase_pop ();
+
+  free (buf.data);
+  metrics_free (metrics);
+}
+#endif
@@ -32,6 +32,7 @@
 
 #include "string-macros.h"
 #include "mountlist.h"
+#include "sysio.h"
 #include "xalloc.h"
 
 #if HAVE_SYS_PARAM_H
@@ -136,8 +137,15 @@ read_file_system_list (bool need_fs_type)
   {
     struct mntent *mnt;
     char const *table = MOUNTED;
+    char buf[PATH_MAX];
     FILE *fp;
 
+    /* MOUNTED is usually a symlink to /proc/self/mounts: when the proc root
+       has been redirected, read the mount table from there.  */
+    if (sysio_proc_root_is_set ()
+	&& !(table = sysio_path (PATH_PROC "/self/mounts", buf, sizeof buf)))
+      return NULL;
+
     fp = setmntent (table, "r");
     if (fp == NULL)
       return NULL;
@@ -195,3 +203,79 @@ free_then_fail:
     return NULL;
   }
 }
+
+static struct fs_type_list *
+fs_type_list_add (struct fs_type_list *list, const char *fstype)
+{
+  struct fs_type_list *fsp;
+
+  fsp = xmalloc (sizeof *fsp);
+  fsp->fs_name = (char *) fstype;
+  fsp->fs_next = list;
+  return fsp;
+}
+
+static bool
+fs_type_list_match (const struct fs_type_list *list, const char *fstype)
+{
+  const struct fs_type_list *fsp;
+
+  for (fsp = list; fsp; fsp = fsp->fs_next)
+    if (STREQ (fstype, fsp->fs_name))
+      return true;
+  return false;
+}
+
+void
+mount_filter_add_type (struct mount_filter *filter, const char *fstype)
+{
+  filter->fs_select_list = fs_type_list_add (filter->fs_select_list, fstype);
+}
+
+void
+mount_filter_exclude_type (struct mount_filter *filter, const char *fstype)
+{
+  filter->fs_exclude_list =
+    fs_type_list_add (filter->fs_exclude_list, fstype);
+}
+
+const char *
+mount_filter_conflict (const struct mount_filter *filter)
+{
+  const struct fs_type_list *fs_incl;
+
+  for (fs_incl = filter->fs_select_list; fs_incl; fs_incl = fs_incl->fs_next)
+    if (fs_type_list_match (filter->fs_exclude_list, fs_incl->fs_name))
+      return fs_incl->fs_name;
+  return NULL;
+}
+
+bool
+mount_filter_need_fs_type (const struct mount_filter *filter)
+{
+  return filter->fs_select_list != NULL || filter->fs_exclude_list != NULL
+    || filter->show_local_fs;
+}
+
+bool
+mount_filter_skip (const struct mount_filter *filter,
+		   const struct mount_entry *me)
+{
+  if (me->me_remote && filter->show_local_fs)
+    return true;
+
+  if (me->me_dummy && !filter->show_all_fs)
+    return true;
+
+  if (me->me_type == NULL)
+    return false;
+
+  /* Is the type of the file system selected and not omitted?  */
+  if (filter->fs_select_list
+      && !fs_type_list_match (filter->fs_select_list, me->me_type))
+    return true;
+  if (fs_type_list_match (filter->fs_exclude_list, me->me_type))
+    return true;
+
+  return false;
+}
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for reading the RPC statistics of the NFS mounts
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "instrument.h"
+#include "logging.h"
+#include "mountstats.h"
+#include "string-macros.h"
+#include "sysio.h"
+
+#define PATH_PROC_MOUNTSTATS  PATH_PROC "/self/mountstats"
+
+static const char *mountstats_op_names[MOUNTSTATS_OPS] = {
+  [MOUNTSTATS_OP_READ] = "READ",
+  [MOUNTSTATS_OP_WRITE] = "WRITE",
+  [MOUNTSTATS_OP_GETATTR] = "GETATTR",
+  [MOUNTSTATS_OP_LOOKUP] = "LOOKUP"
+};
+
+static const char *mountstats_counter_names[MOUNTSTATS_COUNTERS] = {
+  [MOUNTSTATS_CALLS] = "calls",
+  [MOUNTSTATS_RETRANS] = "retrans",
+  [MOUNTSTATS_TIMEOUTS] = "timeouts",
+  [MOUNTSTATS_QUEUE_MS] = "queue",
+  [MOUNTSTATS_RTT_MS] = "rtt",
+  [MOUNTSTATS_EXECUTE_MS] = "execute"
+};
+
+const char *
+mountstats_op_name (enum mountstats_op op)
+{
+  return (op < MOUNTSTATS_OPS) ? mountstats_op_names[op] : NULL;
+}
+
+const char *
+mountstats_counter_name (enum mountstats_counter counter)
+{
+  return (counter < MOUNTSTATS_COUNTERS) ?
+    mountstats_counter_names[counter] : NULL;
+}
+
+/* Decode in place the octal escapes (\040 for a space) of the kernel.  */
+
+static void
+mountstats_unescape (char *s)
+{
+  char *dst = s;
+
+  for (; *s; s++)
+    if (s[0] == '\\' && s[1] >= '0' && s[1] <= '3'
+	&& s[2] >= '0' && s[2] <= '7' && s[3] >= '0' && s[3] <= '7')
+      {
+	*dst++ = ((s[1] - '0') << 6) | ((s[2] - '0') << 3) | (s[3] - '0');
+	s += 3;
+      }
+    else
+      *dst++ = *s;
+  *dst = '\0';
+}
+
+/* Parse the line
+ *   device SERVER:/EXPORT mounted on MOUNTDIR with fstype nfs4 statvers=1.1
+ * splitting it in place.  Return false if the line is malformed.  */
+
+static bool
+mountstats_parse_device (char *line, struct mountstats *ms)
+{
+  char *mountdir, *fstype, *end;
+
+  if (NULL == (mountdir = strstr (line, " mounted on "))
+      || NULL == (fstype = strstr (mountdir, " with fstype ")))
+    return false;
+
+  *mountdir = '\0';
+  mountdir += sizeof (" mounted on ") - 1;
+  *fstype = '\0';
+  fstype += sizeof (" with fstype ") - 1;
+  for (end = fstype; *end && !isspace ((unsigned char) *end); end++)
+    ;
+  *end = '\0';
+
+  ms->devname = line + sizeof ("device ") - 1;
+  ms->mountdir = mountdir;
+  ms->fstype = fstype;
+  mountstats_unescape ((char *) ms->devname);
+  mountstats_unescape (mountdir);
+
+  return true;
+}
+
+/* Parse the line of the statistics of an operation
+ *   READ: ops trans timeouts bytes_sent bytes_recv queue rtt execute [errors]
+ * if it is one of the operations of interest.  */
+
+static void
+mountstats_parse_op (const char *line, struct mountstats *ms)
+{
+  unsigned long long value[8];
+  const char *p, *colon;
+  char *end;
+  size_t op, i;
+
+  while (isspace ((unsigned char) *line))
+    line++;
+  if (NULL == (colon = strchr (line, ':')))
+    return;
+
+  for (op = 0; op < MOUNTSTATS_OPS; op++)
+    if (STREQLEN (line, mountstats_op_names[op], colon - line)
+	&& mountstats_op_names[op][colon - line] == '\0')
+      break;
+  if (op == MOUNTSTATS_OPS)
+    return;
+
+  for (i = 0, p = colon + 1; i < 8; i++, p = end)
+    {
+      errno = 0;
+      value[i] = strtoull (p, &end, 10);
+      if (errno != 0 || end == p)
+	{
+	  dbg ("%s: malformed statistics of %s\n", ms->mountdir,
+	       mountstats_op_names[op]);
+	  return;
+	}
+    }
+
+  ms->counter[op][MOUNTSTATS_CALLS] = value[0];
+  ms->counter[op][MOUNTSTATS_RETRANS] =
+    (value[1] > value[0]) ? value[1] - value[0] : 0;
+  ms->counter[op][MOUNTSTATS_TIMEOUTS] = value[2];
+  ms->counter[op][MOUNTSTATS_QUEUE_MS] = value[5];
+  ms->counter[op][MOUNTSTATS_RTT_MS] = value[6];
+  ms->counter[op][MOUNTSTATS_EXECUTE_MS] = value[7];
+}
+
+/* The file is made of a "device" line per mount, followed for the NFS ones
+ * by some lines of statistics ending with the "per-op statistics", a line
+ * for each operation of the protocol.  Only the line being parsed and the
+ * counters of the current mount are kept in memory.  */
+
+int
+mountstats_read (void (*fn) (const struct mountstats *ms, void *data),
+		 void *data)
+{
+  struct mountstats ms;
+  bool per_op = false, device = false;
+  char *line = NULL, *device_line = NULL;
+  size_t len = 0;
+  FILE *fp;
+
+  if ((fp = sysio_fopen (PATH_PROC_MOUNTSTATS)) == NULL)
+    return -1;
+
+  instrument_phase_push (NPL_PHASE_PARSE);
+  memset (&ms, 0, sizeof (ms));
+  while (getline (&line, &len, fp) != -1)
+    {
+      if (STRPREFIX (line, "device "))
+	{
+	  if (per_op)
+	    fn (&ms, data);
+	  per_op = false;
+	  memset (&ms, 0, sizeof (ms));
+
+	  /* the strings of the mount point to the device line, which is
+	     kept while the next lines are read */
+	  free (device_line);
+	  device_line = line;
+	  line = NULL;
+	  len = 0;
+	  device = mountstats_parse_device (device_line, &ms);
+	  continue;
+	}
+
+      if (!device)
+	continue;
+      if (per_op)
+	mountstats_parse_op (line, &ms);
+      else if (STRPREFIX (line, "\tper-op statistics"))
+	per_op = true;
+    }
+  if (per_op)
+    fn (&ms, data);
+
+  free (device_line);
+  free (line);
+  fclose (fp);
+  instrument_phase_pop ();
+
+  return 0;
+}
@@ -27,18 +27,22 @@
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <linux/ethtool.h>
+#include <linux/gen_stats.h>
 #ifdef HAVE_LINUX_IF_LINK_H
 # include <linux/if_link.h>
 #endif
 #include <linux/netlink.h>
+#include <linux/pkt_sched.h>
 #include <linux/rtnetlink.h>
 #include <linux/sockios.h>
 #include <linux/wireless.h>
 
 #include "common.h"
+#include "instrument.h"
 #include "logging.h"
 #include "messages.h"
 #include "netinfo.h"
+#include "sockdiag.h"
 #include "string-macros.h"
 #include "system.h"
 #include "xalloc.h"
@@ -362,7 +366,11 @@ get_netinfo_snapshot (unsigned int options, const regex_t *if_regex)
       rtnl_reply.msg_namelen = sizeof (kernel);
 
       /* read as much data as fits in the receive buffer */
-      if ((len = recvmsg (fd, &rtnl_reply, MSG_DONTWAIT)) < 0)
+      instrument_phase_push (NPL_PHASE_READ);
+      len = recvmsg (fd, &rtnl_reply, MSG_DONTWAIT);
+      instrument_phase_pop ();
+      instrument_count_io (1, len > 0 ? len : 0);
+      if (len < 0)
 	{
 	  usleep (250000);		/* sleep for a while */
 	  continue;
@@ -412,6 +420,7 @@ get_netinfo_snapshot (unsigned int options, const regex_t *if_regex)
 	       * all the members, except stats-related ones  */
 	      ifl = xmalloc (sizeof (struct iflist));
 	      ifl->ifname = xstrdup (name);
+	      ifl->ifindex = ifi->ifi_index;
 	      ifl->flags = ifi->ifi_flags;
 	      check_link_speed (name, &(ifl->speed), &(ifl->duplex));
 
@@ -452,3 +461,136 @@ get_netinfo_snapshot (unsigned int options, const regex_t *if_regex)
 }
 
 #undef IFLIST_REPLY_BUFFER
+
+static const char *qdisc_counter_names[QDISC_COUNTERS] = {
+  [QDISC_BYTES] = "bytes",
+  [QDISC_PACKETS] = "packets",
+  [QDISC_DROPS] = "drops",
+  [QDISC_OVERLIMITS] = "overlimits",
+  [QDISC_REQUEUES] = "requeues"
+};
+
+const char *
+qdisc_counter_name (enum qdisc_counter counter)
+{
+  return (counter < QDISC_COUNTERS) ? qdisc_counter_names[counter] : NULL;
+}
+
+struct qdisc_dump
+{
+  struct qdisc_stats *qdiscs;
+  size_t nqdiscs;
+};
+
+/* Copy at most SIZE bytes of the payload of the attribute RTA into DEST,
+   the structures of the statistics having grown over time.  */
+
+static void
+qdisc_rta_copy (void *dest, size_t size, struct rtattr *rta)
+{
+  size_t len = RTA_PAYLOAD (rta);
+
+  memcpy (dest, RTA_DATA (rta), len < size ? len : size);
+}
+
+/* Add the root qdisc of the message H to the dump DATA, with the counters
+ * of TCA_STATS2 or, for the old kernels, of TCA_STATS.  */
+
+static void
+qdisc_dump_add (const struct nlmsghdr *h, void *data)
+{
+  struct qdisc_dump *dump = data;
+  struct tcmsg *tcm = NLMSG_DATA (h);
+  struct rtattr *tb[TCA_MAX + 1], *st[TCA_STATS_MAX + 1];
+  struct qdisc_stats *qdisc;
+  int attr_len = h->nlmsg_len - NLMSG_LENGTH (sizeof (*tcm));
+
+  if (h->nlmsg_type != RTM_NEWQDISC || attr_len < 0
+      || tcm->tcm_parent != TC_H_ROOT)
+    return;
+
+  parse_rtattr (tb, TCA_MAX, TCA_RTA (tcm), attr_len);
+
+  dump->qdiscs = xrealloc (dump->qdiscs, (dump->nqdiscs + 1)
+					 * sizeof (struct qdisc_stats));
+  qdisc = &dump->qdiscs[dump->nqdiscs++];
+  memset (qdisc, 0, sizeof (struct qdisc_stats));
+  qdisc->ifindex = tcm->tcm_ifindex;
+  qdisc->handle = tcm->tcm_handle;
+  if (tb[TCA_KIND])
+    STRNCPY_TERMINATED (qdisc->kind, (char *) RTA_DATA (tb[TCA_KIND]),
+			sizeof (qdisc->kind));
+
+  if (tb[TCA_STATS2])
+    {
+      struct gnet_stats_basic basic = { 0 };
+      struct gnet_stats_queue queue = { 0 };
+
+      parse_rtattr (st, TCA_STATS_MAX, RTA_DATA (tb[TCA_STATS2]),
+		    RTA_PAYLOAD (tb[TCA_STATS2]));
+      if (st[TCA_STATS_BASIC])
+	qdisc_rta_copy (&basic, sizeof (basic), st[TCA_STATS_BASIC]);
+      if (st[TCA_STATS_QUEUE])
+	qdisc_rta_copy (&queue, sizeof (queue), st[TCA_STATS_QUEUE]);
+
+      qdisc->counter[QDISC_BYTES] = basic.bytes;
+      qdisc->counter[QDISC_PACKETS] = basic.packets;
+#if HAVE_DECL_TCA_STATS_PKT64
+      /* the 32-bit packet counter wraps */
+      if (st[TCA_STATS_PKT64])
+	qdisc_rta_copy (&qdisc->counter[QDISC_PACKETS],
+			sizeof (qdisc->counter[QDISC_PACKETS]),
+			st[TCA_STATS_PKT64]);
+#endif
+      qdisc->counter[QDISC_DROPS] = queue.drops;
+      qdisc->counter[QDISC_OVERLIMITS] = queue.overlimits;
+      qdisc->counter[QDISC_REQUEUES] = queue.requeues;
+      qdisc->backlog = queue.backlog;
+      qdisc->qlen = queue.qlen;
+    }
+  else if (tb[TCA_STATS])
+    {
+      struct tc_stats stats = { 0 };
+
+      qdisc_rta_copy (&stats, sizeof (stats), tb[TCA_STATS]);
+      qdisc->counter[QDISC_BYTES] = stats.bytes;
+      qdisc->counter[QDISC_PACKETS] = stats.packets;
+      qdisc->counter[QDISC_DROPS] = stats.drops;
+      qdisc->counter[QDISC_OVERLIMITS] = stats.overlimits;
+      qdisc->backlog = stats.backlog;
+      qdisc->qlen = stats.qlen;
+    }
+
+  dbg ("qdisc %s %x: on ifindex %d, %llu packets, %llu drops, "
+       "backlog %ub %up\n", qdisc->kind, qdisc->handle >> 16,
+       qdisc->ifindex, qdisc->counter[QDISC_PACKETS],
+       qdisc->counter[QDISC_DROPS], qdisc->backlog, qdisc->qlen);
+}
+
+struct qdisc_stats *
+qdisc_read (size_t *nqdiscs)
+{
+  struct
+  {
+    struct nlmsghdr nlh;
+    struct tcmsg tcm;
+  } req;
+  struct qdisc_dump dump = { NULL, 0 };
+  int fd;
+
+  memset (&req, 0, sizeof (req));
+  req.nlh.nlmsg_len = NLMSG_LENGTH (sizeof (struct tcmsg));
+  req.nlh.nlmsg_type = RTM_GETQDISC;
+  req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.nlh.nlmsg_seq = 1;
+  req.tcm.tcm_family = AF_UNSPEC;
+
+  fd = get_rtnl_fd ();
+  if (netlink_dump (fd, &req, req.nlh.nlmsg_len, qdisc_dump_add, &dump) < 0)
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot dump the queueing disciplines");
+  close (fd);
+
+  *nqdiscs = dump.nqdiscs;
+  return dump.qdiscs;
+}
@@ -20,6 +20,7 @@
  *
  */
 
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -35,27 +36,167 @@
 #include "messages.h"
 #include "netinfo.h"
 #include "netinfo-private.h"
+#include "netns.h"
 #include "system.h"
+#include "xalloc.h"
 #include "xasprintf.h"
 
-extern char *const duplex_table[];
+/* Compile the regular expression IFNAME_REGEX selecting the interfaces */
 
-struct iflist *
-netinfo (unsigned int options, const char *ifname_regex, unsigned int seconds,
-	 unsigned int *ninterfaces)
+static void
+netinfo_regcomp (regex_t *regex, const char *ifname_regex)
 {
-  bool opt_check_link = (options & CHECK_LINK);
   char msgbuf[256];
   int rc;
-  regex_t regex;
-  struct iflist *iflhead, *ifl, *iflhead2, *ifl2;
 
   if ((rc =
-       regcomp (&regex, ifname_regex ? ifname_regex : ".*", REG_EXTENDED)))
+       regcomp (regex, ifname_regex ? ifname_regex : ".*", REG_EXTENDED)))
     {
-      regerror (rc, &regex, msgbuf, sizeof (msgbuf));
+      regerror (rc, regex, msgbuf, sizeof (msgbuf));
       plugin_error (STATE_UNKNOWN, 0, "could not compile regex: %s", msgbuf);
     }
+}
+
+static bool
+netinfo_same_iface (const struct iflist *ifl, const struct iflist *ifl2)
+{
+  return ifl->ifindex == ifl2->ifindex && STREQ (ifl->ifname, ifl2->ifname);
+}
+
+/* Return the interface of the list IFLHEAD with the same name and index
+ * as IFL, or NULL.  The search starts from *CURSOR, the entry following
+ * the last match, the two lists being usually in the same order.  */
+
+static struct iflist *
+netinfo_lookup (struct iflist *iflhead, struct iflist **cursor,
+		const struct iflist *ifl)
+{
+  struct iflist *found;
+
+  for (found = *cursor; found != NULL; found = found->next)
+    if (netinfo_same_iface (found, ifl))
+      {
+	*cursor = found->next;
+	return found;
+      }
+  for (found = iflhead; found != *cursor; found = found->next)
+    if (netinfo_same_iface (found, ifl))
+      {
+	*cursor = found->next;
+	return found;
+      }
+
+  return NULL;
+}
+
+/* Replace the counters of *IFLHEAD with the rates per second, IFLHEAD2
+ * being the snapshot taken SECONDS later, and count the interfaces.
+ * The interfaces removed or recreated between the two snapshots are
+ * dropped from *IFLHEAD, and the ones added are ignored.  */
+
+static void
+netinfo_rates (struct iflist **iflhead, struct iflist *iflhead2,
+	       unsigned int seconds, unsigned int options,
+	       unsigned int *ninterfaces)
+{
+  bool opt_check_link = (options & CHECK_LINK);
+  struct iflist **next = iflhead, *ifl, *ifl2, *cursor = iflhead2;
+
+  *ninterfaces = 0;
+  while ((ifl = *next) != NULL)
+    {
+      if (NULL == (ifl2 = netinfo_lookup (iflhead2, &cursor, ifl)))
+	{
+	  dbg ("network interface '%s' has vanished\n", ifl->ifname);
+	  *next = ifl->next;
+	  ifl->next = NULL;
+	  freeiflist (ifl);
+	  continue;
+	}
+      next = &ifl->next;
+
+      dbg ("network interface '%s'\n", ifl->ifname);
+
+      bool if_up = if_flags_UP (ifl->flags),
+	   if_running = if_flags_RUNNING (ifl->flags);
+
+      if (ifl->stats && ifl2->stats)
+	{
+#define DIV(a, b) ceil (((b) - (a)) / (double)seconds)
+	  dbg ("\ttx_packets : %u %u\n",
+	       ifl->stats->tx_packets, ifl2->stats->tx_packets);
+	  ifl->stats->tx_packets = DIV (ifl->stats->tx_packets,
+					ifl2->stats->tx_packets);
+
+	  dbg ("\trx_packets : %u %u\n",
+	       ifl->stats->rx_packets, ifl2->stats->rx_packets);
+	  ifl->stats->rx_packets = DIV (ifl->stats->rx_packets,
+					ifl2->stats->rx_packets);
+
+	  dbg ("\ttx_bytes   : %u %u\n",
+	       ifl->stats->tx_bytes, ifl2->stats->tx_bytes);
+	  ifl->stats->tx_bytes   = DIV (ifl->stats->tx_bytes,
+					ifl2->stats->tx_bytes);
+
+	  dbg ("\trx_bytes   : %u %u\n",
+	       ifl->stats->rx_bytes, ifl2->stats->rx_bytes);
+	  ifl->stats->rx_bytes   = DIV (ifl->stats->rx_bytes,
+					ifl2->stats->rx_bytes);
+
+	  dbg ("\ttx_errors  : %u %u\n",
+	       ifl->stats->tx_errors, ifl2->stats->tx_errors);
+	  ifl->stats->tx_errors  = DIV (ifl->stats->tx_errors,
+					ifl2->stats->tx_errors);
+
+	  dbg ("\trx_errors  : %u %u\n",
+	       ifl->stats->rx_errors, ifl2->stats->rx_errors);
+	  ifl->stats->rx_errors  = DIV (ifl->stats->rx_errors,
+					ifl2->stats->rx_errors);
+
+	  dbg ("\ttx_dropped : %u %u\n",
+	       ifl->stats->tx_dropped, ifl2->stats->tx_dropped);
+	  ifl->stats->tx_dropped = DIV (ifl->stats->tx_dropped,
+					ifl2->stats->tx_dropped);
+
+	  dbg ("\trx_dropped : %u %u\n",
+	       ifl->stats->rx_dropped, ifl2->stats->rx_dropped);
+	  ifl->stats->rx_dropped = DIV (ifl->stats->rx_dropped,
+					ifl2->stats->rx_dropped);
+
+	  dbg ("\tcollisions : %u %u\n",
+	       ifl->stats->collisions, ifl2->stats->collisions);
+	  ifl->stats->collisions = DIV (ifl->stats->collisions,
+					ifl2->stats->collisions);
+
+	  dbg ("\tmulticast  : %u %u\n",
+	       ifl->stats->multicast, ifl2->stats->multicast);
+	  ifl->stats->multicast  = DIV (ifl->stats->multicast,
+					ifl2->stats->multicast);
+#undef DIV
+	}
+
+      dbg ("\tlink UP: %s\n", if_up ? "true" : "false");
+      dbg ("\tlink RUNNING: %s\n", if_running ? "true" : "false");
+
+      if (ifl->speed > 0)
+	dbg ("\tspeed      : %uMbit/s\n", ifl->speed);
+
+      if (opt_check_link && !(if_up && if_running))
+	plugin_error (STATE_CRITICAL, 0,
+		      "%s matches the given regular expression "
+		      "but is not UP and RUNNING!", ifl->ifname);
+      (*ninterfaces)++;
+    }
+}
+
+struct iflist *
+netinfo (unsigned int options, const char *ifname_regex, unsigned int seconds,
+	 unsigned int *ninterfaces)
+{
+  regex_t regex;
+  struct iflist *iflhead, *iflhead2;
+
+  netinfo_regcomp (&regex, ifname_regex);
 
   dbg ("getting network informations...\n");
   iflhead = get_netinfo_snapshot (options, &regex);
@@ -66,92 +207,114 @@ netinfo (unsigned int options, const char *ifname_regex, unsigned int seconds,
 
       dbg ("getting network informations again (after %us)...\n", seconds);
       iflhead2 = get_netinfo_snapshot (options, &regex);
+      netinfo_rates (&iflhead, iflhead2, seconds, options, ninterfaces);
+      freeiflist (iflhead2);
+    }
 
-      *ninterfaces = 0;
-      for (ifl = iflhead, ifl2 = iflhead2; ifl != NULL && ifl2 != NULL;
-	   ifl = ifl->next, ifl2 = ifl2->next)
-	{
-	  if (STRNEQ (ifl->ifname, ifl2->ifname))
-	    plugin_error (STATE_UNKNOWN, 0,
-			  "bug in netinfo(), please contact the developers");
+  /* Free memory allocated to the pattern buffer by regcomp() */
+  regfree (&regex);
 
-	  dbg ("network interface '%s'\n", ifl->ifname);
+  return iflhead;
+}
 
-	  bool if_up = if_flags_UP (ifl->flags),
-	       if_running = if_flags_RUNNING (ifl->flags);
+struct netinfo_netns_data
+{
+  unsigned int options;
+  const regex_t *regex;
+  struct iflist *iflhead;
+};
 
-	  if (ifl->stats)
-	    {
-#define DIV(a, b) ceil (((b) - (a)) / (double)seconds)
-	      dbg ("\ttx_packets : %u %u\n",
-		   ifl->stats->tx_packets, ifl2->stats->tx_packets);
-	      ifl->stats->tx_packets = DIV (ifl->stats->tx_packets,
-					    ifl2->stats->tx_packets);
-
-	      dbg ("\trx_packets : %u %u\n",
-		   ifl->stats->rx_packets, ifl2->stats->rx_packets);
-	      ifl->stats->rx_packets = DIV (ifl->stats->rx_packets,
-					    ifl2->stats->rx_packets);
-
-	      dbg ("\ttx_bytes   : %u %u\n",
-		   ifl->stats->tx_bytes, ifl2->stats->tx_bytes);
-	      ifl->stats->tx_bytes   = DIV (ifl->stats->tx_bytes,
-					    ifl2->stats->tx_bytes);
-
-	      dbg ("\trx_bytes   : %u %u\n",
-		   ifl->stats->rx_bytes, ifl2->stats->rx_bytes);
-	      ifl->stats->rx_bytes   = DIV (ifl->stats->rx_bytes,
-					    ifl2->stats->rx_bytes);
-
-	      dbg ("\ttx_errors  : %u %u\n",
-		   ifl->stats->tx_errors, ifl2->stats->tx_errors);
-	      ifl->stats->tx_errors  = DIV (ifl->stats->tx_errors,
-					    ifl2->stats->tx_errors);
-
-	      dbg ("\trx_errors  : %u %u\n",
-		   ifl->stats->rx_errors, ifl2->stats->rx_errors);
-	      ifl->stats->rx_errors  = DIV (ifl->stats->rx_errors,
-					    ifl2->stats->rx_errors);
-
-	      dbg ("\ttx_dropped : %u %u\n",
-		   ifl->stats->tx_dropped, ifl2->stats->tx_dropped);
-	      ifl->stats->tx_dropped = DIV (ifl->stats->tx_dropped,
-					    ifl2->stats->tx_dropped);
-
-	      dbg ("\trx_dropped : %u %u\n",
-		   ifl->stats->rx_dropped, ifl2->stats->rx_dropped);
-	      ifl->stats->rx_dropped = DIV (ifl->stats->rx_dropped,
-					    ifl2->stats->rx_dropped);
-
-	      dbg ("\tcollisions : %u %u\n",
-		   ifl->stats->collisions, ifl2->stats->collisions);
-	      ifl->stats->collisions = DIV (ifl->stats->collisions,
-					    ifl2->stats->collisions);
-
-	      dbg ("\tmulticast  : %u %u\n",
-		   ifl->stats->multicast, ifl2->stats->multicast);
-	      ifl->stats->multicast  = DIV (ifl->stats->multicast,
-					    ifl2->stats->multicast);
-#undef DIV
-	    }
+static void
+netinfo_netns_snapshot (void *data)
+{
+  struct netinfo_netns_data *d = data;
+
+  d->iflhead = get_netinfo_snapshot (d->options, d->regex);
+}
+
+/* Take a snapshot in the network namespace NS, and return false if the
+ * namespace has vanished in the meantime.  */
+
+static bool
+netinfo_netns_run (const struct netns *ns, struct netinfo_netns_data *d)
+{
+  d->iflhead = NULL;
+  if (netns_run (ns, netinfo_netns_snapshot, d) == 0)
+    return true;
+
+  if (errno != ENOENT && errno != ESRCH)
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot enter the network namespace %s", ns->name);
+  dbg ("the network namespace %s has vanished\n", ns->name);
+  return false;
+}
+
+struct iflist *
+netinfo_netns (const struct netns *netns, size_t nnetns,
+	       unsigned int options, const char *ifname_regex,
+	       unsigned int seconds, unsigned int *ninterfaces)
+{
+  struct netinfo_netns_data *first, second;
+  struct iflist *iflhead = NULL, *ifltail = NULL, *ifl;
+  regex_t regex;
+  size_t i;
 
-	  dbg ("\tlink UP: %s\n", if_up ? "true" : "false");
-	  dbg ("\tlink RUNNING: %s\n", if_running ? "true" : "false");
+  netinfo_regcomp (&regex, ifname_regex);
+  first = xnmalloc (nnetns, sizeof (struct netinfo_netns_data));
 
-	  if (ifl->speed > 0)
-	    dbg ("\tspeed      : %uMbit/s\n", ifl->speed);
+  for (i = 0; i < nnetns; i++)
+    {
+      first[i].options = options;
+      first[i].regex = &regex;
+      dbg ("getting network informations in the namespace \"%s\"...\n",
+	   netns[i].name);
+      netinfo_netns_run (&netns[i], &first[i]);
+    }
 
-	  if (opt_check_link && !(if_up && if_running))
-	    plugin_error (STATE_CRITICAL, 0,
-			  "%s matches the given regular expression "
-			  "but is not UP and RUNNING!", ifl->ifname);
-	  (*ninterfaces)++;
+  /* a single delay for all the namespaces */
+  if (seconds > 0)
+    sleep (seconds);
+
+  *ninterfaces = 0;
+  for (i = 0; i < nnetns; i++)
+    {
+      unsigned int n = 0;
+
+      if (seconds > 0 && first[i].iflhead)
+	{
+	  second = first[i];
+	  if (netinfo_netns_run (&netns[i], &second))
+	    {
+	      netinfo_rates (&first[i].iflhead, second.iflhead, seconds,
+			     options, &n);
+	      freeiflist (second.iflhead);
+	    }
+	  else
+	    {
+	      freeiflist (first[i].iflhead);
+	      first[i].iflhead = NULL;
+	    }
 	}
 
-      freeiflist (iflhead2);
+      /* label the interfaces with the namespace and chain the lists */
+      for (ifl = first[i].iflhead; ifl != NULL; ifl = ifl->next)
+	{
+	  char *label = netns_label (&netns[i], ifl->ifname);
+
+	  free (ifl->ifname);
+	  ifl->ifname = label;
+	  if (seconds == 0)
+	    n++;
+	  if (NULL == iflhead)
+	    iflhead = ifl;
+	  else
+	    ifltail->next = ifl;
+	  ifltail = ifl;
+	}
+      *ninterfaces += n;
     }
 
-  /* Free memory allocated to the pattern buffer by regcomp() */
+  free (first);
   regfree (&regex);
 
   return iflhead;
@@ -171,6 +334,12 @@ iflist_get_ifname (struct iflist *ifentry)
   return ifentry->ifname;
 }
 
+int
+iflist_get_ifindex (struct iflist *ifentry)
+{
+  return ifentry->ifindex;
+}
+
 uint8_t
 iflist_get_duplex (struct iflist *ifentry)
 {
@@ -280,6 +449,7 @@ freeiflist (struct iflist *iflhead)
     {
       iflnext = ifl->next;
       free (ifl->ifname);
+      free (ifl->stats);
       free (ifl);
       ifl = iflnext;
     }
@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for listing the network namespaces and running some code in
+ * each of them
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc (setns) */
+#endif
+
+#include <sys/stat.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logging.h"
+#include "netns.h"
+#include "sysio.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+
+#define PATH_PROC_SELF_NETNS  PATH_PROC "/self/ns/net"
+
+/* Add to NETNS, an array of *NNETNS namespaces, the one of the file PATH,
+   unless it has already been found or PATH cannot be accessed (the
+   namespaces of the processes of the other users cannot).  */
+
+static struct netns *
+netns_add (struct netns *netns, size_t *nnetns, const char *name,
+	   const char *path, bool self)
+{
+  char buf[PATH_MAX];
+  const char *realpath = sysio_path (path, buf, sizeof (buf));
+  struct stat st;
+
+  if (NULL == realpath || stat (realpath, &st) < 0)
+    {
+      dbg ("cannot access %s: %s\n", path, strerror (errno));
+      return netns;
+    }
+
+  for (size_t i = 0; i < *nnetns; i++)
+    if (netns[i].dev == st.st_dev && netns[i].ino == st.st_ino)
+      return netns;
+
+  netns = xrealloc (netns, (*nnetns + 1) * sizeof (struct netns));
+  netns[*nnetns].name = xstrdup (name);
+  netns[*nnetns].path = xstrdup (realpath);
+  netns[*nnetns].dev = st.st_dev;
+  netns[*nnetns].ino = st.st_ino;
+  netns[*nnetns].self = self;
+  dbg ("network namespace \"%s\" (inode %lu): %s\n", name,
+       (unsigned long) st.st_ino, path);
+  (*nnetns)++;
+
+  return netns;
+}
+
+static struct netns *
+netns_scan (const char *rundir, size_t *nnetns)
+{
+  struct netns *netns = NULL;
+  struct dirent **namelist, *dp;
+  struct sysio_dir *dirp;
+  int n;
+
+  *nnetns = 0;
+  netns = netns_add (netns, nnetns, "", PATH_PROC_SELF_NETNS, true);
+  if (*nnetns == 0)
+    return NULL;
+
+  if ((n = scandir (rundir, &namelist, NULL, alphasort)) >= 0)
+    {
+      for (int i = 0; i < n; i++)
+	{
+	  if (namelist[i]->d_name[0] != '.')
+	    {
+	      char *path = xasprintf ("%s/%s", rundir, namelist[i]->d_name);
+	      netns = netns_add (netns, nnetns, namelist[i]->d_name, path,
+				 false);
+	      free (path);
+	    }
+	  free (namelist[i]);
+	}
+      free (namelist);
+    }
+
+  if ((dirp = sysio_opendir (PATH_PROC)) == NULL)
+    {
+      int saved_errno = errno;
+      netns_list_free (netns, *nnetns);
+      errno = saved_errno;
+      return NULL;
+    }
+
+  while ((dp = sysio_readdir (dirp)) != NULL)
+    {
+      char *name, *path;
+
+      if (!isdigit ((unsigned char) dp->d_name[0]))
+	continue;
+
+      name = xasprintf ("pid%s", dp->d_name);
+      path = xasprintf (PATH_PROC "/%s/ns/net", dp->d_name);
+      netns = netns_add (netns, nnetns, name, path, false);
+      free (path);
+      free (name);
+    }
+  sysio_closedir (dirp);
+
+  return netns;
+}
+
+struct netns *
+netns_list (size_t *nnetns)
+{
+  return netns_scan (PATH_RUN_NETNS, nnetns);
+}
+
+void
+netns_list_free (struct netns *netns, size_t nnetns)
+{
+  for (size_t i = 0; i < nnetns; i++)
+    {
+      free (netns[i].name);
+      free (netns[i].path);
+    }
+  free (netns);
+}
+
+char *
+netns_label (const struct netns *ns, const char *name)
+{
+  return ns->self ? xstrdup (name) : xasprintf ("%s@%s", name, ns->name);
+}
+
+#ifdef HAVE_SETNS
+
+struct netns_worker
+{
+  const struct netns *ns;
+  void (*fn) (void *data);
+  void *data;
+  int err;
+};
+
+/* The namespaces are per thread: the worker enters NS and exits with it,
+   the other threads being left in the namespace of the plugin.  */
+
+static void *
+netns_worker (void *arg)
+{
+  struct netns_worker *w = arg;
+  struct stat st;
+  int fd;
+
+  if ((fd = open (w->ns->path, O_RDONLY | O_CLOEXEC)) < 0)
+    {
+      w->err = errno;
+      return NULL;
+    }
+
+  /* the process may have exited and its pid been reused */
+  if (fstat (fd, &st) < 0
+      || st.st_dev != w->ns->dev || st.st_ino != w->ns->ino)
+    w->err = ESRCH;
+  else if (setns (fd, CLONE_NEWNET) < 0)
+    w->err = errno;
+  close (fd);
+
+  if (w->err == 0)
+    w->fn (w->data);
+  return NULL;
+}
+
+int
+netns_run (const struct netns *ns, void (*fn) (void *data), void *data)
+{
+  struct netns_worker w = { .ns = ns, .fn = fn, .data = data };
+  pthread_t thread;
+  int err;
+
+  if (ns->self)
+    {
+      fn (data);
+      return 0;
+    }
+
+  if ((err = pthread_create (&thread, NULL, netns_worker, &w)) != 0
+      || (err = pthread_join (thread, NULL)) != 0)
+    {
+      errno = err;
+      return -1;
+    }
+  if (w.err)
+    {
+      dbg ("cannot enter the network namespace \"%s\": %s\n", ns->name,
+	   strerror (w.err));
+      errno = w.err;
+      return -1;
+    }
+
+  return 0;
+}
+
+#else
+
+int
+netns_run (const struct netns *ns, void (*fn) (void *data), void *data)
+{
+  if (ns->self)
+    {
+      fn (data);
+      return 0;
+    }
+
+  errno = ENOSYS;
+  return -1;
+}
+
+#endif
@@ -0,0 +1,334 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for reading the statistics of the queues of the network
+ * interfaces
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/ethtool.h>
+#include <linux/if.h>
+#include <linux/sockios.h>
+
+#include "logging.h"
+#include "netqueue.h"
+#include "string-macros.h"
+#include "sysio.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+
+#define PATH_SYS_CLASS_NET  PATH_SYS "/class/net"
+
+static const char *netqueue_counter_names[NETQUEUE_COUNTERS] = {
+  [NETQUEUE_RX_PACKETS] = "rxpck",
+  [NETQUEUE_RX_DROPS] = "rxdrop",
+  [NETQUEUE_TX_PACKETS] = "txpck",
+  [NETQUEUE_TX_DROPS] = "txdrop"
+};
+
+struct netqueue
+{
+  char ifname[IFNAMSIZ];
+  int fd;			/* the socket used for the ethtool ioctls */
+  unsigned int rx_queues;
+  unsigned int tx_queues;
+  unsigned int nqueues;
+  unsigned int counters;	/* the counters found, 1 << counter */
+  uint32_t nstats;		/* the number of the ethtool statistics */
+  int *map;			/* the counter of each statistic, or -1 */
+  struct ethtool_stats *stats;
+};
+
+const char *
+netqueue_counter_name (enum netqueue_counter counter)
+{
+  return (counter < NETQUEUE_COUNTERS) ?
+    netqueue_counter_names[counter] : NULL;
+}
+
+unsigned int
+netqueue_rx_queues (const struct netqueue *nq)
+{
+  return nq->rx_queues;
+}
+
+unsigned int
+netqueue_tx_queues (const struct netqueue *nq)
+{
+  return nq->tx_queues;
+}
+
+unsigned int
+netqueue_queues (const struct netqueue *nq)
+{
+  return nq->nqueues;
+}
+
+bool
+netqueue_has_counter (const struct netqueue *nq,
+		      enum netqueue_counter counter)
+{
+  return nq->counters & (1U << counter);
+}
+
+/* Map the name of an ethtool statistic to a queue counter, and return the
+ * counter or -1.  The drivers do not agree on a naming scheme, the ones
+ * understood being:
+ *   rx_queue_0_packets, tx_queue_0_drops  (igb, ixgbe, ice, virtio_net)
+ *   rx-0.packets, rx-0.rx_packets         (i40e)
+ *   rx0_packets, tx0_dropped              (mlx4, mlx5)  */
+
+static int
+netqueue_parse_stat (const char *name, unsigned int *queue)
+{
+  const char *p, *prefix;
+  char *end;
+  unsigned long q;
+  bool rx;
+
+  if (STRPREFIX (name, "rx"))
+    rx = true;
+  else if (STRPREFIX (name, "tx"))
+    rx = false;
+  else
+    return -1;
+  prefix = rx ? "rx_" : "tx_";
+
+  p = name + 2;
+  if (STRPREFIX (p, "_queue_"))
+    p += 7;
+  else if (*p == '-')
+    p++;
+  if (!isdigit ((unsigned char) *p))
+    return -1;
+
+  errno = 0;
+  q = strtoul (p, &end, 10);
+  if (errno != 0 || q >= NETQUEUE_MAX_QUEUES
+      || (*end != '_' && *end != '.'))
+    return -1;
+  p = end + 1;
+  if (STRPREFIX (p, prefix))
+    p += 3;
+
+  *queue = q;
+  if (STREQ (p, "packets"))
+    return rx ? NETQUEUE_RX_PACKETS : NETQUEUE_TX_PACKETS;
+  if (STREQ (p, "drops") || STREQ (p, "dropped"))
+    return rx ? NETQUEUE_RX_DROPS : NETQUEUE_TX_DROPS;
+  return -1;
+}
+
+/* Count the rx-N and tx-N directories of /sys/class/net/IFNAME/queues.  */
+
+static void
+netqueue_sysfs_count (const char *ifname, unsigned int *rx_queues,
+		      unsigned int *tx_queues)
+{
+  char *path = xasprintf (PATH_SYS_CLASS_NET "/%s/queues", ifname);
+  struct dirent *dp;
+  struct sysio_dir *dirp;
+
+  *rx_queues = *tx_queues = 0;
+  if ((dirp = sysio_opendir (path)) == NULL)
+    {
+      dbg ("%s: cannot open %s\n", ifname, path);
+      free (path);
+      return;
+    }
+
+  while ((dp = sysio_readdir (dirp)) != NULL)
+    if (STRPREFIX (dp->d_name, "rx-"))
+      (*rx_queues)++;
+    else if (STRPREFIX (dp->d_name, "tx-"))
+      (*tx_queues)++;
+
+  sysio_closedir (dirp);
+  free (path);
+}
+
+static int
+netqueue_ioctl (struct netqueue *nq, void *data)
+{
+  struct ifreq ifr;
+
+  memset (&ifr, 0, sizeof (ifr));
+  memcpy (ifr.ifr_name, nq->ifname, sizeof (ifr.ifr_name));
+  ifr.ifr_data = data;
+
+  return ioctl (nq->fd, SIOCETHTOOL, &ifr);
+}
+
+/* Return the number of the ethtool statistics of the driver, with
+   ETHTOOL_GSSET_INFO or, for the old kernels, ETHTOOL_GDRVINFO.  */
+
+static int
+netqueue_nstats (struct netqueue *nq, uint32_t *nstats)
+{
+  struct
+  {
+    struct ethtool_sset_info hdr;
+    uint32_t buf[1];
+  } sset_info;
+  struct ethtool_drvinfo drvinfo;
+
+  memset (&sset_info, 0, sizeof (sset_info));
+  sset_info.hdr.cmd = ETHTOOL_GSSET_INFO;
+  sset_info.hdr.sset_mask = 1ULL << ETH_SS_STATS;
+  if (netqueue_ioctl (nq, &sset_info) == 0)
+    {
+      *nstats = sset_info.hdr.sset_mask ? sset_info.hdr.data[0] : 0;
+      return 0;
+    }
+
+  memset (&drvinfo, 0, sizeof (drvinfo));
+  drvinfo.cmd = ETHTOOL_GDRVINFO;
+  if (netqueue_ioctl (nq, &drvinfo) < 0)
+    return -1;
+
+  *nstats = drvinfo.n_stats;
+  return 0;
+}
+
+/* Fetch the names of the ethtool statistics and build the map from the
+   index of each statistic to the queue counter.  */
+
+static int
+netqueue_map (struct netqueue *nq)
+{
+  struct ethtool_gstrings *strings;
+  unsigned int queue;
+  int counter;
+
+  strings = xmalloc (sizeof (struct ethtool_gstrings)
+		     + (size_t) nq->nstats * ETH_GSTRING_LEN);
+  strings->cmd = ETHTOOL_GSTRINGS;
+  strings->string_set = ETH_SS_STATS;
+  strings->len = nq->nstats;
+  if (netqueue_ioctl (nq, strings) < 0)
+    {
+      free (strings);
+      return -1;
+    }
+
+  /* the statistics may have been changed in the meantime */
+  if (strings->len < nq->nstats)
+    nq->nstats = strings->len;
+
+  nq->map = xnmalloc (nq->nstats, sizeof (int));
+  for (uint32_t i = 0; i < nq->nstats; i++)
+    {
+      char name[ETH_GSTRING_LEN + 1];
+
+      memcpy (name, strings->data + (size_t) i * ETH_GSTRING_LEN,
+	      ETH_GSTRING_LEN);
+      name[ETH_GSTRING_LEN] = '\0';
+
+      nq->map[i] = -1;
+      if ((counter = netqueue_parse_stat (name, &queue)) < 0)
+	continue;
+
+      dbg ("%s: statistic %u \"%s\" is %s of queue %u\n", nq->ifname, i,
+	   name, netqueue_counter_names[counter], queue);
+      nq->map[i] = queue * NETQUEUE_COUNTERS + counter;
+      nq->counters |= 1U << counter;
+      if (queue >= nq->nqueues)
+	nq->nqueues = queue + 1;
+    }
+
+  free (strings);
+  return 0;
+}
+
+struct netqueue *
+netqueue_open (const char *ifname)
+{
+  struct netqueue *nq = xmalloc (sizeof (struct netqueue));
+  int saved_errno;
+
+  STRNCPY_TERMINATED (nq->ifname, ifname, sizeof (nq->ifname));
+  netqueue_sysfs_count (ifname, &nq->rx_queues, &nq->tx_queues);
+
+  if ((nq->fd = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0)
+    goto error;
+  if (netqueue_nstats (nq, &nq->nstats) < 0 || netqueue_map (nq) < 0)
+    goto error;
+  if (nq->counters == 0)
+    {
+      dbg ("%s: no per-queue statistics in the %u ethtool ones\n", ifname,
+	   nq->nstats);
+      errno = EOPNOTSUPP;
+      goto error;
+    }
+
+  if (nq->nqueues < nq->rx_queues)
+    nq->nqueues = nq->rx_queues;
+  if (nq->nqueues < nq->tx_queues)
+    nq->nqueues = nq->tx_queues;
+  dbg ("%s: %u rx and %u tx queues, statistics for %u queues\n", ifname,
+       nq->rx_queues, nq->tx_queues, nq->nqueues);
+
+  nq->stats = xmalloc (sizeof (struct ethtool_stats)
+		       + (size_t) nq->nstats * sizeof (uint64_t));
+  return nq;
+
+error:
+  saved_errno = errno;
+  netqueue_free (nq);
+  errno = saved_errno;
+  return NULL;
+}
+
+int
+netqueue_read (struct netqueue *nq, unsigned long long *counters)
+{
+  memset (counters, 0,
+	  (size_t) nq->nqueues * NETQUEUE_COUNTERS
+	  * sizeof (unsigned long long));
+
+  nq->stats->cmd = ETHTOOL_GSTATS;
+  nq->stats->n_stats = nq->nstats;
+  if (netqueue_ioctl (nq, nq->stats) < 0)
+    return -1;
+
+  for (uint32_t i = 0; i < nq->nstats && i < nq->stats->n_stats; i++)
+    if (nq->map[i] >= 0)
+      counters[nq->map[i]] = nq->stats->data[i];
+
+  return 0;
+}
+
+void
+netqueue_free (struct netqueue *nq)
+{
+  if (NULL == nq)
+    return;
+
+  if (nq->fd >= 0)
+    close (nq->fd);
+  free (nq->map);
+  free (nq->stats);
+  free (nq);
+}
@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * The public interface of the libnpl shared library.
+ *
+ * The entry points of libnpl only call the readers that report their
+ * failures with a return value, and never the ones that terminate the
+ * plugins with plugin_error().
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpustats.h"
+#include "files.h"
+#include "meminfo.h"
+#include "npl.h"
+#include "vminfo.h"
+
+/* the flags of files_filecount() are part of the public interface */
+#define SAME_FLAG(flag)  ((int) NPL_ ## flag == (int) flag)
+_Static_assert (SAME_FLAG (FILES_DIRECTORIES_ONLY)
+		&& SAME_FLAG (FILES_IGNORE_SYMLINKS)
+		&& SAME_FLAG (FILES_IGNORE_UNKNOWN)
+		&& SAME_FLAG (FILES_INCLUDE_HIDDEN)
+		&& SAME_FLAG (FILES_RECURSIVE)
+		&& SAME_FLAG (FILES_REGULAR_ONLY),
+		"the libnpl and files.h flags differ");
+#undef SAME_FLAG
+_Static_assert (sizeof (struct npl_filecount) == sizeof (struct files_types),
+		"the libnpl and files.h counters differ");
+
+static __thread char last_error[320];
+
+/* Save the description of a failure, made of the printf-style FORMAT and
+   the description of ERRNUM, and return the negative value of ERRNUM, or
+   -EIO if the failure is not related to a system error.  */
+
+static int _attribute_format_printf_ (2, 3)
+npl_set_error (int errnum, const char *format, ...)
+{
+  va_list args;
+  int len;
+
+  va_start (args, format);
+  len = vsnprintf (last_error, sizeof last_error, format, args);
+  va_end (args);
+
+  if (errnum)
+    {
+      char buf[64];
+      if (len >= 0 && (size_t) len < sizeof last_error)
+	snprintf (last_error + len, sizeof last_error - len, " (%s)",
+		  strerror_r (errnum, buf, sizeof buf));
+      return -errnum;
+    }
+
+  return -EIO;
+}
+
+const char *
+npl_version (void)
+{
+  return PACKAGE_VERSION;
+}
+
+const char *
+npl_last_error (void)
+{
+  return last_error;
+}
+
+/* System memory */
+
+int
+npl_sysmem_new (struct proc_sysmem **sysmem)
+{
+  int err;
+
+  last_error[0] = '\0';
+  if ((err = proc_sysmem_new (sysmem)) < 0)
+    return npl_set_error (-err, "cannot allocate the memory context");
+  return 0;
+}
+
+int
+npl_sysmem_read (struct proc_sysmem *sysmem)
+{
+  int err;
+
+  last_error[0] = '\0';
+  if (NULL == sysmem)
+    return npl_set_error (EINVAL, "no memory context");
+
+  if ((err = proc_sysmem_read (sysmem)) < 0)
+    return npl_set_error (-err, "cannot read %s", get_path_proc_meminfo ());
+  return 0;
+}
+
+unsigned long
+npl_sysmem_get (struct proc_sysmem *sysmem, enum npl_sysmem_item item)
+{
+  switch (item)
+    {
+    default:
+      return 0;
+    case NPL_SYSMEM_ACTIVE:
+      return proc_sysmem_get_active (sysmem);
+    case NPL_SYSMEM_ANON_PAGES:
+      return proc_sysmem_get_anon_pages (sysmem);
+    case NPL_SYSMEM_COMMITTED_AS:
+      return proc_sysmem_get_committed_as (sysmem);
+    case NPL_SYSMEM_DIRTY:
+      return proc_sysmem_get_dirty (sysmem);
+    case NPL_SYSMEM_INACTIVE:
+      return proc_sysmem_get_inactive (sysmem);
+    case NPL_SYSMEM_MAIN_AVAILABLE:
+      return proc_sysmem_get_main_available (sysmem);
+    case NPL_SYSMEM_MAIN_BUFFERS:
+      return proc_sysmem_get_main_buffers (sysmem);
+    case NPL_SYSMEM_MAIN_CACHED:
+      return proc_sysmem_get_main_cached (sysmem);
+    case NPL_SYSMEM_MAIN_FREE:
+      return proc_sysmem_get_main_free (sysmem);
+    case NPL_SYSMEM_MAIN_SHARED:
+      return proc_sysmem_get_main_shared (sysmem);
+    case NPL_SYSMEM_MAIN_TOTAL:
+      return proc_sysmem_get_main_total (sysmem);
+    case NPL_SYSMEM_MAIN_USED:
+      return proc_sysmem_get_main_used (sysmem);
+    case NPL_SYSMEM_SWAP_CACHED:
+      return proc_sysmem_get_swap_cached (sysmem);
+    case NPL_SYSMEM_SWAP_FREE:
+      return proc_sysmem_get_swap_free (sysmem);
+    case NPL_SYSMEM_SWAP_TOTAL:
+      return proc_sysmem_get_swap_total (sysmem);
+    case NPL_SYSMEM_SWAP_USED:
+      return proc_sysmem_get_swap_used (sysmem);
+    }
+}
+
+void
+npl_sysmem_unref (struct proc_sysmem *sysmem)
+{
+  proc_sysmem_unref (sysmem);
+}
+
+/* Virtual memory */
+
+int
+npl_vmem_new (struct proc_vmem **vmem)
+{
+  int err;
+
+  last_error[0] = '\0';
+  if ((err = proc_vmem_new (vmem)) < 0)
+    return npl_set_error (-err, "cannot allocate the vmem context");
+  return 0;
+}
+
+int
+npl_vmem_read (struct proc_vmem *vmem)
+{
+  int err;
+
+  last_error[0] = '\0';
+  if (NULL == vmem)
+    return npl_set_error (EINVAL, "no vmem context");
+
+  if ((err = proc_vmem_read (vmem)) < 0)
+    return npl_set_error (-err, "cannot read %s", get_path_proc_vmstat ());
+  return 0;
+}
+
+unsigned long
+npl_vmem_get (struct proc_vmem *vmem, enum npl_vmem_item item)
+{
+  switch (item)
+    {
+    default:
+      return 0;
+    case NPL_VMEM_PGALLOC:
+      return proc_vmem_get_pgalloc (vmem);
+    case NPL_VMEM_PGFAULT:
+      return proc_vmem_get_pgfault (vmem);
+    case NPL_VMEM_PGFREE:
+      return proc_vmem_get_pgfree (vmem);
+    case NPL_VMEM_PGMAJFAULT:
+      return proc_vmem_get_pgmajfault (vmem);
+    case NPL_VMEM_PGPGIN:
+      return proc_vmem_get_pgpgin (vmem);
+    case NPL_VMEM_PGPGOUT:
+      return proc_vmem_get_pgpgout (vmem);
+    case NPL_VMEM_PGREFILL:
+      return proc_vmem_get_pgrefill (vmem);
+    case NPL_VMEM_PGSCAN:
+      return proc_vmem_get_pgscan (vmem);
+    case NPL_VMEM_PGSCAND:
+      return proc_vmem_get_pgscand (vmem);
+    case NPL_VMEM_PGSCANK:
+      return proc_vmem_get_pgscank (vmem);
+    case NPL_VMEM_PGSTEAL:
+      return proc_vmem_get_pgsteal (vmem);
+    case NPL_VMEM_PSWPIN:
+      return proc_vmem_get_pswpin (vmem);
+    case NPL_VMEM_PSWPOUT:
+      return proc_vmem_get_pswpout (vmem);
+    }
+}
+
+void
+npl_vmem_unref (struct proc_vmem *vmem)
+{
+  proc_vmem_unref (vmem);
+}
+
+/* CPU */
+
+int
+npl_cpu_time_read (struct npl_cpu_time *cputime)
+{
+  struct cpu_time ct;
+
+  last_error[0] = '\0';
+  if (cpu_stats_read_time (&ct, 1) < 0)
+    return npl_set_error (errno, "cannot read the cpu times in %s",
+			  get_path_proc_stat ());
+  free ((char *) ct.cpuname);
+
+  cputime->user = ct.user;
+  cputime->nice = ct.nice;
+  cputime->system = ct.system;
+  cputime->idle = ct.idle;
+  cputime->iowait = ct.iowait;
+  cputime->irq = ct.irq;
+  cputime->softirq = ct.softirq;
+  cputime->steal = ct.steal;
+  cputime->guest = ct.guest;
+  cputime->guestn = ct.guestn;
+
+  return 0;
+}
+
+int
+npl_cpu_counters_read (struct npl_cpu_counters *counters)
+{
+  last_error[0] = '\0';
+  if (cpu_stats_read_value ("ctxt ", &counters->cswch) < 0
+      || cpu_stats_read_value ("intr ", &counters->intr) < 0)
+    return npl_set_error (errno, "cannot read the cpu counters in %s",
+			  get_path_proc_stat ());
+  /* not separated out until the 2.6.0-test4 */
+  if (cpu_stats_read_value ("softirq ", &counters->softirq) < 0
+      && errno != ENODATA)
+    return npl_set_error (errno, "cannot read the cpu counters in %s",
+			  get_path_proc_stat ());
+  return 0;
+}
+
+/* File counting */
+
+int
+npl_filecount (const char *dir, unsigned int flags,
+	       int64_t age, int64_t size, const char *pattern,
+	       struct npl_filecount *count)
+{
+  struct files_types *filecount = NULL;
+
+  last_error[0] = '\0';
+  if (files_filecount (dir, flags, age, size, pattern, &filecount) < 0)
+    {
+      int err = errno;
+      free (filecount);
+      return npl_set_error (err, "cannot read %s", dir);
+    }
+
+  memcpy (count, filecount, sizeof *count);
+  free (filecount);
+  return 0;
+}
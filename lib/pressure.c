@@ -23,10 +23,12 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "instrument.h"
 #include "logging.h"
 #include "messages.h"
 #include "pressure.h"
 #include "string-macros.h"
+#include "sysio.h"
 #include "xalloc.h"
 
 #ifdef NPL_TESTING
@@ -62,10 +64,11 @@ proc_psi_parser (struct proc_psi_oneline *psi_stat,
   ssize_t chread;
   char *line = NULL;
 
-  if ((fp = fopen (procpath, "r")) == NULL)
+  if ((fp = sysio_fopen (procpath)) == NULL)
     plugin_error (STATE_UNKNOWN, errno, "error opening %s", procpath);
 
   dbg ("reading file %s\n", procpath);
+  instrument_phase_push (NPL_PHASE_PARSE);
   while ((chread = getline (&line, &len, fp)) != -1)
     {
       dbg ("line: %s", line);
@@ -89,6 +92,7 @@ proc_psi_parser (struct proc_psi_oneline *psi_stat,
 
   free (line);
   fclose (fp);
+  instrument_phase_pop ();
 
   if (rc < 4)
     plugin_error (STATE_UNKNOWN, errno, "error reading %s", procpath);
@@ -34,12 +34,13 @@
 #include <string.h>
 
 #include "common.h"
+#include "instrument.h"
 #include "logging.h"
 #include "messages.h"
+#include "sysio.h"
 #include "system.h"
 #include "xalloc.h"
 
-#define PROC_ROOT	"/proc"
 #ifndef RLIM_INFINITY
 # define RLIM_INFINITY	65535
 #endif
@@ -53,7 +54,13 @@
 char *
 uid_to_username (uid_t uid)
 {
-  struct passwd *pwd = getpwuid (uid);
+  struct passwd *pwd;
+
+  /* the NSS lookups can be slow (LDAP, NIS, ...) */
+  instrument_phase_push (NPL_PHASE_READ);
+  pwd = getpwuid (uid);
+  instrument_phase_pop ();
+
   return (pwd == NULL) ? "<no-user>" : pwd->pw_name;
 }
 
@@ -173,7 +180,7 @@ procs_list_node_add (uid_t uid, unsigned long inc,
 struct procs_list_node *
 procs_list_getall (unsigned int flags)
 {
-  DIR *dirp;
+  struct sysio_dir *dirp;
   FILE *fp;
   size_t len = 0;
   bool gotname, gotuid, gotthreads,
@@ -187,10 +194,11 @@ procs_list_getall (unsigned int flags)
 #define MAX_LINE   128
   char *cmd = xmalloc (MAX_LINE);
 
-  if ((dirp = opendir (PROC_ROOT)) == NULL)
-    plugin_error (STATE_UNKNOWN, errno, "Cannot open %s", PROC_ROOT);
+  if ((dirp = sysio_opendir (PATH_PROC)) == NULL)
+    plugin_error (STATE_UNKNOWN, errno, "Cannot open %s", PATH_PROC);
 
   procs_list_node_init (&plist);
+  instrument_phase_push (NPL_PHASE_PARSE);
 
   /* Scan entries under /proc directory */
   for (;;)
@@ -199,7 +207,7 @@ procs_list_getall (unsigned int flags)
       ssize_t chread;
       errno = 0;
 
-      if ((dp = readdir (dirp)) == NULL)
+      if ((dp = sysio_readdir (dirp)) == NULL)
 	{
 	  if (errno != 0)
 	    plugin_error (STATE_UNKNOWN, errno, "readdir() failure");
@@ -213,9 +221,9 @@ procs_list_getall (unsigned int flags)
       if (dp->d_type != DT_DIR || !isdigit ((unsigned char) dp->d_name[0]))
 	continue;
 
-      snprintf (path, PATH_MAX, "/proc/%s/status", dp->d_name);
+      snprintf (path, PATH_MAX, PATH_PROC "/%s/status", dp->d_name);
 
-      if ((fp = fopen (path, "r")) == NULL)
+      if ((fp = sysio_fopen (path)) == NULL)
 	continue;		/* Ignore errors: fopen() might fail if
 				   process has just terminated */
 
@@ -264,9 +272,10 @@ procs_list_getall (unsigned int flags)
 		uid_to_username (uid), dp->d_name, threads_nbr, cmd);
     }
 
-  closedir (dirp);
+  sysio_closedir (dirp);
   free (cmd);
   free (line);
+  instrument_phase_pop ();
 
   return plist;
 }
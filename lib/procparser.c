@@ -32,9 +32,10 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "instrument.h"
 #include "string-macros.h"
-#include "messages.h"
 #include "procparser.h"
+#include "sysio.h"
 #include "xalloc.h"
 
 static int
@@ -44,7 +45,7 @@ compare_proc_table_structs (const void *a, const void *b)
 		 ((const proc_table_struct *) b)->name);
 }
 
-void
+int
 procparser (const char *filename, const proc_table_struct *proc_table,
 	    int proc_table_count, char separator)
 {
@@ -60,9 +61,10 @@ procparser (const char *filename, const proc_table_struct *proc_table,
   unsigned long long slotll;
 #endif
 
-  if ((fp = fopen (filename,  "r")) == NULL)
-    plugin_error (STATE_UNKNOWN, errno, "error: cannot read %s", filename);
+  if ((fp = sysio_fopen (filename)) == NULL)
+    return -1;
 
+  instrument_phase_push (NPL_PHASE_PARSE);
   while ((chread = getline (&line, &len, fp)) != -1)
     {
       char *head = line;
@@ -93,6 +95,9 @@ procparser (const char *filename, const proc_table_struct *proc_table,
     }
 
   free (line);
+  fclose (fp);
+  instrument_phase_pop ();
+  return 0;
 }
 
 int
@@ -23,6 +23,7 @@
 #include <string.h>
 
 #include "common.h"
+#include "instrument.h"
 #include "messages.h"
 
 /* String containing name the program is called with.
@@ -52,4 +53,6 @@ set_program_name (const char *argv0)
 
   underscore = strchr (program_name, '_');
   program_name_short = (underscore != NULL ? underscore + 1 : program_name);
+
+  instrument_init ();
 }
@@ -0,0 +1,386 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A cache of the plugin results, for the monitoring setups where several
+ * pollers run the same checks on a host within a few seconds.
+ *
+ * The result of a plugin execution (its standard output and exit status)
+ * is stored in a file named after the plugin, the user, and a hash of the
+ * canonicalized command line.  The file is written under a temporary name
+ * and renamed when complete, so that a concurrent execution never sees a
+ * partial result.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "getenv.h"
+#include "logging.h"
+#include "progname.h"
+#include "result_cache.h"
+#include "string-macros.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+
+#define CACHE_DIR_DEFAULT	"/dev/shm/npl-cache-%u"
+#define CACHE_MAGIC		"NPLC"
+/* "NPLC <status> <key length>\n" */
+#define CACHE_HEADER_FMT	CACHE_MAGIC " %3d %08zx\n"
+#define CACHE_HEADER_SIZE	18
+
+/* The environment variables that change the output of the plugins */
+static const char *const cache_key_env[] = {
+  "NPL_OUTPUT", "NPL_PROC_ROOT", "NPL_REPLAY", "NPL_SYS_ROOT", NULL
+};
+
+struct result_cache
+{
+  char *path;			/* the cached result */
+  char *tmppath;		/* the result being written */
+  char *key;			/* the canonicalized command line */
+  size_t keylen;
+  int fd;			/* the file descriptor of tmppath */
+  int outfd;			/* the captured file descriptor */
+  int savedfd;			/* the original OUTFD */
+};
+
+/* Build the key of the cache: the user, the plugin name, the arguments,
+   and the environment variables affecting the output, separated by NUL
+   bytes.  The long options "--name=value" are split in two arguments, as
+   getopt_long() accepts both the forms.  */
+
+static char *
+result_cache_key (uid_t uid, const char *name, int argc, char **argv,
+		  size_t *keylen)
+{
+  char *key, *p, uidstr[16];
+  const char *env[sizeof (cache_key_env) / sizeof (cache_key_env[0])];
+  size_t len;
+  int i;
+
+  len = snprintf (uidstr, sizeof uidstr, "%u", (unsigned int) uid) + 1;
+  len += strlen (name) + 1;
+  for (i = 1; i < argc; i++)
+    len += strlen (argv[i]) + 1;
+  for (i = 0; cache_key_env[i]; i++)
+    {
+      env[i] = secure_getenv (cache_key_env[i]);
+      len += strlen (cache_key_env[i]) + 1 + (env[i] ? strlen (env[i]) : 0)
+	+ 1;
+    }
+
+  p = key = xmalloc (len);
+  p = stpcpy (p, uidstr) + 1;
+  p = stpcpy (p, name) + 1;
+  for (i = 1; i < argc; i++)
+    {
+      char *arg = p, *eq;
+
+      p = stpcpy (p, argv[i]) + 1;
+      if (STRPREFIX (arg, "--") && (eq = strchr (arg, '=')))
+	*eq = '\0';
+    }
+  for (i = 0; cache_key_env[i]; i++)
+    {
+      p = stpcpy (p, cache_key_env[i]);
+      *p++ = '=';
+      p = stpcpy (p, env[i] ? env[i] : "") + 1;
+    }
+
+  *keylen = len;
+  return key;
+}
+
+/* 64-bit FNV-1a hash */
+
+static uint64_t
+result_cache_hash (const char *key, size_t keylen)
+{
+  uint64_t hash = UINT64_C (14695981039346656037);
+  size_t i;
+
+  for (i = 0; i < keylen; i++)
+    {
+      hash ^= (unsigned char) key[i];
+      hash *= UINT64_C (1099511628211);
+    }
+
+  return hash;
+}
+
+/* Create the cache directory DIR if needed, and make sure that it is a
+   directory owned by UID and not accessible by the other users.  */
+
+static bool
+result_cache_dir_ok (const char *dir, uid_t uid)
+{
+  struct stat st;
+
+  if (mkdir (dir, 0700) < 0 && errno != EEXIST)
+    {
+      dbg ("cannot create the cache directory %s: %s\n", dir,
+	   strerror (errno));
+      return false;
+    }
+  if (lstat (dir, &st) < 0)
+    return false;
+  if (!S_ISDIR (st.st_mode) || st.st_uid != uid
+      || (st.st_mode & (S_IRWXG | S_IRWXO)))
+    {
+      dbg ("the cache directory %s is not private, ignoring it\n", dir);
+      return false;
+    }
+
+  return true;
+}
+
+static bool
+write_all (int fd, const char *buf, size_t len)
+{
+  while (len > 0)
+    {
+      ssize_t n = write (fd, buf, len);
+      if (n < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return false;
+	}
+      buf += n;
+      len -= n;
+    }
+  return true;
+}
+
+/* Copy the content of the file FD, starting at OFFSET, to OUTFD.  */
+
+static bool
+copy_from (int fd, off_t offset, int outfd)
+{
+  char buf[4096];
+  ssize_t n;
+
+  while ((n = pread (fd, buf, sizeof buf, offset)) != 0)
+    {
+      if (n < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return false;
+	}
+      if (!write_all (outfd, buf, n))
+	return false;
+      offset += n;
+    }
+  return true;
+}
+
+/* Copy the result stored in PATH to OUTFD if it is not older than TTL
+   seconds and has been saved for the given KEY.  Return the exit status
+   of the plugin, or -1 if there is no valid result.  */
+
+static int
+result_cache_lookup (const char *path, const char *key, size_t keylen,
+		     long ttl, uid_t uid, int outfd)
+{
+  char header[CACHE_HEADER_SIZE + 1], *cached_key = NULL, *end;
+  struct timespec now;
+  struct stat st;
+  int fd, status = -1;
+  long value;
+
+  if ((fd = open (path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC)) < 0)
+    return -1;
+  if (fstat (fd, &st) < 0 || st.st_uid != uid)
+    goto out;
+
+  clock_gettime (CLOCK_REALTIME, &now);
+  if (st.st_mtim.tv_sec > now.tv_sec || now.tv_sec - st.st_mtim.tv_sec >= ttl)
+    {
+      dbg ("the cached result %s has expired\n", path);
+      goto out;
+    }
+
+  if (pread (fd, header, CACHE_HEADER_SIZE, 0) != CACHE_HEADER_SIZE
+      || !STRPREFIX (header, CACHE_MAGIC " "))
+    goto out;
+  header[CACHE_HEADER_SIZE] = '\0';
+
+  value = strtol (header + sizeof (CACHE_MAGIC), &end, 10);
+  if (value < STATE_OK || value > STATE_CRITICAL
+      || strtoul (end, NULL, 16) != keylen)
+    goto out;
+
+  cached_key = xmalloc (keylen);
+  if (pread (fd, cached_key, keylen, CACHE_HEADER_SIZE) != (ssize_t) keylen
+      || memcmp (cached_key, key, keylen) != 0)
+    goto out;
+
+  if (copy_from (fd, CACHE_HEADER_SIZE + keylen, outfd))
+    status = value;
+
+out:
+  free (cached_key);
+  close (fd);
+  return status;
+}
+
+/* Redirect OUTFD to a new temporary file in the directory of CACHE->PATH,
+   where the result of the plugin is stored.  */
+
+static bool
+result_cache_capture (struct result_cache *cache, int outfd)
+{
+  char header[CACHE_HEADER_SIZE + 1];
+
+  cache->tmppath = xasprintf ("%s.XXXXXX", cache->path);
+  if ((cache->fd = mkostemp (cache->tmppath, O_CLOEXEC)) < 0)
+    return false;
+
+  snprintf (header, sizeof header, CACHE_HEADER_FMT, 0, cache->keylen);
+  if (!write_all (cache->fd, header, CACHE_HEADER_SIZE)
+      || !write_all (cache->fd, cache->key, cache->keylen)
+      || (cache->savedfd = fcntl (outfd, F_DUPFD_CLOEXEC, 0)) < 0)
+    goto error;
+
+  if (outfd == STDOUT_FILENO)
+    fflush (stdout);
+  if (dup2 (cache->fd, outfd) < 0)
+    {
+      close (cache->savedfd);
+      goto error;
+    }
+  cache->outfd = outfd;
+  return true;
+
+error:
+  unlink (cache->tmppath);
+  close (cache->fd);
+  return false;
+}
+
+/* Restore the captured file descriptor and copy the output of the plugin
+   to it.  Keep the result if the plugin exited with STATUS OK, WARNING,
+   or CRITICAL: the other exit statuses signal usage or system errors that
+   might be transient.  */
+
+static void
+result_cache_commit (struct result_cache *cache, int status)
+{
+  char header[CACHE_HEADER_SIZE + 1];
+  bool keep = (status >= STATE_OK && status <= STATE_CRITICAL);
+
+  if (cache->outfd == STDOUT_FILENO)
+    fflush (stdout);
+  dup2 (cache->savedfd, cache->outfd);
+  close (cache->savedfd);
+
+  snprintf (header, sizeof header, CACHE_HEADER_FMT, status, cache->keylen);
+  if (pwrite (cache->fd, header, CACHE_HEADER_SIZE, 0) != CACHE_HEADER_SIZE)
+    keep = false;
+  if (!copy_from (cache->fd, CACHE_HEADER_SIZE + cache->keylen, cache->outfd))
+    keep = false;
+  close (cache->fd);
+
+  if (!keep || rename (cache->tmppath, cache->path) < 0)
+    unlink (cache->tmppath);
+}
+
+#if !defined NPL_TESTING && defined HAVE_ON_EXIT
+
+static struct result_cache result_cache;
+
+static void
+result_cache_on_exit (int status, void *arg)
+{
+  result_cache_commit (arg, status);
+}
+
+void
+result_cache_init (int argc, char **argv)
+{
+  const char *value = secure_getenv (NPL_CACHE_TTL_ENV), *dir;
+  char *cachedir = NULL, *end;
+  uid_t uid = geteuid ();
+  long ttl;
+  int status;
+
+  if (value == NULL || *value == '\0')
+    return;
+  errno = 0;
+  ttl = strtol (value, &end, 10);
+  if (errno || *end != '\0' || ttl <= 0)
+    {
+      dbg ("ignoring the invalid cache TTL \"%s\"\n", value);
+      return;
+    }
+
+  if ((dir = secure_getenv (NPL_CACHE_DIR_ENV)) == NULL || *dir == '\0')
+    dir = cachedir = xasprintf (CACHE_DIR_DEFAULT, (unsigned int) uid);
+  if (!result_cache_dir_ok (dir, uid))
+    {
+      free (cachedir);
+      return;
+    }
+
+  result_cache.key =
+    result_cache_key (uid, program_name, argc, argv, &result_cache.keylen);
+  result_cache.path =
+    xasprintf ("%s/%s-%u-%016llx", dir, program_name, (unsigned int) uid,
+	       (unsigned long long) result_cache_hash (result_cache.key,
+						       result_cache.keylen));
+  free (cachedir);
+
+  status = result_cache_lookup (result_cache.path, result_cache.key,
+				result_cache.keylen, ttl, uid,
+				STDOUT_FILENO);
+  if (status >= 0)
+    exit (status);
+
+  /* the exit handlers registered before, like the instrumentation report,
+     run after the output is restored and are not cached */
+  if (result_cache_capture (&result_cache, STDOUT_FILENO))
+    on_exit (result_cache_on_exit, &result_cache);
+}
+
+#elif !defined NPL_TESTING
+
+void
+result_cache_init (int argc, char **argv)
+{
+  (void) argc;
+  (void) argv;
+
+  if (secure_getenv (NPL_CACHE_TTL_ENV))
+    dbg ("the result cache requires on_exit(), that is not available\n");
+}
+
+#endif		/* NPL_TESTING */
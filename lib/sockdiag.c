@@ -0,0 +1,367 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for dumping and counting the sockets with NETLINK_SOCK_DIAG
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#if HAVE_NETINET_IN_H
+# include <netinet/in.h>
+#endif
+#include <linux/netlink.h>
+#if defined (HAVE_LINUX_INET_DIAG_H) && defined (HAVE_LINUX_SOCK_DIAG_H)
+# include <linux/rtnetlink.h>
+# include <linux/inet_diag.h>
+# include <linux/sock_diag.h>
+#endif
+#if HAVE_LINUX_UNIX_DIAG_H
+# include <linux/unix_diag.h>
+#endif
+
+#include "instrument.h"
+#include "logging.h"
+#include "sockdiag.h"
+
+static const char *sock_kind_names[SOCK_KINDS] = {
+  [SOCK_KIND_UDP] = "udp",
+  [SOCK_KIND_UDP6] = "udp6",
+  [SOCK_KIND_RAW] = "raw",
+  [SOCK_KIND_RAW6] = "raw6",
+  [SOCK_KIND_UNIX_STREAM] = "unix_stream",
+  [SOCK_KIND_UNIX_DGRAM] = "unix_dgram",
+  [SOCK_KIND_UNIX_SEQPACKET] = "unix_seqpacket"
+};
+
+const char *
+sock_kind_name (enum sock_kind kind)
+{
+  return (kind < SOCK_KINDS) ? sock_kind_names[kind] : NULL;
+}
+
+#define NETLINK_REPLY_BUFFER	32768
+
+/* Read the replies to a dump request until NLMSG_DONE.  The buffer is
+   large enough for the replies of the kernel, that fit a page each.  */
+
+int
+netlink_dump (int fd, const void *request, size_t len, netlink_dump_fn fn,
+	      void *data)
+{
+  char reply[NETLINK_REPLY_BUFFER];
+  bool done = false;
+
+  if (send (fd, request, len, 0) < 0)
+    return -1;
+
+  while (!done)
+    {
+      struct nlmsghdr *h;
+      ssize_t nread;
+
+      instrument_phase_push (NPL_PHASE_READ);
+      nread = recv (fd, reply, sizeof (reply), 0);
+      instrument_phase_pop ();
+      instrument_count_io (1, nread > 0 ? nread : 0);
+      if (nread < 0 && errno == EINTR)
+	continue;
+      if (nread <= 0)
+	return -1;
+
+      for (h = (struct nlmsghdr *) reply; NLMSG_OK (h, nread);
+	   h = NLMSG_NEXT (h, nread))
+	{
+	  if (h->nlmsg_type == NLMSG_DONE)
+	    {
+	      done = true;
+	      break;
+	    }
+	  if (h->nlmsg_type == NLMSG_ERROR)
+	    {
+	      struct nlmsgerr *err = NLMSG_DATA (h);
+	      errno = -err->error;
+	      return -1;
+	    }
+	  if (h->nlmsg_type >= NLMSG_MIN_TYPE)
+	    fn (h, data);
+	}
+    }
+
+  return 0;
+}
+
+#undef NETLINK_REPLY_BUFFER
+
+#if defined (HAVE_LINUX_INET_DIAG_H) && defined (HAVE_LINUX_SOCK_DIAG_H)
+
+#define INET_DIAG_BYTECODE_MAX	256
+#define SOCK_STATE_LISTEN	10
+
+int
+sock_diag_open (void)
+{
+  return socket (AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+}
+
+struct inet_diag_dump_data
+{
+  inet_diag_fn fn;
+  void *data;
+};
+
+/* Index the attributes of an inet_diag_msg by type.  */
+
+static void
+inet_diag_dump_msg (const struct nlmsghdr *h, void *data)
+{
+  struct inet_diag_dump_data *dump = data;
+  const struct inet_diag_msg *msg = NLMSG_DATA (h);
+  struct rtattr *attrs[INET_DIAG_MAX + 1], *rta;
+  int attrlen = h->nlmsg_len - NLMSG_LENGTH (sizeof (*msg));
+
+  memset (attrs, 0, sizeof (attrs));
+  for (rta = (struct rtattr *) (msg + 1); RTA_OK (rta, attrlen);
+       rta = RTA_NEXT (rta, attrlen))
+    if (rta->rta_type <= INET_DIAG_MAX)
+      attrs[rta->rta_type] = rta;
+
+  dump->fn (msg, attrs, dump->data);
+}
+
+int
+inet_diag_dump (int fd, int family, int protocol, unsigned int states,
+		unsigned char ext, const void *bytecode, size_t bclen,
+		inet_diag_fn fn, void *data)
+{
+  struct
+  {
+    struct nlmsghdr nlh;
+    struct inet_diag_req_v2 req;
+    struct rtattr rta;
+    unsigned char bytecode[INET_DIAG_BYTECODE_MAX];
+  } request;
+  struct inet_diag_dump_data dump = { fn, data };
+
+  if (bclen > INET_DIAG_BYTECODE_MAX)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  memset (&request, 0, sizeof (request));
+  request.nlh.nlmsg_len = NLMSG_LENGTH (sizeof (request.req));
+  request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+  request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.nlh.nlmsg_seq = family;
+  request.req.sdiag_family = family;
+  request.req.sdiag_protocol = protocol;
+  request.req.idiag_states = states;
+  request.req.idiag_ext = ext;
+  /* the raw sockets are selected by their protocol too, IPPROTO_RAW
+     matching all of them (since Linux 4.17) */
+  if (protocol == IPPROTO_RAW)
+    request.req.pad = IPPROTO_RAW;
+  if (bclen > 0)
+    {
+      request.rta.rta_type = INET_DIAG_REQ_BYTECODE;
+      request.rta.rta_len = RTA_LENGTH (bclen);
+      memcpy (request.bytecode, bytecode, bclen);
+      request.nlh.nlmsg_len += RTA_SPACE (bclen);
+    }
+
+  return netlink_dump (fd, &request, request.nlh.nlmsg_len,
+			 inet_diag_dump_msg, &dump);
+}
+
+/* Account a socket in STATE with RQUEUE bytes to be read to COUNT.  */
+
+static void
+sock_count_add (struct sock_count *count, unsigned int state,
+		unsigned long long rqueue)
+{
+  count->sockets++;
+  if (state < SOCK_NSTATES)
+    count->state[state]++;
+  /* the receive queue of a listening socket holds its pending
+     connections */
+  if (state == SOCK_STATE_LISTEN || rqueue == 0)
+    return;
+
+  count->queued++;
+  count->rqueue += rqueue;
+  if (rqueue > count->max_rqueue)
+    count->max_rqueue = rqueue;
+}
+
+static void
+sock_count_inet (const struct inet_diag_msg *msg, struct rtattr *attrs[],
+		 void *data)
+{
+  (void) attrs;
+  sock_count_add (data, msg->idiag_state, msg->idiag_rqueue);
+}
+
+static int
+sock_count_inet_read (int fd, int family, int protocol,
+		      struct sock_count *count)
+{
+  return inet_diag_dump (fd, family, protocol, ~0U, 0, NULL, 0,
+			 sock_count_inet, count);
+}
+
+#if HAVE_LINUX_UNIX_DIAG_H
+
+static void
+sock_count_unix (const struct nlmsghdr *h, void *data)
+{
+  struct sock_count *count = data;
+  const struct unix_diag_msg *msg = NLMSG_DATA (h);
+  int attrlen = h->nlmsg_len - NLMSG_LENGTH (sizeof (*msg));
+  unsigned long long rqueue = 0;
+  struct rtattr *rta;
+
+  for (rta = (struct rtattr *) (msg + 1); RTA_OK (rta, attrlen);
+       rta = RTA_NEXT (rta, attrlen))
+    if (rta->rta_type == UNIX_DIAG_RQLEN
+	&& RTA_PAYLOAD (rta) >= sizeof (struct unix_diag_rqlen))
+      rqueue = ((struct unix_diag_rqlen *) RTA_DATA (rta))->udiag_rqueue;
+
+  switch (msg->udiag_type)
+    {
+    case SOCK_STREAM:
+      sock_count_add (&count[SOCK_KIND_UNIX_STREAM], msg->udiag_state,
+		      rqueue);
+      break;
+    case SOCK_DGRAM:
+      sock_count_add (&count[SOCK_KIND_UNIX_DGRAM], msg->udiag_state,
+		      rqueue);
+      break;
+    case SOCK_SEQPACKET:
+      sock_count_add (&count[SOCK_KIND_UNIX_SEQPACKET], msg->udiag_state,
+		      rqueue);
+      break;
+    }
+}
+
+/* A single dump returns the UNIX sockets of all the types.  */
+
+static int
+sock_count_unix_read (int fd, struct sock_count *count)
+{
+  struct
+  {
+    struct nlmsghdr nlh;
+    struct unix_diag_req req;
+  } request;
+
+  memset (&request, 0, sizeof (request));
+  request.nlh.nlmsg_len = sizeof (request);
+  request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+  request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.nlh.nlmsg_seq = AF_UNIX;
+  request.req.sdiag_family = AF_UNIX;
+  request.req.udiag_states = ~0U;
+  request.req.udiag_show = UDIAG_SHOW_RQLEN;
+
+  return netlink_dump (fd, &request, sizeof (request), sock_count_unix,
+			 count);
+}
+
+#else
+
+static int
+sock_count_unix_read (int fd, struct sock_count *count)
+{
+  (void) fd;
+  (void) count;
+  errno = ENOSYS;
+  return -1;
+}
+
+#endif
+
+int
+sock_count_read (unsigned int kinds, struct sock_count *count)
+{
+  const struct
+  {
+    enum sock_kind kind;
+    int family, protocol;
+  } inet[] = {
+    { SOCK_KIND_UDP, AF_INET, IPPROTO_UDP },
+    { SOCK_KIND_UDP6, AF_INET6, IPPROTO_UDP },
+    { SOCK_KIND_RAW, AF_INET, IPPROTO_RAW },
+    { SOCK_KIND_RAW6, AF_INET6, IPPROTO_RAW }
+  };
+  int fd, ret = 0;
+
+  memset (count, 0, SOCK_KINDS * sizeof (struct sock_count));
+  if ((fd = sock_diag_open ()) < 0)
+    return -1;
+
+  for (size_t i = 0; i < sizeof (inet) / sizeof (inet[0]) && ret == 0; i++)
+    if (kinds & (1 << inet[i].kind))
+      {
+	dbg ("dumping the %s sockets\n", sock_kind_name (inet[i].kind));
+	ret = sock_count_inet_read (fd, inet[i].family, inet[i].protocol,
+				    &count[inet[i].kind]);
+      }
+  if (ret == 0 && (kinds & SOCK_KIND_UNIX))
+    ret = sock_count_unix_read (fd, count);
+
+  if (ret < 0)
+    {
+      int saved_errno = errno;
+      close (fd);
+      errno = saved_errno;
+      return -1;
+    }
+
+  close (fd);
+  return 0;
+}
+
+#undef INET_DIAG_BYTECODE_MAX
+#undef SOCK_STATE_LISTEN
+
+#else
+
+int
+sock_diag_open (void)
+{
+  errno = ENOSYS;
+  return -1;
+}
+
+int
+sock_count_read (unsigned int kinds, struct sock_count *count)
+{
+  (void) kinds;
+  memset (count, 0, SOCK_KINDS * sizeof (struct sock_count));
+  errno = ENOSYS;
+  return -1;
+}
+
+#endif
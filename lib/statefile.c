@@ -0,0 +1,471 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A library for saving the counters sampled by a plugin, so that the next
+ * execution can compute their rates without sampling them twice.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "getenv.h"
+#include "logging.h"
+#include "progname.h"
+#include "statefile.h"
+#include "sysio.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+
+#define STATE_DIR_DEFAULT	"/dev/shm/npl-state-%u"
+#define STATE_MAGIC		"NPLSTAT1"
+#define PATH_PROC_BOOT_ID	PATH_PROC "/sys/kernel/random/boot_id"
+
+/* The file starts with this header, in the host byte order, followed by
+   NENTRIES entries made of the key length (uint32_t), the key (not NUL
+   terminated), and NVALUES uint64_t values.  */
+struct statefile_header
+{
+  char magic[8];
+  int64_t time_ns;		/* CLOCK_BOOTTIME, in nanoseconds */
+  uint32_t nvalues;
+  uint32_t nentries;
+  char boot_id[40];
+};
+
+struct statefile_entry
+{
+  const char *key;
+  size_t keylen;
+  unsigned long long *values;
+};
+
+struct statefile
+{
+  char *path;
+  size_t nvalues;
+  char boot_id[40];
+  double elapsed;		/* since the saved samples were taken */
+  char *data;			/* the content of the state file */
+  struct statefile_entry *saved;
+  size_t nsaved;
+  struct statefile_entry *entries;	/* the samples to be saved */
+  size_t nentries, size;
+};
+
+static int64_t
+statefile_now_ns (void)
+{
+  struct timespec ts;
+
+#ifdef CLOCK_BOOTTIME
+  if (clock_gettime (CLOCK_BOOTTIME, &ts) == 0)
+    return ts.tv_sec * INT64_C (1000000000) + ts.tv_nsec;
+#endif
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * INT64_C (1000000000) + ts.tv_nsec;
+}
+
+/* 64-bit FNV-1a hash */
+
+static uint64_t
+statefile_hash (const char *str)
+{
+  uint64_t hash = UINT64_C (14695981039346656037);
+
+  for (; *str; str++)
+    {
+      hash ^= (unsigned char) *str;
+      hash *= UINT64_C (1099511628211);
+    }
+
+  return hash;
+}
+
+/* Create the state directory DIR if needed, and make sure that it is a
+   directory owned by UID and not accessible by the other users.  */
+
+static bool
+statefile_dir_ok (const char *dir, uid_t uid)
+{
+  struct stat st;
+
+  if (mkdir (dir, 0700) < 0 && errno != EEXIST)
+    return false;
+  if (lstat (dir, &st) < 0)
+    return false;
+  if (!S_ISDIR (st.st_mode) || st.st_uid != uid
+      || (st.st_mode & (S_IRWXG | S_IRWXO)))
+    {
+      dbg ("the state directory %s is not private, ignoring it\n", dir);
+      return false;
+    }
+
+  return true;
+}
+
+static int
+statefile_entry_cmp (const void *a, const void *b)
+{
+  const struct statefile_entry *ea = a, *eb = b;
+  int cmp = memcmp (ea->key, eb->key,
+		    ea->keylen < eb->keylen ? ea->keylen : eb->keylen);
+
+  if (cmp)
+    return cmp;
+  return (ea->keylen > eb->keylen) - (ea->keylen < eb->keylen);
+}
+
+/* Read the whole file FD.  */
+
+static char *
+statefile_slurp (int fd, size_t *size)
+{
+  struct stat st;
+  char *data;
+  size_t used = 0;
+  ssize_t n;
+
+  if (fstat (fd, &st) < 0 || st.st_uid != geteuid ()
+      || st.st_size < (off_t) sizeof (struct statefile_header))
+    return NULL;
+
+  data = xmalloc (st.st_size);
+  while (used < (size_t) st.st_size
+	 && (n = read (fd, data + used, st.st_size - used)) != 0)
+    {
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n < 0)
+	{
+	  free (data);
+	  return NULL;
+	}
+      used += n;
+    }
+
+  *size = used;
+  return data;
+}
+
+/* Parse the DATA of a state file, and keep its samples if they have been
+   taken since the last boot.  */
+
+static void
+statefile_load (struct statefile *state, char *data, size_t size)
+{
+  struct statefile_header header;
+  size_t offset = sizeof header, i;
+  int64_t now = statefile_now_ns ();
+
+  memcpy (&header, data, sizeof header);
+  if (memcmp (header.magic, STATE_MAGIC, sizeof header.magic)
+      || header.nvalues != state->nvalues
+      || memcmp (header.boot_id, state->boot_id, sizeof header.boot_id)
+      || header.time_ns >= now
+      /* each entry takes at least its key length and values */
+      || header.nentries > (size - sizeof header)
+			   / (sizeof (uint32_t)
+			      + state->nvalues * sizeof (uint64_t)))
+    {
+      dbg ("discarding the state file %s\n", state->path);
+      free (data);
+      return;
+    }
+
+  state->saved = xnmalloc (header.nentries ? header.nentries : 1,
+			   sizeof (struct statefile_entry));
+  for (i = 0; i < header.nentries; i++)
+    {
+      struct statefile_entry *entry = &state->saved[i];
+      uint32_t keylen;
+
+      if (size - offset < sizeof keylen)
+	break;
+      memcpy (&keylen, data + offset, sizeof keylen);
+      offset += sizeof keylen;
+      if (size - offset < keylen + state->nvalues * sizeof (uint64_t))
+	break;
+
+      entry->key = data + offset;
+      entry->keylen = keylen;
+      offset += keylen;
+      entry->values = xnmalloc (state->nvalues, sizeof (unsigned long long));
+      for (size_t v = 0; v < state->nvalues; v++)
+	{
+	  uint64_t value;
+	  memcpy (&value, data + offset, sizeof value);
+	  entry->values[v] = value;
+	  offset += sizeof value;
+	}
+    }
+
+  if (i < header.nentries)
+    {
+      dbg ("the state file %s is truncated\n", state->path);
+      for (size_t j = 0; j < i; j++)
+	free (state->saved[j].values);
+      free (state->saved);
+      state->saved = NULL;
+      free (data);
+      return;
+    }
+
+  qsort (state->saved, i, sizeof (struct statefile_entry),
+	 statefile_entry_cmp);
+  state->nsaved = i;
+  state->data = data;
+  state->elapsed = (now - header.time_ns) / 1e9;
+}
+
+struct statefile *
+statefile_open (const char *id, size_t nvalues)
+{
+  struct statefile *state = xmalloc (sizeof (struct statefile));
+  const char *dir = secure_getenv (NPL_STATE_DIR_ENV), *name;
+  char *statedir = NULL, *data;
+  uid_t uid = geteuid ();
+  size_t size;
+  int fd;
+
+  state->nvalues = nvalues;
+  /* the content of the file is "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx\n" */
+  if (sysio_read (PATH_PROC_BOOT_ID, state->boot_id,
+		  sizeof state->boot_id) > 0)
+    state->boot_id[strcspn (state->boot_id, "\n")] = '\0';
+  memset (state->boot_id + strlen (state->boot_id), 0,
+	  sizeof state->boot_id - strlen (state->boot_id));
+
+  if (NULL == dir || '\0' == *dir)
+    dir = statedir = xasprintf (STATE_DIR_DEFAULT, (unsigned int) uid);
+  if (!statefile_dir_ok (dir, uid))
+    {
+      free (statedir);
+      return state;
+    }
+
+  name = strrchr (program_name, '/');
+  state->path =
+    xasprintf ("%s/%s-%u-%016llx", dir, name ? name + 1 : program_name,
+	       (unsigned int) uid, (unsigned long long) statefile_hash (id));
+  free (statedir);
+
+  if ((fd = open (state->path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC)) < 0)
+    return state;
+  if ((data = statefile_slurp (fd, &size)))
+    statefile_load (state, data, size);
+  close (fd);
+
+  return state;
+}
+
+double
+statefile_elapsed (const struct statefile *state)
+{
+  return state->elapsed;
+}
+
+const unsigned long long *
+statefile_get (const struct statefile *state, const char *key)
+{
+  struct statefile_entry needle = { key, strlen (key), NULL }, *entry;
+
+  if (0 == state->nsaved)
+    return NULL;
+  entry = bsearch (&needle, state->saved, state->nsaved,
+		   sizeof (struct statefile_entry), statefile_entry_cmp);
+  return entry ? entry->values : NULL;
+}
+
+/* Return true if STATE has a sample at least DELAY seconds old with the
+   values of all the NKEYS KEYS (the NULL ones being skipped).  */
+
+static bool
+statefile_has_sample (const struct statefile *state, unsigned long delay,
+		      const char *const keys[], size_t nkeys)
+{
+  if (state->elapsed <= 0 || state->elapsed < delay)
+    return false;
+  for (size_t i = 0; i < nkeys; i++)
+    if (keys[i] && NULL == statefile_get (state, keys[i]))
+      return false;
+  return true;
+}
+
+double
+statefile_sample (const struct statefile *state, unsigned long delay,
+		  const char *const keys[], size_t nkeys,
+		  void (*resample) (void *data), void *data)
+{
+  if (statefile_has_sample (state, delay, keys, nkeys))
+    return state->elapsed;
+
+  dbg ("no previous sample, sleeping %lu seconds\n", delay);
+  sleep (delay);
+  resample (data);
+  return delay;
+}
+
+bool
+statefile_sample_states (struct statefile *const states[], size_t nstates,
+			 unsigned long delay, const char *key,
+			 double elapsed[], void (*resample) (void *data),
+			 void *data)
+{
+  size_t i;
+
+  for (i = 0; i < nstates; i++)
+    if (!statefile_has_sample (states[i], delay, &key, 1))
+      break;
+
+  if (i == nstates)
+    {
+      for (i = 0; i < nstates; i++)
+	elapsed[i] = states[i]->elapsed;
+      return false;
+    }
+
+  dbg ("no previous sample, sleeping %lu seconds\n", delay);
+  sleep (delay);
+  resample (data);
+  for (i = 0; i < nstates; i++)
+    elapsed[i] = delay;
+  return true;
+}
+
+void
+statefile_put (struct statefile *state, const char *key,
+	       const unsigned long long *values)
+{
+  struct statefile_entry *entry;
+
+  if (state->nentries == state->size)
+    {
+      state->size = state->size ? state->size * 2 : 64;
+      state->entries =
+	xrealloc (state->entries,
+		  state->size * sizeof (struct statefile_entry));
+    }
+
+  entry = &state->entries[state->nentries++];
+  entry->key = xstrdup (key);
+  entry->keylen = strlen (key);
+  entry->values = xnmalloc (state->nvalues, sizeof (unsigned long long));
+  memcpy (entry->values, values,
+	  state->nvalues * sizeof (unsigned long long));
+}
+
+int
+statefile_save (struct statefile *state)
+{
+  struct statefile_header header;
+  char *buf, *p, *tmppath;
+  size_t size, i;
+  ssize_t n;
+  int fd;
+
+  if (NULL == state->path)
+    {
+      errno = ENOENT;
+      return -1;
+    }
+
+  memset (&header, 0, sizeof header);
+  memcpy (header.magic, STATE_MAGIC, sizeof header.magic);
+  header.time_ns = statefile_now_ns ();
+  header.nvalues = state->nvalues;
+  header.nentries = state->nentries;
+  memcpy (header.boot_id, state->boot_id, sizeof header.boot_id);
+
+  size = sizeof header;
+  for (i = 0; i < state->nentries; i++)
+    size += sizeof (uint32_t) + state->entries[i].keylen
+      + state->nvalues * sizeof (uint64_t);
+
+  p = buf = xmalloc (size);
+  p = mempcpy (p, &header, sizeof header);
+  for (i = 0; i < state->nentries; i++)
+    {
+      uint32_t keylen = state->entries[i].keylen;
+
+      p = mempcpy (p, &keylen, sizeof keylen);
+      p = mempcpy (p, state->entries[i].key, keylen);
+      for (size_t v = 0; v < state->nvalues; v++)
+	{
+	  uint64_t value = state->entries[i].values[v];
+	  p = mempcpy (p, &value, sizeof value);
+	}
+    }
+
+  /* a concurrent execution of the plugin never sees a partial file */
+  tmppath = xasprintf ("%s.XXXXXX", state->path);
+  if ((fd = mkostemp (tmppath, O_CLOEXEC)) < 0)
+    {
+      free (tmppath);
+      free (buf);
+      return -1;
+    }
+  while ((n = write (fd, buf, size)) < 0 && errno == EINTR)
+    ;
+  free (buf);
+  if (close (fd) < 0 || n != (ssize_t) size
+      || rename (tmppath, state->path) < 0)
+    {
+      int saved_errno = (n < 0 || n == (ssize_t) size) ? errno : EIO;
+      unlink (tmppath);
+      free (tmppath);
+      errno = saved_errno;
+      return -1;
+    }
+
+  free (tmppath);
+  return 0;
+}
+
+void
+statefile_free (struct statefile *state)
+{
+  size_t i;
+
+  if (NULL == state)
+    return;
+
+  for (i = 0; i < state->nsaved; i++)
+    free (state->saved[i].values);
+  for (i = 0; i < state->nentries; i++)
+    {
+      free ((char *) state->entries[i].key);
+      free (state->entries[i].values);
+    }
+  free (state->saved);
+  free (state->entries);
+  free (state->data);
+  free (state->path);
+  free (state);
+}
@@ -42,6 +42,7 @@
 #include "string-macros.h"
 #include "messages.h"
 #include "sysfsparser.h"
+#include "sysio.h"
 #include "xasprintf.h"
 
 #define PATH_SYS_SYSTEM		PATH_SYS "/devices/system"
@@ -91,9 +92,17 @@ void
 sysfsparser_check_for_sysfs (void)
 {
   struct statfs statfsbuf;
-  char sysfs_mount[NAME_MAX];
+  const char *sysfs_mount = sysio_sys_root ();
+
+  /* a sysfs tree provided by the user is not required to be a real sysfs */
+  if (sysio_sys_root_is_set ())
+    {
+      if (access (sysfs_mount, F_OK) < 0)
+	plugin_error (STATE_UNKNOWN, errno,
+		      "The sysfs root (%s) cannot be accessed", sysfs_mount);
+      return;
+    }
 
-  snprintf (sysfs_mount, NAME_MAX, "%s", PATH_SYS);
   if (statfs (sysfs_mount, &statfsbuf) < 0
       || statfsbuf.f_type != SYSFS_MAGIC)
     plugin_error (STATE_UNKNOWN, 0,
@@ -111,11 +120,14 @@ sysfsparser_path_exist (const char *path, ...)
     plugin_error (STATE_UNKNOWN, errno, "vasprintf has failed");
   va_end (args);
 
-  return access (filename, F_OK) == 0;
+  bool exist = (sysio_access (filename, F_OK) == 0);
+
+  free (filename);
+  return exist;
 }
 
 void
-sysfsparser_opendir(DIR **dirp, const char *path, ...)
+sysfsparser_opendir(struct sysio_dir **dirp, const char *path, ...)
 {
   char *dirname;
   va_list args;
@@ -125,23 +137,25 @@ sysfsparser_opendir(DIR **dirp, const char *path, ...)
     plugin_error (STATE_UNKNOWN, errno, "vasprintf has failed");
   va_end (args);
 
-  if ((*dirp = opendir (dirname)) == NULL)
+  if ((*dirp = sysio_opendir (dirname)) == NULL)
     plugin_error (STATE_UNKNOWN, errno, "Cannot open %s", dirname);
+
+  free (dirname);
 }
 
-void sysfsparser_closedir(DIR *dirp)
+void sysfsparser_closedir(struct sysio_dir *dirp)
 {
-  closedir(dirp);
+  sysio_closedir(dirp);
 }
 
 struct dirent *
-sysfsparser_readfilename(DIR *dirp, unsigned int flags)
+sysfsparser_readfilename(struct sysio_dir *dirp, unsigned int flags)
 {
   for (;;)
     {
       struct dirent *dp;
       errno = 0;
-      if ((dp = readdir (dirp)) == NULL)
+      if ((dp = sysio_readdir (dirp)) == NULL)
 	{
 	  if (errno != 0)
 	    plugin_error (STATE_UNKNOWN, errno, "readdir() failure");
@@ -172,14 +186,19 @@ sysfsparser_getline (const char *format, ...)
     plugin_error (STATE_UNKNOWN, errno, "vasprintf has failed");
   va_end (args);
 
-  if ((fp = fopen (filename, "r")) == NULL)
+  fp = sysio_fopen (filename);
+  free (filename);
+  if (NULL == fp)
     return NULL;
 
   chread = getline (&line, &len, fp);
   fclose (fp);
 
   if (chread < 1)
-    return NULL;
+    {
+      free (line);
+      return NULL;
+    }
 
   len = strlen (line);
   if (line[len-1] == '\n')
@@ -200,7 +219,9 @@ sysfsparser_getvalue (const char *format, ...)
     plugin_error (STATE_UNKNOWN, errno, "vasprintf has failed");
   va_end (args);
 
-  if (NULL == (line = sysfsparser_getline ("%s", filename)))
+  line = sysfsparser_getline ("%s", filename);
+  free (filename);
+  if (NULL == line)
     return 0;
 
   errno = 0;
@@ -212,6 +233,34 @@ sysfsparser_getvalue (const char *format, ...)
   return value;
 }
 
+size_t
+sysfsparser_getvalues (const char *dir, const char *const names[],
+		       unsigned long long values[], size_t n)
+{
+  char path[PATH_MAX], buf[64], *endptr;
+  size_t i, nread = 0;
+  int len;
+
+  for (i = 0; i < n; i++)
+    {
+      values[i] = 0;
+      len = snprintf (path, sizeof path, "%s/%s", dir, names[i]);
+      if (len < 0 || (size_t) len >= sizeof path
+	  || sysio_read (path, buf, sizeof buf) < 0)
+	continue;
+
+      errno = 0;
+      values[i] = strtoull (buf, &endptr, 0);
+      if ((endptr == buf) || (errno == ERANGE))
+	values[i] = 0;
+      else
+	nread++;
+      dbg ("%s = %llu\n", path, values[i]);
+    }
+
+  return nread;
+}
+
 int
 sysfsparser_linelookup_numeric (char *line, char *pattern, long long *value)
 {
@@ -354,7 +403,10 @@ sysfsparser_cpufreq_get_available_governors (unsigned int cpu)
 bool
 sysfsparser_thermal_kernel_support ()
 {
-  if (chdir (PATH_SYS_ACPI_THERMAL) < 0)
+  char buf[PATH_MAX];
+  const char *syspath = sysio_path (PATH_SYS_ACPI_THERMAL, buf, sizeof buf);
+
+  if (NULL == syspath || chdir (syspath) < 0)
     return false;
 
   return true;
@@ -496,7 +548,7 @@ sysfsparser_thermal_listall ()
 		  "no ACPI thermal support in kernel "
 		  "or incorrect path (\"%s\")", PATH_SYS_ACPI_THERMAL);
 
-  n = scandir (PATH_SYS_ACPI_THERMAL, &namelist, 0, alphasort);
+  n = sysio_scandir (PATH_SYS_ACPI_THERMAL, &namelist, 0, alphasort);
   if (-1 == n)
     plugin_error (STATE_UNKNOWN, errno,
 		  "cannot scandir() " PATH_SYS_ACPI_THERMAL);
@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A thin layer used by the library to access the proc and sysfs filesystems.
+ * The root of both filesystems can be redirected at runtime by setting the
+ * environment variables NPL_PROC_ROOT and NPL_SYS_ROOT, so that the readers
+ * can be run against fixture trees (see tests/mkfixtures.sh).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "getenv.h"
+#include "instrument.h"
+#include "sysio.h"
+#include "xalloc.h"
+#ifndef NPL_LIBRARY
+# include "sysio_record.h"
+#endif
+
+/* A directory read from the filesystem (DIRP), or from a listing in the
+   SYSIO_RECORD_DIR format, when recording or replaying.  */
+struct sysio_dir
+{
+  DIR *dirp;
+  const char *data;
+  size_t len;
+  size_t pos;
+  char *owned;			/* freed on close */
+  struct dirent entry;
+};
+
+static const char *
+sysio_root_from_env (const char *envvar)
+{
+  const char *root = secure_getenv (envvar);
+  return (root && *root) ? root : NULL;
+}
+
+const char *
+sysio_proc_root (void)
+{
+  const char *root = sysio_root_from_env ("NPL_PROC_ROOT");
+  return root ? root : PATH_PROC;
+}
+
+const char *
+sysio_sys_root (void)
+{
+  const char *root = sysio_root_from_env ("NPL_SYS_ROOT");
+  return root ? root : PATH_SYS;
+}
+
+bool
+sysio_proc_root_is_set (void)
+{
+  return sysio_root_from_env ("NPL_PROC_ROOT") != NULL;
+}
+
+bool
+sysio_sys_root_is_set (void)
+{
+  return sysio_root_from_env ("NPL_SYS_ROOT") != NULL;
+}
+
+/* Return the length of PREFIX if PATH is PREFIX or a path below it */
+static size_t
+sysio_match_prefix (const char *path, const char *prefix)
+{
+  size_t len = strlen (prefix);
+
+  if (strncmp (path, prefix, len) == 0
+      && (path[len] == '/' || path[len] == '\0'))
+    return len;
+
+  return 0;
+}
+
+const char *
+sysio_path (const char *path, char *buf, size_t size)
+{
+  const char *root = NULL;
+  size_t len;
+  int n;
+
+  if ((len = sysio_match_prefix (path, PATH_PROC)))
+    root = sysio_root_from_env ("NPL_PROC_ROOT");
+  else if ((len = sysio_match_prefix (path, PATH_SYS)))
+    root = sysio_root_from_env ("NPL_SYS_ROOT");
+
+  if (NULL == root)
+    return path;
+
+  n = snprintf (buf, size, "%s%s", root, path + len);
+  if (n < 0 || (size_t) n >= size)
+    {
+      errno = ENAMETOOLONG;
+      return NULL;
+    }
+
+  return buf;
+}
+
+FILE *
+sysio_fopen (const char *path)
+{
+  char buf[PATH_MAX];
+  const char *syspath;
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () == SYSIO_RECORD_REPLAY)
+    return sysio_replay_fopen (path);
+#endif
+
+  if (NULL == (syspath = sysio_path (path, buf, sizeof buf)))
+    return NULL;
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () == SYSIO_RECORD_ON)
+    return sysio_record_fopen (path, syspath);
+#endif
+
+  return instrument_enabled () ?
+    instrument_fopen (syspath) : fopen (syspath, "r");
+}
+
+/* Read the file PATH into BUF, as described for sysio_read().  */
+
+static ssize_t
+sysio_read_file (const char *path, char *buf, size_t size)
+{
+  size_t used = 0;
+  ssize_t n;
+  int fd;
+
+  instrument_phase_push (NPL_PHASE_OPEN);
+  fd = open (path, O_RDONLY | O_CLOEXEC);
+  instrument_phase_pop ();
+  instrument_count_io (1, 0);
+  if (fd < 0)
+    return -1;
+
+  instrument_phase_push (NPL_PHASE_READ);
+  while (used < size - 1
+	 && (n = read (fd, buf + used, size - 1 - used)) != 0)
+    {
+      instrument_count_io (1, n > 0 ? n : 0);
+      if (n < 0)
+	{
+	  int saved_errno = errno;
+
+	  if (errno == EINTR)
+	    continue;
+	  instrument_phase_pop ();
+	  close (fd);
+	  errno = saved_errno;
+	  return -1;
+	}
+      used += n;
+    }
+  instrument_phase_pop ();
+
+  close (fd);
+  buf[used] = '\0';
+  return used;
+}
+
+ssize_t
+sysio_read (const char *path, char *buf, size_t size)
+{
+  char pathbuf[PATH_MAX];
+  const char *syspath;
+
+  if (size == 0)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () == SYSIO_RECORD_REPLAY)
+    return sysio_replay_read (path, buf, size);
+#endif
+
+  if (NULL == (syspath = sysio_path (path, pathbuf, sizeof pathbuf)))
+    return -1;
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () == SYSIO_RECORD_ON)
+    return sysio_record_read (path, syspath, buf, size);
+#endif
+
+  return sysio_read_file (syspath, buf, size);
+}
+
+static struct sysio_dir *
+sysio_dir_new (DIR *dirp, const char *data, size_t len, char *owned)
+{
+  struct sysio_dir *dir = xmalloc (sizeof (struct sysio_dir));
+
+  memset (dir, 0, sizeof (struct sysio_dir));
+  dir->dirp = dirp;
+  dir->data = data;
+  dir->len = len;
+  dir->owned = owned;
+
+  return dir;
+}
+
+struct sysio_dir *
+sysio_opendir (const char *path)
+{
+  char buf[PATH_MAX];
+  const char *syspath;
+  DIR *dirp;
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () == SYSIO_RECORD_REPLAY)
+    {
+      size_t len;
+      const char *data = sysio_replay_listdir (path, &len);
+      return data ? sysio_dir_new (NULL, data, len, NULL) : NULL;
+    }
+#endif
+
+  if (NULL == (syspath = sysio_path (path, buf, sizeof buf)))
+    return NULL;
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () == SYSIO_RECORD_ON)
+    {
+      size_t len;
+      char *data = sysio_record_listdir (path, syspath, &len);
+      return data ? sysio_dir_new (NULL, data, len, data) : NULL;
+    }
+#endif
+
+  instrument_phase_push (NPL_PHASE_OPEN);
+  dirp = opendir (syspath);
+  instrument_phase_pop ();
+  instrument_count_io (1, 0);
+
+  return dirp ? sysio_dir_new (dirp, NULL, 0, NULL) : NULL;
+}
+
+struct dirent *
+sysio_readdir (struct sysio_dir *dir)
+{
+  const char *name;
+  size_t namelen;
+
+  if (dir->dirp)
+    return readdir (dir->dirp);
+
+  /* each entry is made of its type and its NUL terminated name */
+  if (dir->len - dir->pos < 2)
+    return NULL;
+  name = dir->data + dir->pos + 1;
+  namelen = strnlen (name, dir->len - dir->pos - 1);
+  if (namelen == dir->len - dir->pos - 1)
+    return NULL;		/* truncated listing */
+
+  dir->entry.d_type = dir->data[dir->pos];
+  dir->pos += namelen + 2;
+  if (namelen >= sizeof dir->entry.d_name)
+    namelen = sizeof dir->entry.d_name - 1;
+  memcpy (dir->entry.d_name, name, namelen);
+  dir->entry.d_name[namelen] = '\0';
+
+  return &dir->entry;
+}
+
+void
+sysio_closedir (struct sysio_dir *dir)
+{
+  if (dir->dirp)
+    closedir (dir->dirp);
+  free (dir->owned);
+  free (dir);
+}
+
+int
+sysio_access (const char *path, int mode)
+{
+  char buf[PATH_MAX];
+  const char *syspath;
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () == SYSIO_RECORD_REPLAY)
+    return sysio_replay_access (path, mode);
+#endif
+
+  if (NULL == (syspath = sysio_path (path, buf, sizeof buf)))
+    return -1;
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () == SYSIO_RECORD_ON)
+    return sysio_record_access (path, syspath, mode);
+#endif
+
+  return access (syspath, mode);
+}
+
+#ifndef NPL_LIBRARY
+/* scandir() cannot read a recorded listing: scan the directory with
+   sysio_readdir() when recording or replaying.  */
+
+static int
+sysio_scandir_listing (const char *path, struct dirent ***namelist,
+		       int (*filter) (const struct dirent *),
+		       int (*compar) (const struct dirent **,
+				      const struct dirent **))
+{
+  struct sysio_dir *dir;
+  struct dirent *dp, **list = NULL;
+  size_t n = 0, size = 0;
+
+  if (NULL == (dir = sysio_opendir (path)))
+    return -1;
+
+  while ((dp = sysio_readdir (dir)) != NULL)
+    {
+      if (filter && !filter (dp))
+	continue;
+      if (n == size)
+	list = xrealloc (list, (size = size ? 2 * size : 16)
+				 * sizeof (struct dirent *));
+      list[n] = xmalloc (sizeof (struct dirent));
+      memcpy (list[n++], dp, sizeof (struct dirent));
+    }
+  sysio_closedir (dir);
+
+  if (compar)
+    qsort (list, n, sizeof (struct dirent *),
+	   (int (*) (const void *, const void *)) compar);
+  *namelist = list;
+  return n;
+}
+#endif
+
+int
+sysio_scandir (const char *path, struct dirent ***namelist,
+	       int (*filter) (const struct dirent *),
+	       int (*compar) (const struct dirent **, const struct dirent **))
+{
+  char buf[PATH_MAX];
+  const char *syspath;
+
+#ifndef NPL_LIBRARY
+  if (sysio_record_mode () != SYSIO_RECORD_OFF)
+    return sysio_scandir_listing (path, namelist, filter, compar);
+#endif
+
+  syspath = sysio_path (path, buf, sizeof buf);
+  return syspath ? scandir (syspath, namelist, filter, compar) : -1;
+}
@@ -0,0 +1,614 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Record the data returned by the kernel to the plugins, and replay it.
+ *
+ * In record mode (NPL_RECORD=FILE) every file opened with sysio_fopen() or
+ * sysio_read() is read in full when opened, and appended, with its path and a timestamp,
+ * to an append-only binary file; the plugin then reads the copy in memory.
+ * The directories opened with sysio_opendir() and sysio_scandir() are
+ * recorded in the same way, as the list of their entries.
+ * In replay mode (NPL_REPLAY=FILE) the same paths are served from the
+ * recorded data, in the order they were recorded, without touching the
+ * proc and sysfs filesystems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "getenv.h"
+#include "instrument.h"
+#include "messages.h"
+#include "sysio_record.h"
+#include "xalloc.h"
+
+#define SYSIO_RECORD_MAGIC_LEN  (sizeof (SYSIO_RECORD_MAGIC) - 1)
+
+/* A record of the replay file */
+struct replay_entry
+{
+  const char *path;
+  uint32_t pathlen;
+  uint32_t type;
+  int32_t error;
+  uint32_t mode;		/* for SYSIO_RECORD_ACCESS */
+  const char *data;
+  size_t datalen;
+  size_t seq;			/* position in the file */
+  size_t next;			/* the next record of the group to serve */
+};
+
+static enum sysio_record_mode record_mode;
+static bool record_mode_set;
+static int record_fd = -1;
+
+static struct
+{
+  const char *file;
+  char *map;
+  size_t size;
+  struct replay_entry *entries;
+  size_t nentries;
+} replay;
+
+enum sysio_record_mode
+sysio_record_mode (void)
+{
+  const char *record, *replay_file;
+
+  if (record_mode_set)
+    return record_mode;
+
+  record = secure_getenv (NPL_RECORD_ENV);
+  replay_file = secure_getenv (NPL_REPLAY_ENV);
+  record_mode_set = true;
+  record_mode = SYSIO_RECORD_OFF;
+  if (record && *record)
+    {
+      if (replay_file && *replay_file)
+	plugin_error (STATE_UNKNOWN, 0, "%s and %s cannot be used together",
+		      NPL_RECORD_ENV, NPL_REPLAY_ENV);
+      record_mode = SYSIO_RECORD_ON;
+    }
+  else if (replay_file && *replay_file)
+    {
+      replay.file = replay_file;
+      record_mode = SYSIO_RECORD_REPLAY;
+    }
+
+  return record_mode;
+}
+
+/* The streams returned by sysio_record_fopen() and sysio_replay_fopen() */
+
+struct memfile
+{
+  const char *data;
+  size_t len;
+  size_t pos;
+  char *owned;			/* freed on close */
+};
+
+static ssize_t
+memfile_read (void *cookie, char *buf, size_t size)
+{
+  struct memfile *mf = cookie;
+  size_t n = mf->len - mf->pos;
+
+  if (n > size)
+    n = size;
+  memcpy (buf, mf->data + mf->pos, n);
+  mf->pos += n;
+
+  return n;
+}
+
+static int
+memfile_seek (void *cookie, off64_t *offset, int whence)
+{
+  struct memfile *mf = cookie;
+  off64_t pos;
+
+  switch (whence)
+    {
+    case SEEK_SET:
+      pos = *offset;
+      break;
+    case SEEK_CUR:
+      pos = mf->pos + *offset;
+      break;
+    case SEEK_END:
+      pos = mf->len + *offset;
+      break;
+    default:
+      return -1;
+    }
+  if (pos < 0 || (size_t) pos > mf->len)
+    return -1;
+
+  *offset = mf->pos = pos;
+  return 0;
+}
+
+static int
+memfile_close (void *cookie)
+{
+  struct memfile *mf = cookie;
+
+  free (mf->owned);
+  free (mf);
+  return 0;
+}
+
+static FILE *
+memfile_open (const char *data, size_t len, char *owned)
+{
+  cookie_io_functions_t io_funcs = {
+    .read = memfile_read,
+    .write = NULL,
+    .seek = memfile_seek,
+    .close = memfile_close
+  };
+  struct memfile *mf = xmalloc (sizeof (struct memfile));
+  FILE *fp;
+
+  mf->data = data;
+  mf->len = len;
+  mf->owned = owned;
+  if ((fp = fopencookie (mf, "r", io_funcs)) == NULL)
+    {
+      free (owned);
+      free (mf);
+    }
+
+  return fp;
+}
+
+/* Record mode */
+
+static void
+write_all (int fd, const char *buf, size_t len)
+{
+  while (len > 0)
+    {
+      ssize_t n = write (fd, buf, len);
+      if (n < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  plugin_error (STATE_UNKNOWN, errno, "cannot write to %s",
+			secure_getenv (NPL_RECORD_ENV));
+	}
+      buf += n;
+      len -= n;
+    }
+}
+
+static void
+sysio_record_append (uint32_t type, const char *path, int error,
+		     const char *data, size_t datalen)
+{
+  struct sysio_record_header hdr;
+  struct timespec now;
+  size_t pathlen = strlen (path), len;
+  char *buf;
+
+  if (record_fd < 0)
+    {
+      const char *file = secure_getenv (NPL_RECORD_ENV);
+      struct stat st;
+
+      record_fd =
+	open (file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+      if (record_fd < 0 || fstat (record_fd, &st) < 0)
+	plugin_error (STATE_UNKNOWN, errno, "cannot open %s", file);
+      if (st.st_size == 0)
+	write_all (record_fd, SYSIO_RECORD_MAGIC, SYSIO_RECORD_MAGIC_LEN);
+    }
+
+  clock_gettime (CLOCK_REALTIME, &now);
+  hdr.type = type;
+  hdr.pathlen = pathlen;
+  hdr.datalen = datalen;
+  hdr.error = error;
+  hdr.time_ns = now.tv_sec * INT64_C (1000000000) + now.tv_nsec;
+
+  /* a single write, so that the records of concurrent plugins writing
+     to the same file do not interleave */
+  len = sizeof hdr + pathlen + datalen;
+  buf = xmalloc (len);
+  memcpy (buf, &hdr, sizeof hdr);
+  memcpy (buf + sizeof hdr, path, pathlen);
+  if (datalen)
+    memcpy (buf + sizeof hdr + pathlen, data, datalen);
+  write_all (record_fd, buf, len);
+  free (buf);
+}
+
+/* Read the whole file PATH.  Return NULL, with errno set, on error.  */
+
+static char *
+sysio_slurp (const char *path, size_t *len)
+{
+  size_t size = 4096, used = 0;
+  char *data;
+  ssize_t n;
+  int fd;
+
+  instrument_phase_push (NPL_PHASE_OPEN);
+  fd = open (path, O_RDONLY | O_CLOEXEC);
+  instrument_phase_pop ();
+  instrument_count_io (1, 0);
+  if (fd < 0)
+    return NULL;
+
+  data = xmalloc (size);
+  instrument_phase_push (NPL_PHASE_READ);
+  while ((n = read (fd, data + used, size - used)) != 0)
+    {
+      instrument_count_io (1, n > 0 ? n : 0);
+      if (n < 0)
+	{
+	  int saved_errno = errno;
+
+	  if (errno == EINTR)
+	    continue;
+	  instrument_phase_pop ();
+	  close (fd);
+	  free (data);
+	  errno = saved_errno;
+	  return NULL;
+	}
+      used += n;
+      if (used == size)
+	data = xrealloc (data, size *= 2);
+    }
+  instrument_phase_pop ();
+
+  close (fd);
+  *len = used;
+  return data;
+}
+
+FILE *
+sysio_record_fopen (const char *path, const char *syspath)
+{
+  size_t len = 0;
+  char *data = sysio_slurp (syspath, &len);
+
+  if (NULL == data)
+    {
+      int saved_errno = errno;
+      sysio_record_append (SYSIO_RECORD_FILE, path, saved_errno, NULL, 0);
+      errno = saved_errno;
+      return NULL;
+    }
+
+  sysio_record_append (SYSIO_RECORD_FILE, path, 0, data, len);
+  return memfile_open (data, len, data);
+}
+
+/* Copy at most SIZE - 1 bytes of DATA to BUF, and terminate them.  */
+static ssize_t
+sysio_copy_data (const char *data, size_t len, char *buf, size_t size)
+{
+  if (len > size - 1)
+    len = size - 1;
+  memcpy (buf, data, len);
+  buf[len] = '\0';
+  return len;
+}
+
+ssize_t
+sysio_record_read (const char *path, const char *syspath, char *buf,
+		   size_t size)
+{
+  size_t len = 0;
+  char *data = sysio_slurp (syspath, &len);
+  ssize_t ret;
+
+  if (NULL == data)
+    {
+      int saved_errno = errno;
+      sysio_record_append (SYSIO_RECORD_FILE, path, saved_errno, NULL, 0);
+      errno = saved_errno;
+      return -1;
+    }
+
+  sysio_record_append (SYSIO_RECORD_FILE, path, 0, data, len);
+  ret = sysio_copy_data (data, len, buf, size);
+  free (data);
+  return ret;
+}
+
+int
+sysio_record_access (const char *path, const char *syspath, int mode)
+{
+  uint32_t data = mode;
+  int ret = access (syspath, mode), saved_errno = errno;
+
+  sysio_record_append (SYSIO_RECORD_ACCESS, path, ret < 0 ? saved_errno : 0,
+		       (const char *) &data, sizeof data);
+  errno = saved_errno;
+  return ret;
+}
+
+char *
+sysio_record_listdir (const char *path, const char *syspath, size_t *len)
+{
+  size_t size = 4096, used = 0;
+  struct dirent *dp;
+  char *data;
+  DIR *dirp;
+
+  instrument_phase_push (NPL_PHASE_OPEN);
+  dirp = opendir (syspath);
+  instrument_phase_pop ();
+  instrument_count_io (1, 0);
+  if (NULL == dirp)
+    {
+      int saved_errno = errno;
+      sysio_record_append (SYSIO_RECORD_DIR, path, saved_errno, NULL, 0);
+      errno = saved_errno;
+      return NULL;
+    }
+
+  data = xmalloc (size);
+  while ((dp = readdir (dirp)) != NULL)
+    {
+      size_t namelen = strlen (dp->d_name) + 1;
+
+      while (size - used < 1 + namelen)
+	data = xrealloc (data, size *= 2);
+      data[used++] = dp->d_type;
+      memcpy (data + used, dp->d_name, namelen);
+      used += namelen;
+    }
+  closedir (dirp);
+
+  sysio_record_append (SYSIO_RECORD_DIR, path, 0, data, used);
+  *len = used;
+  return data;
+}
+
+/* Replay mode */
+
+static int
+replay_entry_cmp (const void *a, const void *b)
+{
+  const struct replay_entry *ea = a, *eb = b;
+  int cmp;
+
+  if (ea->type != eb->type)
+    return ea->type < eb->type ? -1 : 1;
+  if (ea->pathlen != eb->pathlen)
+    return ea->pathlen < eb->pathlen ? -1 : 1;
+  if ((cmp = memcmp (ea->path, eb->path, ea->pathlen)) != 0)
+    return cmp;
+  if (ea->mode != eb->mode)
+    return ea->mode < eb->mode ? -1 : 1;
+  return ea->seq < eb->seq ? -1 : ea->seq > eb->seq;
+}
+
+/* Compare the keys of two entries, ignoring their position.  */
+static int
+replay_key_cmp (const struct replay_entry *key, const struct replay_entry *e)
+{
+  struct replay_entry k = *key;
+
+  k.seq = e->seq;
+  return replay_entry_cmp (&k, e);
+}
+
+static void
+sysio_replay_load (void)
+{
+  struct sysio_record_header hdr;
+  size_t off, size = 16;
+  struct stat st;
+  int fd;
+
+  if ((fd = open (replay.file, O_RDONLY | O_CLOEXEC)) < 0
+      || fstat (fd, &st) < 0)
+    plugin_error (STATE_UNKNOWN, errno, "cannot open %s", replay.file);
+
+  replay.size = st.st_size;
+  replay.map = (replay.size > 0) ?
+    mmap (NULL, replay.size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+  close (fd);
+  if (replay.map == MAP_FAILED)
+    plugin_error (STATE_UNKNOWN, errno, "cannot map %s", replay.file);
+
+  if (replay.size < SYSIO_RECORD_MAGIC_LEN
+      || memcmp (replay.map, SYSIO_RECORD_MAGIC, SYSIO_RECORD_MAGIC_LEN))
+    plugin_error (STATE_UNKNOWN, 0, "%s: not a record file", replay.file);
+
+  replay.entries = xnmalloc (size, sizeof (struct replay_entry));
+  for (off = SYSIO_RECORD_MAGIC_LEN; off < replay.size;)
+    {
+      struct replay_entry *e;
+
+      if (replay.size - off < sizeof hdr)
+	break;
+      memcpy (&hdr, replay.map + off, sizeof hdr);
+      off += sizeof hdr;
+      if (replay.size - off < (size_t) hdr.pathlen + hdr.datalen)
+	break;
+
+      if (replay.nentries == size)
+	replay.entries =
+	  xrealloc (replay.entries,
+		    (size *= 2) * sizeof (struct replay_entry));
+      e = &replay.entries[replay.nentries];
+      e->type = hdr.type;
+      e->path = replay.map + off;
+      e->pathlen = hdr.pathlen;
+      e->error = hdr.error;
+      e->data = replay.map + off + hdr.pathlen;
+      e->datalen = hdr.datalen;
+      e->mode = 0;
+      if (hdr.type == SYSIO_RECORD_ACCESS && hdr.datalen == sizeof e->mode)
+	memcpy (&e->mode, e->data, sizeof e->mode);
+      e->seq = replay.nentries++;
+      e->next = 0;
+      off += hdr.pathlen + hdr.datalen;
+    }
+  if (off != replay.size)
+    plugin_error (STATE_UNKNOWN, 0, "%s: truncated record at offset %zu",
+		  replay.file, off);
+
+  qsort (replay.entries, replay.nentries, sizeof (struct replay_entry),
+	 replay_entry_cmp);
+}
+
+/* Return the next recorded entry matching KEY.  The recorded entries are
+   served in order, and the last one is repeated when they are exhausted.  */
+
+static const struct replay_entry *
+sysio_replay_next (const struct replay_entry *key)
+{
+  size_t lo = 0, hi, n;
+  struct replay_entry *group;
+
+  if (NULL == replay.entries)
+    sysio_replay_load ();
+
+  /* the first entry of the group */
+  hi = replay.nentries;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (replay_key_cmp (key, &replay.entries[mid]) > 0)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == replay.nentries || replay_key_cmp (key, &replay.entries[lo]))
+    return NULL;
+
+  group = &replay.entries[lo];
+  for (n = 1; lo + n < replay.nentries
+       && replay_key_cmp (key, &group[n]) == 0; n++)
+    ;
+
+  return &group[group->next < n ? group->next++ : n - 1];
+}
+
+FILE *
+sysio_replay_fopen (const char *path)
+{
+  struct replay_entry key = {
+    .type = SYSIO_RECORD_FILE, .path = path, .pathlen = strlen (path)
+  };
+  const struct replay_entry *e = sysio_replay_next (&key);
+
+  if (NULL == e)
+    {
+      errno = ENOENT;
+      return NULL;
+    }
+  if (e->error)
+    {
+      errno = e->error;
+      return NULL;
+    }
+
+  return memfile_open (e->data, e->datalen, NULL);
+}
+
+ssize_t
+sysio_replay_read (const char *path, char *buf, size_t size)
+{
+  struct replay_entry key = {
+    .type = SYSIO_RECORD_FILE, .path = path, .pathlen = strlen (path)
+  };
+  const struct replay_entry *e = sysio_replay_next (&key);
+
+  if (NULL == e)
+    {
+      errno = ENOENT;
+      return -1;
+    }
+  if (e->error)
+    {
+      errno = e->error;
+      return -1;
+    }
+
+  return sysio_copy_data (e->data, e->datalen, buf, size);
+}
+
+int
+sysio_replay_access (const char *path, int mode)
+{
+  struct replay_entry key = {
+    .type = SYSIO_RECORD_ACCESS, .path = path, .pathlen = strlen (path),
+    .mode = mode
+  };
+  const struct replay_entry *e = sysio_replay_next (&key);
+
+  if (NULL == e)
+    {
+      errno = ENOENT;
+      return -1;
+    }
+  if (e->error)
+    {
+      errno = e->error;
+      return -1;
+    }
+
+  return 0;
+}
+
+const char *
+sysio_replay_listdir (const char *path, size_t *len)
+{
+  struct replay_entry key = {
+    .type = SYSIO_RECORD_DIR, .path = path, .pathlen = strlen (path)
+  };
+  const struct replay_entry *e = sysio_replay_next (&key);
+
+  if (NULL == e)
+    {
+      errno = ENOENT;
+      return NULL;
+    }
+  if (e->error)
+    {
+      errno = e->error;
+      return NULL;
+    }
+
+  *len = e->datalen;
+  return e->data;
+}
@@ -23,26 +23,41 @@
 #endif
 
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <arpa/inet.h>
+#include <unistd.h>
 #if HAVE_NETINET_IN_H
 # include <netinet/in.h>
 #endif
+#if defined (HAVE_LINUX_INET_DIAG_H) && defined (HAVE_LINUX_SOCK_DIAG_H)
+# include <linux/netlink.h>
+# include <linux/rtnetlink.h>
+# include <linux/inet_diag.h>
+# include <linux/sock_diag.h>
+# include <linux/tcp.h>
+#endif
 
 #include "common.h"
+#include "instrument.h"
+#include "logging.h"
 #include "messages.h"
+#include "sockdiag.h"
+#include "string-macros.h"
+#include "sysio.h"
 #include "system.h"
+#include "tcpinfo.h"
+#include "xalloc.h"
 
-#define PROC_TCPINFO  "/proc/net/tcp"
-#define PROC_TCP6INFO  "/proc/net/tcp6"
-
-#define TCP_UNSET   0
-#define TCP_VERBOSE (1 << 1)
-#define TCP_v4      (1 << 2)
-#define TCP_v6      (1 << 3)
+#define PROC_TCPINFO  PATH_PROC "/net/tcp"
+#define PROC_TCP6INFO  PATH_PROC "/net/tcp6"
+#define PROC_NETSTAT  PATH_PROC "/net/netstat"
 
 typedef enum tcp_status
 {
@@ -96,12 +111,50 @@ typedef struct proc_tcptable
   struct proc_tcptable_data *data;
 } proc_tcptable_t;
 
+/* The connections grouped by local port and by remote address, in two
+   open addressing tables with linear probing, whose sizes are powers of
+   two.  An empty slot has no connections.  */
+
+struct tcp_conntable
+{
+  struct tcp_port_conn *ports;
+  size_t nports, ports_size;
+  struct tcp_peer_conn *peers;
+  size_t npeers, peers_size;
+};
+
+static void tcp_conntable_add (struct tcp_conntable *table,
+			       unsigned int state, unsigned int port,
+			       int family, const unsigned char *raddr);
+
+/* Decode an address of /proc/net/tcp{,6}, the in-memory representation
+   of the address printed as 32-bit hexadecimal words.  */
+
+static int
+procparser_tcp_addr (const char *hex, unsigned char *addr)
+{
+  unsigned int word[4] = { 0, 0, 0, 0 };
+
+  if (strlen (hex) > 8)
+    {
+      sscanf (hex, "%08X%08X%08X%08X", &word[0], &word[1], &word[2],
+	      &word[3]);
+      memcpy (addr, word, 16);
+      return AF_INET6;
+    }
+
+  sscanf (hex, "%X", &word[0]);
+  memset (addr, 0, 16);
+  memcpy (addr, word, 4);
+  return AF_INET;
+}
+
 
 /* Parses /proc/net/tcp and /proc/net/tcp6 */
 
 static void
 procparser_tcp (const char *procfile, struct proc_tcptable_data *data,
-	        bool verbose)
+	        struct tcp_conntable *conntable, bool verbose)
 {
   FILE *fp;
   char *line = NULL;
@@ -121,9 +174,10 @@ procparser_tcp (const char *procfile, struct proc_tcptable_data *data,
 #endif
   struct sockaddr_in in;
 
-  if ((fp = fopen (procfile, "r")) == NULL)
+  if ((fp = sysio_fopen (procfile)) == NULL)
     plugin_error (STATE_UNKNOWN, errno, "error opening %s", procfile);
 
+  instrument_phase_push (NPL_PHASE_PARSE);
   /* sl local_addr:local_port rem_addr:rem_port st ... */
   while ((nread = getline (&line, &len, fp)) != -1)
     {
@@ -182,6 +236,14 @@ procparser_tcp (const char *procfile, struct proc_tcptable_data *data,
 	  break;
 	}
 
+      if (conntable && num >= 6)
+	{
+	  unsigned char raddr[16];
+	  int family = procparser_tcp_addr (rem_addr_buf, raddr);
+
+	  tcp_conntable_add (conntable, state, local_port, family, raddr);
+	}
+
       if (verbose == false)
 	continue;
 
@@ -217,6 +279,8 @@ procparser_tcp (const char *procfile, struct proc_tcptable_data *data,
     }
 
   free (line);
+  fclose (fp);
+  instrument_phase_pop ();
 }
 
 /* Allocates space for a new tcptable object.
@@ -256,10 +320,10 @@ proc_tcptable_read (struct proc_tcptable *tcptable, int flags)
   struct proc_tcptable_data *data = tcptable->data;
 
   if (flags & TCP_v4)
-    procparser_tcp (PROC_TCPINFO, data, verbose);
+    procparser_tcp (PROC_TCPINFO, data, NULL, verbose);
 
   if (flags & TCP_v6)
-    procparser_tcp (PROC_TCP6INFO, data, verbose);
+    procparser_tcp (PROC_TCP6INFO, data, NULL, verbose);
 }
 
 struct proc_tcptable *
@@ -292,3 +356,662 @@ proc_tcp_get (close_wait)
 proc_tcp_get (last_ack)
 proc_tcp_get (listen)
 proc_tcp_get (closing)
+
+const char *
+tcp_state_name (unsigned int state)
+{
+  return (state > 0 && state < TCP_NSTATES) ? tcp_state[state] : NULL;
+}
+
+int
+tcp_state_lookup (const char *name)
+{
+  for (int state = 1; state < TCP_NSTATES; state++)
+    if (strcasecmp (name, tcp_state[state]) == 0)
+      return state;
+  return -1;
+}
+
+static inline uint32_t
+tcp_conntable_hash_port (unsigned int port)
+{
+  uint32_t h = port;
+
+  h ^= h >> 16;
+  h *= 0x45d9f3b;
+  h ^= h >> 16;
+  return h;
+}
+
+/* FNV-1a of the family and of the binary address */
+
+static inline uint32_t
+tcp_conntable_hash_peer (int family, const unsigned char *addr)
+{
+  uint32_t h = 2166136261u ^ family;
+
+  h *= 16777619;
+  for (int i = 0; i < 16; i++)
+    {
+      h ^= addr[i];
+      h *= 16777619;
+    }
+  return h;
+}
+
+/* Return the slot of PORT in TABLE, or the empty slot where to add it.  */
+
+static struct tcp_port_conn *
+tcp_conntable_port_slot (struct tcp_port_conn *table, size_t size,
+			 unsigned int port)
+{
+  size_t i = tcp_conntable_hash_port (port) & (size - 1);
+
+  while (table[i].total > 0 && table[i].port != port)
+    i = (i + 1) & (size - 1);
+  return &table[i];
+}
+
+static struct tcp_peer_conn *
+tcp_conntable_peer_slot (struct tcp_peer_conn *table, size_t size,
+			 int family, const unsigned char *addr)
+{
+  size_t i = tcp_conntable_hash_peer (family, addr) & (size - 1);
+
+  while (table[i].connections > 0
+	 && (table[i].family != family || memcmp (table[i].addr, addr, 16)))
+    i = (i + 1) & (size - 1);
+  return &table[i];
+}
+
+/* Double the size of the tables when they are three-quarters full.  */
+
+static void
+tcp_conntable_grow_ports (struct tcp_conntable *table)
+{
+  size_t size = table->ports_size ? table->ports_size * 2 : 64;
+  struct tcp_port_conn *ports = xnmalloc (size, sizeof (*ports));
+
+  for (size_t i = 0; i < table->ports_size; i++)
+    if (table->ports[i].total > 0)
+      *tcp_conntable_port_slot (ports, size, table->ports[i].port) =
+	table->ports[i];
+
+  free (table->ports);
+  table->ports = ports;
+  table->ports_size = size;
+}
+
+static void
+tcp_conntable_grow_peers (struct tcp_conntable *table)
+{
+  size_t size = table->peers_size ? table->peers_size * 2 : 64;
+  struct tcp_peer_conn *peers = xnmalloc (size, sizeof (*peers));
+
+  for (size_t i = 0; i < table->peers_size; i++)
+    if (table->peers[i].connections > 0)
+      *tcp_conntable_peer_slot (peers, size, table->peers[i].family,
+				table->peers[i].addr) = table->peers[i];
+
+  free (table->peers);
+  table->peers = peers;
+  table->peers_size = size;
+}
+
+/* Account a socket in the STATE to its local PORT and, unless listening,
+   to its remote address RADDR (16 bytes, zero-padded for IPv4).  The
+   IPv4-mapped IPv6 addresses are accounted as IPv4 addresses.  */
+
+static void
+tcp_conntable_add (struct tcp_conntable *table, unsigned int state,
+		   unsigned int port, int family, const unsigned char *raddr)
+{
+  static const unsigned char v4mapped[12] =
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+  unsigned char addr[16];
+  struct tcp_port_conn *p;
+  struct tcp_peer_conn *peer;
+
+  if (state == 0 || state >= TCP_NSTATES)
+    return;
+
+  if (4 * (table->nports + 1) > 3 * table->ports_size)
+    tcp_conntable_grow_ports (table);
+  p = tcp_conntable_port_slot (table->ports, table->ports_size, port);
+  if (p->total == 0)
+    {
+      p->port = port;
+      table->nports++;
+    }
+  p->state[state]++;
+  p->total++;
+
+  if (state == TCP_LISTEN)
+    return;
+
+  memcpy (addr, raddr, 16);
+  if (family == AF_INET6 && memcmp (addr, v4mapped, 12) == 0)
+    {
+      family = AF_INET;
+      memmove (addr, addr + 12, 4);
+      memset (addr + 4, 0, 12);
+    }
+
+  if (4 * (table->npeers + 1) > 3 * table->peers_size)
+    tcp_conntable_grow_peers (table);
+  peer = tcp_conntable_peer_slot (table->peers, table->peers_size, family,
+				  addr);
+  if (peer->connections == 0)
+    {
+      peer->family = family;
+      memcpy (peer->addr, addr, 16);
+      table->npeers++;
+    }
+  peer->connections++;
+}
+
+struct tcp_conntable *
+tcp_conntable_new (void)
+{
+  return xmalloc (sizeof (struct tcp_conntable));
+}
+
+static void
+tcp_conntable_clear (struct tcp_conntable *table)
+{
+  free (table->ports);
+  free (table->peers);
+  memset (table, 0, sizeof (struct tcp_conntable));
+}
+
+void
+tcp_conntable_free (struct tcp_conntable *table)
+{
+  if (table == NULL)
+    return;
+
+  tcp_conntable_clear (table);
+  free (table);
+}
+
+void
+tcp_conntable_read_proc (struct tcp_conntable *table, int flags)
+{
+  struct proc_tcptable_data data;
+
+  memset (&data, 0, sizeof (data));
+  if (flags & TCP_v4)
+    procparser_tcp (PROC_TCPINFO, &data, table, false);
+  if (flags & TCP_v6)
+    procparser_tcp (PROC_TCP6INFO, &data, table, false);
+}
+
+const struct tcp_port_conn *
+tcp_conntable_port (const struct tcp_conntable *table, unsigned int port)
+{
+  const struct tcp_port_conn *p;
+
+  if (table->nports == 0)
+    return NULL;
+
+  p = tcp_conntable_port_slot (table->ports, table->ports_size, port);
+  return (p->total > 0) ? p : NULL;
+}
+
+static int
+tcp_port_conn_cmp (const void *a, const void *b)
+{
+  const struct tcp_port_conn *pa = a, *pb = b;
+  return (pa->port > pb->port) - (pa->port < pb->port);
+}
+
+size_t
+tcp_conntable_ports (const struct tcp_conntable *table,
+		     struct tcp_port_conn **ports)
+{
+  size_t n = 0;
+
+  *ports = xnmalloc (table->nports + 1, sizeof (struct tcp_port_conn));
+  for (size_t i = 0; i < table->ports_size; i++)
+    if (table->ports[i].total > 0)
+      (*ports)[n++] = table->ports[i];
+
+  qsort (*ports, n, sizeof (struct tcp_port_conn), tcp_port_conn_cmp);
+  return n;
+}
+
+/* The peer with more connections first, and then the lower address */
+
+static int
+tcp_peer_conn_cmp (const struct tcp_peer_conn *a,
+		   const struct tcp_peer_conn *b)
+{
+  if (a->connections != b->connections)
+    return (a->connections < b->connections) ? 1 : -1;
+  if (a->family != b->family)
+    return (a->family > b->family) - (a->family < b->family);
+  return memcmp (a->addr, b->addr, 16);
+}
+
+/* Keep the N peers with more connections sorted in an array, which is
+   cheaper than sorting all the peers when N is small.  */
+
+size_t
+tcp_conntable_top_peers (const struct tcp_conntable *table, size_t n,
+			 struct tcp_peer_conn **peers)
+{
+  size_t ntop = 0;
+
+  *peers = xnmalloc (n + 1, sizeof (struct tcp_peer_conn));
+  for (size_t i = 0; i < table->peers_size && n > 0; i++)
+    {
+      const struct tcp_peer_conn *peer = &table->peers[i];
+      size_t j;
+
+      if (peer->connections == 0
+	  || (ntop == n && tcp_peer_conn_cmp (peer, &(*peers)[n - 1]) > 0))
+	continue;
+
+      j = (ntop < n) ? ntop++ : n - 1;
+      for (; j > 0 && tcp_peer_conn_cmp (peer, &(*peers)[j - 1]) < 0; j--)
+	(*peers)[j] = (*peers)[j - 1];
+      (*peers)[j] = *peer;
+    }
+
+  return ntop;
+}
+
+#if defined (HAVE_LINUX_INET_DIAG_H) && defined (HAVE_LINUX_SOCK_DIAG_H)
+
+/* two port comparisons (>= and <=) for the source and for the destination */
+#define TCP_DIAG_BYTECODE_MAX	(4 * 2 * sizeof (struct inet_diag_bc_op))
+
+/* Compile the filter "sport == SPORT && dport == DPORT" in BYTECODE, a port
+   set to 0 matching any port.  Return the length of the bytecode.  */
+
+static size_t
+tcp_diag_bytecode (unsigned char *bytecode, unsigned int sport,
+		   unsigned int dport)
+{
+  const struct
+  {
+    unsigned char code;
+    unsigned int port;
+  } cmp[] = {
+    { INET_DIAG_BC_S_GE, sport }, { INET_DIAG_BC_S_LE, sport },
+    { INET_DIAG_BC_D_GE, dport }, { INET_DIAG_BC_D_LE, dport }
+  };
+  struct inet_diag_bc_op *op = (struct inet_diag_bc_op *) bytecode;
+  size_t len = 0, offset = 0, i;
+
+  for (i = 0; i < 4; i++)
+    if (cmp[i].port)
+      len += 2 * sizeof (struct inet_diag_bc_op);
+
+  /* a comparison that holds jumps to the next one, and the end of the
+     bytecode accepts the socket: jumping past the end rejects it */
+  for (i = 0; i < 4; i++)
+    {
+      if (0 == cmp[i].port)
+	continue;
+      op[0].code = cmp[i].code;
+      op[0].yes = 2 * sizeof (struct inet_diag_bc_op);
+      op[0].no = len - offset + 4;
+      op[1].code = op[1].yes = 0;
+      op[1].no = cmp[i].port;
+      op += 2;
+      offset += 2 * sizeof (struct inet_diag_bc_op);
+    }
+
+  return len;
+}
+
+/* Dump the TCP sockets of the families selected by FLAGS in the STATES
+   (a mask of 1 << state), with the extensions EXT, and keep the ones with
+   the local port SPORT and the remote port DPORT (0 for any).  */
+
+static int
+tcp_diag_dump_all (int flags, unsigned int states, unsigned char ext,
+		   unsigned int sport, unsigned int dport, inet_diag_fn fn,
+		   void *data)
+{
+  unsigned char bytecode[TCP_DIAG_BYTECODE_MAX];
+  size_t bclen = tcp_diag_bytecode (bytecode, sport, dport);
+  int fd, ret = 0;
+
+  if ((fd = sock_diag_open ()) < 0)
+    return -1;
+
+  if (flags & TCP_v4)
+    ret = inet_diag_dump (fd, AF_INET, IPPROTO_TCP, states, ext, bytecode,
+			  bclen, fn, data);
+  if (ret == 0 && (flags & TCP_v6))
+    ret = inet_diag_dump (fd, AF_INET6, IPPROTO_TCP, states, ext, bytecode,
+			  bclen, fn, data);
+
+  if (ret < 0)
+    {
+      int saved_errno = errno;
+      close (fd);
+      errno = saved_errno;
+      return -1;
+    }
+
+  close (fd);
+  return 0;
+}
+
+struct tcp_listen_dump
+{
+  struct tcp_listen_port *ports;
+  size_t nports, size;
+};
+
+static int
+tcp_listen_port_cmp (const void *a, const void *b)
+{
+  const struct tcp_listen_port *pa = a, *pb = b;
+  return (pa->port > pb->port) - (pa->port < pb->port);
+}
+
+/* Add the listening socket MSG to the port it is bound to.  */
+
+static void
+tcp_listen_add (const struct inet_diag_msg *msg, struct rtattr *attrs[],
+		void *data)
+{
+  struct tcp_listen_dump *dump = data;
+  unsigned int port = ntohs (msg->id.idiag_sport);
+  struct tcp_listen_port *p = NULL;
+  double fill;
+  (void) attrs;
+
+  for (size_t i = 0; i < dump->nports && NULL == p; i++)
+    if (dump->ports[i].port == port)
+      p = &dump->ports[i];
+
+  if (NULL == p)
+    {
+      if (dump->nports == dump->size)
+	{
+	  dump->size = dump->size ? dump->size * 2 : 16;
+	  dump->ports = xrealloc (dump->ports,
+				  dump->size * sizeof (struct tcp_listen_port));
+	}
+      p = &dump->ports[dump->nports++];
+      memset (p, 0, sizeof (struct tcp_listen_port));
+      p->port = port;
+    }
+
+  /* for a listening socket, the current and the maximum length of the
+     accept queue */
+  p->sockets++;
+  p->backlog += msg->idiag_rqueue;
+  p->max_backlog += msg->idiag_wqueue;
+  fill = msg->idiag_wqueue ? 100.0 * msg->idiag_rqueue / msg->idiag_wqueue : 0;
+  if (fill > p->fill)
+    p->fill = fill;
+
+  dbg ("listening socket on port %u: backlog %u/%u\n",
+       port, msg->idiag_rqueue, msg->idiag_wqueue);
+}
+
+/* Only the listening hash table is walked by the kernel when the only
+   state requested is LISTEN, whatever the number of the other sockets.  */
+
+int
+tcp_listen_read (int flags, struct tcp_listen_port **ports)
+{
+  struct tcp_listen_dump dump = { NULL, 0, 0 };
+
+  *ports = NULL;
+  if (tcp_diag_dump_all (flags, 1 << TCP_LISTEN, 0, 0, 0, tcp_listen_add,
+			 &dump) < 0)
+    {
+      int saved_errno = errno;
+      free (dump.ports);
+      errno = saved_errno;
+      return -1;
+    }
+
+  if (dump.nports > 0)
+    qsort (dump.ports, dump.nports, sizeof (struct tcp_listen_port),
+	   tcp_listen_port_cmp);
+  *ports = dump.ports;
+  return dump.nports;
+}
+
+struct tcp_quality_dump
+{
+  struct tcp_port_quality *ports;
+  size_t nports;
+  struct tcp_listen_port *listen;	/* sorted by port */
+  size_t nlisten;
+  bool local;			/* all the connections have a service port */
+};
+
+/* The service port of a connection is its local port if a socket listens
+   on it (or if the local port has been selected), and the remote port
+   otherwise.  */
+
+static unsigned int
+tcp_quality_port (const struct tcp_quality_dump *dump, unsigned int sport,
+		  unsigned int dport)
+{
+  struct tcp_listen_port key = { .port = sport };
+
+  if (dump->local
+      || bsearch (&key, dump->listen, dump->nlisten,
+		  sizeof (struct tcp_listen_port), tcp_listen_port_cmp))
+    return sport;
+  return dport;
+}
+
+static int
+tcp_port_quality_cmp (const void *a, const void *b)
+{
+  const struct tcp_port_quality *pa = a, *pb = b;
+  return (pa->port > pb->port) - (pa->port < pb->port);
+}
+
+/* Add the tcp_info of the established connection MSG to the histograms of
+   its service port.  */
+
+static void
+tcp_quality_add (const struct inet_diag_msg *msg, struct rtattr *attrs[],
+		 void *data)
+{
+  struct tcp_quality_dump *dump = data;
+  unsigned int port = tcp_quality_port (dump, ntohs (msg->id.idiag_sport),
+				       ntohs (msg->id.idiag_dport));
+  struct tcp_port_quality *p = NULL;
+  struct tcp_info info;
+
+  if (NULL == attrs[INET_DIAG_INFO])
+    return;
+
+  /* older kernels return a shorter structure */
+  memset (&info, 0, sizeof (info));
+  memcpy (&info, RTA_DATA (attrs[INET_DIAG_INFO]),
+	  RTA_PAYLOAD (attrs[INET_DIAG_INFO]) < sizeof (info) ?
+	  RTA_PAYLOAD (attrs[INET_DIAG_INFO]) : sizeof (info));
+
+  for (size_t i = 0; i < dump->nports && NULL == p; i++)
+    if (dump->ports[i].port == port)
+      p = &dump->ports[i];
+
+  if (NULL == p)
+    {
+      /* the connections of the other ports share the last slot */
+      if (dump->nports < TCP_QUALITY_PORTS_MAX - 1)
+	{
+	  p = &dump->ports[dump->nports++];
+	  p->port = port;
+	}
+      else
+	{
+	  p = &dump->ports[TCP_QUALITY_PORTS_MAX - 1];
+	  p->port = 0;
+	  dump->nports = TCP_QUALITY_PORTS_MAX;
+	}
+    }
+
+  p->connections++;
+  histogram_add (&p->rtt, info.tcpi_rtt);
+  histogram_add (&p->unacked, info.tcpi_unacked);
+  histogram_add (&p->cwnd, info.tcpi_snd_cwnd);
+  p->retrans += info.tcpi_total_retrans;
+#ifdef HAVE_STRUCT_TCP_INFO_TCPI_SEGS_OUT
+  p->segs_out += info.tcpi_segs_out;
+#endif
+}
+
+int
+tcp_quality_read (int flags, unsigned int sport, unsigned int dport,
+		  struct tcp_port_quality **ports)
+{
+  struct tcp_quality_dump dump = { NULL, 0, NULL, 0, sport != 0 };
+  int nlisten = 0;
+
+  *ports = NULL;
+  if (!dump.local && (nlisten = tcp_listen_read (flags, &dump.listen)) < 0)
+    return -1;
+  dump.nlisten = nlisten;
+  dump.ports = xnmalloc (TCP_QUALITY_PORTS_MAX,
+			 sizeof (struct tcp_port_quality));
+
+  if (tcp_diag_dump_all (flags, 1 << TCP_ESTABLISHED,
+			 1 << (INET_DIAG_INFO - 1), sport, dport,
+			 tcp_quality_add, &dump) < 0)
+    {
+      int saved_errno = errno;
+      free (dump.listen);
+      free (dump.ports);
+      errno = saved_errno;
+      return -1;
+    }
+  free (dump.listen);
+
+  if (dump.nports > 0)
+    qsort (dump.ports, dump.nports, sizeof (struct tcp_port_quality),
+	   tcp_port_quality_cmp);
+  *ports = dump.ports;
+  return dump.nports;
+}
+
+/* Account the socket MSG, whose state is reported by newer kernels as
+   NEW_SYN_RECV (12) for the connections not accepted yet.  */
+
+static void
+tcp_conntable_diag_add (const struct inet_diag_msg *msg,
+			struct rtattr *attrs[], void *data)
+{
+  unsigned int state =
+    (msg->idiag_state == TCP_NSTATES) ? TCP_SYN_RECV : msg->idiag_state;
+  unsigned char raddr[16];
+  (void) attrs;
+
+  memcpy (raddr, msg->id.idiag_dst, 16);
+  if (msg->idiag_family == AF_INET)
+    memset (raddr + 4, 0, 12);
+  tcp_conntable_add (data, state, ntohs (msg->id.idiag_sport),
+		     msg->idiag_family, raddr);
+}
+
+int
+tcp_conntable_read_diag (struct tcp_conntable *table, int flags)
+{
+  if (tcp_diag_dump_all (flags, ~0U, 0, 0, 0, tcp_conntable_diag_add,
+			 table) < 0)
+    {
+      int saved_errno = errno;
+      tcp_conntable_clear (table);
+      errno = saved_errno;
+      return -1;
+    }
+
+  return 0;
+}
+
+#undef TCP_DIAG_BYTECODE_MAX
+
+#else
+
+int
+tcp_conntable_read_diag (struct tcp_conntable *table, int flags)
+{
+  (void) table;
+  (void) flags;
+  errno = ENOSYS;
+  return -1;
+}
+
+int
+tcp_listen_read (int flags, struct tcp_listen_port **ports)
+{
+  (void) flags;
+  *ports = NULL;
+  errno = ENOSYS;
+  return -1;
+}
+
+int
+tcp_quality_read (int flags, unsigned int sport, unsigned int dport,
+		  struct tcp_port_quality **ports)
+{
+  (void) flags;
+  (void) sport;
+  (void) dport;
+  *ports = NULL;
+  errno = ENOSYS;
+  return -1;
+}
+
+#endif
+
+/* Parses the "TcpExt:" lines of /proc/net/netstat, a line with the names of
+ * the counters followed by a line with their values.  */
+
+int
+proc_tcp_listen_drops (unsigned long long *overflows,
+		       unsigned long long *drops)
+{
+  FILE *fp;
+  char *names = NULL, *values = NULL;
+  size_t nameslen = 0, valueslen = 0;
+  int ret = -1;
+
+  if ((fp = sysio_fopen (PROC_NETSTAT)) == NULL)
+    return -1;
+
+  instrument_phase_push (NPL_PHASE_PARSE);
+  while (getline (&names, &nameslen, fp) != -1
+	 && getline (&values, &valueslen, fp) != -1)
+    {
+      char *nameptr, *valueptr, *name, *value;
+
+      if (!STRPREFIX (names, "TcpExt:") || !STRPREFIX (values, "TcpExt:"))
+	continue;
+
+      *overflows = *drops = 0;
+      name = strtok_r (names, " \n", &nameptr);
+      value = strtok_r (values, " \n", &valueptr);
+      while ((name = strtok_r (NULL, " \n", &nameptr))
+	     && (value = strtok_r (NULL, " \n", &valueptr)))
+	{
+	  if (STREQ (name, "ListenOverflows"))
+	    *overflows = strtoull (value, NULL, 10);
+	  else if (STREQ (name, "ListenDrops"))
+	    *drops = strtoull (value, NULL, 10);
+	}
+      ret = 0;
+      break;
+    }
+
+  free (names);
+  free (values);
+  fclose (fp);
+  instrument_phase_pop ();
+
+  return ret;
+}
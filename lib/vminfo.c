@@ -35,9 +35,10 @@
 #include "getenv.h"
 #include "messages.h"
 #include "procparser.h"
+#include "sysio.h"
 #include "vminfo.h"
 
-#define PROC_STAT     "/proc/stat"
+#define PROC_STAT     PATH_PROC "/stat"
 
 typedef struct proc_vmem_data
 {
@@ -114,7 +115,7 @@ get_path_proc_vmstat ()
   if (env_procvmstat)
     return env_procvmstat;
 
-  return "/proc/vmstat";
+  return PATH_PROC "/vmstat";
 }
 
 /* get_vmem_pagesize - get memory page size */
@@ -152,7 +153,7 @@ proc_vmem_new (struct proc_vmem **vmem)
 /* Fill the proc_vmem structure pointed will the values found in the
  * proc filesystem. */
 
-void
+int
 proc_vmem_read (struct proc_vmem *vmem)
 {
   FILE *fp;
@@ -161,7 +162,7 @@ proc_vmem_read (struct proc_vmem *vmem)
   bool found_pgpg_data = false, found_pswp_data = false;
 
   if (vmem == NULL)
-    return;
+    return -EINVAL;
 
   struct proc_vmem_data *data = vmem->data;
 
@@ -230,7 +231,9 @@ proc_vmem_read (struct proc_vmem *vmem)
   data->vm_pgpgin = data->vm_pgpgout = ~0UL;
   data->vm_pswpin = data->vm_pswpout = ~0UL;
 
-  procparser (get_path_proc_vmstat (), vmem_table, vmem_table_count, ' ');
+  if (procparser (get_path_proc_vmstat (), vmem_table, vmem_table_count,
+		  ' ') < 0)
+    return -errno;
 
 #define FOR_ALL_ZONES(x) x##_dma + x##_dma32 + x##_normal + x##_high
   if (!data->vm_pgalloc)
@@ -248,7 +251,7 @@ proc_vmem_read (struct proc_vmem *vmem)
 #undef FOR_ALL_ZONES
 
   if (data->vm_pgpgin != ~0UL && data->vm_pswpin != ~0UL)
-    return;
+    return 0;
   else if (data->vm_pgpgin != ~0UL)
     found_pgpg_data = true;
   else if (data->vm_pswpin != ~0UL)
@@ -256,7 +259,7 @@ proc_vmem_read (struct proc_vmem *vmem)
 
   /* Linux kernels < 2.5.40-bk4 */
 
-  if ((fp = fopen (PROC_STAT, "r")))
+  if ((fp = sysio_fopen (PROC_STAT)))
     {
       ssize_t nread;
       while ((nread = getline (&line, &len, fp)) != -1)
@@ -280,6 +283,8 @@ proc_vmem_read (struct proc_vmem *vmem)
       data->vm_pgpgin = data->vm_pgpgout = 0;
     if (!found_pswp_data)
       data->vm_pswpin = data->vm_pswpout = 0;
+
+  return 0;
 }
 
 /* Drop a reference of the memory library context. If the refcount of
@@ -49,9 +49,10 @@ proc_vmem_new (struct proc_vmem **vmem)
   return 0;
 }
 
-void
+int
 proc_vmem_read (struct proc_vmem *vmem __attribute__ ((unused)))
 {
+  return 0;
 }
 
 struct proc_vmem *
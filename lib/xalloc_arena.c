@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * free() and realloc() wrappers aware of the xmalloc bump arena.
+ *
+ * The memory returned by xmalloc() and friends is often released with
+ * free() or resized with realloc(), sometimes by the C library itself
+ * (getline for instance).  These wrappers make the calls on blocks coming
+ * from the arena harmless, and forward all the other calls to the glibc.
+ *
+ * This file only defines free and realloc, so that the linker does not
+ * pick it up from libutils.a when a program (like the benchmarks) already
+ * interposes these functions.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+
+#include "system.h"
+#include "xalloc.h"
+
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void __libc_free (void *ptr);
+
+void
+free (void *ptr)
+{
+  if (!xalloc_arena_owns (ptr))
+    __libc_free (ptr);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+  if (ptr && xalloc_arena_owns (ptr))
+    return xalloc_arena_realloc (ptr, size);
+  return __libc_realloc (ptr, size);
+}
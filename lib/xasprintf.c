@@ -25,17 +25,28 @@
 
 #include "common.h"
 #include "messages.h"
+#include "xalloc.h"
 #include "xasprintf.h"
 
+/* The string is allocated with xmalloc, so that it is accounted in the
+   allocation counters and can come from the bump arena.  */
+
 char *
 xasprintf (const char *format, ...)
 {
   va_list args;
   char *result;
+  int len;
 
   va_start (args, format);
-  if (vasprintf (&result, format, args) < 0)
+  len = vsnprintf (NULL, 0, format, args);
+  va_end (args);
+  if (len < 0)
     plugin_error (STATE_UNKNOWN, errno, "asprintf has failed");
+
+  result = xmalloc (len + 1);
+  va_start (args, format);
+  vsnprintf (result, len + 1, format, args);
   va_end (args);
 
   return result;
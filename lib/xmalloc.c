@@ -16,21 +16,169 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+/* the memory of the arena is never released: keep it out of libnpl */
+#ifdef NPL_LIBRARY
+# undef ENABLE_XALLOC_ARENA
+#endif
+
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if ENABLE_XALLOC_ARENA
+# include <sys/mman.h>
+# include "getenv.h"
+# include "string-macros.h"
+#endif
+
 # include "messages.h"
 # include "xalloc.h"
 
+/* process-wide, so that the allocations of all the threads are counted:
+ * the shared library can be called concurrently */
+static struct xalloc_stats xstats;
+
+#define xstats_add(counter, n) \
+  __atomic_fetch_add (&xstats.counter, (n), __ATOMIC_RELAXED)
+
+#if ENABLE_XALLOC_ARENA
+
+/* The bump arena.
+ *
+ * A large region of virtual memory is reserved at the first allocation: the
+ * pages are only backed by physical memory when touched, and are already
+ * zeroed by the kernel.  Each allocation is preceded by a small header with
+ * its size (required by realloc) and is never released: the whole arena goes
+ * away when the process exits.  free() and realloc() are interposed (see
+ * xalloc_arena.c) so that the existing calls on memory coming from the arena
+ * remain valid.  The arena is not thread-safe.  */
+
+# define XALLOC_ARENA_SIZE	(64UL << 20)
+# define XALLOC_ARENA_ALIGN	16
+
+struct xalloc_arena_header
+{
+  size_t size;
+  size_t unused;		/* keep the payload aligned */
+};
+
+static char *arena_base, *arena_next, *arena_end;
+static char *arena_last;	/* the last allocation, can grow in place */
+static int arena_state = -1;	/* -1: not initialized, 0: off, 1: on */
+
+static inline size_t
+xalloc_arena_round (size_t n)
+{
+  return (n + XALLOC_ARENA_ALIGN - 1) & ~(size_t) (XALLOC_ARENA_ALIGN - 1);
+}
+
+static void
+xalloc_arena_init (void)
+{
+  const char *value = secure_getenv ("NPL_XALLOC_ARENA");
+  void *p;
+
+  arena_state = 0;
+  if (value && STREQ (value, "0"))
+    return;
+
+  p = mmap (NULL, XALLOC_ARENA_SIZE, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED)
+    return;
+
+  arena_base = arena_next = p;
+  arena_end = arena_base + XALLOC_ARENA_SIZE;
+  arena_state = 1;
+}
+
+/* Return a zeroed block of N bytes from the arena,
+ * or NULL if the arena is disabled or full.  */
+static void *
+xalloc_arena_alloc (size_t n)
+{
+  size_t total = sizeof (struct xalloc_arena_header) + xalloc_arena_round (n);
+  struct xalloc_arena_header *h;
+
+  if (arena_state < 0)
+    xalloc_arena_init ();
+  if (arena_state == 0 || n > XALLOC_ARENA_SIZE
+      || total > (size_t) (arena_end - arena_next))
+    return NULL;
+
+  h = (struct xalloc_arena_header *) arena_next;
+  h->size = n;
+  arena_last = (char *) (h + 1);
+  arena_next += total;
+  xstats_add (arena_bytes, total);
+
+  return arena_last;
+}
+
+bool
+xalloc_arena_owns (const void *p)
+{
+  return (const char *) p >= arena_base && (const char *) p < arena_end;
+}
+
+void *
+xalloc_arena_realloc (void *p, size_t n)
+{
+  struct xalloc_arena_header *h = (struct xalloc_arena_header *) p - 1;
+  void *newp;
+
+  if (n <= h->size)
+    {
+      h->size = n;
+      return p;
+    }
+
+  /* the last block can simply be extended */
+  if (p == arena_last
+      && xalloc_arena_round (n) <= (size_t) (arena_end - arena_last))
+    {
+      char *next = arena_last + xalloc_arena_round (n);
+
+      if (next > arena_next)
+	{
+	  xstats_add (arena_bytes, next - arena_next);
+	  arena_next = next;
+	}
+      h->size = n;
+      return p;
+    }
+
+  if ((newp = xalloc_arena_alloc (n)) == NULL
+      && (newp = malloc (n)) == NULL)
+    return NULL;
+
+  return memcpy (newp, p, h->size);
+}
+
+#endif		/* ENABLE_XALLOC_ARENA */
+
 /* Allocate N bytes of memory dynamically, with error checking.
  * The memory is set to zero.  */
 
 void *
 xmalloc (const size_t n)
 {
-  void *p = calloc (1, n);
+  void *p;
+
+  xstats_add (allocs, 1);
+  xstats_add (bytes, n);
+
+#if ENABLE_XALLOC_ARENA
+  if ((p = xalloc_arena_alloc (n)))
+    return p;
+#endif
+
+  p = calloc (1, n);
   if (!p && n != 0)
     plugin_error (STATE_UNKNOWN, errno, "memory exhausted");
   return p;
@@ -78,8 +226,34 @@ xnmalloc (const size_t n, const size_t s)
 void *
 xrealloc (void *ptr, const size_t size)
 {
-  void *ret = realloc (ptr, size);
+  void *ret;
+
+#if ENABLE_XALLOC_ARENA
+  if (ptr == NULL)
+    return xmalloc (size);
+#endif
+
+  xstats_add (allocs, 1);
+  xstats_add (bytes, size);
+
+#if ENABLE_XALLOC_ARENA
+  if (xalloc_arena_owns (ptr))
+    ret = xalloc_arena_realloc (ptr, size);
+  else
+#endif
+  ret = realloc (ptr, size);
   if (!ret && size)
     plugin_error (STATE_UNKNOWN, errno, "memory exhausted");
   return ret;
 }
+
+/* Return the allocation counters */
+
+void
+xalloc_stats_get (struct xalloc_stats *stats)
+{
+  stats->allocs = __atomic_load_n (&xstats.allocs, __ATOMIC_RELAXED);
+  stats->bytes = __atomic_load_n (&xstats.bytes, __ATOMIC_RELAXED);
+  stats->arena_bytes =
+    __atomic_load_n (&xstats.arena_bytes, __ATOMIC_RELAXED);
+}
@@ -29,9 +29,12 @@
 
 #include "common.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
+#include "xasprintf.h"
 #include "xstrton.h"
 
 static const char *program_copyright =
@@ -126,6 +129,7 @@ main (int argc, char **argv)
   long timedelta;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "r:c:w:v" GETOPT_HELP_VERSION_STRING,
@@ -167,8 +171,14 @@ main (int argc, char **argv)
   status = get_status (labs (timedelta), my_threshold);
   free (my_threshold);
 
-  printf ("%s %s - time delta %lds | clock_delta=%ld\n",
-	  program_name_short, state_text (status), timedelta, timedelta);
+  struct metrics *metrics = metrics_new (program_name_short, 1);
+  struct metric metric = { .name = "clock_delta" };
+  metrics_add (metrics, &metric, timedelta);
+
+  char *status_msg = xasprintf ("%s %s - time delta %lds", program_name_short,
+				state_text (status), timedelta);
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
 
   return status;
 }
@@ -0,0 +1,304 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A Nagios plugin that checks the usage of the netfilter connection
+ * tracking table and the packets dropped by the connection tracking.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "conntrack.h"
+#include "logging.h"
+#include "messages.h"
+#include "metrics.h"
+#include "progname.h"
+#include "progversion.h"
+#include "result_cache.h"
+#include "statefile.h"
+#include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+#include "xstrton.h"
+
+static const char *program_copyright =
+  "Copyright (C) 2026 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
+
+static struct option const longopts[] = {
+  {(char *) "drops", required_argument, NULL, 'd'},
+  {(char *) "protocols", no_argument, NULL, 'p'},
+  {(char *) "critical", required_argument, NULL, 'c'},
+  {(char *) "warning", required_argument, NULL, 'w'},
+  {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
+  {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
+  {NULL, 0, NULL, 0}
+};
+
+static _Noreturn void
+usage (FILE * out)
+{
+  fprintf (out, "%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs ("This plugin checks the usage of the netfilter connection tracking "
+	 "table and\nthe packets dropped by the connection tracking.\n", out);
+  fputs (program_copyright, out);
+  fputs (USAGE_HEADER, out);
+  fprintf (out, "  %s [-p] [-d COUNTER,COUNTER] [-w PERC] [-c PERC] "
+	   "[delay]\n", program_name);
+  fputs (USAGE_OPTIONS, out);
+  fputs ("  -d, --drops=COUNTER,COUNTER   warning and critical thresholds on "
+	 "the packets\n"
+	 "                  dropped per second (drop and insert_failed)\n",
+	 out);
+  fputs ("  -p, --protocols   report the entries by protocol and the TCP "
+	 "ones by state\n"
+	 "                  (requires CAP_NET_ADMIN)\n", out);
+  fputs ("  -w, --warning PERC   warning threshold on the table usage\n", out);
+  fputs ("  -c, --critical PERC   critical threshold on the table usage\n",
+	 out);
+  fputs (USAGE_HELP, out);
+  fputs (USAGE_VERSION, out);
+  fprintf (out, "  \"delay\" is the delay in seconds between two samples of "
+	   "the counters\n"
+	   "    (default: %dsec)\n", DELAY_DEFAULT);
+  fputs (USAGE_NOTE, out);
+  fputs (USAGE_STATEFILE, out);
+  fputs (USAGE_EXAMPLES, out);
+  fprintf (out, "  %s -w 80 -c 90 -d 1,10\n", program_name);
+  fprintf (out, "  %s --protocols -c 95\n", program_name);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static _Noreturn void
+print_version (void)
+{
+  printf ("%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs (program_copyright, stdout);
+  fputs (GPLv3_DISCLAIMER, stdout);
+
+  exit (STATE_OK);
+}
+
+/* The current counters, and the previous ones */
+
+struct conntrack_sample
+{
+  unsigned long long counters[CONNTRACK_COUNTERS];
+  unsigned long long first[CONNTRACK_COUNTERS];
+  const unsigned long long *prev;
+};
+
+static void
+conntrack_resample (void *data)
+{
+  struct conntrack_sample *sample = data;
+
+  memcpy (sample->first, sample->counters, sizeof (sample->first));
+  sample->prev = sample->first;
+  if (conntrack_stat_read (sample->counters) < 0)
+    plugin_error (STATE_UNKNOWN, errno, "cannot read the conntrack counters");
+}
+
+/* Compute in RATES the counters per second, comparing them with the ones
+   saved by the last execution or, if missing or too recent, with a second
+   sample taken after DELAY seconds.  */
+
+static void
+conntrack_rates (unsigned long delay, double *rates)
+{
+  static const char *const keys[] = { "stat" };
+  struct conntrack_sample sample;
+  struct statefile *state;
+  double elapsed;
+
+  if (conntrack_stat_read (sample.counters) < 0)
+    plugin_error (STATE_UNKNOWN, errno, "cannot read the conntrack counters");
+
+  state = statefile_open ("conntrack", CONNTRACK_COUNTERS);
+  sample.prev = statefile_get (state, "stat");
+  elapsed = statefile_sample (state, delay, keys, 1, conntrack_resample,
+			      &sample);
+
+  for (size_t i = 0; i < CONNTRACK_COUNTERS; i++)
+    rates[i] = (sample.counters[i] > sample.prev[i]) ?
+      (sample.counters[i] - sample.prev[i]) / elapsed : 0;
+
+  statefile_put (state, "stat", sample.counters);
+  if (statefile_save (state) < 0)
+    dbg ("cannot save the state: %s\n", strerror (errno));
+  statefile_free (state);
+}
+
+int
+main (int argc, char **argv)
+{
+  int c;
+  bool protocols = false;
+  char *critical = NULL, *warning = NULL, *drops_critical = NULL,
+       *drops_warning = NULL, *message;
+  unsigned long delay = DELAY_DEFAULT;
+  unsigned long long count, max;
+  nagstatus status, drops_status;
+  thresholds *my_threshold = NULL, *drops_threshold = NULL;
+  struct conntrack_table table;
+  double rates[CONNTRACK_COUNTERS], usage_perc, drops;
+  char max_str[32];
+
+  set_program_name (argv[0]);
+  result_cache_init (argc, argv);
+
+  while ((c = getopt_long (argc, argv,
+			   "d:pc:w:" GETOPT_HELP_VERSION_STRING,
+			   longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'd':
+	  drops_warning = xstrdup (optarg);
+	  if (NULL == (drops_critical = strchr (drops_warning, ',')))
+	    usage (stderr);
+	  *drops_critical++ = '\0';
+	  break;
+	case 'p':
+	  protocols = true;
+	  break;
+	case 'c':
+	  critical = optarg;
+	  break;
+	case 'w':
+	  warning = optarg;
+	  break;
+
+	case_GETOPT_HELP_CHAR
+	case_GETOPT_VERSION_CHAR
+
+	}
+    }
+
+  if (optind < argc)
+    {
+      delay = strtol_or_err (argv[optind++], "failed to parse argument");
+
+      if (delay < 1)
+	plugin_error (STATE_UNKNOWN, 0, "delay must be positive integer");
+      else if (DELAY_MAX < delay)
+	plugin_error (STATE_UNKNOWN, 0,
+		      "too large delay value (greater than %d)", DELAY_MAX);
+    }
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&drops_threshold, drops_warning, drops_critical)
+	 == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  if (conntrack_usage (&count, &max) < 0)
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot read the size of the conntrack table "
+		  "(is nf_conntrack loaded?)");
+  conntrack_rates (delay, rates);
+
+  if (protocols && conntrack_table_read (&table) < 0)
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot dump the conntrack table with ctnetlink");
+
+  usage_perc = max ? 100.0 * count / max : 0;
+  drops = rates[CONNTRACK_DROP] + rates[CONNTRACK_INSERT_FAILED];
+  status = get_status (usage_perc, my_threshold);
+  drops_status = get_status (drops, drops_threshold);
+  if (status < drops_status)
+    status = drops_status;
+
+  struct metrics *metrics =
+    metrics_new (program_name_short,
+		 4 + CONNTRACK_COUNTERS + CONNTRACK_PROTOS
+		 + CONNTRACK_TCP_STATES);
+  struct metric metric = { .precision = 0, .min = "0" };
+  char name[32];
+
+  snprintf (max_str, sizeof max_str, "%llu", max);
+  metric.name = "entries";
+  metric.max = max_str;
+  metrics_add (metrics, &metric, count);
+  metric.name = "max";
+  metric.max = NULL;
+  metrics_add (metrics, &metric, max);
+  metric.name = "usage";
+  metric.unit = "%";
+  metric.precision = 2;
+  metric.warning = warning;
+  metric.critical = critical;
+  metric.max = "100";
+  metrics_add (metrics, &metric, usage_perc);
+
+  metric.unit = NULL;
+  metric.max = NULL;
+  metric.name = "dropped/s";
+  metric.warning = drops_warning;
+  metric.critical = drops_critical;
+  metrics_add (metrics, &metric, drops);
+  metric.warning = metric.critical = NULL;
+  for (size_t i = 0; i < CONNTRACK_COUNTERS; i++)
+    {
+      snprintf (name, sizeof name, "%s/s", conntrack_counter_name (i));
+      metric.name = name;
+      metrics_add (metrics, &metric, rates[i]);
+    }
+
+  if (protocols)
+    {
+      metric.precision = 0;
+      metric.label = "proto";
+      metric.name = "entries";
+      for (size_t i = 0; i < CONNTRACK_PROTOS; i++)
+	{
+	  metric.label_value = conntrack_proto_name (i);
+	  metrics_add (metrics, &metric, table.proto[i]);
+	}
+      metric.label = "state";
+      metric.name = "tcp_entries";
+      for (size_t i = 1; i < CONNTRACK_TCP_STATES; i++)
+	{
+	  metric.label_value = conntrack_tcp_state_name (i);
+	  metrics_add (metrics, &metric, table.tcp_state[i]);
+	}
+    }
+
+  message =
+    xasprintf ("%s %s - %.2f%% of the conntrack table used (%llu/%llu), "
+	       "%.2f packets dropped/s, %.2f early drops/s",
+	       program_name_short, state_text (status), usage_perc, count,
+	       max, drops, rates[CONNTRACK_EARLY_DROP]);
+  metrics_write (metrics, status, message);
+
+  free (message);
+  free (drops_warning);
+  free (my_threshold);
+  free (drops_threshold);
+
+  return status;
+}
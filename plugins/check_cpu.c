@@ -41,8 +41,10 @@
 #include "cputopology.h"
 #include "logging.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
 #include "string-macros.h"
 #include "sysfsparser.h"
@@ -256,6 +258,7 @@ main (int argc, char **argv)
   struct cpu_desc *cpudesc = NULL;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   len = strlen (program_name);
   if (len > 6 && STRPREFIX (program_name, "check_"))
@@ -440,21 +443,36 @@ main (int argc, char **argv)
     cpu_model ?	xasprintf ("(%s) ",
 			   cpu_desc_get_model_name (cpudesc)) : NULL;
 
-  printf ("%s %s%s - cpu %s %.1f%% |"
-	  , program_name_short, cpu_model ? cpu_model_str : ""
-	  , state_text (status), cpu_progname, cpu_perc);
+  struct metrics *metrics = metrics_new (program_name_short, 5 * ncpus);
   for (c = 0; c < ncpus; c++)
     {
       if ((cpuname = cpuv[0][c].cpuname))
-        printf (" %s_user=%.1f%% %s_system=%.1f%% %s_idle=%.1f%%"
-		" %s_iowait=%.1f%% %s_steal=%.1f%%"
-		, cpuname, 100.0 * duser[c]   / ratio[c]
-		, cpuname, 100.0 * dsystem[c] / ratio[c]
-		, cpuname, 100.0 * didle[c]   / ratio[c]
-		, cpuname, 100.0 * diowait[c] / ratio[c]
-		, cpuname, 100.0 * dsteal[c]  / ratio[c]);
+	{
+	  struct metric metric = {
+	    .label = "cpu", .label_value = cpuname, .unit = "%",
+	    .precision = 1
+	  };
+	  const struct { const char *name; jiff value; } modes[] = {
+	    { "user", duser[c] }, { "system", dsystem[c] },
+	    { "idle", didle[c] }, { "iowait", diowait[c] },
+	    { "steal", dsteal[c] }
+	  };
+
+	  for (size_t m = 0; m < sizeof (modes) / sizeof (modes[0]); m++)
+	    {
+	      metric.name = modes[m].name;
+	      metrics_add (metrics, &metric,
+			   100.0 * modes[m].value / ratio[c]);
+	    }
+	}
     }
-  putchar ('\n');
+
+  char *message =
+    xasprintf ("%s %s%s - cpu %s %.1f%%"
+	       , program_name_short, cpu_model ? cpu_model_str : ""
+	       , state_text (status), cpu_progname, cpu_perc);
+  metrics_write (metrics, status, message);
+  free (message);
 
   cpu_desc_unref (cpudesc);
   return status;
@@ -31,8 +31,10 @@
 #include "cpustats.h"
 #include "cputopology.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "sysfsparser.h"
 #include "thresholds.h"
 #include "units.h"
@@ -102,6 +104,7 @@ main (int argc, char **argv)
   unsigned long freq_min, freq_max, freq_kernel;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   sysfsparser_check_for_sysfs ();
 
@@ -159,9 +162,7 @@ main (int argc, char **argv)
 	  status = currstatus;
       }
 
-  printf ("%s %s%s |"
-	  , program_name_short, cpu_model ? cpu_model_str : ""
-	  , state_text (status));
+  struct metrics *metrics = metrics_new (program_name_short, ncpus);
 #define unit_convert(_val, _factor) (unsigned long long)(_val * _factor)
   for (c = 0; c < ncpus; c++)
     {
@@ -171,15 +172,29 @@ main (int argc, char **argv)
 	  /* expected format for the Nagios performance data:
 	   *   'label'=value[UOM];[warn];[crit];[min];[max]	*/
 	  if (freq_kernel)
-	    printf (" cpu%d_freq=%llu;;;%llu;%llu",
-		    c,
-		    unit_convert(freq_kernel, factor),
-		    unit_convert(freq_min, factor),
-		    unit_convert(freq_max, factor));
+	    {
+	      char cpuname[16], min[32], max[32];
+	      snprintf (cpuname, sizeof cpuname, "cpu%d", c);
+	      snprintf (min, sizeof min, "%llu",
+			unit_convert(freq_min, factor));
+	      snprintf (max, sizeof max, "%llu",
+			unit_convert(freq_max, factor));
+	      struct metric metric = {
+		.name = "freq", .label = "cpu", .label_value = cpuname,
+		.min = min, .max = max
+	      };
+	      metrics_add (metrics, &metric,
+			   unit_convert(freq_kernel, factor));
+	    }
 	}
     }
 #undef unit_convert
-  putchar ('\n');
+
+  char *status_msg = xasprintf ("%s %s%s", program_name_short,
+				cpu_model ? cpu_model_str : "",
+				state_text (status));
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
   cpu_desc_unref (cpudesc);
 
   return status;
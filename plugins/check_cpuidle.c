@@ -0,0 +1,485 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A Nagios plugin that checks the time spent by the CPUs in the idle
+ * states (C-states) with a long exit latency.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "cputopology.h"
+#include "logging.h"
+#include "messages.h"
+#include "metrics.h"
+#include "progname.h"
+#include "progversion.h"
+#include "result_cache.h"
+#include "statefile.h"
+#include "string-macros.h"
+#include "sysfsparser.h"
+#include "system.h"
+#include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+#include "xstrton.h"
+
+#define PATH_SYS_CPU  PATH_SYS "/devices/system/cpu"
+
+/* The maximum number of idle states of a CPU (CPUIDLE_STATE_MAX in the
+   kernel sources) */
+#define CPUIDLE_STATE_MAX  10
+
+static const char *program_copyright =
+  "Copyright (C) 2026 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
+
+static struct option const longopts[] = {
+  {(char *) "cpus", required_argument, NULL, 'p'},
+  {(char *) "latency", required_argument, NULL, 'l'},
+  {(char *) "critical", required_argument, NULL, 'c'},
+  {(char *) "warning", required_argument, NULL, 'w'},
+  {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
+  {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
+  {NULL, 0, NULL, 0}
+};
+
+static _Noreturn void
+usage (FILE * out)
+{
+  fprintf (out, "%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs ("This plugin checks the residency of the CPUs in the idle states "
+	 "with a long\nexit latency.\n", out);
+  fputs (program_copyright, out);
+  fputs (USAGE_HEADER, out);
+  fprintf (out, "  %s [-p CPULIST] [-l USEC] [-w PERC] [-c PERC] [delay]\n",
+	   program_name);
+  fputs (USAGE_OPTIONS, out);
+  fputs ("  -p, --cpus=CPULIST   the CPUs to check: a list like \"2-5,8\", "
+	 "or \"isolated\"\n"
+	 "                  or \"nohz_full\" (default: all the online CPUs)\n",
+	 out);
+  fputs ("  -l, --latency=USEC   the exit latency budget, in microseconds "
+	 "(default: 0)\n", out);
+  fputs ("  -w, --warning PERC   warning threshold on the time spent in the "
+	 "idle states\n"
+	 "                  exceeding the latency budget\n", out);
+  fputs ("  -c, --critical PERC   critical threshold on the time spent in "
+	 "the idle states\n"
+	 "                  exceeding the latency budget\n", out);
+  fputs (USAGE_HELP, out);
+  fputs (USAGE_VERSION, out);
+  fprintf (out, "  \"delay\" is the delay in seconds between two samples "
+	   "(default: %dsec)\n", DELAY_DEFAULT);
+  fputs (USAGE_NOTE, out);
+  fputs (USAGE_STATEFILE, out);
+  fputs (USAGE_EXAMPLES, out);
+  fprintf (out, "  %s --cpus isolated --latency 20 -w 1 -c 5\n",
+	   program_name);
+  fprintf (out, "  %s --cpus 2-5 -c 10\n", program_name);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static _Noreturn void
+print_version (void)
+{
+  printf ("%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs (program_copyright, stdout);
+  fputs (GPLv3_DISCLAIMER, stdout);
+
+  exit (STATE_OK);
+}
+
+/* The attributes of an idle state read with sysfsparser_getvalues():
+   the counters first, saved between two executions, then the latency.  */
+enum cpuidle_attr
+{
+  CPUIDLE_USAGE,		/* number of times the state was entered */
+  CPUIDLE_TIME,			/* microseconds spent in the state */
+  CPUIDLE_COUNTERS,
+  CPUIDLE_LATENCY = CPUIDLE_COUNTERS,	/* exit latency, microseconds */
+  CPUIDLE_ATTRS
+};
+
+static const char *const cpuidle_attr_name[] = {
+  [CPUIDLE_USAGE] = "usage",
+  [CPUIDLE_TIME] = "time",
+  [CPUIDLE_LATENCY] = "latency"
+};
+
+typedef struct cpuidle_state
+{
+  char name[16];
+  unsigned long long attr[CPUIDLE_ATTRS];
+  double residency;		/* percentage of the time */
+  double wakeups;		/* exits per second */
+} cpuidle_state;
+
+typedef struct cpuidle_cpu
+{
+  unsigned int cpu;
+  unsigned long long socket;
+  size_t nstates;
+  cpuidle_state state[CPUIDLE_STATE_MAX];
+  double deep;			/* residency above the latency budget */
+  double wakeups;
+} cpuidle_cpu;
+
+/* Read the idle states of CPU.  The names, the latencies, and the socket
+   are only read if ALL is true, the counters are always read.  */
+
+static void
+cpuidle_read (cpuidle_cpu *cpu, bool all)
+{
+  char dir[PATH_MAX], path[PATH_MAX];
+  size_t nattrs = all ? CPUIDLE_ATTRS : CPUIDLE_COUNTERS, k;
+
+  if (all)
+    {
+      static const char *const package_id[] = { "physical_package_id" };
+
+      snprintf (dir, sizeof dir, PATH_SYS_CPU "/cpu%u/topology", cpu->cpu);
+      sysfsparser_getvalues (dir, package_id, &cpu->socket, 1);
+    }
+
+  for (k = 0; k < CPUIDLE_STATE_MAX; k++)
+    {
+      cpuidle_state *state = &cpu->state[k];
+
+      snprintf (dir, sizeof dir, PATH_SYS_CPU "/cpu%u/cpuidle/state%zu",
+		cpu->cpu, k);
+      if (all)
+	{
+	  snprintf (path, sizeof path,
+		    PATH_SYS_CPU "/cpu%u/cpuidle/state%zu/name", cpu->cpu, k);
+	  if (sysio_read (path, state->name, sizeof state->name) <= 0)
+	    break;
+	  state->name[strcspn (state->name, "\n")] = '\0';
+	}
+      else if (k == cpu->nstates)
+	break;
+
+      sysfsparser_getvalues (dir, cpuidle_attr_name, state->attr, nattrs);
+    }
+
+  if (all)
+    cpu->nstates = k;
+}
+
+/* Compute the residencies and the wakeups of CPU, whose counters were
+   PREV ELAPSED seconds ago, and the residency in the idle states with an
+   exit latency greater than LATENCY.  */
+
+static void
+cpuidle_compute (cpuidle_cpu *cpu,
+		 unsigned long long prev[][CPUIDLE_COUNTERS], double elapsed,
+		 unsigned long long latency)
+{
+  cpu->deep = cpu->wakeups = 0;
+
+  for (size_t k = 0; k < cpu->nstates; k++)
+    {
+      cpuidle_state *state = &cpu->state[k];
+      unsigned long long usage = state->attr[CPUIDLE_USAGE],
+	time = state->attr[CPUIDLE_TIME];
+
+      usage = (usage > prev[k][CPUIDLE_USAGE]) ?
+	usage - prev[k][CPUIDLE_USAGE] : 0;
+      time = (time > prev[k][CPUIDLE_TIME]) ? time - prev[k][CPUIDLE_TIME] : 0;
+
+      state->residency = time / (elapsed * 1e4);
+      state->wakeups = usage / elapsed;
+      cpu->wakeups += state->wakeups;
+      if (state->attr[CPUIDLE_LATENCY] > latency)
+	cpu->deep += state->residency;
+    }
+}
+
+static char *
+cpuidle_key (const cpuidle_cpu *cpu, size_t k)
+{
+  return xasprintf ("cpu%u/state%zu", cpu->cpu, k);
+}
+
+/* The CPUs, and the counters of their previous sample */
+
+struct cpuidle_sample
+{
+  cpuidle_cpu *cpus;
+  size_t ncpus;
+  unsigned long long (*prev)[CPUIDLE_STATE_MAX][CPUIDLE_COUNTERS];
+  bool resampled;
+};
+
+static void
+cpuidle_resample (void *data)
+{
+  struct cpuidle_sample *sample = data;
+
+  for (size_t i = 0; i < sample->ncpus; i++)
+    {
+      for (size_t k = 0; k < sample->cpus[i].nstates; k++)
+	memcpy (sample->prev[i][k], sample->cpus[i].state[k].attr,
+		sizeof (sample->prev[i][k]));
+      cpuidle_read (&sample->cpus[i], false);
+    }
+  sample->resampled = true;
+}
+
+/* Add the average residency and the total wakeups of each idle state of
+   the CPUs of SOCKET.  The CPUs of a socket have the same idle states.  */
+
+static void
+cpuidle_add_socket_metrics (struct metrics *metrics, const cpuidle_cpu *cpus,
+			    size_t ncpus, unsigned long long socket)
+{
+  struct metric metric = { .label = "socket", .precision = 2 };
+  const cpuidle_cpu *first = NULL;
+  char label[24], name[32];
+  size_t i, n = 0;
+
+  for (i = 0; i < ncpus; i++)
+    if (cpus[i].socket == socket)
+      {
+	if (NULL == first)
+	  first = &cpus[i];
+	n++;
+      }
+
+  snprintf (label, sizeof label, "socket%llu", socket);
+  metric.label_value = label;
+
+  for (size_t k = 0; k < first->nstates; k++)
+    {
+      double residency = 0, wakeups = 0;
+
+      for (i = 0; i < ncpus; i++)
+	if (cpus[i].socket == socket && k < cpus[i].nstates)
+	  {
+	    residency += cpus[i].state[k].residency;
+	    wakeups += cpus[i].state[k].wakeups;
+	  }
+
+      snprintf (name, sizeof name, "%s_residency", first->state[k].name);
+      metric.name = name;
+      metric.unit = "%";
+      metric.min = "0";
+      metric.max = "100";
+      metrics_add (metrics, &metric, residency / n);
+
+      snprintf (name, sizeof name, "%s_wakeups/s", first->state[k].name);
+      metric.unit = NULL;
+      metric.max = NULL;
+      metrics_add (metrics, &metric, wakeups);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  int c, ncpus;
+  char *critical = NULL, *warning = NULL, *message;
+  const char *cpulist = NULL;
+  nagstatus status = STATE_OK;
+  thresholds *my_threshold = NULL;
+  unsigned long delay, latency = 0;
+  cpu_set_t *cpuset;
+  size_t setsize, i, n = 0, worst = 0;
+  cpuidle_cpu *cpus;
+  unsigned long long (*prev)[CPUIDLE_STATE_MAX][CPUIDLE_COUNTERS];
+  struct statefile *state;
+  struct cpuidle_sample sample = { .resampled = false };
+  char **keys;
+  double elapsed;
+  size_t nkeys = 0;
+
+  set_program_name (argv[0]);
+  result_cache_init (argc, argv);
+
+  while ((c = getopt_long (argc, argv,
+			   "p:l:c:w:" GETOPT_HELP_VERSION_STRING,
+			   longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'p':
+	  cpulist = optarg;
+	  break;
+	case 'l':
+	  latency = strtol_or_err (optarg, "the latency must be an integer");
+	  break;
+	case 'c':
+	  critical = optarg;
+	  break;
+	case 'w':
+	  warning = optarg;
+	  break;
+
+	case_GETOPT_HELP_CHAR
+	case_GETOPT_VERSION_CHAR
+
+	}
+    }
+
+  delay = DELAY_DEFAULT;
+  if (optind < argc)
+    {
+      delay = strtol_or_err (argv[optind++], "failed to parse argument");
+
+      if (delay < 1)
+	plugin_error (STATE_UNKNOWN, 0, "delay must be positive integer");
+      else if (DELAY_MAX < delay)
+	plugin_error (STATE_UNKNOWN, 0,
+		      "too large delay value (greater than %d)", DELAY_MAX);
+    }
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  sysfsparser_check_for_sysfs ();
+
+  if (NULL == cpulist)
+    cpuset = get_cpulist ("online", &setsize, &ncpus);
+  else if (STREQ (cpulist, "isolated") || STREQ (cpulist, "nohz_full"))
+    cpuset = get_cpulist (cpulist, &setsize, &ncpus);
+  else
+    cpuset = cpulist_alloc (cpulist, &setsize, &ncpus);
+  if (NULL == cpuset)
+    plugin_error (STATE_UNKNOWN, 0, "invalid or unreadable cpu list: %s",
+		  cpulist ? cpulist : "online");
+  if (ncpus == 0)
+    plugin_error (STATE_UNKNOWN, 0, "no CPUs selected");
+
+  cpus = xnmalloc (ncpus, sizeof (cpuidle_cpu));
+  prev = xnmalloc (ncpus, sizeof (*prev));
+  for (unsigned int cpu = 0; cpu < 8 * setsize && n < (size_t) ncpus; cpu++)
+    {
+      if (!CPU_ISSET_S (cpu, setsize, cpuset))
+	continue;
+      cpus[n].cpu = cpu;
+      cpuidle_read (&cpus[n], true);
+      /* offline CPUs and CPUs without cpuidle driver */
+      if (cpus[n].nstates > 0)
+	n++;
+    }
+  CPU_FREE (cpuset);
+  if (0 == n)
+    plugin_error (STATE_UNKNOWN, 0,
+		  "no idle state information found for the selected CPUs");
+
+  /* the samples saved for the same selection of CPUs, if all there */
+  state = statefile_open (cpulist ? cpulist : "online", CPUIDLE_COUNTERS);
+  keys = xnmalloc (n * CPUIDLE_STATE_MAX, sizeof (char *));
+  for (i = 0; i < n; i++)
+    for (size_t k = 0; k < cpus[i].nstates; k++)
+      keys[nkeys++] = cpuidle_key (&cpus[i], k);
+
+  sample.cpus = cpus;
+  sample.ncpus = n;
+  sample.prev = prev;
+  elapsed = statefile_sample (state, delay, (const char *const *) keys,
+			      nkeys, cpuidle_resample, &sample);
+
+  nkeys = 0;
+  for (i = 0; i < n; i++)
+    {
+      nagstatus s;
+
+      for (size_t k = 0; k < cpus[i].nstates; k++, nkeys++)
+	{
+	  if (!sample.resampled)
+	    memcpy (prev[i][k], statefile_get (state, keys[nkeys]),
+		    sizeof (prev[i][k]));
+	  statefile_put (state, keys[nkeys], cpus[i].state[k].attr);
+	  free (keys[nkeys]);
+	}
+
+      cpuidle_compute (&cpus[i], prev[i], elapsed, latency);
+      if (cpus[i].deep > cpus[worst].deep)
+	worst = i;
+      s = get_status (cpus[i].deep, my_threshold);
+      if (status < s)
+	status = s;
+    }
+  free (keys);
+  if (statefile_save (state) < 0)
+    dbg ("cannot save the state: %s\n", strerror (errno));
+  statefile_free (state);
+
+  struct metrics *metrics = metrics_new (program_name_short, 2 * n + 32);
+  struct metric metric = { .label = "cpu", .precision = 2 };
+  char label[16];
+
+  for (i = 0; i < n; i++)
+    {
+      bool seen = false;
+
+      /* once per socket */
+      for (size_t j = 0; j < i && !seen; j++)
+	seen = (cpus[j].socket == cpus[i].socket);
+      if (!seen)
+	cpuidle_add_socket_metrics (metrics, cpus, n, cpus[i].socket);
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      snprintf (label, sizeof label, "cpu%u", cpus[i].cpu);
+      metric.label_value = label;
+      metric.name = "deep_residency";
+      metric.unit = "%";
+      metric.warning = warning;
+      metric.critical = critical;
+      metric.min = "0";
+      metric.max = "100";
+      metrics_add (metrics, &metric, cpus[i].deep);
+
+      metric.name = "wakeups/s";
+      metric.unit = NULL;
+      metric.warning = metric.critical = metric.max = NULL;
+      metrics_add (metrics, &metric, cpus[i].wakeups);
+    }
+
+  message =
+    xasprintf ("%s %s - %zu CPUs, time in the idle states with exit latency "
+	       "above %luus: %.2lf%% (cpu%u)", program_name_short,
+	       state_text (status), n, latency, cpus[worst].deep,
+	       cpus[worst].cpu);
+  metrics_write (metrics, status, message);
+  free (message);
+
+  free (prev);
+  free (cpus);
+  free (my_threshold);
+
+  return status;
+}
@@ -29,9 +29,12 @@
 #include "common.h"
 #include "cpustats.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
+#include "xasprintf.h"
 #include "xstrton.h"
 
 static const char *program_copyright =
@@ -123,6 +126,7 @@ main (int argc, char **argv)
   unsigned long long dnctxt;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "c:w:v" GETOPT_HELP_VERSION_STRING,
@@ -178,9 +182,17 @@ main (int argc, char **argv)
   free (my_threshold);
 
   char *time_unit = (count > 1) ? "/s" : "";
-  printf ("%s %s - number of context switches%s %llu | cswch%s=%llu\n",
-	  program_name_short, state_text (status),
-	  time_unit, dnctxt, time_unit, dnctxt);
+  char *name = xasprintf ("cswch%s", time_unit);
+  struct metrics *metrics = metrics_new (program_name_short, 1);
+  struct metric metric = { .name = name };
+  metrics_add (metrics, &metric, dnctxt);
+
+  char *status_msg =
+    xasprintf ("%s %s - number of context switches%s %llu",
+	       program_name_short, state_text (status), time_unit, dnctxt);
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
+  free (name);
 
   return status;
 }
@@ -31,8 +31,10 @@
 #include "container_docker.h"
 #include "logging.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
 #include "units.h"
 #include "xalloc.h"
@@ -112,13 +114,15 @@ main (int argc, char **argv)
        verbose = false;
   char *image = NULL;
   char *critical = NULL, *warning = NULL;
-  char *status_msg, *perfdata_msg;
+  char *status_msg, *message;
   char *units = NULL;
   nagstatus status = STATE_OK;
   thresholds *my_threshold = NULL;
   unsigned long delay = DELAY_DEFAULT;
+  struct metrics *metrics;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "c:w:vi:Mbkmg" GETOPT_HELP_VERSION_STRING,
@@ -173,6 +177,7 @@ main (int argc, char **argv)
   if (status == NP_RANGE_UNPARSEABLE)
     usage (stderr);
 
+  metrics = metrics_new (program_name_short, 8);
   if (check_memory)
     {
       int err;
@@ -232,25 +237,42 @@ main (int argc, char **argv)
 	xasprintf ("%s: %llu %s memory used", state_text (status),
 		   UNIT_STR (kb_memory_used_total));
 
-      perfdata_msg =
-	xasprintf ("cache=%llu%s rss=%llu%s swap=%llu%s unevictable=%llu%s "
-		   "pgfault=%lld pgmajfault=%lld "
-		   "pgpgin=%lld pgpgout=%lld"
-		   , UNIT_STR (kb_total_cache)
-		   , UNIT_STR (kb_total_rss)
-		   , UNIT_STR (kb_total_swap)
-		   , UNIT_STR (kb_total_unevictable)
-		   , pgfault[1] - pgfault[0]
-		   , pgmajfault[1] - pgmajfault[0]
-		   , pgpgin[1] - pgpgin[0]
-		   , pgpgout[1] - pgpgout[0]);
+      const struct
+      {
+	const char *name;
+	long long value;
+      } sizes[] = {
+	{ "cache", kb_total_cache },
+	{ "rss", kb_total_rss },
+	{ "swap", kb_total_swap },
+	{ "unevictable", kb_total_unevictable }
+      }, counters[] = {
+	{ "pgfault", pgfault[1] - pgfault[0] },
+	{ "pgmajfault", pgmajfault[1] - pgmajfault[0] },
+	{ "pgpgin", pgpgin[1] - pgpgin[0] },
+	{ "pgpgout", pgpgout[1] - pgpgout[0] }
+      };
+      struct metric metric = { .unit = units };
+
+      for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+	{
+	  metric.name = sizes[i].name;
+	  metrics_add (metrics, &metric,
+		       UNIT_CONVERT (sizes[i].value, shift));
+	}
+      metric.unit = NULL;
+      for (size_t i = 0; i < sizeof (counters) / sizeof (counters[0]); i++)
+	{
+	  metric.name = counters[i].name;
+	  metrics_add (metrics, &metric, counters[i].value);
+	}
 
       docker_memory_desc_unref (memdesc);
     }
   else
     {
       unsigned int containers;
-      docker_running_containers (&containers, image, &perfdata_msg, verbose);
+      docker_running_containers (&containers, image, metrics, verbose);
       status = get_status (containers, my_threshold);
       status_msg = image ?
        xasprintf ("%s: %u running container(s) of type \"%s\"",
@@ -259,8 +281,11 @@ main (int argc, char **argv)
                   containers);
     }
 
-  printf ("%s%s %s | %s\n", program_name_short,
-	  check_memory ? " memory" : " containers", status_msg, perfdata_msg);
+  message = xasprintf ("%s%s %s", program_name_short,
+		       check_memory ? " memory" : " containers", status_msg);
+  metrics_write (metrics, status, message);
+  free (message);
+  free (status_msg);
 
   free (my_threshold);
   return status;
@@ -34,10 +34,14 @@
 #include "logging.h"
 #include "string-macros.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "sysfsparser.h"
 #include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
 #include "xstrton.h"
 
 static const char *program_copyright =
@@ -75,6 +79,8 @@ usage (FILE * out)
   fprintf (out, "  count is the number of updates "
 	   "(default: %d)\n", COUNT_DEFAULT);
   fputs ("\t1 means the total inbound/outbound traffic from boottime.\n", out);
+  fputs ("  The per-port rates and link utilization are reported when count "
+	 "is at least 2.\n", out);
   fputs (USAGE_EXAMPLES, out);
   fprintf (out, "  %s -c 2:\n", program_name);
   fprintf (out, "  %s -i -v\n", program_name);
@@ -98,7 +104,7 @@ print_version (void)
 void
 fc_host_summary (bool verbose)
 {
-  DIR *dirp;
+  struct sysio_dir *dirp;
   struct dirent *dp;
   char *line, path[PATH_MAX];
 
@@ -107,7 +113,7 @@ fc_host_summary (bool verbose)
   /* Scan entries under /sys/class/fc_host directory */
   while ((dp = sysfsparser_readfilename(dirp, DT_DIR | DT_LNK)))
     {
-      DIR *dirp_host;
+      struct sysio_dir *dirp_host;
       struct dirent *dp_host;
 
       printf ("Class Device = \"%s\"\n", dp->d_name);
@@ -142,100 +148,195 @@ fc_host_summary (bool verbose)
   sysfsparser_closedir (dirp);
 }
 
-static uint64_t
-fc_host_get_statistic (const char *which, const char *host)
+/* The statistics of the fc_host class, see
+   <https://www.kernel.org/doc/Documentation/scsi/scsi_fc_transport.txt> */
+enum fc_stat
 {
-  uint64_t value =
-    sysfsparser_getvalue (PATH_SYS_FC_HOST "/%s/statistics/%s", host, which);
+  FC_RX_FRAMES,
+  FC_TX_FRAMES,
+  FC_RX_WORDS,
+  FC_TX_WORDS,
+  FC_ERROR_FRAMES,
+  FC_INVALID_CRC_COUNT,
+  FC_LINK_FAILURE_COUNT,
+  FC_LOSS_OF_SIGNAL_COUNT,
+  FC_LOSS_OF_SYNC_COUNT,
+  FC_STAT_COUNT
+};
 
-  dbg (PATH_SYS_FC_HOST "/%s/statistics/%s = %llu\n",
-       host, which, (unsigned long long)value);
+static const char *const fc_stat_name[FC_STAT_COUNT] = {
+  [FC_RX_FRAMES] = "rx_frames",
+  [FC_TX_FRAMES] = "tx_frames",
+  [FC_RX_WORDS] = "rx_words",
+  [FC_TX_WORDS] = "tx_words",
+  [FC_ERROR_FRAMES] = "error_frames",
+  [FC_INVALID_CRC_COUNT] = "invalid_crc_count",
+  [FC_LINK_FAILURE_COUNT] = "link_failure_count",
+  [FC_LOSS_OF_SIGNAL_COUNT] = "loss_of_signal_count",
+  [FC_LOSS_OF_SYNC_COUNT] = "loss_of_sync_count"
+};
 
-  return value;
-}
+typedef struct fc_port
+{
+  char *name;			/* "host0", ... */
+  char *statdir;		/* the directory of the statistics */
+  bool online;
+  unsigned long long speed;	/* nominal throughput in words/s, or 0 */
+  unsigned long long sample[2][FC_STAT_COUNT];
+  unsigned long long delta[FC_STAT_COUNT];
+} fc_port;
+
+/* Return the nominal data throughput, in 4-byte words per second, of a
+   port with the given speed ("8 Gbit", "16 Gbit", ...).  The FC speeds
+   are named after the data rate: each Gbit carries 100 MB/s of data,
+   whatever the line encoding (8b/10b or 64b/66b).  */
+
+static unsigned long long
+fc_port_speed (const char *speed)
+{
+  unsigned long long gbit;
+  char *endptr;
 
-#define fc_get_stat(name)                         \
-static uint64_t fc_stat_##name(const char *host)  \
-{                                                 \
-  return fc_host_get_statistic (#name, host);     \
+  errno = 0;
+  gbit = strtoull (speed, &endptr, 10);
+  if (endptr == speed || errno || !STRPREFIX (endptr, " Gbit"))
+    return 0;
+
+  return gbit * 100 * 1000 * 1000 / 4;
 }
-fc_get_stat(rx_frames);
-fc_get_stat(tx_frames);
-fc_get_stat(error_frames);
-fc_get_stat(invalid_crc_count);
-fc_get_stat(link_failure_count);
-fc_get_stat(loss_of_signal_count);
-fc_get_stat(loss_of_sync_count);
-
-/* see <http://osxr.org/linux/source/drivers/scsi/scsi_transport_fc.c> */
-typedef struct fc_host_statistics {
-  uint64_t rx_frames;
-  uint64_t tx_frames;
-  uint64_t error_frames;
-  uint64_t invalid_crc_count;
-  uint64_t link_failure_count;
-  uint64_t loss_of_signal_count;
-  uint64_t loss_of_sync_count;
-} fc_host_statistics;
 
-static void
-fc_host_status (int *n_ports, int *n_online, fc_host_statistics *stats,
-		unsigned int delay, unsigned int count)
+/* Find the fc_host ports and read their state and speed.  */
+
+static fc_port *
+fc_host_ports (size_t *nports)
 {
-  DIR *dirp;
+  struct sysio_dir *dirp;
   struct dirent *dp;
-  char path[PATH_MAX];
-  uint64_t drx_frames_tot = 0, dtx_frames_tot = 0;
+  char path[PATH_MAX], buf[64];
+  fc_port *ports = NULL;
+  size_t size = 0;
 
-  *n_ports = *n_online = 0;
+  *nports = 0;
   sysfsparser_opendir(&dirp, PATH_SYS_FC_HOST);
 
   /* Scan entries under /sys/class/fc_host directory */
   while ((dp = sysfsparser_readfilename(dirp, DT_DIR | DT_LNK)))
     {
-      (*n_ports)++;
+      fc_port *port;
+
+      if (*nports == size)
+	ports = xrealloc (ports, (size = size ? 2 * size : 8)
+			  * sizeof (fc_port));
+      port = &ports[(*nports)++];
+      memset (port, 0, sizeof (fc_port));
+
+      port->name = xstrdup (dp->d_name);
+      port->statdir =
+	xasprintf ("%s/%s/statistics", PATH_SYS_FC_HOST, dp->d_name);
+
       snprintf (path, PATH_MAX, "%s/%s/port_state",
 		PATH_SYS_FC_HOST, dp->d_name);
+      if (sysio_read (path, buf, sizeof buf) > 0)
+	port->online = STRPREFIX (buf, "Online");
 
-      char *line = sysfsparser_getline ("%s", path);
-      if (STREQ (line, "Online"))
-	(*n_online)++;
+      snprintf (path, PATH_MAX, "%s/%s/speed", PATH_SYS_FC_HOST, dp->d_name);
+      if (sysio_read (path, buf, sizeof buf) > 0)
+	port->speed = fc_port_speed (buf);
 
-      free (line);
+      dbg ("%s: online: %d, speed: %llu words/s\n",
+	   port->name, port->online, port->speed);
+    }
 
-      /* collect some statistics */
-      uint64_t rx_frames[2], tx_frames[2];
-      unsigned int i, tog = 0;
+  sysfsparser_closedir (dirp);
+  return ports;
+}
 
-      stats->rx_frames = rx_frames[0] = fc_stat_rx_frames (dp->d_name);
-      stats->tx_frames = tx_frames[0] = fc_stat_tx_frames (dp->d_name);
+/* Sample the statistics of all the ports COUNT times, DELAY seconds apart,
+   and compute the variations between the last two samples.  When COUNT is
+   1, the variations are the counters themselves (the totals since boot).  */
 
-      for (i = 1; i < count; i++)
-	{
-	  sleep (delay);
-	  tog = !tog;
+static void
+fc_host_sample (fc_port *ports, size_t nports, unsigned int delay,
+		unsigned int count)
+{
+  unsigned int i, tog = 0;
+  size_t p, j;
 
-	  rx_frames[tog] = fc_stat_rx_frames (dp->d_name);
-	  stats->rx_frames = rx_frames[tog] - rx_frames[!tog];
-	  tx_frames[tog] = fc_stat_tx_frames (dp->d_name);
-	  stats->tx_frames = tx_frames[tog] - tx_frames[!tog];
-	}
+  for (p = 0; p < nports; p++)
+    sysfsparser_getvalues (ports[p].statdir, fc_stat_name,
+			   ports[p].sample[0], FC_STAT_COUNT);
 
-	drx_frames_tot += stats->rx_frames;
-	dtx_frames_tot += stats->tx_frames;
+  /* a single wait for all the ports */
+  for (i = 1; i < count; i++)
+    {
+      sleep (delay);
+      tog = !tog;
+      for (p = 0; p < nports; p++)
+	sysfsparser_getvalues (ports[p].statdir, fc_stat_name,
+			       ports[p].sample[tog], FC_STAT_COUNT);
+    }
+
+  for (p = 0; p < nports; p++)
+    for (j = 0; j < FC_STAT_COUNT; j++)
+      ports[p].delta[j] = (count > 1) ?
+	ports[p].sample[tog][j] - ports[p].sample[!tog][j] :
+	ports[p].sample[tog][j];
+}
 
-	stats->error_frames += fc_stat_error_frames (dp->d_name);
-	stats->invalid_crc_count += fc_stat_invalid_crc_count (dp->d_name);
-	stats->link_failure_count += fc_stat_link_failure_count (dp->d_name);
-	stats->loss_of_signal_count +=
-	  fc_stat_loss_of_signal_count (dp->d_name);
-	stats->loss_of_sync_count += fc_stat_loss_of_sync_count (dp->d_name);
+/* Add the per-second rates of the port PORT.  */
+
+static void
+fc_port_add_metrics (struct metrics *metrics, const fc_port *port,
+		     unsigned int delay)
+{
+  static const struct
+  {
+    const char *name;
+    enum fc_stat stat;
+    int precision;
+  } rates[] = {
+    { "rx_words/s", FC_RX_WORDS, 0 },
+    { "tx_words/s", FC_TX_WORDS, 0 },
+    { "rx_frames/s", FC_RX_FRAMES, 0 },
+    { "tx_frames/s", FC_TX_FRAMES, 0 },
+    { "error_frames/s", FC_ERROR_FRAMES, 2 },
+    { "invalid_crc/s", FC_INVALID_CRC_COUNT, 2 },
+    { "link_failure/s", FC_LINK_FAILURE_COUNT, 2 }
+  };
+  struct metric metric = { .label = "host", .label_value = port->name };
+  char *max = NULL;
+  size_t i;
+
+  if (port->speed > 0)
+    max = xasprintf ("%llu", port->speed);
+
+  for (i = 0; i < sizeof (rates) / sizeof (rates[0]); i++)
+    {
+      metric.name = rates[i].name;
+      metric.precision = rates[i].precision;
+      metric.min = (rates[i].stat == FC_RX_WORDS
+		    || rates[i].stat == FC_TX_WORDS) ? "0" : NULL;
+      metric.max = metric.min ? max : NULL;
+      metrics_add (metrics, &metric,
+		   (double) port->delta[rates[i].stat] / delay);
     }
 
-  sysfsparser_closedir (dirp);
+  /* the utilization of the busiest direction */
+  if (port->speed > 0)
+    {
+      unsigned long long rx = port->delta[FC_RX_WORDS],
+	tx = port->delta[FC_TX_WORDS], words = (rx > tx) ? rx : tx;
+
+      metric.name = "util";
+      metric.unit = "%";
+      metric.precision = 1;
+      metric.min = "0";
+      metric.max = "100";
+      metrics_add (metrics, &metric,
+		   100.0 * words / delay / port->speed);
+    }
 
-  stats->rx_frames = drx_frames_tot;
-  stats->tx_frames = dtx_frames_tot;
+  free (max);
 }
 
 #undef PATH_SYS_FC
@@ -244,7 +345,7 @@ fc_host_status (int *n_ports, int *n_online, fc_host_statistics *stats,
 int
 main (int argc, char **argv)
 {
-  int c, n_ports, n_online;
+  int c;
   bool verbose = false, summary = false;
   char *critical = NULL, *warning = NULL;
   nagstatus status = STATE_OK;
@@ -252,6 +353,7 @@ main (int argc, char **argv)
   unsigned long count, delay;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "c:w:vi" GETOPT_HELP_VERSION_STRING,
@@ -313,28 +415,51 @@ main (int argc, char **argv)
   if (status == NP_RANGE_UNPARSEABLE)
     usage (stderr);
 
-  fc_host_statistics stats = {0};
+  size_t nports, p, j;
+  fc_port *ports = fc_host_ports (&nports);
+  unsigned long long total[FC_STAT_COUNT] = { 0 };
+  int n_online = 0;
+
+  fc_host_sample (ports, nports, delay, count);
 
-  fc_host_status (&n_ports, &n_online, &stats, delay, count);
+  for (p = 0; p < nports; p++)
+    {
+      if (ports[p].online)
+	n_online++;
+      for (j = 0; j < FC_STAT_COUNT; j++)
+	total[j] += ports[p].delta[j];
+    }
   status = get_status (n_online, my_threshold);
 
-  printf ("%s %s - Fiber Channel ports status: %d/%d Online "
-	  "| rx_frames=%llu tx_frames=%llu"
-	  " error_frames=%llu"
-	  " invalid_crc_count=%llu"
-	  " link_failure_count=%llu"
-	  " loss_of_signal_count=%llu"
-	  " loss_of_sync_count=%llu\n",
-	  program_name_short, state_text (status),
-	  n_online, n_ports,
-	  (unsigned long long) stats.rx_frames,
-	  (unsigned long long) stats.tx_frames,
-	  (unsigned long long) stats.error_frames,
-	  (unsigned long long) stats.invalid_crc_count,
-	  (unsigned long long) stats.link_failure_count,
-	  (unsigned long long) stats.loss_of_signal_count,
-	  (unsigned long long) stats.loss_of_sync_count
-  );
+  struct metrics *metrics =
+    metrics_new (program_name_short, FC_STAT_COUNT + 8 * nports);
+  struct metric metric = { 0 };
+
+  /* the frames and the errors of all the ports during the sampling period
+     (since boot if count is 1) */
+  for (j = 0; j < FC_STAT_COUNT; j++)
+    if (j != FC_RX_WORDS && j != FC_TX_WORDS)
+      {
+	metric.name = fc_stat_name[j];
+	metrics_add (metrics, &metric, total[j]);
+      }
+
+  if (count > 1)
+    for (p = 0; p < nports; p++)
+      fc_port_add_metrics (metrics, &ports[p], delay);
+
+  char *message =
+    xasprintf ("%s %s - Fiber Channel ports status: %d/%zu Online",
+	       program_name_short, state_text (status), n_online, nports);
+  metrics_write (metrics, status, message);
+  free (message);
+
+  for (p = 0; p < nports; p++)
+    {
+      free (ports[p].name);
+      free (ports[p].statdir);
+    }
+  free (ports);
 
   return status;
 }
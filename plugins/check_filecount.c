@@ -31,9 +31,12 @@
 #include "files.h"
 #include "logging.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
+#include "xasprintf.h"
 #include "xstrton.h"
 
 static const char *program_copyright =
@@ -149,17 +152,16 @@ main (int argc, char **argv)
 {
   int c, i, ret;
   bool verbose = false;
-  char *bp, *critical = NULL, *warning = NULL,
+  char *critical = NULL, *warning = NULL,
        *errmesg_fage = NULL, *errmesg_fsize = NULL,
        *pattern = NULL;
   int64_t fileage = 0, filesize = 0;
-  size_t size;
   unsigned int filecount_flags = FILES_DEFAULT;
-  FILE *perfdata;
   nagstatus status = STATE_OK;
   thresholds *my_threshold = NULL;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "c:fHln:rs:t:uvw:" GETOPT_HELP_VERSION_STRING,
@@ -221,7 +223,8 @@ main (int argc, char **argv)
     usage (stderr);
 
   struct files_types *filecount;
-  perfdata = open_memstream (&bp, &size);
+  struct metrics *metrics = metrics_new (program_name_short,
+					 7 * (argc - optind));
   int64_t total = 0;
 
   for (i = optind; i < argc; ++i)
@@ -244,40 +247,46 @@ main (int argc, char **argv)
       filecount = NULL;
       ret = files_filecount (argv[i], filecount_flags,
 			     fileage, filesize, pattern, &filecount);
-      if (ret < 0)
-	plugin_error (STATE_UNKNOWN, errno, "Cannot open %s", argv[i]);
-
-      fprintf (perfdata, "%s_total=%lu ", argv[i],
-	       (unsigned long)filecount->total);
-
-      if (!(filecount_flags & FILES_REGULAR_ONLY))
-	fprintf (perfdata, "%s_directory=%lu ", argv[i],
-		 (unsigned long)filecount->directory);
-
-      if (filecount_flags & FILES_INCLUDE_HIDDEN)
-	fprintf (perfdata, "%s_hidden=%lu ", argv[i],
-		 (unsigned long)filecount->hidden);
-
-      fprintf (perfdata, "%s_regular=%lu ", argv[i],
-	       (unsigned long)filecount->regular_file);
-
-      if (!(filecount_flags & FILES_REGULAR_ONLY))
-	fprintf (perfdata, "%s_special=%lu ",
-		 argv[i], (unsigned long)filecount->special_file);
-
-      if (!(filecount_flags & (FILES_IGNORE_SYMLINKS | FILES_REGULAR_ONLY)))
-	fprintf (perfdata, "%s_symlink=%lu ", argv[i],
-		 (unsigned long)filecount->symlink);
+      switch (ret)
+	{
+	case FILES_ERROR_OPENDIR:
+	  plugin_error (STATE_UNKNOWN, errno, "Cannot open %s", argv[i]);
+	case FILES_ERROR_READDIR:
+	  plugin_error (STATE_UNKNOWN, errno, "readdir() failure in %s",
+			argv[i]);
+	case FILES_ERROR_LSTAT:
+	  plugin_error (STATE_UNKNOWN, errno, "lstat() failure in %s",
+			argv[i]);
+	}
 
-      fprintf (perfdata, "%s_unknown=%lu ", argv[i],
-	       (unsigned long)filecount->unknown);
+      const struct { const char *name; int64_t value; bool show; }
+      samples[] = {
+	{ "total", filecount->total, true },
+	{ "directory", filecount->directory,
+	  !(filecount_flags & FILES_REGULAR_ONLY) },
+	{ "hidden", filecount->hidden,
+	  filecount_flags & FILES_INCLUDE_HIDDEN },
+	{ "regular", filecount->regular_file, true },
+	{ "special", filecount->special_file,
+	  !(filecount_flags & FILES_REGULAR_ONLY) },
+	{ "symlink", filecount->symlink,
+	  !(filecount_flags & (FILES_IGNORE_SYMLINKS | FILES_REGULAR_ONLY)) },
+	{ "unknown", filecount->unknown, true }
+      };
+
+      for (size_t j = 0; j < sizeof (samples) / sizeof (samples[0]); j++)
+	if (samples[j].show)
+	  {
+	    struct metric metric = {
+	      .name = samples[j].name, .label = "dir", .label_value = argv[i]
+	    };
+	    metrics_add (metrics, &metric, samples[j].value);
+	  }
 
       total += filecount->total;
       free (filecount);
     }
 
-  fclose (perfdata);
-
   status = set_thresholds (&my_threshold, warning, critical);
   if (status == NP_RANGE_UNPARSEABLE)
     usage (stderr);
@@ -285,8 +294,11 @@ main (int argc, char **argv)
   status = get_status (total, my_threshold);
   free (my_threshold);
 
-  printf ("%s %s - total number of files: %lu | %s\n",
-	  program_name_short, state_text (status), (unsigned long)total, bp);
+  char *status_msg = xasprintf ("%s %s - total number of files: %lu",
+				program_name_short, state_text (status),
+				(unsigned long)total);
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
 
   return status;
 }
@@ -0,0 +1,485 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A Nagios plugin that checks the log forces and the buffer misses of the
+ * XFS file systems and the errors of the ext4 ones.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "fsstats.h"
+#include "logging.h"
+#include "messages.h"
+#include "metrics.h"
+#include "mountlist.h"
+#include "progname.h"
+#include "progversion.h"
+#include "result_cache.h"
+#include "statefile.h"
+#include "string-macros.h"
+#include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+#include "xstrton.h"
+
+/* The key of the global XFS statistics, the mount points starting by '/' */
+#define FSSTATS_GLOBAL  "xfs"
+
+static const char *program_copyright =
+  "Copyright (C) 2026 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
+
+static struct option const longopts[] = {
+  {(char *) "mountpoint", required_argument, NULL, 'm'},
+  {(char *) "type", required_argument, NULL, 'T'},
+  {(char *) "global", no_argument, NULL, 'g'},
+  {(char *) "log-forces", required_argument, NULL, 'l'},
+  {(char *) "buf-misses", required_argument, NULL, 'b'},
+  {(char *) "errors", required_argument, NULL, 'e'},
+  {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
+  {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
+  {NULL, 0, NULL, 0}
+};
+
+static _Noreturn void
+usage (FILE * out)
+{
+  fprintf (out, "%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs ("This plugin checks the log forces and the buffer misses of the XFS "
+	 "file systems\nand the errors of the ext4 ones.\n", out);
+  fputs (program_copyright, out);
+  fputs (USAGE_HEADER, out);
+  fprintf (out, "  %s [-m DIR]... [-T TYPE] [-g] [-l COUNTER,COUNTER] "
+	   "[-b COUNTER,COUNTER]\n"
+	   "     [-e COUNTER,COUNTER] [delay]\n", program_name);
+  fputs (USAGE_OPTIONS, out);
+  fputs ("  -m, --mountpoint DIR   only check the file system mounted on "
+	 "DIR\n", out);
+  fputs ("  -T, --type=TYPE   only check the file systems of type TYPE "
+	 "(xfs or ext4)\n", out);
+  fputs ("  -g, --global    also check the statistics of all the XFS file "
+	 "systems\n", out);
+  fputs ("  -l, --log-forces=COUNTER,COUNTER   warning and critical "
+	 "thresholds on the\n"
+	 "                  XFS log forces per second\n", out);
+  fputs ("  -b, --buf-misses=COUNTER,COUNTER   warning and critical "
+	 "thresholds on the\n"
+	 "                  XFS buffers per second not found in memory\n", out);
+  fputs ("  -e, --errors=COUNTER,COUNTER   warning and critical thresholds "
+	 "on the new\n"
+	 "                  ext4 errors\n", out);
+  fputs (USAGE_HELP, out);
+  fputs (USAGE_VERSION, out);
+  fprintf (out, "  \"delay\" is the delay in seconds between two samples of "
+	   "the counters\n"
+	   "    (default: %dsec)\n", DELAY_DEFAULT);
+  fputs (USAGE_NOTE, out);
+  fputs ("  The statistics are read from /sys/fs/xfs/DEV/stats/stats "
+	 "(Linux 4.4+),\n"
+	 "  /proc/fs/xfs/stat (with --global), and /sys/fs/ext4/DEV.  The "
+	 "new ext4 errors\n"
+	 "  are the ones recorded in the superblock since the last "
+	 "sample.\n", out);
+  fputs (USAGE_STATEFILE, out);
+  fputs (USAGE_EXAMPLES, out);
+  fprintf (out, "  %s -T xfs --log-forces 500,2000 --buf-misses 1000,5000\n",
+	   program_name);
+  fprintf (out, "  %s --mountpoint /var/lib/pgsql --errors 1,1\n",
+	   program_name);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static _Noreturn void
+print_version (void)
+{
+  printf ("%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs (program_copyright, stdout);
+  fputs (GPLv3_DISCLAIMER, stdout);
+
+  exit (STATE_OK);
+}
+
+/* A XFS or ext4 file system, or the global XFS statistics */
+
+struct fs
+{
+  const char *mountdir;		/* the first mount point, or FSSTATS_GLOBAL */
+  char name[NAME_MAX + 1];	/* the name of the device in sysfs */
+  bool xfs;
+  bool selected;
+  unsigned long long counters[FSSTATS_COUNTERS];
+  unsigned long long first[FSSTATS_COUNTERS];
+  double rates[FSSTATS_COUNTERS];
+};
+
+static int
+fs_read (const struct fs *fs, unsigned long long *counters)
+{
+  if (STREQ (fs->mountdir, FSSTATS_GLOBAL))
+    return fsstats_xfs_read (NULL, counters);
+  return fs->xfs ? fsstats_xfs_read (fs->name, counters)
+    : fsstats_ext4_read (fs->name, counters);
+}
+
+/* Return the XFS and ext4 file systems of MOUNT_LIST with some statistics,
+   the ones mounted more than once being listed only once.  */
+
+static struct fs *
+fs_list (const struct mount_entry *mount_list, const struct mount_filter
+	 *filter, char **mountdirs, size_t nmountdirs, bool global,
+	 size_t *nfs)
+{
+  const struct mount_entry *me;
+  struct fs *fs = NULL;
+  size_t i, j;
+
+  *nfs = 0;
+  for (me = mount_list; me; me = me->me_next)
+    {
+      bool xfs = STREQ (me->me_type, "xfs");
+      char name[NAME_MAX + 1];
+
+      if (!xfs && STRNEQ (me->me_type, "ext4"))
+	continue;
+
+      fsstats_devname (me->me_devname, name, sizeof name);
+      for (i = 0; i < *nfs; i++)
+	if (STREQ (fs[i].name, name))
+	  break;
+      if (i < *nfs)
+	continue;
+
+      fs = xrealloc (fs, (*nfs + 1) * sizeof (struct fs));
+      memset (&fs[*nfs], 0, sizeof (struct fs));
+      fs[*nfs].mountdir = me->me_mountdir;
+      memcpy (fs[*nfs].name, name, sizeof name);
+      fs[*nfs].xfs = xfs;
+      if (fs_read (&fs[*nfs], fs[*nfs].counters) < 0)
+	{
+	  dbg ("no statistics for %s (%s)\n", me->me_mountdir, name);
+	  continue;
+	}
+
+      for (j = 0; j < nmountdirs; j++)
+	if (STREQ (mountdirs[j], me->me_mountdir))
+	  break;
+      fs[*nfs].selected = !mount_filter_skip (filter, me)
+	&& (nmountdirs == 0 || j < nmountdirs);
+      (*nfs)++;
+    }
+
+  if (global)
+    {
+      fs = xrealloc (fs, (*nfs + 1) * sizeof (struct fs));
+      memset (&fs[*nfs], 0, sizeof (struct fs));
+      fs[*nfs].mountdir = FSSTATS_GLOBAL;
+      fs[*nfs].xfs = true;
+      fs[*nfs].selected = true;
+      if (fs_read (&fs[*nfs], fs[*nfs].counters) < 0)
+	plugin_error (STATE_UNKNOWN, errno,
+		      "cannot read the XFS statistics (is xfs loaded?)");
+      (*nfs)++;
+    }
+
+  return fs;
+}
+
+/* The key of the counters of FS in the state file.  */
+
+static const char *
+fs_key (const struct fs *fs)
+{
+  return STREQ (fs->mountdir, FSSTATS_GLOBAL) ? FSSTATS_GLOBAL : fs->name;
+}
+
+/* The file systems sampled, and whether they have been sampled twice */
+
+struct fs_sample
+{
+  struct fs *fs;
+  size_t nfs;
+  bool resampled;
+};
+
+static void
+fs_resample (void *data)
+{
+  struct fs_sample *sample = data;
+  struct fs *fs = sample->fs;
+
+  for (size_t i = 0; i < sample->nfs; i++)
+    {
+      memcpy (fs[i].first, fs[i].counters, sizeof (fs[i].first));
+      if (fs_read (&fs[i], fs[i].counters) < 0)
+	plugin_error (STATE_UNKNOWN, errno,
+		      "cannot read the statistics of %s", fs[i].mountdir);
+    }
+  sample->resampled = true;
+}
+
+/* Compute the rates of the file systems, comparing the counters with the
+   ones saved by the last execution or, if missing or too recent, with a
+   second sample taken after DELAY seconds.  The ext4 errors are not
+   divided by the time elapsed.  */
+
+static void
+fs_rates (struct fs *fs, size_t nfs, unsigned long delay)
+{
+  struct fs_sample sample = { fs, nfs, false };
+  struct statefile *state;
+  const unsigned long long *prev;
+  const char **keys;
+  double elapsed;
+  size_t i, k;
+
+  /* the counters of all the file systems are saved, so that the checks of
+     different file systems do not discard the samples of each other */
+  state = statefile_open ("fsstats", FSSTATS_COUNTERS);
+  keys = xnmalloc (nfs ? nfs : 1, sizeof (const char *));
+  for (i = 0; i < nfs; i++)
+    keys[i] = fs[i].selected ? fs_key (&fs[i]) : NULL;
+  elapsed = statefile_sample (state, delay, keys, nfs, fs_resample, &sample);
+  free (keys);
+
+  for (i = 0; i < nfs; i++)
+    {
+      const char *key = fs_key (&fs[i]);
+
+      prev = sample.resampled ? fs[i].first : statefile_get (state, key);
+      for (k = 0; prev && k < FSSTATS_COUNTERS; k++)
+	fs[i].rates[k] = (fs[i].counters[k] > prev[k]) ?
+	  (fs[i].counters[k] - prev[k]) / elapsed : 0;
+      if (prev)
+	fs[i].rates[FSSTATS_ERRORS] *= elapsed;
+
+      statefile_put (state, key, fs[i].counters);
+    }
+
+  if (statefile_save (state) < 0)
+    dbg ("cannot save the state: %s\n", strerror (errno));
+  statefile_free (state);
+}
+
+int
+main (int argc, char **argv)
+{
+  int c;
+  bool global = false;
+  char *log_critical = NULL, *log_warning = NULL, *buf_critical = NULL,
+       *buf_warning = NULL, *errors_critical = NULL, *errors_warning = NULL,
+       *message, *problems = NULL, **mountdirs = NULL;
+  unsigned long delay = DELAY_DEFAULT;
+  nagstatus status = STATE_OK, fs_status, s;
+  thresholds *log_threshold = NULL, *buf_threshold = NULL,
+	     *errors_threshold = NULL;
+  struct mount_filter filter = { 0 };
+  struct mount_entry *mount_list;
+  struct fs *fs;
+  size_t i, k, nfs, nselected = 0, nmountdirs = 0;
+
+  set_program_name (argv[0]);
+  result_cache_init (argc, argv);
+
+  while ((c = getopt_long (argc, argv,
+			   "m:T:gl:b:e:" GETOPT_HELP_VERSION_STRING,
+			   longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'm':
+	  mountdirs = xrealloc (mountdirs, (nmountdirs + 1) * sizeof (char *));
+	  mountdirs[nmountdirs++] = optarg;
+	  break;
+	case 'T':
+	  if (STRNEQ (optarg, "xfs") && STRNEQ (optarg, "ext4"))
+	    usage (stderr);
+	  mount_filter_add_type (&filter, optarg);
+	  break;
+	case 'g':
+	  global = true;
+	  break;
+	case 'l':
+	  log_warning = xstrdup (optarg);
+	  if (NULL == (log_critical = strchr (log_warning, ',')))
+	    usage (stderr);
+	  *log_critical++ = '\0';
+	  break;
+	case 'b':
+	  buf_warning = xstrdup (optarg);
+	  if (NULL == (buf_critical = strchr (buf_warning, ',')))
+	    usage (stderr);
+	  *buf_critical++ = '\0';
+	  break;
+	case 'e':
+	  errors_warning = xstrdup (optarg);
+	  if (NULL == (errors_critical = strchr (errors_warning, ',')))
+	    usage (stderr);
+	  *errors_critical++ = '\0';
+	  break;
+
+	case_GETOPT_HELP_CHAR
+	case_GETOPT_VERSION_CHAR
+
+	}
+    }
+
+  if (optind < argc)
+    {
+      delay = strtol_or_err (argv[optind++], "failed to parse argument");
+
+      if (delay < 1)
+	plugin_error (STATE_UNKNOWN, 0, "delay must be positive integer");
+      else if (DELAY_MAX < delay)
+	plugin_error (STATE_UNKNOWN, 0,
+		      "too large delay value (greater than %d)", DELAY_MAX);
+    }
+
+  if (set_thresholds (&log_threshold, log_warning, log_critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&buf_threshold, buf_warning, buf_critical)
+	 == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&errors_threshold, errors_warning, errors_critical)
+	 == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  if (NULL == (mount_list = read_file_system_list (true)))
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot read table of mounted file systems");
+
+  fs = fs_list (mount_list, &filter, mountdirs, nmountdirs, global, &nfs);
+  for (i = 0; i < nfs; i++)
+    if (fs[i].selected)
+      nselected++;
+  if (nselected == 0 && nmountdirs > 0)
+    plugin_error (STATE_UNKNOWN, 0, "no XFS or ext4 statistics for %s%s",
+		  mountdirs[0], nmountdirs > 1 ? " (and others)" : "");
+
+  if (nselected > 0)
+    fs_rates (fs, nfs, delay);
+
+  struct metrics *metrics =
+    metrics_new (program_name_short, (FSSTATS_XFS_LAST + 1) * nselected);
+  struct metric metric = { .label = "mount", .precision = 2, .min = "0" };
+  char name[32];
+
+  for (i = 0; i < nfs; i++)
+    {
+      enum fsstats_counter first, last;
+
+      if (!fs[i].selected)
+	continue;
+
+      if (fs[i].xfs)
+	{
+	  fs_status = get_status (fs[i].rates[FSSTATS_LOG_FORCES],
+				  log_threshold);
+	  s = get_status (fs[i].rates[FSSTATS_BUF_MISSES], buf_threshold);
+	  first = FSSTATS_XFS_FIRST;
+	  last = FSSTATS_XFS_LAST;
+	}
+      else
+	{
+	  fs_status = get_status (fs[i].rates[FSSTATS_ERRORS],
+				  errors_threshold);
+	  s = STATE_OK;
+	  first = FSSTATS_EXT4_FIRST;
+	  last = FSSTATS_EXT4_LAST;
+	}
+      if (fs_status < s)
+	fs_status = s;
+      if (status < fs_status)
+	status = fs_status;
+      if (fs_status != STATE_OK)
+	{
+	  char *p = problems ?
+	    xasprintf ("%s %s", problems, fs[i].mountdir) :
+	    xstrdup (fs[i].mountdir);
+	  free (problems);
+	  problems = p;
+	}
+
+      metric.label_value = fs[i].mountdir;
+      for (k = first; k <= last; k++)
+	{
+	  metric.name = name;
+	  metric.warning = metric.critical = NULL;
+	  metric.precision = 2;
+	  snprintf (name, sizeof name, "%s/s", fsstats_counter_name (k));
+	  switch (k)
+	    {
+	    default:
+	      break;
+	    case FSSTATS_LOG_FORCES:
+	      metric.warning = log_warning;
+	      metric.critical = log_critical;
+	      break;
+	    case FSSTATS_BUF_MISSES:
+	      metric.warning = buf_warning;
+	      metric.critical = buf_critical;
+	      break;
+	    case FSSTATS_ERRORS:
+	      metric.name = "new_errors";
+	      metric.precision = 0;
+	      metric.warning = errors_warning;
+	      metric.critical = errors_critical;
+	      break;
+	    }
+	  metrics_add (metrics, &metric, fs[i].rates[k]);
+	}
+      if (!fs[i].xfs)
+	{
+	  metric.name = "errors";
+	  metric.precision = 0;
+	  metric.warning = metric.critical = NULL;
+	  metrics_add (metrics, &metric, fs[i].counters[FSSTATS_ERRORS]);
+	}
+    }
+
+  if (problems)
+    message = xasprintf ("%s %s - %zu file system(s), problems on %s",
+			 program_name_short, state_text (status), nselected,
+			 problems);
+  else
+    message = xasprintf ("%s %s - %zu file system(s)", program_name_short,
+			 state_text (status), nselected);
+  metrics_write (metrics, status, message);
+
+  free (message);
+  free (problems);
+  free (fs);
+  free (mountdirs);
+  free (log_warning);
+  free (buf_warning);
+  free (errors_warning);
+  free (log_threshold);
+  free (buf_threshold);
+  free (errors_threshold);
+
+  return status;
+}
@@ -29,9 +29,12 @@
 #include "common.h"
 #include "string-macros.h"
 #include "messages.h"
+#include "metrics.h"
 #include "mountlist.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
+#include "xasprintf.h"
 
 static const char *program_copyright =
   "Copyright (C) 2013-2014 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
@@ -92,6 +95,7 @@ main (int argc, char **argv)
   nagstatus status = STATE_OK;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv, GETOPT_HELP_VERSION_STRING, longopts,
                            NULL)) != -1)
@@ -125,14 +129,24 @@ main (int argc, char **argv)
        * http://www.open-std.org/JTC1/sc22/wg14/www/docs/n1256.pdf */
       argv[i] = NULL;
 
-  printf ("filesystems %s", state_text (status));
+  char *status_msg = xasprintf ("filesystems %s", state_text (status));
   for (i = optind; i < argc; ++i)
     if (argv[i])
-      printf (" %s", argv[i]);
+      {
+	char *msg = xasprintf ("%s %s", status_msg, argv[i]);
+	free (status_msg);
+	status_msg = msg;
+      }
 
   if (STATE_CRITICAL == status)
-    printf (" unmounted!");
-  putchar ('\n');
+    {
+      char *msg = xasprintf ("%s unmounted!", status_msg);
+      free (status_msg);
+      status_msg = msg;
+    }
+
+  metrics_write (metrics_new (program_name_short, 0), status, status_msg);
+  free (status_msg);
 
   return status;
 }
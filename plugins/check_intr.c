@@ -34,9 +34,12 @@
 #include "cpustats.h"
 #include "interrupts.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
+#include "xasprintf.h"
 #include "xstrton.h"
 
 #define MIN(a,b) \
@@ -143,6 +146,7 @@ main (int argc, char **argv)
   unsigned long long dnintr;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "c:w:v" GETOPT_HELP_VERSION_STRING,
@@ -197,14 +201,32 @@ main (int argc, char **argv)
   free (my_threshold);
 
   char *time_unit = (count > 1) ? "/s" : "";
-  printf ("%s %s - number of interrupts%s %llu | intr%s=%llu",
-	  program_name_short, state_text (status),
-	  time_unit, dnintr, time_unit, dnintr);
+  char *name = xasprintf ("intr%s", time_unit);
+  struct metrics *metrics =
+    metrics_new (program_name_short, 1 + MIN (ncpus0, ncpus1));
+  struct metric metric = { .name = name };
+  metrics_add (metrics, &metric, dnintr);
 
   for (i = 0; i < MIN (ncpus0, ncpus1); i++)
-    printf (" intr_cpu%lu%s=%lu", i, time_unit,
-	    (count > 1) ? (vintr[1][i] - vintr[0][i]) / delay : vintr[0][i]);
-  printf ("\n");
+    {
+      char cpuname[32], label[64];
+      snprintf (cpuname, sizeof cpuname, "cpu%lu", i);
+      snprintf (label, sizeof label, "intr_%s%s", cpuname, time_unit);
+      metric = (struct metric) {
+	.name = name, .label = "cpu", .label_value = cpuname,
+	.perfdata_label = label
+      };
+      metrics_add (metrics, &metric,
+		   (count > 1) ? (vintr[1][i] - vintr[0][i]) / delay
+			       : vintr[0][i]);
+    }
+
+  char *status_msg =
+    xasprintf ("%s %s - number of interrupts%s %llu",
+	       program_name_short, state_text (status), time_unit, dnintr);
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
+  free (name);
 
   free (vintr[1]);
   free (vintr[0]);
@@ -0,0 +1,646 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A Nagios plugin that checks the interrupts, the softirqs, and the kernel
+ * time hitting the isolated CPUs (isolcpus, nohz_full).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <errno.h>
+#include <getopt.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "cpustats.h"
+#include "cputopology.h"
+#include "interrupts.h"
+#include "logging.h"
+#include "messages.h"
+#include "metrics.h"
+#include "progname.h"
+#include "progversion.h"
+#include "result_cache.h"
+#include "statefile.h"
+#include "string-macros.h"
+#include "system.h"
+#include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+#include "xstrton.h"
+
+#define TOP_DEFAULT  3
+
+static const char *program_copyright =
+  "Copyright (C) 2026 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
+
+static struct option const longopts[] = {
+  {(char *) "cpus", required_argument, NULL, 'p'},
+  {(char *) "top", required_argument, NULL, 'n'},
+  {(char *) "system", required_argument, NULL, 's'},
+  {(char *) "critical", required_argument, NULL, 'c'},
+  {(char *) "warning", required_argument, NULL, 'w'},
+  {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
+  {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
+  {NULL, 0, NULL, 0}
+};
+
+static _Noreturn void
+usage (FILE * out)
+{
+  fprintf (out, "%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs ("This plugin checks the interrupts and the kernel time hitting the "
+	 "isolated CPUs.\n", out);
+  fputs (program_copyright, out);
+  fputs (USAGE_HEADER, out);
+  fprintf (out, "  %s [-p CPULIST] [-n TOP] [-s PERC,PERC] [-w COUNTER] "
+	   "[-c COUNTER] [delay]\n", program_name);
+  fputs (USAGE_OPTIONS, out);
+  fputs ("  -p, --cpus=CPULIST   the CPUs to check: a list like \"2-5,8\", "
+	 "or \"isolated\"\n"
+	 "                  or \"nohz_full\" (default: the CPUs listed in "
+	 "both)\n", out);
+  fputs ("  -n, --top=TOP   the number of interrupts reported per CPU "
+	 "(default: 3)\n", out);
+  fputs ("  -s, --system=PERC,PERC   warning and critical thresholds on the "
+	 "time spent\n"
+	 "                  in kernel mode (system, irq, softirq) by each CPU\n",
+	 out);
+  fputs ("  -w, --warning COUNTER   warning threshold on the interrupts and "
+	 "softirqs\n"
+	 "                  per second of each CPU\n", out);
+  fputs ("  -c, --critical COUNTER   critical threshold on the interrupts "
+	 "and softirqs\n"
+	 "                  per second of each CPU\n", out);
+  fputs (USAGE_HELP, out);
+  fputs (USAGE_VERSION, out);
+  fprintf (out, "  \"delay\" is the delay in seconds between two samples "
+	   "(default: %dsec)\n", DELAY_DEFAULT);
+  fputs (USAGE_NOTE, out);
+  fputs (USAGE_STATEFILE, out);
+  fputs (USAGE_EXAMPLES, out);
+  fprintf (out, "  %s -w 100 -c 1000 -s 1,5\n", program_name);
+  fprintf (out, "  %s --cpus 2-5 --top 5 -c 500\n", program_name);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static _Noreturn void
+print_version (void)
+{
+  printf ("%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs (program_copyright, stdout);
+  fputs (GPLv3_DISCLAIMER, stdout);
+
+  exit (STATE_OK);
+}
+
+/* The fields of the cpu lines of /proc/stat, saved between two executions */
+enum stat_field
+{
+  STAT_USER,
+  STAT_NICE,
+  STAT_SYSTEM,
+  STAT_IDLE,
+  STAT_IOWAIT,
+  STAT_IRQ,
+  STAT_SOFTIRQ,
+  STAT_STEAL,
+  STAT_FIELDS
+};
+
+static const char *const stat_field_name[] = {
+  [STAT_USER] = "user",
+  [STAT_NICE] = "nice",
+  [STAT_SYSTEM] = "system",
+  [STAT_IDLE] = "idle",
+  [STAT_IOWAIT] = "iowait",
+  [STAT_IRQ] = "irq",
+  [STAT_SOFTIRQ] = "softirq",
+  [STAT_STEAL] = "steal"
+};
+
+/* The counters of the checked CPUs.  Each counter is saved in the state
+   file as a vector with one value per CPU.  */
+typedef struct isol_sample
+{
+  unsigned long long *stat[STAT_FIELDS];
+  struct irq_table *intr, *softirq;
+} isol_sample;
+
+typedef struct isol_irq
+{
+  const char *name, *device;
+  bool soft;
+  double rate;
+} isol_irq;
+
+typedef struct isol_cpu
+{
+  unsigned int cpu;
+  double busy, system;		/* percentages of the time */
+  double irqs;			/* interrupts and softirqs per second */
+  isol_irq *top;		/* the most frequent ones */
+  nagstatus status;
+} isol_cpu;
+
+static void
+isol_sample_read (isol_sample *sample, const isol_cpu *cpus, size_t n,
+		  struct cpu_time *cputime, unsigned int lines)
+{
+  for (size_t f = 0; f < STAT_FIELDS; f++)
+    sample->stat[f] = xnmalloc (n, sizeof (unsigned long long));
+
+  cpu_stats_get_time (cputime, lines);
+  for (size_t i = 0; i < n; i++)
+    {
+      const struct cpu_time *t = &cputime[cpus[i].cpu + 1];
+
+      sample->stat[STAT_USER][i] = t->user;
+      sample->stat[STAT_NICE][i] = t->nice;
+      sample->stat[STAT_SYSTEM][i] = t->system;
+      sample->stat[STAT_IDLE][i] = t->idle;
+      sample->stat[STAT_IOWAIT][i] = t->iowait;
+      sample->stat[STAT_IRQ][i] = t->irq;
+      sample->stat[STAT_SOFTIRQ][i] = t->softirq;
+      sample->stat[STAT_STEAL][i] = t->steal;
+    }
+  for (unsigned int l = 0; l < lines; l++)
+    free ((char *) cputime[l].cpuname);
+
+  if (NULL == (sample->intr = proc_interrupts_read ()))
+    plugin_error (STATE_UNKNOWN, errno, "error reading /proc/interrupts");
+  /* /proc/softirqs exists since Linux 2.6.31 */
+  if (NULL == (sample->softirq = proc_softirqs_read ()))
+    sample->softirq = xmalloc (sizeof (struct irq_table));
+}
+
+static void
+isol_sample_free (isol_sample *sample)
+{
+  for (size_t f = 0; f < STAT_FIELDS; f++)
+    free (sample->stat[f]);
+  irq_table_free (sample->intr);
+  irq_table_free (sample->softirq);
+}
+
+/* The samples compared, and what is needed to read a second one */
+
+struct isol_sampling
+{
+  isol_sample *first, *cur;
+  const isol_cpu *cpus;
+  size_t ncpus;
+  struct cpu_time *cputime;
+  unsigned int lines;
+  bool resampled;
+};
+
+static void
+isol_resample (void *data)
+{
+  struct isol_sampling *sample = data;
+
+  *sample->first = *sample->cur;
+  isol_sample_read (sample->cur, sample->cpus, sample->ncpus,
+		    sample->cputime, sample->lines);
+  sample->resampled = true;
+}
+
+/* Fill VALUES with the counters of ROW for each CPU.  */
+
+static void
+isol_row_values (const struct irq_table *table, const struct irq_row *row,
+		 const isol_cpu *cpus, size_t n, unsigned long long *values)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      int col = irq_table_column (table, cpus[i].cpu);
+      values[i] = (col < 0) ? 0 : row->count[col];
+    }
+}
+
+/* Return the counters of the row NAME in the previous sample: the state
+   file if PREV is NULL, or the irq table PREV.  */
+
+static const unsigned long long *
+isol_row_prev (const struct statefile *state, const struct irq_table *prev,
+	       const char *key, const char *name, const isol_cpu *cpus,
+	       size_t n, unsigned long long *values)
+{
+  if (NULL == prev)
+    return statefile_get (state, key);
+
+  for (size_t r = 0; r < prev->nrows; r++)
+    if (STREQ (prev->row[r].name, name))
+      {
+	isol_row_values (prev, &prev->row[r], cpus, n, values);
+	return values;
+      }
+
+  return NULL;
+}
+
+static void
+isol_top_insert (isol_irq *top, size_t ntop, const isol_irq *irq)
+{
+  size_t k = ntop;
+
+  while (k > 0 && top[k - 1].rate < irq->rate)
+    {
+      if (k < ntop)
+	top[k] = top[k - 1];
+      k--;
+    }
+  if (k < ntop)
+    top[k] = *irq;
+}
+
+/* Add the interrupts of TABLE since PREV to the CPUs, and save their
+   counters in STATE.  */
+
+static void
+isol_compute_irqs (isol_cpu *cpus, size_t n, size_t ntop,
+		   const struct irq_table *table,
+		   const struct irq_table *prev, struct statefile *state,
+		   bool soft, double elapsed)
+{
+  unsigned long long *values = xnmalloc (n, sizeof (unsigned long long)),
+    *prevbuf = xnmalloc (n, sizeof (unsigned long long));
+
+  for (size_t r = 0; r < table->nrows; r++)
+    {
+      const struct irq_row *row = &table->row[r];
+      char *key = xasprintf ("%s/%s", soft ? "softirq" : "irq", row->name);
+      const unsigned long long *before;
+
+      isol_row_values (table, row, cpus, n, values);
+      before = isol_row_prev (state, prev, key, row->name, cpus, n, prevbuf);
+      statefile_put (state, key, values);
+      free (key);
+
+      /* the irqs registered since the previous sample */
+      for (size_t i = 0; i < n; i++)
+	{
+	  unsigned long long delta = values[i];
+	  isol_irq irq = { row->name, row->device, soft, 0 };
+
+	  if (before)
+	    delta = (values[i] > before[i]) ? values[i] - before[i] : 0;
+	  if (0 == delta)
+	    continue;
+
+	  irq.rate = delta / elapsed;
+	  cpus[i].irqs += irq.rate;
+	  isol_top_insert (cpus[i].top, ntop, &irq);
+	}
+    }
+
+  free (prevbuf);
+  free (values);
+}
+
+static void
+isol_compute_time (isol_cpu *cpus, size_t n, const isol_sample *cur,
+		   unsigned long long *prev[])
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      unsigned long long delta[STAT_FIELDS], total = 0;
+
+      for (size_t f = 0; f < STAT_FIELDS; f++)
+	{
+	  delta[f] = (cur->stat[f][i] > prev[f][i]) ?
+	    cur->stat[f][i] - prev[f][i] : 0;
+	  total += delta[f];
+	}
+      if (0 == total)
+	continue;
+
+      cpus[i].busy =
+	100.0 * (total - delta[STAT_IDLE] - delta[STAT_IOWAIT]) / total;
+      cpus[i].system =
+	100.0 * (delta[STAT_SYSTEM] + delta[STAT_IRQ] + delta[STAT_SOFTIRQ])
+	/ total;
+    }
+}
+
+/* The CPUs listed in /sys/devices/system/cpu/isolated or nohz_full.  */
+
+static cpu_set_t *
+isol_default_cpus (size_t *setsize, int *ncpus)
+{
+  size_t nohz_setsize;
+  int nohz_ncpus;
+  cpu_set_t *cpuset = get_cpulist ("isolated", setsize, ncpus),
+    *nohz = get_cpulist ("nohz_full", &nohz_setsize, &nohz_ncpus);
+
+  if (NULL == cpuset || NULL == nohz)
+    {
+      if (NULL == cpuset)
+	{
+	  *setsize = nohz_setsize;
+	  *ncpus = nohz_ncpus;
+	}
+      return cpuset ? cpuset : nohz;
+    }
+
+  for (unsigned int cpu = 0; cpu < 8 * nohz_setsize && cpu < 8 * *setsize;
+       cpu++)
+    if (CPU_ISSET_S (cpu, nohz_setsize, nohz)
+	&& !CPU_ISSET_S (cpu, *setsize, cpuset))
+      {
+	CPU_SET_S (cpu, *setsize, cpuset);
+	(*ncpus)++;
+      }
+  CPU_FREE (nohz);
+
+  return cpuset;
+}
+
+static void
+isol_add_metrics (struct metrics *metrics, const isol_cpu *cpu, size_t ntop,
+		  const char *warning, const char *critical,
+		  const char *system_warning, const char *system_critical)
+{
+  struct metric metric = { .label = "cpu", .precision = 2 };
+  char label[16], name[64];
+
+  snprintf (label, sizeof label, "cpu%u", cpu->cpu);
+  metric.label_value = label;
+
+  metric.name = "interrupts/s";
+  metric.warning = warning;
+  metric.critical = critical;
+  metric.min = "0";
+  metrics_add (metrics, &metric, cpu->irqs);
+
+  metric.name = "system";
+  metric.unit = "%";
+  metric.warning = system_warning;
+  metric.critical = system_critical;
+  metric.max = "100";
+  metrics_add (metrics, &metric, cpu->system);
+
+  metric.name = "busy";
+  metric.warning = metric.critical = NULL;
+  metrics_add (metrics, &metric, cpu->busy);
+
+  metric.unit = metric.max = NULL;
+  for (size_t k = 0; k < ntop && cpu->top[k].rate > 0; k++)
+    {
+      snprintf (name, sizeof name, "%s_%s/s",
+		cpu->top[k].soft ? "softirq" : "irq", cpu->top[k].name);
+      metric.name = name;
+      metrics_add (metrics, &metric, cpu->top[k].rate);
+    }
+}
+
+/* "cpu3: 1520.0 interrupts/s (LOC 1000.0, TIMER 500.0, 24:eth0 20.0),
+   2.50% system time" */
+
+static char *
+isol_cpu_summary (const isol_cpu *cpu, size_t ntop)
+{
+  char *summary = xasprintf ("cpu%u: %.1f interrupts/s", cpu->cpu, cpu->irqs),
+    *tmp;
+
+  for (size_t k = 0; k < ntop && cpu->top[k].rate > 0; k++)
+    {
+      const isol_irq *irq = &cpu->top[k];
+
+      tmp = summary;
+      summary = xasprintf ("%s%s%s%s%s %.1f", tmp, k ? ", " : " (",
+			   irq->name, irq->device ? ":" : "",
+			   irq->device ? irq->device : "", irq->rate);
+      free (tmp);
+    }
+
+  tmp = summary;
+  summary = xasprintf ("%s%s, %.2f%% system time", tmp,
+		       (ntop && cpu->top[0].rate > 0) ? ")" : "", cpu->system);
+  free (tmp);
+
+  return summary;
+}
+
+int
+main (int argc, char **argv)
+{
+  int c, ncpus;
+  char *critical = NULL, *warning = NULL, *system_critical = NULL,
+       *system_warning = NULL, *id, *summary, *message;
+  const char *cpulist = NULL;
+  nagstatus status = STATE_OK;
+  thresholds *my_threshold = NULL, *system_threshold = NULL;
+  unsigned long delay, top = TOP_DEFAULT;
+  unsigned int lines;
+  cpu_set_t *cpuset;
+  size_t setsize, i, n = 0, worst = 0;
+  isol_cpu *cpus;
+  isol_sample first = { 0 }, cur = { 0 };
+  unsigned long long *prev[STAT_FIELDS];
+  struct cpu_time *cputime;
+  struct statefile *state;
+  struct isol_sampling sample = { .resampled = false };
+  char *keys[STAT_FIELDS];
+  double elapsed;
+
+  set_program_name (argv[0]);
+  result_cache_init (argc, argv);
+
+  while ((c = getopt_long (argc, argv,
+			   "p:n:s:c:w:" GETOPT_HELP_VERSION_STRING,
+			   longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'p':
+	  cpulist = optarg;
+	  break;
+	case 'n':
+	  top = strtol_or_err (optarg, "the top value must be an integer");
+	  if ((long) top < 0)
+	    plugin_error (STATE_UNKNOWN, 0, "invalid top value: %s", optarg);
+	  break;
+	case 's':
+	  system_warning = xstrdup (optarg);
+	  if (NULL == (system_critical = strchr (system_warning, ',')))
+	    usage (stderr);
+	  *system_critical++ = '\0';
+	  break;
+	case 'c':
+	  critical = optarg;
+	  break;
+	case 'w':
+	  warning = optarg;
+	  break;
+
+	case_GETOPT_HELP_CHAR
+	case_GETOPT_VERSION_CHAR
+
+	}
+    }
+
+  delay = DELAY_DEFAULT;
+  if (optind < argc)
+    {
+      delay = strtol_or_err (argv[optind++], "failed to parse argument");
+
+      if (delay < 1)
+	plugin_error (STATE_UNKNOWN, 0, "delay must be positive integer");
+      else if (DELAY_MAX < delay)
+	plugin_error (STATE_UNKNOWN, 0,
+		      "too large delay value (greater than %d)", DELAY_MAX);
+    }
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&system_threshold, system_warning, system_critical)
+	 == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  if (NULL == cpulist)
+    cpuset = isol_default_cpus (&setsize, &ncpus);
+  else if (STREQ (cpulist, "isolated") || STREQ (cpulist, "nohz_full"))
+    cpuset = get_cpulist (cpulist, &setsize, &ncpus);
+  else
+    cpuset = cpulist_alloc (cpulist, &setsize, &ncpus);
+  if (NULL == cpuset && cpulist && !STREQ (cpulist, "isolated")
+      && !STREQ (cpulist, "nohz_full"))
+    plugin_error (STATE_UNKNOWN, 0, "invalid cpu list: %s", cpulist);
+  if (NULL == cpuset || ncpus == 0)
+    plugin_error (STATE_UNKNOWN, 0, "no isolated CPUs found");
+
+  /* the offline CPUs are not listed in /proc/stat */
+  lines = get_processor_number_total () + 1;
+  cputime = xnmalloc (lines, sizeof (struct cpu_time));
+  cpu_stats_get_time (cputime, lines);
+
+  cpus = xnmalloc (ncpus, sizeof (isol_cpu));
+  id = xstrdup ("cpu");
+  for (unsigned int cpu = 0; cpu < 8 * setsize && n < (size_t) ncpus; cpu++)
+    {
+      if (!CPU_ISSET_S (cpu, setsize, cpuset)
+	  || cpu + 1 >= lines || NULL == cputime[cpu + 1].cpuname)
+	continue;
+      cpus[n].cpu = cpu;
+      n++;
+
+      summary = id;
+      id = xasprintf ("%s,%u", summary, cpu);
+      free (summary);
+    }
+  for (unsigned int l = 0; l < lines; l++)
+    free ((char *) cputime[l].cpuname);
+  CPU_FREE (cpuset);
+  if (0 == n)
+    plugin_error (STATE_UNKNOWN, 0, "the selected CPUs are offline");
+
+  /* the samples saved for the same CPUs */
+  state = statefile_open (id, n);
+  isol_sample_read (&cur, cpus, n, cputime, lines);
+  /* no more than the interrupts listed */
+  if (top > cur.intr->nrows + cur.softirq->nrows)
+    top = cur.intr->nrows + cur.softirq->nrows;
+  for (i = 0; i < n; i++)
+    cpus[i].top = xnmalloc (top + 1, sizeof (isol_irq));
+  for (size_t f = 0; f < STAT_FIELDS; f++)
+    keys[f] = xasprintf ("stat/%s", stat_field_name[f]);
+  sample.first = &first;
+  sample.cur = &cur;
+  sample.cpus = cpus;
+  sample.ncpus = n;
+  sample.cputime = cputime;
+  sample.lines = lines;
+  elapsed = statefile_sample (state, delay, (const char *const *) keys,
+			      STAT_FIELDS, isol_resample, &sample);
+  for (size_t f = 0; f < STAT_FIELDS; f++)
+    prev[f] = sample.resampled ? first.stat[f] :
+      (unsigned long long *) statefile_get (state, keys[f]);
+
+  isol_compute_time (cpus, n, &cur, prev);
+  isol_compute_irqs (cpus, n, top, cur.intr,
+		     sample.resampled ? first.intr : NULL, state, false,
+		     elapsed);
+  isol_compute_irqs (cpus, n, top, cur.softirq,
+		     sample.resampled ? first.softirq : NULL, state, true,
+		     elapsed);
+  for (size_t f = 0; f < STAT_FIELDS; f++)
+    {
+      statefile_put (state, keys[f], cur.stat[f]);
+      free (keys[f]);
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      nagstatus s = get_status (cpus[i].system, system_threshold);
+
+      cpus[i].status = get_status (cpus[i].irqs, my_threshold);
+      if (cpus[i].status < s)
+	cpus[i].status = s;
+      if (status < cpus[i].status)
+	status = cpus[i].status;
+      if (cpus[i].status > cpus[worst].status
+	  || (cpus[i].status == cpus[worst].status
+	      && cpus[i].irqs > cpus[worst].irqs))
+	worst = i;
+    }
+
+  size_t nmetrics = 3 * n;
+  for (i = 0; i < n; i++)
+    for (size_t k = 0; k < top && cpus[i].top[k].rate > 0; k++)
+      nmetrics++;
+  struct metrics *metrics = metrics_new (program_name_short, nmetrics);
+  for (i = 0; i < n; i++)
+    isol_add_metrics (metrics, &cpus[i], top, warning, critical,
+		      system_warning, system_critical);
+
+  summary = isol_cpu_summary (&cpus[worst], top);
+  message = xasprintf ("%s %s - %zu isolated CPUs, %s", program_name_short,
+		       state_text (status), n, summary);
+  metrics_write (metrics, status, message);
+  free (message);
+  free (summary);
+
+  if (statefile_save (state) < 0)
+    dbg ("cannot save the state: %s\n", strerror (errno));
+  statefile_free (state);
+  isol_sample_free (&first);
+  isol_sample_free (&cur);
+
+  for (i = 0; i < n; i++)
+    free (cpus[i].top);
+  free (cpus);
+  free (cputime);
+  free (id);
+  free (system_warning);
+  free (my_threshold);
+  free (system_threshold);
+
+  return status;
+}
@@ -5,6 +5,10 @@
  *
  * A Nagios plugin that tests the current system load average.
  *
+ * The load averages can be normalized by the CPU capacity actually
+ * available to the plugin, that inside a container is limited by the
+ * cgroup v2 CPU quota (cpu.max) and by the effective cpuset.
+ *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation, either version 3 of the License, or
@@ -19,15 +23,22 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 
+#include "cgroup.h"
 #include "common.h"
+#include "cpustats.h"
 #include "cputopology.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "sysfsparser.h"
 #include "system.h"
 #include "xasprintf.h"
@@ -40,6 +51,8 @@ static struct option const longopts[] = {
   {(char *) "load5", required_argument, NULL, '5'},
   {(char *) "load15", required_argument, NULL, 'L'},
   {(char *) "percpu", no_argument, NULL, 'r'},
+  {(char *) "cgroup", optional_argument, NULL, 'g'},
+  {(char *) "saturation", required_argument, NULL, 's'},
   {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
   {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
   {NULL, 0, NULL, 0}
@@ -54,9 +67,20 @@ usage (FILE * out)
   fputs (USAGE_HEADER, out);
   fprintf (out, "  %s [-r] [--load1=w,c] [--load5=w,c] [--load15=w,c]\n",
 	   program_name);
+  fprintf (out, "  %s [-r] --cgroup[=PATH] [--saturation=w,c] "
+	   "[--load1=w,c] [--load5=w,c] [--load15=w,c]\n", program_name);
   fputs (USAGE_OPTIONS, out);
-  fputs ("  -r, --percpu    divide the load averages by the number of CPUs\n",
-	 out);
+  fputs ("  -r, --percpu    divide the load averages by the number of CPUs "
+	 "available:\n"
+	 "                  the online CPUs, limited by the cgroup cpuset and "
+	 "CPU quota\n", out);
+  fputs ("  -g, --cgroup[=PATH]   also measure the CPU saturation of a cgroup "
+	 "(default:\n"
+	 "                  the cgroup of the plugin, PATH is relative to "
+	 PATH_SYS_CGROUP ")\n", out);
+  fputs ("  -s, --saturation=WPERC,CPERC"
+	 "   warning and critical thresholds for the cgroup\n"
+	 "                  CPU usage, as a percentage of its capacity\n", out);
   fputs ("  -1, --load1=WLOAD1,CLOAD1"
 	 "   warning and critical thresholds for load1\n", out);
   fputs ("  -5, --load5=WLOAD5,CLOAD5"
@@ -67,6 +91,13 @@ usage (FILE * out)
   fputs (USAGE_VERSION, out);
   fputs (USAGE_EXAMPLES, out);
   fprintf (out, "  %s -r --load1=2,3 --load15=1.5,2.5\n", program_name);
+  fprintf (out, "  %s -r --cgroup --saturation=80,95\n", program_name);
+  fputs (USAGE_NOTE, out);
+  fputs ("  The load averages are computed by the kernel for the whole "
+	 "system, also\n"
+	 "  inside a container.  The CPU saturation of a cgroup is its CPU "
+	 "usage over one\n"
+	 "  second (cpu.stat) divided by its capacity.\n", out);
 
   exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
 }
@@ -88,19 +119,67 @@ validate_input (int i, double w, double c)
     plugin_error (STATE_UNKNOWN, 0, "command line error: bad thresholds");
 }
 
+/* Return the CPU capacity available to the cgroup CGROUP, or the number
+ * of online CPUs if CGROUP is NULL or its limits cannot be read.  */
+static double
+get_cpu_capacity (const char *cgroup)
+{
+  struct cgroup_cpu_capacity capacity;
+
+  if (cgroup && cgroup_cpu_capacity (cgroup, &capacity) == 0)
+    return capacity.capacity;
+
+  return get_processor_number_online ();
+}
+
 static void
-normalize_loadavg (double *loadavg, int numcpus)
+normalize_loadavg (double *loadavg, double capacity)
 {
   int i;
 
-  if (!numcpus)
-    numcpus = get_processor_number_online ();
+  if (!capacity)
+    {
+      char *cgroup = cgroup_path (NULL);
+      capacity = get_cpu_capacity (cgroup);
+      free (cgroup);
+    }
 
   for (i = 0; i < 3; i++)
     {
-      if (numcpus > 1)
-	loadavg[i] /= numcpus;
+      if (capacity > 0)
+	loadavg[i] /= capacity;
+    }
+}
+
+/* Measure the CPU usage of the cgroup CGROUP over one second, and return it
+ * as a percentage of CAPACITY.  The number of periods throttled in the
+ * meanwhile is stored in THROTTLED.  */
+static double
+cgroup_saturation (const char *cgroup, double capacity,
+		   unsigned long long *throttled)
+{
+  struct cgroup_cpu_stat stat[2];
+  struct timespec ts[2];
+  double elapsed;
+
+  for (int i = 0; i < 2; i++)
+    {
+      if (i > 0)
+	sleep (1);
+      clock_gettime (CLOCK_MONOTONIC, &ts[i]);
+      if (cgroup_cpu_stat (cgroup, &stat[i]) < 0)
+	plugin_error (STATE_UNKNOWN, errno, "error reading %s/cpu.stat",
+		      cgroup);
     }
+
+  elapsed = (ts[1].tv_sec - ts[0].tv_sec) * 1e6
+	    + (ts[1].tv_nsec - ts[0].tv_nsec) / 1e3;
+  *throttled = stat[1].nr_throttled - stat[0].nr_throttled;
+
+  if (elapsed <= 0 || capacity <= 0)
+    return 0;
+  return (stat[1].usage_usec - stat[0].usage_usec) * 100.0
+	 / (elapsed * capacity);
 }
 
 static int
@@ -132,15 +211,21 @@ main (int argc, char **argv)
   int c, i, status = STATE_OK;
   const unsigned int lamin[3] = { 1, 5, 15 };
   bool required[3] = { false, false, false };
-  bool normalize = false;
-  double loadavg[3];
+  bool normalize = false, cgroup_check = false, saturation_check = false;
+  double loadavg[3], capacity;
   double wload[3] = { 0.0, 0.0, 0.0 };
   double cload[3] = { 0.0, 0.0, 0.0 };
-  char *status_msg, *perfdata_msg;
+  double saturation = 0.0, wsat = 0.0, csat = 0.0;
+  unsigned long long throttled = 0;
+  char *cgroup, *cgroup_name = NULL, *status_msg, *cgroup_msg = NULL;
+  bool has_pressure = false;
+  struct cgroup_cpu_pressure pressure;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
-  while ((c = getopt_long (argc, argv, "1:5:L:r" GETOPT_HELP_VERSION_STRING,
+  while ((c = getopt_long (argc, argv, "1:5:L:rg::s:"
+			   GETOPT_HELP_VERSION_STRING,
 			   longopts, NULL)) != -1)
     {
       switch (c)
@@ -165,6 +250,15 @@ main (int argc, char **argv)
 	case 'r':
 	  normalize = true;
 	  break;
+	case 'g':
+	  cgroup_check = true;
+	  cgroup_name = optarg;
+	  break;
+	case 's':
+	  i = sscanf (optarg, "%lf,%lf", &wsat, &csat);
+	  validate_input (i, wsat, csat);
+	  saturation_check = true;
+	  break;
 
 	case_GETOPT_HELP_CHAR
 	case_GETOPT_VERSION_CHAR
@@ -177,24 +271,82 @@ main (int argc, char **argv)
   if (getloadavg (&loadavg[0], 3) != 3)
     plugin_error (STATE_UNKNOWN, 0,
 		  "the system load average was unobtainable");
+
+  cgroup = cgroup_path (cgroup_name);
+  if (cgroup_check && NULL == cgroup)
+    plugin_error (STATE_UNKNOWN, 0, "the cgroup v2 hierarchy is not mounted");
+  capacity = get_cpu_capacity (cgroup);
   if (normalize)
-    normalize_loadavg (loadavg, 0);
+    normalize_loadavg (loadavg, capacity);
   status = loadavg_status (loadavg, wload, cload, required);
 
+  if (cgroup_check)
+    {
+      saturation = cgroup_saturation (cgroup, capacity, &throttled);
+      if (saturation_check && saturation > csat)
+	status = STATE_CRITICAL;
+      else if (saturation_check && saturation > wsat && status == STATE_OK)
+	status = STATE_WARNING;
+
+      cgroup_msg = xasprintf (", cgroup cpu saturation: %.2lf%%", saturation);
+      /* cpu.pressure is missing when the kernel is booted with psi=0 */
+      has_pressure = (cgroup_cpu_pressure (cgroup, &pressure) == 0);
+    }
+  free (cgroup);
+
   status_msg =
-    xasprintf ("%s - average: %.2lf, %.2lf, %.2lf",
-	       state_text (status), loadavg[0], loadavg[1], loadavg[2]);
+    xasprintf ("%s %s - average: %.2lf, %.2lf, %.2lf%s", program_name_short,
+	       state_text (status), loadavg[0], loadavg[1], loadavg[2],
+	       cgroup_msg ? cgroup_msg : "");
+
   /* performance data format:
    * 'label'=value[UOM];[warn];[crit];[min];[max] */
-  perfdata_msg =
-    xasprintf ("load%u=%.3lf;%.3lf;%.3lf;0 "
-	       "load%u=%.3lf;%.3lf;%.3lf;0 "
-	       "load%u=%.3lf;%.3lf;%.3lf;0"
-	       , lamin[0], loadavg[0], wload[0], cload[0]
-	       , lamin[1], loadavg[1], wload[1], cload[1]
-	       , lamin[2], loadavg[2], wload[2], cload[2]);
-
-  printf ("%s %s | %s\n", program_name_short, status_msg, perfdata_msg);
+  struct metrics *metrics = metrics_new (program_name_short, 9);
+  char warning[32], critical[32], name[16];
+
+  for (i = 0; i < 3; i++)
+    {
+      snprintf (name, sizeof name, "load%u", lamin[i]);
+      snprintf (warning, sizeof warning, "%.3lf", wload[i]);
+      snprintf (critical, sizeof critical, "%.3lf", cload[i]);
+      struct metric metric = {
+	.name = name, .precision = 3,
+	.warning = warning, .critical = critical, .min = "0"
+      };
+      metrics_add (metrics, &metric, loadavg[i]);
+    }
+
+  struct metric metric = { .name = "procs_running", .min = "0" };
+  metrics_add (metrics, &metric, cpu_stats_get_procs_running ());
+  metric.name = "procs_blocked";
+  metrics_add (metrics, &metric, cpu_stats_get_procs_blocked ());
+  metric.name = "cpu_capacity";
+  metric.precision = 2;
+  metrics_add (metrics, &metric, capacity);
+
+  if (cgroup_check)
+    {
+      snprintf (warning, sizeof warning, "%.2lf", wsat);
+      snprintf (critical, sizeof critical, "%.2lf", csat);
+      metric = (struct metric) {
+	.name = "cpu_saturation", .unit = "%", .precision = 2,
+	.warning = warning, .critical = critical, .min = "0"
+      };
+      metrics_add (metrics, &metric, saturation);
+      metric = (struct metric) { .name = "cpu_throttled_periods" };
+      metrics_add (metrics, &metric, throttled);
+      if (has_pressure)
+	{
+	  metric = (struct metric) {
+	    .name = "cpu_pressure_some_avg10", .unit = "%", .precision = 2
+	  };
+	  metrics_add (metrics, &metric, pressure.avg10);
+	}
+    }
+
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
+  free (cgroup_msg);
 
   return status;
 }
@@ -31,9 +31,11 @@
 #include "logging.h"
 #include "meminfo.h"
 #include "messages.h"
+#include "metrics.h"
 #include "perfdata.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "string-macros.h"
 #include "system.h"
 #include "thresholds.h"
@@ -125,10 +127,7 @@ main (int argc, char **argv)
   int shift = k_shift;
   char *critical = NULL, *warning = NULL;
   char *units = NULL;
-  char *status_msg, *perfdata_mem_msg,
-       *perfdata_vmem_msg = "",
-       *perfdata_memavailable_msg = "",
-       *perfdata_memused_msg = "";
+  char *status_msg;
   float mem_percent = 0;
   thresholds *my_threshold = NULL;
 
@@ -150,11 +149,13 @@ main (int argc, char **argv)
   unsigned long nr_vmem_pgpgin[2];
   unsigned long nr_vmem_pgpgout[2];
   unsigned long nr_vmem_pgmajfault[2];
+  unsigned long dpgpgin = 0, dpgpgout = 0, dpgmajfault = 0;
 
   /* by default we display the memory used */
   unsigned long *kb_mem_monitored = &kb_mem_main_used;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
                            "aMSCsc:w:bkmgu:" GETOPT_HELP_VERSION_STRING,
@@ -222,7 +223,10 @@ main (int argc, char **argv)
   if (err < 0)
     plugin_error (STATE_UNKNOWN, err, "memory exhausted");
 
-  proc_sysmem_read (sysmem);
+  err = proc_sysmem_read (sysmem);
+  if (err < 0)
+    plugin_error (STATE_UNKNOWN, -err, "error: cannot read %s",
+		  get_path_proc_meminfo ());
 
   kb_mem_active       = proc_sysmem_get_active (sysmem);
   kb_mem_anon_pages   = proc_sysmem_get_anon_pages (sysmem);
@@ -239,20 +243,24 @@ main (int argc, char **argv)
 
   if (vmem_perfdata)
     {
-      unsigned long dpgpgin, dpgpgout, dpgmajfault;
-
       err = proc_vmem_new (&vmem);
       if (err < 0)
 	plugin_error (STATE_UNKNOWN, err, "memory exhausted");
 
-      proc_vmem_read (vmem);
+      err = proc_vmem_read (vmem);
+      if (err < 0)
+        plugin_error (STATE_UNKNOWN, -err, "error: cannot read %s",
+		      get_path_proc_vmstat ());
       nr_vmem_pgpgin[0] = proc_vmem_get_pgpgin (vmem);
       nr_vmem_pgpgout[0] = proc_vmem_get_pgpgout (vmem);
       nr_vmem_pgmajfault[0] = proc_vmem_get_pgmajfault (vmem);
 
       sleep (1);
 
-      proc_vmem_read (vmem);
+      err = proc_vmem_read (vmem);
+      if (err < 0)
+        plugin_error (STATE_UNKNOWN, -err, "error: cannot read %s",
+		      get_path_proc_vmstat ());
       nr_vmem_pgpgin[1] = proc_vmem_get_pgpgin (vmem);
       nr_vmem_pgpgout[1] = proc_vmem_get_pgpgout (vmem);
       nr_vmem_pgmajfault[1] = proc_vmem_get_pgmajfault (vmem);
@@ -260,10 +268,6 @@ main (int argc, char **argv)
       dpgpgin = nr_vmem_pgpgin[1] - nr_vmem_pgpgin[0];
       dpgpgout = nr_vmem_pgpgout[1] - nr_vmem_pgpgout[0];
       dpgmajfault = nr_vmem_pgmajfault[1] - nr_vmem_pgmajfault[0];
-
-      perfdata_vmem_msg =
-	xasprintf (", vmem_pageins/s=%lu, vmem_pageouts/s=%lu, "
-		   "vmem_pgmajfault/s=%lu", dpgpgin, dpgpgout, dpgmajfault);
     }
 
   /* Note: we should perhaps implement the following tests instead:
@@ -290,56 +294,73 @@ main (int argc, char **argv)
 	     &critical_limit, true)))
     mem_monitored_critical = xasprintf ("%llu", critical_limit);
 
-  /* performance data format:
-   * 'label'=value[UOM];[warn];[crit];[min];[max] */
-  bool add_perfdata = (kb_mem_monitored == &kb_mem_main_available);
-  perfdata_memavailable_msg =
-    xasprintf ("mem_available=%llu%s;%s;%s;0;%llu",
-	       UNIT_STR (kb_mem_main_available),
-	       (add_perfdata
-	        && mem_monitored_warning) ? mem_monitored_warning : "",
-	       (add_perfdata
-	        && mem_monitored_critical) ? mem_monitored_critical : "",
-	       UNIT_CONVERT (kb_mem_main_total, shift));
-
-  add_perfdata = (kb_mem_monitored == &kb_mem_main_used);
-  perfdata_memused_msg =
-    xasprintf ("mem_used=%llu%s;%s;%s;0;%llu",
-	       UNIT_STR (kb_mem_main_used),
-	       (add_perfdata
-		&& mem_monitored_warning) ? mem_monitored_warning : "",
-	       (add_perfdata &&
-		mem_monitored_critical) ? mem_monitored_critical : "",
-	       UNIT_CONVERT (kb_mem_main_total, shift));
-
   status_msg =
-    xasprintf ("%s: %.2f%% (%llu %s) %s",
+    xasprintf ("%s %s: %.2f%% (%llu %s) %s", program_name_short,
 	       state_text (status), mem_percent, UNIT_STR (*kb_mem_monitored),
 	       (kb_mem_monitored == &kb_mem_main_available) ?
 		 "available" : "used");
 
   free (my_threshold);
 
-  perfdata_mem_msg =
-    xasprintf ("mem_total=%llu%s %s mem_free=%llu%s "
-	       "mem_shared=%llu%s mem_buffers=%llu%s mem_cached=%llu%s %s "
-	       "mem_active=%llu%s mem_anonpages=%llu%s mem_committed=%llu%s "
-	       "mem_dirty=%llu%s mem_inactive=%llu%s"
-	       , UNIT_STR (kb_mem_main_total)
-	       , perfdata_memused_msg
-	       , UNIT_STR (kb_mem_main_free)
-	       , UNIT_STR (kb_mem_main_shared)
-	       , UNIT_STR (kb_mem_main_buffers)
-	       , UNIT_STR (kb_mem_main_cached)
-	       , perfdata_memavailable_msg
-	       , UNIT_STR (kb_mem_active)
-	       , UNIT_STR (kb_mem_anon_pages)
-	       , UNIT_STR (kb_mem_committed_as)
-	       , UNIT_STR (kb_mem_dirty)
-	       , UNIT_STR (kb_mem_inactive));
-
-  printf ("%s %s | %s%s\n", program_name_short, status_msg,
-	  perfdata_mem_msg, perfdata_vmem_msg);
+  /* performance data format:
+   * 'label'=value[UOM];[warn];[crit];[min];[max] */
+  char *mem_max = xasprintf ("%llu", UNIT_CONVERT (kb_mem_main_total, shift));
+  const struct { const char *name; unsigned long *value; } samples[] = {
+    { "mem_total", &kb_mem_main_total },
+    { "mem_used", &kb_mem_main_used },
+    { "mem_free", &kb_mem_main_free },
+    { "mem_shared", &kb_mem_main_shared },
+    { "mem_buffers", &kb_mem_main_buffers },
+    { "mem_cached", &kb_mem_main_cached },
+    { "mem_available", &kb_mem_main_available },
+    { "mem_active", &kb_mem_active },
+    { "mem_anonpages", &kb_mem_anon_pages },
+    { "mem_committed", &kb_mem_committed_as },
+    { "mem_dirty", &kb_mem_dirty },
+    { "mem_inactive", &kb_mem_inactive }
+  };
+  size_t nsamples = sizeof (samples) / sizeof (samples[0]);
+
+  struct metrics *metrics = metrics_new (program_name_short, nsamples + 3);
+  for (size_t i = 0; i < nsamples; i++)
+    {
+      struct metric metric = { .name = samples[i].name, .unit = units };
+
+      /* the used and available memory carry the range of the values,
+       * and the monitored one the thresholds */
+      if (samples[i].value == &kb_mem_main_used
+	  || samples[i].value == &kb_mem_main_available)
+	{
+	  metric.min = "0";
+	  metric.max = mem_max;
+	}
+      if (samples[i].value == kb_mem_monitored)
+	{
+	  metric.warning = mem_monitored_warning;
+	  metric.critical = mem_monitored_critical;
+	}
+      metrics_add (metrics, &metric,
+		   UNIT_CONVERT (*samples[i].value, shift));
+    }
+
+  if (vmem_perfdata)
+    {
+      const struct { const char *name; unsigned long value; } vsamples[] = {
+	{ "vmem_pageins/s", dpgpgin },
+	{ "vmem_pageouts/s", dpgpgout },
+	{ "vmem_pgmajfault/s", dpgmajfault }
+      };
+
+      for (size_t i = 0; i < sizeof (vsamples) / sizeof (vsamples[0]); i++)
+	{
+	  struct metric metric = { .name = vsamples[i].name };
+	  metrics_add (metrics, &metric, vsamples[i].value);
+	}
+    }
+
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
+  free (mem_max);
 
   proc_sysmem_unref (sysmem);
   proc_vmem_unref (vmem);
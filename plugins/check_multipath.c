@@ -32,9 +32,12 @@
 
 #include "common.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "system.h"
+#include "xasprintf.h"
 
 static bool verbose = false;
 static const char *multipathd_socket = MULTIPATHD_SOCKET;
@@ -247,6 +250,7 @@ main (int argc, char **argv)
   static char buffer[bufsize];
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv, "v" GETOPT_HELP_VERSION_STRING,
 			   longopts, NULL)) != -1)
@@ -271,15 +275,15 @@ main (int argc, char **argv)
   multipathd_query ("show paths", buffer, sizeof (buffer));
   faulty_paths = check_for_faulty_paths (buffer, bufsize);
 
-  if (faulty_paths > 0)
-    {
-      printf ("%s %s: found %d faulty path(s)\n", program_name_short,
-	      state_text (STATE_CRITICAL), faulty_paths);
-
-      return STATE_CRITICAL;
-    }
+  nagstatus status = (faulty_paths > 0) ? STATE_CRITICAL : STATE_OK;
+  char *status_msg =
+    (faulty_paths > 0) ?
+      xasprintf ("%s %s: found %d faulty path(s)", program_name_short,
+		 state_text (status), faulty_paths) :
+      xasprintf ("%s %s", program_name_short, state_text (status));
 
-  printf ("%s %s\n", program_name_short, state_text (STATE_OK));
+  metrics_write (metrics_new (program_name_short, 0), status, status_msg);
+  free (status_msg);
 
-  return STATE_OK;
+  return status;
 }
@@ -28,10 +28,13 @@
 
 #include "common.h"
 #include "messages.h"
+#include "metrics.h"
 #include "processes.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
+#include "xasprintf.h"
 
 static const char *program_copyright =
   "Copyright (C) 2014,2015 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
@@ -92,6 +95,7 @@ main (int argc, char **argv)
   struct procs_list_node *procs_list, *node;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "c:w:v" GETOPT_HELP_VERSION_STRING,
@@ -130,22 +134,36 @@ main (int argc, char **argv)
 		       my_threshold);
   free (my_threshold);
 
-  printf ("%s %s - %ld running processes | ",
-	  program_name_short, state_text (status),
-	  procs_list_node_get_total_procs_nbr (procs_list));
-
+  struct metrics *metrics = metrics_new (program_name_short, 0);
   proc_list_node_foreach (node, procs_list)
+    {
+      char *username = procs_list_node_get_username (node);
+      char *label = xasprintf ("nbr_%s", username);
+      struct metric metric = {
+	.name = "nbr", .label = "user", .label_value = username,
+	.perfdata_label = label
+      };
 #ifdef RLIMIT_NPROC
-    /* 'label'=value[UOM];[warn];[crit];[min];[max] */
-    printf ("nbr_%s=%ld;%lu;%lu;0 ", procs_list_node_get_username (node),
-	    procs_list_node_get_nbr (node),
-	    procs_list_node_get_rlimit_nproc_soft (node),
-	    procs_list_node_get_rlimit_nproc_hard (node));
-#else
-    printf ("nbr_%s=%ld ", procs_list_node_get_username (node),
-	    procs_list_node_get_nbr (node));
+      /* 'label'=value[UOM];[warn];[crit];[min];[max] */
+      char soft[32], hard[32];
+      snprintf (soft, sizeof soft, "%lu",
+		procs_list_node_get_rlimit_nproc_soft (node));
+      snprintf (hard, sizeof hard, "%lu",
+		procs_list_node_get_rlimit_nproc_hard (node));
+      metric.warning = soft;
+      metric.critical = hard;
+      metric.min = "0";
 #endif
-  putchar ('\n');
+      metrics_add (metrics, &metric, procs_list_node_get_nbr (node));
+      free (label);
+    }
+
+  char *status_msg =
+    xasprintf ("%s %s - %ld running processes", program_name_short,
+	       state_text (status),
+	       procs_list_node_get_total_procs_nbr (procs_list));
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
 
   return status;
 }
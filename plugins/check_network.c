@@ -20,6 +20,7 @@
  *
  */
 
+#include <errno.h>
 #include <getopt.h>
 #include <stdlib.h>
 #include <linux/ethtool.h>
@@ -29,13 +30,19 @@
 # include <linux/rtnetlink.h>
 #endif
 #include <string.h>
+#include <unistd.h>
 
 #include "common.h"
 #include "logging.h"
 #include "messages.h"
+#include "metrics.h"
 #include "netinfo.h"
+#include "netns.h"
+#include "netqueue.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
+#include "statefile.h"
 #include "string-macros.h"
 #include "system.h"
 #include "thresholds.h"
@@ -49,9 +56,12 @@ static const char *program_copyright =
   "Copyright (C) 2014,2015,2020 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
 
 static struct option const longopts[] = {
+  {(char *) "backlog", required_argument, NULL, 0},
   {(char *) "check-link", no_argument, NULL, 'k'},
   {(char *) "ifname", required_argument, NULL, 'i'},
   {(char *) "ifname-debug", no_argument, NULL, 0},
+  {(char *) "imbalance", required_argument, NULL, 0},
+  {(char *) "netns", no_argument, NULL, 'N'},
   {(char *) "no-bytes", no_argument, NULL, 'b'},
   {(char *) "no-collisions", no_argument, NULL, 'C'},
   {(char *) "no-drops", no_argument, NULL, 'd'},
@@ -61,6 +71,10 @@ static struct option const longopts[] = {
   {(char *) "no-packets", no_argument, NULL, 'p'},
   {(char *) "no-wireless", no_argument, NULL, 'W'},
   {(char *) "perc", no_argument, NULL, '%'},
+  {(char *) "qdisc", no_argument, NULL, 'Q'},
+  {(char *) "qdisc-drops", required_argument, NULL, 0},
+  {(char *) "queues", no_argument, NULL, 'q'},
+  {(char *) "queue-drops", required_argument, NULL, 0},
   {(char *) "rx-only", no_argument, NULL, 'r'},
   {(char *) "tx-only", no_argument, NULL, 't'},
   {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
@@ -85,10 +99,16 @@ usage (FILE * out)
   fputs ("This plugin displays some network interfaces statistics.\n", out);
   fputs (program_copyright, out);
   fputs (USAGE_HEADER, out);
-  fprintf (out, "  %s [-klW] [-bCdemp] [-i <ifname-regex>] [delay]\n",
+  fprintf (out, "  %s [-klNW] [-bCdemp] [-i <ifname-regex>] [delay]\n",
 	   program_name);
   fprintf (out, "  %s [-klW] [-bCdemp] [-i <ifname-regex>] --ifname-debug\n",
 	   program_name);
+  fprintf (out, "  %s --queues [-klW] [-i <ifname-regex>]\n"
+	   "     [--imbalance=COUNTER,COUNTER] [--queue-drops=COUNTER,COUNTER] "
+	   "[delay]\n", program_name);
+  fprintf (out, "  %s --qdisc [-klW] [-i <ifname-regex>]\n"
+	   "     [--qdisc-drops=COUNTER,COUNTER] [--backlog=COUNTER,COUNTER] "
+	   "[delay]\n", program_name);
   fputs (USAGE_OPTIONS, out);
   fputs ("  -i, --ifname         only display interfaces matching a regular "
 	 "expression\n", out);
@@ -97,11 +117,33 @@ usage (FILE * out)
   fputs ("  -k, --check-link     report an error if at least a link is down\n",
 	 out);
   fputs ("  -l, --no-loopback    skip the loopback interface\n", out);
+  fputs ("  -N, --netns          also check the interfaces of the other "
+	 "network namespaces\n", out);
   fputs ("  -W, --no-wireless    skip the wireless interfaces\n", out);
   fputs ("  -%, --perc           return percentage metrics if possible\n",
 	 out);
   fputs ("  -w, --warning COUNTER   warning threshold\n", out);
   fputs ("  -c, --critical COUNTER   critical threshold\n", out);
+  fputs ("  -q, --queues         check the RX and TX queues of the "
+	 "interfaces\n", out);
+  fputs ("      --imbalance=COUNTER,COUNTER   warning and critical "
+	 "thresholds on the\n"
+	 "                       ratio between the packets received by the "
+	 "busiest RX\n"
+	 "                       queue and the mean of the RX queues\n", out);
+  fputs ("      --queue-drops=COUNTER,COUNTER   warning and critical "
+	 "thresholds on the\n"
+	 "                       packets dropped per second by each queue\n",
+	 out);
+  fputs ("  -Q, --qdisc          check the root queueing disciplines of the "
+	 "interfaces\n", out);
+  fputs ("      --qdisc-drops=COUNTER,COUNTER   warning and critical "
+	 "thresholds on the\n"
+	 "                       packets dropped per second by the queueing "
+	 "discipline\n", out);
+  fputs ("      --backlog=COUNTER,COUNTER   warning and critical thresholds "
+	 "on the bytes\n"
+	 "                       queued in the queueing discipline\n", out);
   fputs (USAGE_HELP, out);
   fputs (USAGE_VERSION, out);
   fprintf (out, "  delay is the delay between the two network snapshots "
@@ -130,6 +172,24 @@ usage (FILE * out)
   fputs ("    See: https://man7.org/linux/man-pages/man7/regex.7.html\n", out);
   fputs ("  - You cannot select both the options r/rx-only and t/tx-only.\n",
 	 out);
+  fputs ("  - With --netns, the namespaces bound in " PATH_RUN_NETNS
+	 " and the ones of the\n"
+	 "    processes are entered in turn (this requires CAP_SYS_ADMIN), "
+	 "and their\n"
+	 "    interfaces are reported as IFNAME@NAMESPACE, the namespaces of "
+	 "the\n"
+	 "    processes being named pidPID.\n", out);
+  fputs ("  - With --qdisc, the statistics of the root (egress) queueing "
+	 "disciplines\n"
+	 "    are dumped with RTM_GETQDISC.  The interfaces without a "
+	 "queue (noqueue)\n"
+	 "    are skipped.\n", out);
+  fputs ("  - The statistics of the queues are the ethtool ones of the "
+	 "drivers reporting\n"
+	 "    them (for instance igb, ixgbe, i40e, ice, mlx5, virtio_net).\n",
+	 out);
+  fputs ("  With --queues and --qdisc:\n", out);
+  fputs (USAGE_STATEFILE, out);
   fputs (USAGE_EXAMPLES, out);
   fprintf (out, "  %s\n", program_name);
   fprintf (out, "  %s --check-link --ifname \"^(enp|eth)\" 15\n", program_name);
@@ -140,6 +200,11 @@ usage (FILE * out)
   fprintf (out, "  %s --perc --ifname \"^(enp|eth)\" -w 80%% 15\n",
 	   program_name);
   fprintf (out, "  %s --no-loopback --no-wireless 15\n", program_name);
+  fprintf (out, "  %s --netns --no-loopback --ifname ^eth 15\n", program_name);
+  fprintf (out, "  %s --queues -i ^eth --imbalance=2,4 --queue-drops=1,100\n",
+	   program_name);
+  fprintf (out, "  %s --qdisc -l --qdisc-drops=10,100 --backlog=1000000,"
+	   "10000000\n", program_name);
 
   exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
 }
@@ -175,24 +240,498 @@ ratio_over_speed (unsigned int counter, unsigned long long speed)
   return (double)(100.0 / speed) * counter;
 }
 
-static inline char *
-fmt_perfdata_bytes (const char *ifname, const char *label,
-		    unsigned int counter, unsigned long long speed, bool perc)
+static void
+add_metric_bytes (struct metrics *metrics, const char *ifname,
+		  const char *name, unsigned int counter,
+		  unsigned long long speed, bool perc)
 {
-  char *perfdata;
+  struct metric metric = {
+    .name = name, .label = "ifname", .label_value = ifname
+  };
+  char *max = NULL;
 
   if (perc && (speed > 0))
     {
-      double counter_perc = ratio_over_speed (counter, speed);
-      perfdata =
-	xasprintf ("%s_%s/s=%.2f%%;;;0;100.0", ifname, label, counter_perc);
+      metric.unit = "%";
+      metric.precision = 2;
+      metric.min = "0";
+      metric.max = "100.0";
+      metrics_add (metrics, &metric, ratio_over_speed (counter, speed));
+      return;
     }
-  else if (!perc && (speed > 0))
-    perfdata = xasprintf("%s_%s/s=%u;;;0;%llu", ifname, label, counter, speed);
-  else
-    perfdata = xasprintf ("%s_%s/s=%u", ifname, label, counter);
 
-  return perfdata;
+  if (speed > 0)
+    {
+      metric.min = "0";
+      metric.max = max = xasprintf ("%llu", speed);
+    }
+  metrics_add (metrics, &metric, counter);
+  free (max);
+}
+
+static void
+add_metric (struct metrics *metrics, const char *ifname,
+	    const char *name, unsigned int counter)
+{
+  struct metric metric = {
+    .name = name, .label = "ifname", .label_value = ifname
+  };
+
+  metrics_add (metrics, &metric, counter);
+}
+
+/* Exit with a critical state if the option --check-link is set and the
+   interface IFL is not up and running.  */
+
+static void
+check_link_up (struct iflist *ifl, unsigned int options)
+{
+  unsigned int flags = iflist_get_flags (ifl);
+
+  if ((options & CHECK_LINK)
+      && !(if_flags_UP (flags) && if_flags_RUNNING (flags)))
+    plugin_error (STATE_CRITICAL, 0,
+		  "%s matches the given regular expression "
+		  "but is not UP and RUNNING!", iflist_get_ifname (ifl));
+}
+
+/* The queues of an interface, their counters, and the rates computed */
+struct ifqueues
+{
+  const char *ifname;
+  struct netqueue *nq;
+  unsigned long long *counters;
+  unsigned long long *first;	/* the first sample, if taken now */
+  double *rates;
+  double imbalance;
+};
+
+/* Return the ratio between the packets per second received by the busiest
+   RX queue and the mean of the RX queues, 1.0 if the load is perfectly
+   balanced or if no packets have been received.  */
+
+static double
+queues_imbalance (const struct ifqueues *ifq)
+{
+  unsigned int n = netqueue_rx_queues (ifq->nq);
+  double max = 0, sum = 0;
+
+  if (n == 0 || n > netqueue_queues (ifq->nq))
+    n = netqueue_queues (ifq->nq);
+
+  for (unsigned int q = 0; q < n; q++)
+    {
+      double rate = ifq->rates[q * NETQUEUE_COUNTERS + NETQUEUE_RX_PACKETS];
+
+      sum += rate;
+      if (rate > max)
+	max = rate;
+    }
+
+  return (sum > 0) ? max / (sum / n) : 1.0;
+}
+
+struct queues_sample
+{
+  struct ifqueues *ifq;
+  size_t nifaces;
+};
+
+/* Read again the counters of the queues, the ones read before becoming
+   the first sample.  */
+
+static void
+queues_resample (void *data)
+{
+  struct queues_sample *sample = data;
+  struct ifqueues *ifq = sample->ifq;
+
+  for (size_t i = 0; i < sample->nifaces; i++)
+    {
+      size_t size = netqueue_queues (ifq[i].nq) * NETQUEUE_COUNTERS;
+
+      ifq[i].first = xnmalloc (size, sizeof (unsigned long long));
+      memcpy (ifq[i].first, ifq[i].counters,
+	      size * sizeof (unsigned long long));
+      if (netqueue_read (ifq[i].nq, ifq[i].counters) < 0)
+	plugin_error (STATE_UNKNOWN, errno,
+		      "cannot read the ethtool statistics of %s",
+		      ifq[i].ifname);
+    }
+}
+
+/* Read the counters of the queues of the interfaces in IFQ and compute
+   their rates, comparing them with the ones saved by the last execution
+   or, if missing or too recent, with a second sample taken after DELAY
+   seconds.  The interfaces share the delay.  */
+
+static void
+queues_rates (struct ifqueues *ifq, size_t nifaces, unsigned long delay)
+{
+  struct queues_sample sample = { ifq, nifaces };
+  struct statefile **states;
+  double *elapsed;
+  bool resampled;
+  size_t i, size;
+
+  states = xnmalloc (nifaces, sizeof (struct statefile *));
+  elapsed = xnmalloc (nifaces, sizeof (double));
+  for (i = 0; i < nifaces; i++)
+    {
+      size = netqueue_queues (ifq[i].nq) * NETQUEUE_COUNTERS;
+      ifq[i].counters = xnmalloc (size, sizeof (unsigned long long));
+      ifq[i].rates = xnmalloc (size, sizeof (double));
+      if (netqueue_read (ifq[i].nq, ifq[i].counters) < 0)
+	plugin_error (STATE_UNKNOWN, errno,
+		      "cannot read the ethtool statistics of %s",
+		      ifq[i].ifname);
+      states[i] = statefile_open (ifq[i].ifname, size);
+    }
+
+  resampled = statefile_sample_states (states, nifaces, delay, "queues",
+				       elapsed, queues_resample, &sample);
+
+  for (i = 0; i < nifaces; i++)
+    {
+      const unsigned long long *prev =
+	resampled ? ifq[i].first : statefile_get (states[i], "queues");
+
+      size = netqueue_queues (ifq[i].nq) * NETQUEUE_COUNTERS;
+      for (size_t j = 0; j < size; j++)
+	ifq[i].rates[j] = (ifq[i].counters[j] > prev[j]) ?
+	  (ifq[i].counters[j] - prev[j]) / elapsed[i] : 0;
+      ifq[i].imbalance = queues_imbalance (&ifq[i]);
+
+      statefile_put (states[i], "queues", ifq[i].counters);
+      if (statefile_save (states[i]) < 0)
+	dbg ("cannot save the state of %s: %s\n", ifq[i].ifname,
+	     strerror (errno));
+      statefile_free (states[i]);
+      free (ifq[i].first);
+    }
+
+  free (elapsed);
+  free (states);
+}
+
+/* Check the imbalance of the RX queues and the packets dropped by each
+   queue of the interfaces listed in IFLHEAD.  */
+
+static nagstatus
+check_queues (struct iflist *iflhead, unsigned int options,
+	      unsigned long delay, char *imbalance_warning,
+	      char *imbalance_critical, char *drops_warning,
+	      char *drops_critical)
+{
+  struct ifqueues *ifq = NULL;
+  struct iflist *ifl;
+  size_t nifaces = 0, nmetrics = 0, worst = 0, worst_drops = 0;
+  unsigned int worst_queue = 0;
+  double max_drops = -1;
+  thresholds *imbalance_threshold = NULL, *drops_threshold = NULL;
+  nagstatus status = STATE_OK;
+  char *message;
+
+  if (set_thresholds (&imbalance_threshold, imbalance_warning,
+		      imbalance_critical) == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&drops_threshold, drops_warning, drops_critical)
+	 == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  iflist_foreach (ifl, iflhead)
+    {
+      const char *ifname = iflist_get_ifname (ifl);
+      struct netqueue *nq;
+
+      check_link_up (ifl, options);
+      if (NULL == (nq = netqueue_open (ifname)))
+	{
+	  dbg ("%s: skipped, no per-queue statistics: %s\n", ifname,
+	       strerror (errno));
+	  continue;
+	}
+
+      ifq = xrealloc (ifq, (nifaces + 1) * sizeof (struct ifqueues));
+      memset (&ifq[nifaces], 0, sizeof (struct ifqueues));
+      ifq[nifaces].ifname = ifname;
+      ifq[nifaces].nq = nq;
+      nmetrics += 2 + netqueue_queues (nq) * NETQUEUE_COUNTERS;
+      nifaces++;
+    }
+
+  if (nifaces == 0)
+    plugin_error (STATE_UNKNOWN, 0,
+		  "no interface with per-queue statistics found");
+
+  queues_rates (ifq, nifaces, delay);
+
+  struct metrics *metrics = metrics_new ("network", nmetrics);
+  struct metric metric = { .min = "0" };
+  char name[32], queue_name[32];
+
+  for (size_t i = 0; i < nifaces; i++)
+    {
+      nagstatus s = get_status (ifq[i].imbalance, imbalance_threshold);
+
+      if (status < s)
+	status = s;
+      if (ifq[i].imbalance > ifq[worst].imbalance)
+	worst = i;
+
+      metric.label = "ifname";
+      metric.label_value = ifq[i].ifname;
+      metric.name = "rxqueues";
+      metric.precision = 0;
+      metric.warning = metric.critical = NULL;
+      metrics_add (metrics, &metric, netqueue_rx_queues (ifq[i].nq));
+      metric.name = "imbalance";
+      metric.precision = 2;
+      metric.warning = imbalance_warning;
+      metric.critical = imbalance_critical;
+      metrics_add (metrics, &metric, ifq[i].imbalance);
+
+      metric.label = "queue";
+      for (unsigned int q = 0; q < netqueue_queues (ifq[i].nq); q++)
+	{
+	  snprintf (queue_name, sizeof queue_name, "%s_q%u", ifq[i].ifname, q);
+	  metric.label_value = queue_name;
+	  for (int c = 0; c < NETQUEUE_COUNTERS; c++)
+	    {
+	      double rate = ifq[i].rates[q * NETQUEUE_COUNTERS + c];
+	      bool drops = (c == NETQUEUE_RX_DROPS || c == NETQUEUE_TX_DROPS);
+
+	      if (!netqueue_has_counter (ifq[i].nq, c))
+		continue;
+
+	      snprintf (name, sizeof name, "%s/s", netqueue_counter_name (c));
+	      metric.name = name;
+	      metric.warning = drops ? drops_warning : NULL;
+	      metric.critical = drops ? drops_critical : NULL;
+	      metrics_add (metrics, &metric, rate);
+	      if (!drops)
+		continue;
+
+	      s = get_status (rate, drops_threshold);
+	      if (status < s)
+		status = s;
+	      if (rate > max_drops)
+		{
+		  max_drops = rate;
+		  worst_drops = i;
+		  worst_queue = q;
+		}
+	    }
+	}
+    }
+
+  message =
+    xasprintf ("network queues %s - %zu interface(s) with per-queue "
+	       "statistics, RX imbalance %.2f (%s)", state_text (status),
+	       nifaces, ifq[worst].imbalance, ifq[worst].ifname);
+  if (max_drops >= 0)
+    {
+      char *drops_message =
+	xasprintf ("%s, %.2f packets dropped/s (%s queue %u)", message,
+		   max_drops, ifq[worst_drops].ifname, worst_queue);
+
+      free (message);
+      message = drops_message;
+    }
+  metrics_write (metrics, status, message);
+
+  for (size_t i = 0; i < nifaces; i++)
+    {
+      netqueue_free (ifq[i].nq);
+      free (ifq[i].counters);
+      free (ifq[i].rates);
+    }
+  free (ifq);
+  free (message);
+  free (imbalance_threshold);
+  free (drops_threshold);
+
+  return status;
+}
+
+/* Return the root qdisc of the interface IFINDEX among the NQDISCS of
+   QDISCS, or NULL.  The "noqueue" ones are ignored.  */
+
+static const struct qdisc_stats *
+qdisc_lookup (const struct qdisc_stats *qdiscs, size_t nqdiscs, int ifindex)
+{
+  for (size_t i = 0; i < nqdiscs; i++)
+    if (qdiscs[i].ifindex == ifindex && STRNEQ (qdiscs[i].kind, "noqueue"))
+      return &qdiscs[i];
+  return NULL;
+}
+
+struct qdisc_sample
+{
+  struct qdisc_stats *qdiscs;
+  size_t nqdiscs;
+  struct qdisc_stats *first;	/* the first dump, if taken now */
+  size_t nfirst;
+};
+
+/* Dump the queueing disciplines again, the ones read before becoming the
+   first dump.  */
+
+static void
+qdisc_resample (void *data)
+{
+  struct qdisc_sample *sample = data;
+
+  sample->first = sample->qdiscs;
+  sample->nfirst = sample->nqdiscs;
+  sample->qdiscs = qdisc_read (&sample->nqdiscs);
+}
+
+/* Check the packets dropped per second and the backlog of the root
+   queueing disciplines of the interfaces listed in IFLHEAD, selected by
+   IFNAME_REGEX.  The rates are computed against the counters saved by the
+   last execution with the same regex or, if missing or too recent, against
+   a second dump taken after DELAY seconds.  */
+
+static nagstatus
+check_qdiscs (struct iflist *iflhead, const char *ifname_regex,
+	      unsigned int options, unsigned long delay, char *drops_warning,
+	      char *drops_critical, char *backlog_warning,
+	      char *backlog_critical)
+{
+  struct qdisc_sample sample = { NULL, 0, NULL, 0 };
+  struct statefile *state;
+  struct iflist *ifl;
+  const char **keys = NULL;
+  size_t nkeys = 0, nifaces = 0;
+  double elapsed, worst_drops = -1;
+  const char *worst_ifname = NULL;
+  const struct qdisc_stats *worst = NULL;
+  thresholds *drops_threshold = NULL, *backlog_threshold = NULL;
+  nagstatus status = STATE_OK;
+  char *message, *id;
+
+  if (set_thresholds (&drops_threshold, drops_warning, drops_critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&backlog_threshold, backlog_warning,
+			 backlog_critical) == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  iflist_foreach (ifl, iflhead)
+    check_link_up (ifl, options);
+
+  sample.qdiscs = qdisc_read (&sample.nqdiscs);
+  id = xasprintf ("qdisc %s", ifname_regex ? ifname_regex : "");
+  state = statefile_open (id, QDISC_COUNTERS);
+  free (id);
+
+  /* all the interfaces with a queueing discipline must have been saved */
+  iflist_foreach (ifl, iflhead)
+    if (qdisc_lookup (sample.qdiscs, sample.nqdiscs,
+		      iflist_get_ifindex (ifl)))
+      {
+	keys = xrealloc (keys, (nkeys + 1) * sizeof (const char *));
+	keys[nkeys++] = iflist_get_ifname (ifl);
+      }
+  if (nkeys == 0)
+    plugin_error (STATE_UNKNOWN, 0,
+		  "no interface with a queueing discipline found");
+
+  elapsed = statefile_sample (state, delay, keys, nkeys, qdisc_resample,
+			      &sample);
+  free (keys);
+
+  struct metrics *metrics = metrics_new ("network", 8 * nkeys);
+  struct metric metric = { .label = "ifname", .min = "0" };
+  char name[32];
+
+  iflist_foreach (ifl, iflhead)
+    {
+      const char *ifname = iflist_get_ifname (ifl);
+      const struct qdisc_stats *qdisc =
+	qdisc_lookup (sample.qdiscs, sample.nqdiscs, iflist_get_ifindex (ifl));
+      const struct qdisc_stats *prev_qdisc;
+      const unsigned long long *prev;
+      double rates[QDISC_COUNTERS];
+      nagstatus s;
+
+      /* the interfaces are counted on the dump the rates are computed
+	 from, that may be the second one */
+      if (NULL == qdisc)
+	continue;
+      nifaces++;
+      if (sample.first)
+	{
+	  prev_qdisc = qdisc_lookup (sample.first, sample.nfirst,
+				     qdisc->ifindex);
+	  prev = prev_qdisc ? prev_qdisc->counter : qdisc->counter;
+	}
+      else
+	prev = statefile_get (state, ifname);
+
+      for (int c = 0; c < QDISC_COUNTERS; c++)
+	rates[c] = (qdisc->counter[c] > prev[c]) ?
+	  (qdisc->counter[c] - prev[c]) / elapsed : 0;
+      statefile_put (state, ifname, qdisc->counter);
+
+      s = get_status (rates[QDISC_DROPS], drops_threshold);
+      if (status < s)
+	status = s;
+      s = get_status (qdisc->backlog, backlog_threshold);
+      if (status < s)
+	status = s;
+      if (NULL == worst || rates[QDISC_DROPS] > worst_drops
+	  || (rates[QDISC_DROPS] == worst_drops
+	      && qdisc->backlog > worst->backlog))
+	{
+	  worst_drops = rates[QDISC_DROPS];
+	  worst = qdisc;
+	  worst_ifname = ifname;
+	}
+
+      metric.label_value = ifname;
+      metric.precision = 2;
+      for (int c = 0; c < QDISC_COUNTERS; c++)
+	{
+	  snprintf (name, sizeof name, "qdisc_%s/s", qdisc_counter_name (c));
+	  metric.name = name;
+	  metric.warning = (c == QDISC_DROPS) ? drops_warning : NULL;
+	  metric.critical = (c == QDISC_DROPS) ? drops_critical : NULL;
+	  metrics_add (metrics, &metric, rates[c]);
+	}
+      metric.precision = 0;
+      metric.name = "qdisc_backlog";
+      metric.unit = "B";
+      metric.warning = backlog_warning;
+      metric.critical = backlog_critical;
+      metrics_add (metrics, &metric, qdisc->backlog);
+      metric.name = "qdisc_qlen";
+      metric.unit = NULL;
+      metric.warning = metric.critical = NULL;
+      metrics_add (metrics, &metric, qdisc->qlen);
+    }
+
+  if (statefile_save (state) < 0)
+    dbg ("cannot save the state: %s\n", strerror (errno));
+  statefile_free (state);
+
+  /* the queueing disciplines may have been removed meanwhile */
+  if (NULL == worst)
+    plugin_error (STATE_UNKNOWN, 0,
+		  "no interface with a queueing discipline found");
+
+  message =
+    xasprintf ("network qdisc %s - %zu interface(s), %.2f packets dropped/s "
+	       "and %u bytes queued by %s (%s)", state_text (status), nifaces,
+	       worst_drops, worst->backlog, worst_ifname, worst->kind);
+  metrics_write (metrics, status, message);
+
+  free (message);
+  free (sample.qdiscs);
+  free (sample.first);
+  free (drops_threshold);
+  free (backlog_threshold);
+
+  return status;
 }
 
 int
@@ -200,30 +739,40 @@ main (int argc, char **argv)
 {
   int c, option_index = 0;
   nagstatus status;
-  bool ifname_debug = false,
+  bool all_netns = false,
+       ifname_debug = false,
        pd_bytes = true,
        pd_collisions = true,
        pd_drops = true,
        pd_errors = true,
        pd_multicast = true,
        pd_packets = true,
+       qdisc = false,
+       queues = false,
        report_perc = false,
        rx_only = false,
        tx_only = false;
   char *p = NULL, *plugin_progname,
        *critical = NULL, *warning = NULL,
-       *bp, *ifname_regex = NULL;
-  size_t size;
+       *bp, *ifname_regex = NULL,
+       *imbalance_critical = NULL, *imbalance_warning = NULL,
+       *drops_critical = NULL, *drops_warning = NULL,
+       *backlog_critical = NULL, *backlog_warning = NULL,
+       *qdisc_critical = NULL, *qdisc_warning = NULL;
+  size_t size, nnetns = 0;
   unsigned int options = 0;
   unsigned long delay, len;
-  FILE *perfdata;
+  FILE *message;
+  struct metrics *metrics;
   network_check check = CHECK_DEFAULT;
   thresholds *my_threshold = NULL;
+  struct netns *netns = NULL;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
-			   "Cc:bdei:klmpWw:%" GETOPT_HELP_VERSION_STRING,
+			   "Cc:bdei:klmNpQqWw:%" GETOPT_HELP_VERSION_STRING,
 			   longopts, &option_index)) != -1)
     {
       switch (c)
@@ -233,6 +782,35 @@ main (int argc, char **argv)
 	case 0:
 	  if (STREQ (longopts[option_index].name, "ifname-debug"))
 	    ifname_debug = true;
+	  else if (STREQ (longopts[option_index].name, "backlog"))
+	    {
+	      backlog_warning = xstrdup (optarg);
+	      if (NULL == (backlog_critical = strchr (backlog_warning, ',')))
+		usage (stderr);
+	      *backlog_critical++ = '\0';
+	    }
+	  else if (STREQ (longopts[option_index].name, "imbalance"))
+	    {
+	      imbalance_warning = xstrdup (optarg);
+	      if (NULL == (imbalance_critical =
+			   strchr (imbalance_warning, ',')))
+		usage (stderr);
+	      *imbalance_critical++ = '\0';
+	    }
+	  else if (STREQ (longopts[option_index].name, "queue-drops"))
+	    {
+	      drops_warning = xstrdup (optarg);
+	      if (NULL == (drops_critical = strchr (drops_warning, ',')))
+		usage (stderr);
+	      *drops_critical++ = '\0';
+	    }
+	  else if (STREQ (longopts[option_index].name, "qdisc-drops"))
+	    {
+	      qdisc_warning = xstrdup (optarg);
+	      if (NULL == (qdisc_critical = strchr (qdisc_warning, ',')))
+		usage (stderr);
+	      *qdisc_critical++ = '\0';
+	    }
 	  break;
 	case 'b':
 	  options |= NO_BYTES;
@@ -266,10 +844,19 @@ main (int argc, char **argv)
 	  options |= NO_MULTICAST;
 	  pd_multicast = false;
 	  break;
+	case 'N':
+	  all_netns = true;
+	  break;
 	case 'p':
 	  options |= NO_PACKETS;
 	  pd_packets = false;
 	  break;
+	case 'Q':
+	  qdisc = true;
+	  break;
+	case 'q':
+	  queues = true;
+	  break;
 	case 'r':
 	  options |= RX_ONLY;
 	  rx_only = true;
@@ -310,6 +897,32 @@ main (int argc, char **argv)
   if (tx_only && rx_only)
     usage (stderr);
 
+  if (queues || qdisc)
+    {
+      unsigned int ninterfaces;
+      struct iflist *iflhead;
+
+      if (ifname_debug || all_netns || (queues && qdisc))
+	usage (stderr);
+
+      iflhead = netinfo (options, ifname_regex, 0, &ninterfaces);
+      if (queues)
+	status = check_queues (iflhead, options, delay, imbalance_warning,
+			       imbalance_critical, drops_warning,
+			       drops_critical);
+      else
+	status = check_qdiscs (iflhead, ifname_regex, options, delay,
+			       qdisc_warning, qdisc_critical, backlog_warning,
+			       backlog_critical);
+
+      freeiflist (iflhead);
+      free (imbalance_warning);
+      free (drops_warning);
+      free (qdisc_warning);
+      free (backlog_warning);
+      return status;
+    }
+
   len = strlen (program_name);
   if (len > 6 && STRPREFIX (program_name, "check_"))
     p = (char *) program_name + 6;
@@ -349,8 +962,18 @@ main (int argc, char **argv)
     plugin_progname = xstrdup ("network");
 
   unsigned int ninterfaces;
-  struct iflist *ifl, *iflhead =
-    netinfo (options, ifname_regex, delay, &ninterfaces);
+  struct iflist *ifl, *iflhead;
+
+  if (all_netns)
+    {
+      if (NULL == (netns = netns_list (&nnetns)))
+	plugin_error (STATE_UNKNOWN, errno,
+		      "cannot list the network namespaces");
+      iflhead = netinfo_netns (netns, nnetns, options, ifname_regex, delay,
+			       &ninterfaces);
+    }
+  else
+    iflhead = netinfo (options, ifname_regex, delay, &ninterfaces);
 
   /* just print the list of matching interfaces and exit */
   if (ifname_debug)
@@ -363,7 +986,7 @@ main (int argc, char **argv)
   if (status == NP_RANGE_UNPARSEABLE)
     usage (stderr);
 
-  perfdata = open_memstream (&bp, &size);
+  metrics = metrics_new ("network", 12 * ninterfaces);
   status = STATE_OK;
 
   iflist_foreach (ifl, iflhead)
@@ -428,60 +1051,61 @@ main (int argc, char **argv)
 
       if (pd_bytes)
 	{
-	  char *perfdata_txbyte =
-	    fmt_perfdata_bytes (ifname, "txbyte", iflist_get_tx_bytes (ifl),
-				speed, report_perc);
-	  char *perfdata_rxbyte =
-	    fmt_perfdata_bytes (ifname, "rxbyte", iflist_get_rx_bytes (ifl),
-				speed, report_perc);
-	  fprintf (perfdata, "%s %s ", perfdata_txbyte, perfdata_rxbyte);
-	  free (perfdata_txbyte);
-	  free (perfdata_rxbyte);
+	  add_metric_bytes (metrics, ifname, "txbyte/s",
+			    iflist_get_tx_bytes (ifl), speed, report_perc);
+	  add_metric_bytes (metrics, ifname, "rxbyte/s",
+			    iflist_get_rx_bytes (ifl), speed, report_perc);
 	}
       if (pd_errors)
-	fprintf (perfdata
-		, "%s_txerr/s=%u %s_rxerr/s=%u "
-		, ifname, iflist_get_tx_errors (ifl)
-		, ifname, iflist_get_rx_errors (ifl));
+	{
+	  add_metric (metrics, ifname, "txerr/s", iflist_get_tx_errors (ifl));
+	  add_metric (metrics, ifname, "rxerr/s", iflist_get_rx_errors (ifl));
+	}
       if (pd_drops)
-	fprintf (perfdata
-		, "%s_txdrop/s=%u %s_rxdrop/s=%u "
-		, ifname, iflist_get_tx_dropped (ifl)
-		, ifname, iflist_get_rx_dropped (ifl));
+	{
+	  add_metric (metrics, ifname, "txdrop/s",
+		      iflist_get_tx_dropped (ifl));
+	  add_metric (metrics, ifname, "rxdrop/s",
+		      iflist_get_rx_dropped (ifl));
+	}
       if (pd_packets)
-        fprintf (perfdata
-		 , "%s_txpck/s=%u %s_rxpck/s=%u "
-		 , ifname, iflist_get_tx_packets (ifl)
-		 , ifname, iflist_get_rx_packets (ifl));
+	{
+	  add_metric (metrics, ifname, "txpck/s",
+		      iflist_get_tx_packets (ifl));
+	  add_metric (metrics, ifname, "rxpck/s",
+		      iflist_get_rx_packets (ifl));
+	}
       if (pd_collisions)
-        fprintf (perfdata, "%s_coll/s=%u "
-		 , ifname, iflist_get_collisions (ifl));
+	add_metric (metrics, ifname, "coll/s", iflist_get_collisions (ifl));
       if (pd_multicast)
-        fprintf (perfdata, "%s_mcast/s=%u "
-		 , ifname, iflist_get_multicast (ifl));
+	add_metric (metrics, ifname, "mcast/s", iflist_get_multicast (ifl));
     }
 
-  fclose (perfdata);
-
   if (ninterfaces < 1)
     status = STATE_UNKNOWN;
 
   int i = 0;
-  printf ("%s %s - found %u interface(s): "
-	  , plugin_progname
-	  , state_text (status)
-	  , ninterfaces);
+  message = open_memstream (&bp, &size);
+  fprintf (message, "%s %s - found %u interface(s): "
+	   , plugin_progname
+	   , state_text (status)
+	   , ninterfaces);
   iflist_foreach (ifl, iflhead)
     if (i++ < MAX_PRINTED_INTERFACES)
-      printf ("%s%s", i < 2 ? "" : ",", iflist_get_ifname (ifl));
+      fprintf (message, "%s%s", i < 2 ? "" : ",", iflist_get_ifname (ifl));
     else
       {
-	printf (",...");
+	fputs (",...", message);
 	break;
       }
-  printf (" | %s\n", bp);
+  fclose (message);
+
+  metrics_write (metrics, status, bp);
+  free (bp);
 
   freeiflist (iflhead);
+  if (netns)
+    netns_list_free (netns, nnetns);
   free (my_threshold);
 
   return status;
@@ -0,0 +1,486 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A Nagios plugin that checks the latency and the retransmissions of the
+ * RPC requests of the NFS mounts.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "logging.h"
+#include "messages.h"
+#include "metrics.h"
+#include "mountlist.h"
+#include "mountstats.h"
+#include "progname.h"
+#include "progversion.h"
+#include "result_cache.h"
+#include "statefile.h"
+#include "string-macros.h"
+#include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+#include "xstrton.h"
+
+#define NFSMOUNT_COUNTERS  (MOUNTSTATS_OPS * MOUNTSTATS_COUNTERS)
+
+static const char *program_copyright =
+  "Copyright (C) 2026 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
+
+static struct option const longopts[] = {
+  {(char *) "mountpoint", required_argument, NULL, 'm'},
+  {(char *) "type", required_argument, NULL, 'T'},
+  {(char *) "exclude-type", required_argument, NULL, 'X'},
+  {(char *) "retrans", required_argument, NULL, 'r'},
+  {(char *) "critical", required_argument, NULL, 'c'},
+  {(char *) "warning", required_argument, NULL, 'w'},
+  {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
+  {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
+  {NULL, 0, NULL, 0}
+};
+
+static _Noreturn void
+usage (FILE * out)
+{
+  fprintf (out, "%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs ("This plugin checks the latency and the retransmissions of the RPC "
+	 "requests of\nthe NFS mounts.\n", out);
+  fputs (program_copyright, out);
+  fputs (USAGE_HEADER, out);
+  fprintf (out, "  %s [-m DIR]... [-T TYPE]... [-X TYPE]... [-r PERC,PERC] "
+	   "[-w MSEC] [-c MSEC]\n"
+	   "     [delay]\n", program_name);
+  fputs (USAGE_OPTIONS, out);
+  fputs ("  -m, --mountpoint DIR   only check the NFS file system mounted on "
+	 "DIR\n", out);
+  fputs ("  -T, --type=TYPE   only check the file systems of type TYPE "
+	 "(nfs, nfs4)\n", out);
+  fputs ("  -X, --exclude-type=TYPE   do not check the file systems of type "
+	 "TYPE\n", out);
+  fputs ("  -r, --retrans=PERC,PERC   warning and critical thresholds on the "
+	 "percentage\n"
+	 "                  of the requests retransmitted\n", out);
+  fputs ("  -w, --warning MSEC   warning threshold on the mean execution time "
+	 "of the\n"
+	 "                  requests\n", out);
+  fputs ("  -c, --critical MSEC   critical threshold on the mean execution "
+	 "time of the\n"
+	 "                  requests\n", out);
+  fputs (USAGE_HELP, out);
+  fputs (USAGE_VERSION, out);
+  fprintf (out, "  \"delay\" is the delay in seconds between two samples of "
+	   "the counters\n"
+	   "    (default: %dsec)\n", DELAY_DEFAULT);
+  fputs (USAGE_NOTE, out);
+  fputs ("  The READ, WRITE, GETATTR, and LOOKUP requests of each mount are "
+	 "read from\n"
+	 "  /proc/self/mountstats, and the thresholds apply to each of them.  "
+	 "The\n"
+	 "  execution time of a request is the time spent in the queue of the "
+	 "client\n"
+	 "  plus the round trip time to the server.\n", out);
+  fputs (USAGE_STATEFILE, out);
+  fputs (USAGE_EXAMPLES, out);
+  fprintf (out, "  %s -w 20 -c 100 -r 1,5\n", program_name);
+  fprintf (out, "  %s --mountpoint /srv/data -T nfs4 -c 50\n", program_name);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static _Noreturn void
+print_version (void)
+{
+  printf ("%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs (program_copyright, stdout);
+  fputs (GPLv3_DISCLAIMER, stdout);
+
+  exit (STATE_OK);
+}
+
+/* A NFS mount and its counters, the counter C of the operation OP being at
+   OP * MOUNTSTATS_COUNTERS + C.  */
+
+struct nfsmount
+{
+  char *mountdir;
+  char *fstype;
+  unsigned long long counters[NFSMOUNT_COUNTERS];
+  bool selected;
+};
+
+struct nfsmounts
+{
+  struct nfsmount *mounts;
+  size_t nmounts;
+};
+
+/* Add the mount MS to the list DATA.  A directory can be mounted more than
+   once, the last mount hiding the others.  */
+
+static void
+nfsmounts_add (const struct mountstats *ms, void *data)
+{
+  struct nfsmounts *list = data;
+  struct nfsmount *m = NULL;
+
+  for (size_t i = 0; i < list->nmounts; i++)
+    if (STREQ (list->mounts[i].mountdir, ms->mountdir))
+      {
+	m = &list->mounts[i];
+	free (m->fstype);
+	break;
+      }
+
+  if (NULL == m)
+    {
+      list->mounts = xrealloc (list->mounts, (list->nmounts + 1)
+			       * sizeof (struct nfsmount));
+      m = &list->mounts[list->nmounts++];
+      m->mountdir = xstrdup (ms->mountdir);
+    }
+
+  m->fstype = xstrdup (ms->fstype);
+  m->selected = false;
+  memcpy (m->counters, ms->counter, sizeof (m->counters));
+  dbg ("NFS mount %s (%s) on %s\n", ms->devname, ms->fstype, ms->mountdir);
+}
+
+static void
+nfsmounts_read (struct nfsmounts *list)
+{
+  list->mounts = NULL;
+  list->nmounts = 0;
+  if (mountstats_read (nfsmounts_add, list) < 0)
+    plugin_error (STATE_UNKNOWN, errno, "cannot read /proc/self/mountstats");
+}
+
+static void
+nfsmounts_free (struct nfsmounts *list)
+{
+  for (size_t i = 0; i < list->nmounts; i++)
+    {
+      free (list->mounts[i].mountdir);
+      free (list->mounts[i].fstype);
+    }
+  free (list->mounts);
+}
+
+static const struct nfsmount *
+nfsmounts_lookup (const struct nfsmounts *list, const char *mountdir)
+{
+  for (size_t i = 0; i < list->nmounts; i++)
+    if (STREQ (list->mounts[i].mountdir, mountdir))
+      return &list->mounts[i];
+  return NULL;
+}
+
+/* Select the mounts of LIST matching FILTER and, if any, the mount
+   points MOUNTDIRS.  Return the number of the mounts selected.  */
+
+static size_t
+nfsmounts_select (struct nfsmounts *list, const struct mount_filter *filter,
+		  const struct mount_entry *mount_list, char **mountdirs,
+		  size_t nmountdirs)
+{
+  size_t nselected = 0, i, j;
+
+  for (i = 0; i < list->nmounts; i++)
+    {
+      struct nfsmount *m = &list->mounts[i];
+      const struct mount_entry *me, *found = NULL;
+
+      for (j = 0; j < nmountdirs; j++)
+	if (STREQ (mountdirs[j], m->mountdir))
+	  break;
+      if (nmountdirs > 0 && j == nmountdirs)
+	continue;
+
+      for (me = mount_list; me; me = me->me_next)
+	if (STREQ (me->me_mountdir, m->mountdir))
+	  found = me;
+      if (NULL == found || mount_filter_skip (filter, found))
+	{
+	  dbg ("skipping the NFS mount %s\n", m->mountdir);
+	  continue;
+	}
+
+      m->selected = true;
+      nselected++;
+    }
+
+  return nselected;
+}
+
+/* The second sample of the mounts, taken if the saved one cannot be used */
+
+struct nfsmounts_sample
+{
+  struct nfsmounts *second;
+  const struct mount_filter *filter;
+  const struct mount_entry *mount_list;
+  char **mountdirs;
+  size_t nmountdirs;
+  bool resampled;
+};
+
+static void
+nfsmounts_resample (void *data)
+{
+  struct nfsmounts_sample *sample = data;
+
+  nfsmounts_read (sample->second);
+  nfsmounts_select (sample->second, sample->filter, sample->mount_list,
+		    sample->mountdirs, sample->nmountdirs);
+  sample->resampled = true;
+}
+
+int
+main (int argc, char **argv)
+{
+  int c;
+  char *critical = NULL, *warning = NULL, *retrans_critical = NULL,
+       *retrans_warning = NULL, *message = NULL, **mountdirs = NULL;
+  unsigned long delay = DELAY_DEFAULT;
+  nagstatus status = STATE_OK, worst_status = STATE_OK, s;
+  thresholds *my_threshold = NULL, *retrans_threshold = NULL;
+  struct mount_filter filter = { 0 };
+  struct mount_entry *mount_list;
+  struct nfsmounts first, second, *current = &first;
+  struct statefile *state;
+  const struct nfsmount *worst = NULL;
+  size_t i, nmountdirs = 0, nselected;
+  unsigned int worst_op = 0;
+  double elapsed, worst_execute = -1, worst_rtt = 0, worst_retrans = 0;
+
+  set_program_name (argv[0]);
+  result_cache_init (argc, argv);
+
+  while ((c = getopt_long (argc, argv,
+			   "m:T:X:r:c:w:" GETOPT_HELP_VERSION_STRING,
+			   longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'm':
+	  mountdirs = xrealloc (mountdirs, (nmountdirs + 1) * sizeof (char *));
+	  mountdirs[nmountdirs++] = optarg;
+	  break;
+	case 'T':
+	  mount_filter_add_type (&filter, optarg);
+	  break;
+	case 'X':
+	  mount_filter_exclude_type (&filter, optarg);
+	  break;
+	case 'r':
+	  retrans_warning = xstrdup (optarg);
+	  if (NULL == (retrans_critical = strchr (retrans_warning, ',')))
+	    usage (stderr);
+	  *retrans_critical++ = '\0';
+	  break;
+	case 'c':
+	  critical = optarg;
+	  break;
+	case 'w':
+	  warning = optarg;
+	  break;
+
+	case_GETOPT_HELP_CHAR
+	case_GETOPT_VERSION_CHAR
+
+	}
+    }
+
+  if (optind < argc)
+    {
+      delay = strtol_or_err (argv[optind++], "failed to parse argument");
+
+      if (delay < 1)
+	plugin_error (STATE_UNKNOWN, 0, "delay must be positive integer");
+      else if (DELAY_MAX < delay)
+	plugin_error (STATE_UNKNOWN, 0,
+		      "too large delay value (greater than %d)", DELAY_MAX);
+    }
+
+  if (mount_filter_conflict (&filter))
+    plugin_error (STATE_UNKNOWN, 0,
+		  "file system type `%s' both selected and excluded",
+		  mount_filter_conflict (&filter));
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&retrans_threshold, retrans_warning,
+			 retrans_critical) == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  if (NULL == (mount_list = read_file_system_list (true)))
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot read table of mounted file systems");
+
+  /* The counters of all the NFS mounts are saved, so that the checks of
+     different mounts do not discard the samples of each other.  */
+  nfsmounts_read (&first);
+  nselected = nfsmounts_select (&first, &filter, mount_list, mountdirs,
+				nmountdirs);
+  if (nselected == 0 && nmountdirs > 0)
+    plugin_error (STATE_UNKNOWN, 0, "no NFS mount found on %s%s",
+		  mountdirs[0], nmountdirs > 1 ? " (and others)" : "");
+
+  state = statefile_open ("mountstats", NFSMOUNT_COUNTERS);
+  elapsed = statefile_elapsed (state);
+  if (nselected > 0)
+    {
+      struct nfsmounts_sample sample = {
+	&second, &filter, mount_list, mountdirs, nmountdirs, false
+      };
+      const char **keys = xnmalloc (first.nmounts, sizeof (const char *));
+
+      for (i = 0; i < first.nmounts; i++)
+	keys[i] = first.mounts[i].selected ? first.mounts[i].mountdir : NULL;
+      elapsed = statefile_sample (state, delay, keys, first.nmounts,
+				  nfsmounts_resample, &sample);
+      if (sample.resampled)
+	current = &second;
+      free (keys);
+    }
+
+  struct metrics *metrics =
+    metrics_new (program_name_short, 6 * MOUNTSTATS_OPS * nselected);
+  struct metric metric = { .label = "mount", .min = "0" };
+  char name[32];
+
+  for (i = 0; i < current->nmounts; i++)
+    {
+      const struct nfsmount *m = &current->mounts[i], *prev_mount;
+      const unsigned long long *prev;
+
+      if (!m->selected)
+	continue;
+      if (current == &second)
+	prev = (prev_mount = nfsmounts_lookup (&first, m->mountdir)) ?
+	  prev_mount->counters : m->counters;
+      else
+	prev = statefile_get (state, m->mountdir);
+
+      metric.label_value = m->mountdir;
+      for (unsigned int op = 0; op < MOUNTSTATS_OPS; op++)
+	{
+	  const unsigned long long *cur =
+	    &m->counters[op * MOUNTSTATS_COUNTERS],
+	    *old = &prev[op * MOUNTSTATS_COUNTERS];
+	  double delta[MOUNTSTATS_COUNTERS], calls, retrans, mean[3];
+	  nagstatus op_status;
+	  char opname[16], *p;
+
+	  for (size_t k = 0; k < MOUNTSTATS_COUNTERS; k++)
+	    delta[k] = (cur[k] > old[k]) ? cur[k] - old[k] : 0;
+	  calls = delta[MOUNTSTATS_CALLS];
+	  retrans = calls ? 100.0 * delta[MOUNTSTATS_RETRANS] / calls : 0;
+	  for (size_t k = 0; k < 3; k++)
+	    mean[k] = calls ? delta[MOUNTSTATS_QUEUE_MS + k] / calls : 0;
+
+	  op_status = get_status (mean[2], my_threshold);
+	  s = get_status (retrans, retrans_threshold);
+	  if (op_status < s)
+	    op_status = s;
+	  if (status < op_status)
+	    status = op_status;
+	  if (NULL == worst || op_status > worst_status
+	      || (op_status == worst_status && mean[2] > worst_execute))
+	    {
+	      worst = m;
+	      worst_op = op;
+	      worst_status = op_status;
+	      worst_execute = mean[2];
+	      worst_rtt = mean[1];
+	      worst_retrans = retrans;
+	    }
+
+	  snprintf (opname, sizeof opname, "%s", mountstats_op_name (op));
+	  for (p = opname; *p; p++)
+	    *p = tolower ((unsigned char) *p);
+
+	  metric.name = name;
+	  metric.unit = NULL;
+	  metric.precision = 2;
+	  metric.warning = metric.critical = metric.max = NULL;
+	  snprintf (name, sizeof name, "%s_calls/s", opname);
+	  metrics_add (metrics, &metric, calls / elapsed);
+	  snprintf (name, sizeof name, "%s_timeouts/s", opname);
+	  metrics_add (metrics, &metric, delta[MOUNTSTATS_TIMEOUTS] / elapsed);
+	  snprintf (name, sizeof name, "%s_retransmitted", opname);
+	  metric.unit = "%";
+	  metric.warning = retrans_warning;
+	  metric.critical = retrans_critical;
+	  metric.max = "100";
+	  metrics_add (metrics, &metric, retrans);
+
+	  metric.unit = "ms";
+	  metric.max = NULL;
+	  metric.warning = metric.critical = NULL;
+	  snprintf (name, sizeof name, "%s_queue", opname);
+	  metrics_add (metrics, &metric, mean[0]);
+	  snprintf (name, sizeof name, "%s_rtt", opname);
+	  metrics_add (metrics, &metric, mean[1]);
+	  snprintf (name, sizeof name, "%s_execute", opname);
+	  metric.warning = warning;
+	  metric.critical = critical;
+	  metrics_add (metrics, &metric, mean[2]);
+	}
+    }
+
+  for (i = 0; i < current->nmounts; i++)
+    statefile_put (state, current->mounts[i].mountdir,
+		   current->mounts[i].counters);
+  if (statefile_save (state) < 0)
+    dbg ("cannot save the state: %s\n", strerror (errno));
+  statefile_free (state);
+
+  if (worst)
+    message =
+      xasprintf ("%s %s - %zu NFS mount(s), the slowest being %s on %s: "
+		 "%.2fms (rtt %.2fms), %.2f%% retransmitted",
+		 program_name_short, state_text (status), nselected,
+		 mountstats_op_name (worst_op), worst->mountdir, worst_execute,
+		 worst_rtt, worst_retrans);
+  else
+    message = xasprintf ("%s %s - no NFS mounts found", program_name_short,
+			 state_text (status));
+  metrics_write (metrics, status, message);
+
+  free (message);
+  if (current == &second)
+    nfsmounts_free (&second);
+  nfsmounts_free (&first);
+  free (mountdirs);
+  free (retrans_warning);
+  free (my_threshold);
+  free (retrans_threshold);
+
+  return status;
+}
@@ -27,8 +27,10 @@
 
 #include "common.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
 #include "vminfo.h"
 #include "xasprintf.h"
@@ -118,7 +120,10 @@ get_paging_status (bool show_swapping, bool swapping_only,
 
   for (i = 0; i < 2; i++)
     {
-      proc_vmem_read (vmem);
+      err = proc_vmem_read (vmem);
+      if (err < 0)
+        plugin_error (STATE_UNKNOWN, -err, "error: cannot read %s",
+		      get_path_proc_vmstat ());
 
       nr_vmem_pgpgin[tog] = proc_vmem_get_pgpgin (vmem);
       nr_vmem_pgpgout[tog] = proc_vmem_get_pgpgout (vmem);
@@ -164,8 +169,8 @@ main (int argc, char **argv)
   int c, status;
   char *critical = NULL, *warning = NULL;
   char *status_msg;
-  char *perfdata_paging_msg = NULL, *perfdata_swapping_msg = NULL;
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
   thresholds *my_threshold = NULL;
   paging_data_t paging;
 
@@ -208,24 +213,34 @@ main (int argc, char **argv)
   free (my_threshold);
 
   status_msg =
-    xasprintf ("%s: %lu %s/s", state_text (status), paging.summary,
-	       swapping_only ? "pswp" : "majfault");
-  if (!swapping_only)
-    perfdata_paging_msg =
-      xasprintf ("vmem_pgpgin/s=%lu vmem_pgpgout/s=%lu vmem_pgfault/s=%lu "
-		 "vmem_pgmajfault/s=%lu vmem_pgfree/s=%lu vmem_pgsteal/s=%lu "
-		 "vmem_pgscand/s=%lu vmem_pgscank/s=%lu ",
-		 paging.dpgpgin, paging.dpgpgout, paging.dpgfault,
-		 paging.dpgmajfault, paging.dpgfree, paging.dpgsteal,
-		 paging.dpgscand, paging.dpgscank);
-  if (show_swapping || swapping_only)
-    perfdata_swapping_msg =
-      xasprintf ("vmem_pswpin/s=%lu vmem_pswpout/s=%lu",
-		 paging.dpswpin, paging.dpswpout);
-
-  printf ("%s %s | %s%s\n", program_name_short, status_msg,
-	  perfdata_paging_msg ? perfdata_paging_msg : "",
-	  perfdata_swapping_msg ? perfdata_swapping_msg : "");
+    xasprintf ("%s %s: %lu %s/s", program_name_short, state_text (status),
+	       paging.summary, swapping_only ? "pswp" : "majfault");
+
+  const struct { const char *name; unsigned long value; bool show; }
+  samples[] = {
+    { "vmem_pgpgin/s", paging.dpgpgin, !swapping_only },
+    { "vmem_pgpgout/s", paging.dpgpgout, !swapping_only },
+    { "vmem_pgfault/s", paging.dpgfault, !swapping_only },
+    { "vmem_pgmajfault/s", paging.dpgmajfault, !swapping_only },
+    { "vmem_pgfree/s", paging.dpgfree, !swapping_only },
+    { "vmem_pgsteal/s", paging.dpgsteal, !swapping_only },
+    { "vmem_pgscand/s", paging.dpgscand, !swapping_only },
+    { "vmem_pgscank/s", paging.dpgscank, !swapping_only },
+    { "vmem_pswpin/s", paging.dpswpin, show_swapping || swapping_only },
+    { "vmem_pswpout/s", paging.dpswpout, show_swapping || swapping_only }
+  };
+  size_t nsamples = sizeof (samples) / sizeof (samples[0]);
+
+  struct metrics *metrics = metrics_new (program_name_short, nsamples);
+  for (size_t i = 0; i < nsamples; i++)
+    if (samples[i].show)
+      {
+	struct metric metric = { .name = samples[i].name };
+	metrics_add (metrics, &metric, samples[i].value);
+      }
+
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
 
   return status;
 }
@@ -27,8 +27,10 @@
 #include "common.h"
 #include "container_podman.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
 #include "units.h"
 #include "xasprintf.h"
@@ -146,15 +148,17 @@ main (int argc, char **argv)
   char *image = NULL;
   char *varlink_address = NULL;
   char *critical = NULL, *warning = NULL;
-  char *status_msg, *perfdata_msg;
+  char *status_msg, *message;
   nagstatus status = STATE_OK;
   podman_varlink_t *pv = NULL;
   stats_type which_stats = unknown;
   thresholds *my_threshold = NULL;
   total_t total;
   unsigned int containers;
+  struct metrics *metrics;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "a:c:w:vi:lLnNMpbkmg%" GETOPT_HELP_VERSION_STRING,
@@ -226,22 +230,21 @@ main (int argc, char **argv)
     usage (stderr);
 
   podman_varlink_new (&pv, varlink_address);
+  metrics = metrics_new (program_name_short, 16);
 
   if (0 <= which_stats)
     {
       podman_stats (pv, which_stats, report_perc, &total, shift, image,
-		    &status_msg, &perfdata_msg);
+		    &status_msg, metrics);
       if (which_stats == cpu_stats)
         status = get_status (total.lf, my_threshold);
       else
         status = get_status (total.llu, my_threshold);
-      printf ("%s: %s | %s\n", program_name_short
-	      , status_msg
-	      , perfdata_msg);
+      message = xasprintf ("%s: %s", program_name_short, status_msg);
     }
   else
     {
-      podman_running_containers (pv, &containers, image, &perfdata_msg);
+      podman_running_containers (pv, &containers, image, metrics);
       status = get_status (containers, my_threshold);
       status_msg = image ?
 	xasprintf ("%s: %u running container(s) of type \"%s\"",
@@ -249,10 +252,12 @@ main (int argc, char **argv)
 	xasprintf ("%s: %u running container(s)", state_text (status),
 		   containers);
 
-      printf ("%s containers %s | %s\n", program_name_short
-	      , status_msg
-	      , perfdata_msg);
+      message = xasprintf ("%s containers %s", program_name_short,
+			   status_msg);
     }
+  metrics_write (metrics, status, message);
+  free (message);
+  free (status_msg);
 
   free (my_threshold);
   podman_varlink_unref (pv);
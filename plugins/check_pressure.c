@@ -26,9 +26,11 @@
 
 #include "common.h"
 #include "messages.h"
+#include "metrics.h"
 #include "pressure.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "system.h"
 #include "thresholds.h"
 #include "xasprintf.h"
@@ -106,7 +108,7 @@ main (int argc, char **argv)
   bool threshold_full = false;
   int c;
   char *critical = NULL, *warning = NULL,
-       *status_msg, *perfdata_mem_msg, *prefix = NULL;
+       *status_msg, *prefix = NULL;
   enum linux_psi_id pressure_mode = LINUX_PSI_NONE;
   unsigned long delay;
   unsigned long long starvation[2];
@@ -118,6 +120,7 @@ main (int argc, char **argv)
 		        unsigned long long *, unsigned long) = NULL;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "Cimfc:w:v" GETOPT_HELP_VERSION_STRING,
@@ -176,6 +179,10 @@ main (int argc, char **argv)
                       "too large delay value (greater than %d)", DELAY_MAX);
     }
 
+  struct metrics *metrics = metrics_new (program_name_short, 8);
+  struct metric metric = { .unit = "%", .precision = 2 };
+  char name[32];
+
   switch (pressure_mode)
   {
     default:
@@ -188,13 +195,14 @@ main (int argc, char **argv)
       status_msg =
 	xasprintf ("%s (CPU starvation) %s: %llu microsecs/s",
 		   program_name_short, state_text (status), starvation[0]);
-      perfdata_mem_msg =
-	xasprintf ("cpu_avg10=%2.2lf%% cpu_avg60=%2.2lf%% cpu_avg300=%2.2lf%% "
-		   "cpu_starvation/s=%llu"
-		   , psi_cpu->avg10
-		   , psi_cpu->avg60
-		   , psi_cpu->avg300
-		   , starvation[0]);
+      metric.name = "cpu_avg10";
+      metrics_add (metrics, &metric, psi_cpu->avg10);
+      metric.name = "cpu_avg60";
+      metrics_add (metrics, &metric, psi_cpu->avg60);
+      metric.name = "cpu_avg300";
+      metrics_add (metrics, &metric, psi_cpu->avg300);
+      metric = (struct metric) { .name = "cpu_starvation/s" };
+      metrics_add (metrics, &metric, starvation[0]);
       break;
     case LINUX_PSI_IO:
     case LINUX_PSI_MEMORY:
@@ -207,23 +215,31 @@ main (int argc, char **argv)
 		   , pressure_mode == LINUX_PSI_IO ? "IO" : "Memory"
 		   , state_text (status)
 		   , starvation[0], starvation[1]);
-      perfdata_mem_msg =
-	xasprintf ("%s_some_avg10=%2.2lf%% %s_some_avg60=%2.2lf%% "
-		   "%s_some_avg300=%2.2lf%% %s_some_starvation/s=%llu "
-		   "%s_full_avg10=%2.2lf%% %s_full_avg60=%2.2lf%% "
-		   "%s_full_avg300=%2.2lf%% %s_full_starvation/s=%llu "
-		   , prefix, psi->some_avg10
-		   , prefix, psi->some_avg60
-		   , prefix, psi->some_avg300
-		   , prefix, starvation[0]
-		   , prefix, psi->full_avg10
-		   , prefix, psi->full_avg60
-		   , prefix, psi->full_avg300
-		   , prefix, starvation[1]);
+      const struct { const char *name; double value; } samples[] = {
+	{ "some_avg10", psi->some_avg10 },
+	{ "some_avg60", psi->some_avg60 },
+	{ "some_avg300", psi->some_avg300 },
+	{ "some_starvation/s", starvation[0] },
+	{ "full_avg10", psi->full_avg10 },
+	{ "full_avg60", psi->full_avg60 },
+	{ "full_avg300", psi->full_avg300 },
+	{ "full_starvation/s", starvation[1] }
+      };
+
+      for (size_t i = 0; i < sizeof (samples) / sizeof (samples[0]); i++)
+	{
+	  bool rate = (i % 4 == 3);
+	  snprintf (name, sizeof name, "%s_%s", prefix, samples[i].name);
+	  metric = (struct metric) {
+	    .name = name, .unit = rate ? NULL : "%", .precision = rate ? 0 : 2
+	  };
+	  metrics_add (metrics, &metric, samples[i].value);
+	}
       break;
   }
 
-  printf ("%s | %s\n", status_msg, perfdata_mem_msg);
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
   free (my_threshold);
 
   return status;
@@ -32,49 +32,30 @@
 #include "common.h"
 #include "string-macros.h"
 #include "messages.h"
+#include "metrics.h"
 #include "mountlist.h"
 #include "xalloc.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
+#include "xasprintf.h"
 
 static const char *program_copyright =
   "Copyright (C) 2013-2015 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
 
-/* A file system type to display. */
-
-struct fs_type_list
-{
-  char *fs_name;
-  struct fs_type_list *fs_next;
-};
-
-/* Linked list of file system types to display.
- * If 'fs_select_list' is NULL, list all types.
- * This table is generated dynamically from command-line options,
- * rather than hardcoding into the program what it thinks are the
- * valid file system types; let the user specify any file system type
- * they want to, and if there are any file systems of that type, they
- * will be shown.
+/* The file systems to be checked, selected by type and locality.
+ * The selected types are not hardcoded into the program: let the user
+ * specify any file system type they want to, and if there are any file
+ * systems of that type, they will be shown.
  *
  * Some file system types:
  * 4.2 4.3 ufs nfs swap ignore io vm efs dbg */
 
-static struct fs_type_list *fs_select_list;
-
-/* Linked list of file system types to omit.
- *    If the list is empty, don't exclude any types.  */
-static struct fs_type_list *fs_exclude_list;
+static struct mount_filter filter;
 
 /* Linked list of mounted file systems. */
 static struct mount_entry *mount_list;
 
-/* If true, show even file systems with zero size or
-   uninteresting types. */
-static bool show_all_fs;
-
-/* If true, show only local file systems.  */
-static bool show_local_fs;
-
 /* If true, show each file system corresponding to the
    command line arguments.  */
 static bool verbose = false;
@@ -127,77 +108,6 @@ print_version (void)
   exit (STATE_OK);
 }
 
-/* Add FSTYPE to the list of file system types to display. */
-
-static void
-add_fs_type (const char *fstype)
-{
-  struct fs_type_list *fsp;
-
-  fsp = xmalloc (sizeof *fsp);
-  fsp->fs_name = (char *) fstype;
-  fsp->fs_next = fs_select_list;
-  fs_select_list = fsp;
-}
-
-/* Is FSTYPE a type of file system that should be listed?  */
-
-static bool
-selected_fstype (const char *fstype)
-{
-  const struct fs_type_list *fsp;
-
-  if (fs_select_list == NULL || fstype == NULL)
-    return true;
-  for (fsp = fs_select_list; fsp; fsp = fsp->fs_next)
-    if (STREQ (fstype, fsp->fs_name))
-      return true;
-  return false;
-}
-
-/* Add FSTYPE to the list of file system types to be omitted. */
-
-static void
-add_excluded_fs_type (const char *fstype)
-{
-  struct fs_type_list *fsp;
-
-  fsp = xmalloc (sizeof *fsp);
-  fsp->fs_name = (char *) fstype;
-  fsp->fs_next = fs_exclude_list;
-  fs_exclude_list = fsp;
-}
-
-/* Is FSTYPE a type of file system that should be omitted?  */
-
-static bool
-excluded_fstype (const char *fstype)
-{
-  const struct fs_type_list *fsp;
-
-  if (fs_exclude_list == NULL || fstype == NULL)
-    return false;
-  for (fsp = fs_exclude_list; fsp; fsp = fsp->fs_next)
-    if (STREQ (fstype, fsp->fs_name))
-      return true;
-  return false;
-}
-
-static bool
-skip_mount_entry (struct mount_entry *me)
-{
-  if (me->me_remote && show_local_fs)
-    return true;
-
-  if (me->me_dummy && !show_all_fs)
-    return true;
-
-  if (!selected_fstype (me->me_type) || excluded_fstype (me->me_type))
-    return true;
-
-  return false;
-}
-
 static int
 check_all_entries (char **ro_filesystems)
 {
@@ -208,7 +118,7 @@ check_all_entries (char **ro_filesystems)
 
   for (me = mount_list; me; me = me->me_next)
     {
-      if (skip_mount_entry (me))
+      if (mount_filter_skip (&filter, me))
 	continue;
 
       if (verbose)
@@ -244,7 +154,7 @@ check_entry (char const *name)
   for (me = mount_list; me; me = me->me_next)
     if (STREQ (me->me_mountdir, name))
       {
-	if (skip_mount_entry (me))
+	if (mount_filter_skip (&filter, me))
 	  return STATE_OK;
 
 	if (verbose)
@@ -264,15 +174,10 @@ main (int argc, char **argv)
 {
   int c, i;
   int status = STATE_OK;
-  char *ro_filesystems = NULL;
-
-  fs_select_list = NULL;
-  fs_exclude_list = NULL;
-
-  show_local_fs = false;
-  show_all_fs = false;
+  char *ro_filesystems = NULL, *status_msg;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
           "alT:X:v" GETOPT_HELP_VERSION_STRING, longopts, NULL)) != -1)
@@ -282,16 +187,16 @@ main (int argc, char **argv)
 	default:
 	  usage (stderr);
 	case 'a':
-	  show_all_fs = true;
+	  filter.show_all_fs = true;
 	  break;
 	case 'l':
-	  show_local_fs = true;
+	  filter.show_local_fs = true;
 	  break;
 	case 'T':
-	  add_fs_type (optarg);
+	  mount_filter_add_type (&filter, optarg);
 	  break;
 	case 'X':
-	  add_excluded_fs_type (optarg);
+	  mount_filter_exclude_type (&filter, optarg);
 	  break;
 	case 'v':
 	  verbose = true;
@@ -305,19 +210,11 @@ main (int argc, char **argv)
 
   /* Fail if the same file system type was both selected and excluded.  */
   {
-    struct fs_type_list *fs_incl;
-    for (fs_incl = fs_select_list; fs_incl; fs_incl = fs_incl->fs_next)
-      {
-	struct fs_type_list *fs_excl;
-	for (fs_excl = fs_exclude_list; fs_excl; fs_excl = fs_excl->fs_next)
-	  {
-	    if (STREQ (fs_incl->fs_name, fs_excl->fs_name))
-	      plugin_error (STATE_UNKNOWN, 0,
-		            "file system type `%s' both selected and "
-                            "excluded",
-		            fs_incl->fs_name);
-	  }
-      }
+    const char *fstype = mount_filter_conflict (&filter);
+    if (fstype)
+      plugin_error (STATE_UNKNOWN, 0,
+		    "file system type `%s' both selected and excluded",
+		    fstype);
   }
 
   if (optind < argc)
@@ -334,9 +231,7 @@ main (int argc, char **argv)
 	}
     }
 
-  mount_list =
-    read_file_system_list ((fs_select_list != NULL
-			    || fs_exclude_list != NULL || show_local_fs));
+  mount_list = read_file_system_list (mount_filter_need_fs_type (&filter));
 
   if (NULL == mount_list)
     /* Couldn't read the table of mounted file systems. */
@@ -353,16 +248,25 @@ main (int argc, char **argv)
 	    argv[i] = NULL;
 	}
 
-      printf ("%s %s", program_name_short, state_text (status));
+      status_msg = xasprintf ("%s %s", program_name_short,
+			      state_text (status));
       if (STATE_CRITICAL == status)
 	{
 	  for (i = optind; i < argc; ++i)
 	    if (argv[i])
-	      printf (" %s", argv[i]);
-	  printf (" readonly!");
+	      {
+		char *msg = xasprintf ("%s %s", status_msg, argv[i]);
+		free (status_msg);
+		status_msg = msg;
+	      }
+	  char *msg = xasprintf ("%s readonly!", status_msg);
+	  free (status_msg);
+	  status_msg = msg;
 	}
 
-      putchar ('\n');
+      metrics_write (metrics_new (program_name_short, 0), status,
+		     status_msg);
+      free (status_msg);
       return status;
     }
 
@@ -370,12 +274,15 @@ main (int argc, char **argv)
 
   if (STATE_CRITICAL == status)
     {
-      printf ("%s %s: %s readonly!\n", program_name_short, state_text (status),
-	      ro_filesystems);
+      status_msg = xasprintf ("%s %s: %s readonly!", program_name_short,
+			      state_text (status), ro_filesystems);
       free (ro_filesystems);
     }
   else
-    printf ("%s %s\n", program_name_short, state_text (status));
+    status_msg = xasprintf ("%s %s", program_name_short, state_text (status));
+
+  metrics_write (metrics_new (program_name_short, 0), status, status_msg);
+  free (status_msg);
 
   return status;
 }
@@ -0,0 +1,331 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A Nagios plugin that checks the number of the UDP, raw, and UNIX sockets
+ * and the data waiting in their receive queues.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "messages.h"
+#include "metrics.h"
+#include "netns.h"
+#include "progname.h"
+#include "progversion.h"
+#include "result_cache.h"
+#include "sockdiag.h"
+#include "tcpinfo.h"
+#include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+
+static const char *program_copyright =
+  "Copyright (C) 2026 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
+
+static struct option const longopts[] = {
+  {(char *) "udp", no_argument, NULL, 'u'},
+  {(char *) "udp6", no_argument, NULL, '6'},
+  {(char *) "raw", no_argument, NULL, 'r'},
+  {(char *) "raw6", no_argument, NULL, 'R'},
+  {(char *) "unix", no_argument, NULL, 'x'},
+  {(char *) "netns", no_argument, NULL, 'N'},
+  {(char *) "queued", required_argument, NULL, 'q'},
+  {(char *) "critical", required_argument, NULL, 'c'},
+  {(char *) "warning", required_argument, NULL, 'w'},
+  {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
+  {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
+  {NULL, 0, NULL, 0}
+};
+
+static _Noreturn void
+usage (FILE * out)
+{
+  fprintf (out, "%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs ("This plugin checks the number of the UDP, raw, and UNIX sockets "
+	 "and the data\nwaiting in their receive queues.\n", out);
+  fputs (program_copyright, out);
+  fputs (USAGE_HEADER, out);
+  fprintf (out, "  %s [--udp] [--udp6] [--raw] [--raw6] [--unix] [--netns]\n"
+	   "     [-q COUNTER,COUNTER]"
+	   " [-w COUNTER] [-c COUNTER]\n", program_name);
+  fputs (USAGE_OPTIONS, out);
+  fputs ("  -u, --udp       check the UDP sockets\n", out);
+  fputs ("  -6, --udp6      check the UDPv6 sockets\n", out);
+  fputs ("  -r, --raw       check the raw IPv4 sockets (Linux 4.17+)\n", out);
+  fputs ("  -R, --raw6      check the raw IPv6 sockets (Linux 4.17+)\n", out);
+  fputs ("  -x, --unix      check the UNIX sockets, by type "
+	 "(default: UDP, UDPv6,\n"
+	 "                  and UNIX)\n", out);
+  fputs ("  -N, --netns     also count the sockets of the other network "
+	 "namespaces\n", out);
+  fputs ("  -q, --queued=COUNTER,COUNTER   warning and critical thresholds on "
+	 "the bytes\n"
+	 "                  waiting to be read in the sockets of each kind\n",
+	 out);
+  fputs ("  -w, --warning COUNTER   warning threshold on the sockets of each "
+	 "kind\n", out);
+  fputs ("  -c, --critical COUNTER   critical threshold on the sockets of "
+	 "each kind\n", out);
+  fputs (USAGE_HELP, out);
+  fputs (USAGE_VERSION, out);
+  fputs (USAGE_NOTE, out);
+  fputs ("  The sockets are dumped with NETLINK_SOCK_DIAG.  The listening "
+	 "UNIX sockets\n"
+	 "  are not accounted in the receive queues.\n", out);
+  fputs ("  With --netns, the namespaces bound in " PATH_RUN_NETNS " and the "
+	 "ones of the\n"
+	 "  processes are entered in turn (this requires CAP_SYS_ADMIN), and "
+	 "the sockets\n"
+	 "  are reported by KIND@NAMESPACE, the namespaces of the processes "
+	 "being named\n"
+	 "  pidPID.\n", out);
+  fputs (USAGE_EXAMPLES, out);
+  fprintf (out, "  %s -w 5000 -c 10000 -q 1048576,8388608\n", program_name);
+  fprintf (out, "  %s --unix -c 20000\n", program_name);
+  fprintf (out, "  %s --netns --udp -q 1048576,8388608\n", program_name);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static _Noreturn void
+print_version (void)
+{
+  printf ("%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs (program_copyright, stdout);
+  fputs (GPLv3_DISCLAIMER, stdout);
+
+  exit (STATE_OK);
+}
+
+/* The states reported, the UDP and raw sockets being either connected
+   (ESTABLISHED) or not (CLOSE), and the UNIX ones also listening or
+   connecting (SYN_SENT).  */
+
+static const char *sock_states[] = {
+  "ESTABLISHED", "CLOSE", "LISTEN", "SYN_SENT"
+};
+
+/* The sockets counted in a network namespace */
+
+struct netns_sockets
+{
+  unsigned int kinds;
+  struct sock_count count[SOCK_KINDS];
+  int err;
+  bool valid;
+};
+
+static void
+netns_sockets_read (void *data)
+{
+  struct netns_sockets *ns_sockets = data;
+
+  ns_sockets->err = 0;
+  if (sock_count_read (ns_sockets->kinds, ns_sockets->count) < 0)
+    ns_sockets->err = errno;
+}
+
+int
+main (int argc, char **argv)
+{
+  int c;
+  bool all_netns = false;
+  unsigned int kinds = 0;
+  char *critical = NULL, *warning = NULL, *queued_critical = NULL,
+       *queued_warning = NULL, *message, *worst_label = NULL;
+  nagstatus status = STATE_OK, worst_status = STATE_OK, kind_status, s;
+  thresholds *my_threshold = NULL, *queued_threshold = NULL;
+  struct netns self = { .name = (char *) "", .self = true }, *netns = &self;
+  struct netns_sockets *ns_sockets;
+  const struct sock_count *count, *worst = NULL;
+  unsigned long sockets = 0;
+  size_t i, k, nnetns = 1;
+
+  set_program_name (argv[0]);
+  result_cache_init (argc, argv);
+
+  while ((c = getopt_long (argc, argv,
+			   "u6rRxNq:c:w:" GETOPT_HELP_VERSION_STRING,
+			   longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'u':
+	  kinds |= 1 << SOCK_KIND_UDP;
+	  break;
+	case '6':
+	  kinds |= 1 << SOCK_KIND_UDP6;
+	  break;
+	case 'r':
+	  kinds |= 1 << SOCK_KIND_RAW;
+	  break;
+	case 'R':
+	  kinds |= 1 << SOCK_KIND_RAW6;
+	  break;
+	case 'x':
+	  kinds |= SOCK_KIND_UNIX;
+	  break;
+	case 'N':
+	  all_netns = true;
+	  break;
+	case 'q':
+	  queued_warning = xstrdup (optarg);
+	  if (NULL == (queued_critical = strchr (queued_warning, ',')))
+	    usage (stderr);
+	  *queued_critical++ = '\0';
+	  break;
+	case 'c':
+	  critical = optarg;
+	  break;
+	case 'w':
+	  warning = optarg;
+	  break;
+
+	case_GETOPT_HELP_CHAR
+	case_GETOPT_VERSION_CHAR
+
+	}
+    }
+
+  if (kinds == 0)
+    kinds = (1 << SOCK_KIND_UDP) | (1 << SOCK_KIND_UDP6) | SOCK_KIND_UNIX;
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&queued_threshold, queued_warning, queued_critical)
+	 == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  if (all_netns && NULL == (netns = netns_list (&nnetns)))
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot list the network namespaces");
+
+  ns_sockets = xnmalloc (nnetns, sizeof (struct netns_sockets));
+  for (i = 0; i < nnetns; i++)
+    {
+      ns_sockets[i].kinds = kinds;
+      if (netns_run (&netns[i], netns_sockets_read, &ns_sockets[i]) < 0)
+	{
+	  /* the namespace has gone in the meantime */
+	  if (errno == ENOENT || errno == ESRCH)
+	    continue;
+	  plugin_error (STATE_UNKNOWN, errno,
+			"cannot enter the network namespace %s",
+			netns[i].name);
+	}
+      if (ns_sockets[i].err)
+	plugin_error (STATE_UNKNOWN, ns_sockets[i].err,
+		      "cannot dump the sockets with sock_diag");
+      ns_sockets[i].valid = true;
+    }
+
+  struct metrics *metrics =
+    metrics_new (program_name_short, 7 * SOCK_KINDS * nnetns);
+  struct metric metric = { .label = "kind", .min = "0" };
+  char name[32], *label;
+
+  for (i = 0; i < nnetns; i++)
+    for (k = 0; k < SOCK_KINDS; k++)
+      {
+	if (!ns_sockets[i].valid || !(kinds & (1 << k)))
+	  continue;
+
+	count = &ns_sockets[i].count[k];
+	label = netns_label (&netns[i], sock_kind_name (k));
+
+	kind_status = get_status (count->sockets, my_threshold);
+	s = get_status (count->rqueue, queued_threshold);
+	if (kind_status < s)
+	  kind_status = s;
+	if (status < kind_status)
+	  status = kind_status;
+	if (NULL == worst || kind_status > worst_status
+	    || (kind_status == worst_status
+		&& (count->rqueue > worst->rqueue
+		    || (count->rqueue == worst->rqueue
+			&& count->sockets > worst->sockets))))
+	  {
+	    worst = count;
+	    worst_status = kind_status;
+	    free (worst_label);
+	    worst_label = xstrdup (label);
+	  }
+	sockets += count->sockets;
+
+	metric.label_value = label;
+	metric.name = "sockets";
+	metric.unit = NULL;
+	metric.warning = warning;
+	metric.critical = critical;
+	metrics_add (metrics, &metric, count->sockets);
+
+	metric.warning = metric.critical = NULL;
+	for (size_t j = 0; j < sizeof (sock_states) / sizeof (*sock_states);
+	     j++)
+	  {
+	    int state = tcp_state_lookup (sock_states[j]);
+	    char *p;
+
+	    /* only the UNIX sockets listen or connect */
+	    if (k < SOCK_KIND_UNIX_STREAM && j > 1)
+	      continue;
+	    snprintf (name, sizeof name, "%s", sock_states[j]);
+	    for (p = name; *p; p++)
+	      *p = tolower ((unsigned char) *p);
+	    metric.name = name;
+	    metrics_add (metrics, &metric, count->state[state]);
+	  }
+
+	metric.name = "queued";
+	metrics_add (metrics, &metric, count->queued);
+	metric.name = "rqueue";
+	metric.unit = "B";
+	metric.warning = queued_warning;
+	metric.critical = queued_critical;
+	metrics_add (metrics, &metric, count->rqueue);
+	free (label);
+      }
+
+  message =
+    xasprintf ("%s %s - %lu sockets, %lu %s sockets with %llu bytes queued "
+	       "in %lu of them", program_name_short, state_text (status),
+	       sockets, worst->sockets, worst_label, worst->rqueue,
+	       worst->queued);
+  metrics_write (metrics, status, message);
+
+  free (message);
+  free (worst_label);
+  free (ns_sockets);
+  if (all_netns)
+    netns_list_free (netns, nnetns);
+  free (queued_warning);
+  free (my_threshold);
+  free (queued_threshold);
+
+  return status;
+}
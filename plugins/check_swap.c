@@ -30,8 +30,10 @@
 #include "common.h"
 #include "messages.h"
 #include "meminfo.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
 #include "units.h"
 #include "vminfo.h"
@@ -95,7 +97,6 @@ main (int argc, char **argv)
   char *critical = NULL, *warning = NULL;
   char *units = NULL;
   char *status_msg;
-  char *perfdata_swap_msg, *perfdata_vmem_msg = NULL;
   float percent_used = 0;
   thresholds *my_threshold = NULL;
 
@@ -108,8 +109,10 @@ main (int argc, char **argv)
   struct proc_vmem *vmem = NULL;
   unsigned long kb_swap_pageins[2];
   unsigned long kb_swap_pageouts[2];
+  unsigned long dpswpin = 0, dpswpout = 0;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv, "sc:w:bkmg" GETOPT_HELP_VERSION_STRING,
                            longopts, NULL)) != -1)
@@ -153,7 +156,10 @@ main (int argc, char **argv)
   if (err < 0)
     plugin_error (STATE_UNKNOWN, err, "memory exhausted");
 
-  proc_sysmem_read (sysmem);
+  err = proc_sysmem_read (sysmem);
+  if (err < 0)
+    plugin_error (STATE_UNKNOWN, -err, "error: cannot read %s",
+		  get_path_proc_meminfo ());
 
   kb_swap_cached = proc_sysmem_get_swap_cached (sysmem);
   kb_swap_free = proc_sysmem_get_swap_free (sysmem);
@@ -162,28 +168,28 @@ main (int argc, char **argv)
 
   if (vmem_perfdata)
     {
-      unsigned long dpswpin, dpswpout;
-
       err = proc_vmem_new (&vmem);
       if (err < 0)
         plugin_error (STATE_UNKNOWN, err, "memory exhausted");
 
-      proc_vmem_read (vmem);
+      err = proc_vmem_read (vmem);
+      if (err < 0)
+        plugin_error (STATE_UNKNOWN, -err, "error: cannot read %s",
+		      get_path_proc_vmstat ());
       kb_swap_pageins[0] = proc_vmem_get_pswpin (vmem);
       kb_swap_pageouts[0] = proc_vmem_get_pswpout (vmem);
 
       sleep (1);
 
-      proc_vmem_read (vmem);
+      err = proc_vmem_read (vmem);
+      if (err < 0)
+        plugin_error (STATE_UNKNOWN, -err, "error: cannot read %s",
+		      get_path_proc_vmstat ());
       kb_swap_pageins[1] = proc_vmem_get_pswpin (vmem);
       kb_swap_pageouts[1] = proc_vmem_get_pswpout (vmem);
 
       dpswpin = kb_swap_pageins[1] - kb_swap_pageins[0];
       dpswpout = kb_swap_pageouts[1] - kb_swap_pageouts[0];
-
-      perfdata_vmem_msg =
-	xasprintf (", swap_pageins/s=%lu swap_pageouts/s=%lu",
-		   dpswpin, dpswpout);
     }
 
   if (kb_swap_total != 0)
@@ -192,18 +198,34 @@ main (int argc, char **argv)
   status = get_status (percent_used, my_threshold);
   free (my_threshold);
 
-  status_msg = xasprintf ("%s: %.2f%% (%llu %s) used", state_text (status),
-			  percent_used, UNIT_STR (kb_swap_used));
+  status_msg = xasprintf ("%s %s: %.2f%% (%llu %s) used", program_name_short,
+			  state_text (status), percent_used,
+			  UNIT_STR (kb_swap_used));
+
+  const struct { const char *name; unsigned long value; } samples[] = {
+    { "swap_total", kb_swap_total },
+    { "swap_used", kb_swap_used },
+    { "swap_free", kb_swap_free },
+    /* The amount of swap, in kB, used as cache memory */
+    { "swap_cached", kb_swap_cached }
+  };
 
-  perfdata_swap_msg =
-    xasprintf ("swap_total=%llu%s swap_used=%llu%s swap_free=%llu%s "
-	       /* The amount of swap, in kB, used as cache memory */
-	       "swap_cached=%llu%s",
-	       UNIT_STR (kb_swap_total), UNIT_STR (kb_swap_used),
-	       UNIT_STR (kb_swap_free), UNIT_STR (kb_swap_cached));
+  struct metrics *metrics = metrics_new (program_name_short, 6);
+  for (size_t i = 0; i < sizeof (samples) / sizeof (samples[0]); i++)
+    {
+      struct metric metric = { .name = samples[i].name, .unit = units };
+      metrics_add (metrics, &metric, UNIT_CONVERT (samples[i].value, shift));
+    }
+  if (vmem_perfdata)
+    {
+      struct metric metric = { .name = "swap_pageins/s" };
+      metrics_add (metrics, &metric, dpswpin);
+      metric.name = "swap_pageouts/s";
+      metrics_add (metrics, &metric, dpswpout);
+    }
 
-  printf ("%s %s | %s%s\n", program_name_short, status_msg, perfdata_swap_msg,
-	  vmem_perfdata ? perfdata_vmem_msg : "");
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
 
   proc_vmem_unref (vmem);
   proc_sysmem_unref (sysmem);
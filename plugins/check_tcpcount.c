@@ -20,16 +20,30 @@
  *
  */
 
+#include <ctype.h>
+#include <errno.h>
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
 
 #include "common.h"
+#include "logging.h"
 #include "messages.h"
+#include "metrics.h"
+#include "netns.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
+#include "statefile.h"
 #include "tcpinfo.h"
 #include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+#include "xstrton.h"
 
 static const char *program_copyright =
   "Copyright (C) 2014,2015 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
@@ -37,6 +51,13 @@ static const char *program_copyright =
 static struct option const longopts[] = {
   {(char *) "tcp", no_argument, NULL, 't'},
   {(char *) "tcp6", no_argument, NULL, '6'},
+  {(char *) "listen", no_argument, NULL, 'l'},
+  {(char *) "drops", required_argument, NULL, 'd'},
+  {(char *) "ports", no_argument, NULL, 'p'},
+  {(char *) "state", required_argument, NULL, 's'},
+  {(char *) "top", required_argument, NULL, 'n'},
+  {(char *) "remote", required_argument, NULL, 'r'},
+  {(char *) "netns", no_argument, NULL, 'N'},
   {(char *) "critical", required_argument, NULL, 'c'},
   {(char *) "warning", required_argument, NULL, 'w'},
   {(char *) "verbose", no_argument, NULL, 'v'},
@@ -52,25 +73,77 @@ usage (FILE * out)
   fputs ("This plugin displays TCP network and socket informations.\n", out);
   fputs (program_copyright, out);
   fputs (USAGE_HEADER, out);
-  fprintf (out, "  %s [--tcp] [--tcp6] [-w COUNTER] [-c COUNTER]\n",
-	   program_name);
+  fprintf (out, "  %s [--tcp] [--tcp6] [--netns] [-w COUNTER] "
+	   "[-c COUNTER]\n", program_name);
+  fprintf (out, "  %s --listen [--tcp] [--tcp6] [-d COUNTER,COUNTER] "
+	   "[-w PERC] [-c PERC]\n"
+	   "     [delay]\n", program_name);
+  fprintf (out, "  %s --ports [--tcp] [--tcp6] [-s STATE] [-n TOP] "
+	   "[-r COUNTER,COUNTER]\n"
+	   "     [-w COUNTER] [-c COUNTER]\n", program_name);
   fputs (USAGE_OPTIONS, out);
   fputs ("  -t, --tcp       display the statistics for the TCP protocol "
 	 "(the default)\n", out);
   fputs ("  -6, --tcp6      display the statistics for the TCPv6 protocol\n",
 	 out);
+  fputs ("  -l, --listen    check the accept queues of the listening sockets "
+	 "(of both\n"
+	 "                  TCP and TCPv6 if none is selected): the thresholds "
+	 "apply\n"
+	 "                  to the fill ratio of the queues of each port\n", out);
+  fputs ("  -d, --drops=COUNTER,COUNTER   warning and critical thresholds on "
+	 "the SYNs\n"
+	 "                  dropped per second by the listening sockets "
+	 "(ListenDrops)\n", out);
+  fputs ("  -p, --ports     check the connections of each local port with a "
+	 "listening\n"
+	 "                  socket (of both TCP and TCPv6 if none is "
+	 "selected), and\n"
+	 "                  of the remote addresses with more connections: "
+	 "the\n"
+	 "                  thresholds apply to each port\n", out);
+  fputs ("  -s, --state STATE   the state of the connections checked by "
+	 "--ports\n"
+	 "                  (default: ESTABLISHED)\n", out);
+  fputs ("  -n, --top TOP   the number of remote addresses reported by "
+	 "--ports\n"
+	 "                  (default: 5)\n", out);
+  fputs ("  -r, --remote=COUNTER,COUNTER   warning and critical thresholds "
+	 "on the\n"
+	 "                  connections, in any state, of a remote address\n",
+	 out);
+  fputs ("  -N, --netns     also count the connections of the other network "
+	 "namespaces:\n"
+	 "                  the thresholds apply to each namespace\n", out);
   fputs ("  -w, --warning COUNTER   warning threshold\n", out);
   fputs ("  -c, --critical COUNTER   critical threshold\n", out);
   fputs ("  -v, --verbose   show details for command-line debugging "
 	 "(Nagios may truncate output)\n", out);
   fputs (USAGE_HELP, out);
   fputs (USAGE_VERSION, out);
+  fprintf (out, "  \"delay\" is the delay in seconds between two samples of "
+	   "the listen drops\n"
+	   "    (default: %dsec)\n", DELAY_DEFAULT);
+  fputs (USAGE_NOTE, out);
+  fputs (USAGE_STATEFILE, out);
+  fputs ("  With --netns, the namespaces bound in " PATH_RUN_NETNS " and the "
+	 "ones of the\n"
+	 "  processes are entered in turn (this requires CAP_SYS_ADMIN), the "
+	 "sockets are\n"
+	 "  dumped with NETLINK_SOCK_DIAG, and the counters are reported by "
+	 "namespace,\n"
+	 "  as NAMESPACE_tcp_STATE, the namespaces of the processes being "
+	 "named pidPID.\n", out);
   fputs (USAGE_EXAMPLES, out);
   fprintf (out, "  %s --tcp -w 1000 -c 1500    # TCPv4 only (the default)\n",
 	   program_name);
   fprintf (out, "  %s --tcp --tcp6 -w 1500 -c 2000   # TCPv4 and TCPv6\n",
 	   program_name);
   fprintf (out, "  %s --tcp6 -w 1500 -c 2000   # TCPv6 only\n", program_name);
+  fprintf (out, "  %s --netns -w 1000 -c 1500\n", program_name);
+  fprintf (out, "  %s --listen -w 50 -c 90 -d 1,10\n", program_name);
+  fprintf (out, "  %s --ports --state close_wait -w 10 -c 100 -r 500,1000\n",
+	   program_name);
 
   exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
 }
@@ -85,13 +158,396 @@ print_version (void)
   exit (STATE_OK);
 }
 
+/* The current ListenOverflows and ListenDrops, and the previous ones */
+
+struct listen_sample
+{
+  unsigned long long counters[2];
+  unsigned long long first[2];
+  const unsigned long long *prev;
+};
+
+static void
+listen_resample (void *data)
+{
+  struct listen_sample *sample = data;
+
+  memcpy (sample->first, sample->counters, sizeof (sample->first));
+  sample->prev = sample->first;
+  proc_tcp_listen_drops (&sample->counters[0], &sample->counters[1]);
+}
+
+/* Check the fill ratio of the accept queues of the listening sockets, and
+   the rate of the SYNs dropped because of a full queue.  */
+
+static _Noreturn void
+check_listen (unsigned int tcp_flags, unsigned long delay,
+	      char *warning, char *critical,
+	      char *drops_warning, char *drops_critical)
+{
+  struct tcp_listen_port *ports;
+  struct statefile *state;
+  thresholds *my_threshold = NULL, *drops_threshold = NULL;
+  nagstatus status = STATE_OK;
+  static const char *const keys[] = { "TcpExt" };
+  struct listen_sample sample;
+  unsigned long long *counters = sample.counters;
+  double elapsed, overflows = 0, drops = 0;
+  char label[16], *message;
+  int nports;
+  size_t i, worst = 0;
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&drops_threshold, drops_warning, drops_critical)
+	 == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  nports = tcp_listen_read (tcp_flags, &ports);
+  if (nports < 0)
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot dump the listening sockets with sock_diag");
+
+  /* the counters saved by the last execution, or sampled twice */
+  state = statefile_open ("listen", 2);
+  sample.prev = statefile_get (state, keys[0]);
+  if (proc_tcp_listen_drops (&counters[0], &counters[1]) == 0)
+    {
+      elapsed = statefile_sample (state, delay, keys, 1, listen_resample,
+				  &sample);
+      overflows = (counters[0] > sample.prev[0]) ?
+	(counters[0] - sample.prev[0]) / elapsed : 0;
+      drops = (counters[1] > sample.prev[1]) ?
+	(counters[1] - sample.prev[1]) / elapsed : 0;
+      statefile_put (state, keys[0], counters);
+      if (statefile_save (state) < 0)
+	dbg ("cannot save the state: %s\n", strerror (errno));
+    }
+  statefile_free (state);
+
+  status = get_status (drops, drops_threshold);
+  for (i = 0; i < (size_t) nports; i++)
+    {
+      nagstatus s = get_status (ports[i].fill, my_threshold);
+      if (status < s)
+	status = s;
+      if (ports[i].fill > ports[worst].fill)
+	worst = i;
+    }
+
+  struct metrics *metrics = metrics_new (program_name_short, 3 * nports + 2);
+  struct metric metric = { .precision = 2, .min = "0" };
+
+  metric.name = "listen_overflows/s";
+  metrics_add (metrics, &metric, overflows);
+  metric.name = "listen_drops/s";
+  metric.warning = drops_warning;
+  metric.critical = drops_critical;
+  metrics_add (metrics, &metric, drops);
+
+  metric.label = "port";
+  for (i = 0; i < (size_t) nports; i++)
+    {
+      snprintf (label, sizeof label, "port%u", ports[i].port);
+      metric.label_value = label;
+      metric.name = "backlog_fill";
+      metric.unit = "%";
+      metric.warning = warning;
+      metric.critical = critical;
+      metric.max = "100";
+      metrics_add (metrics, &metric, ports[i].fill);
+
+      metric.name = "backlog";
+      metric.unit = NULL;
+      metric.warning = metric.critical = metric.max = NULL;
+      metric.precision = 0;
+      metrics_add (metrics, &metric, ports[i].backlog);
+      metric.name = "max_backlog";
+      metrics_add (metrics, &metric, ports[i].max_backlog);
+      metric.precision = 2;
+    }
+
+  if (nports > 0)
+    message =
+      xasprintf ("%s %s - %d listening ports, the accept queue of port %u "
+		 "is %.2f%% full (%lu/%lu), %.2f listen drops/s",
+		 program_name_short, state_text (status), nports,
+		 ports[worst].port, ports[worst].fill, ports[worst].backlog,
+		 ports[worst].max_backlog, drops);
+  else
+    message = xasprintf ("%s %s - no listening ports, %.2f listen drops/s",
+			 program_name_short, state_text (status), drops);
+  metrics_write (metrics, status, message);
+
+  free (message);
+  free (ports);
+  free (my_threshold);
+  free (drops_threshold);
+
+  exit (status);
+}
+
+/* Check the connections in the STATE of the local ports with a listening
+   socket, and the connections of the TOP remote addresses.  */
+
+static _Noreturn void
+check_ports (unsigned int tcp_flags, int state, size_t top,
+	     char *warning, char *critical,
+	     char *remote_warning, char *remote_critical)
+{
+  struct tcp_conntable *table;
+  struct tcp_port_conn *ports;
+  struct tcp_peer_conn *peers;
+  thresholds *my_threshold = NULL, *remote_threshold = NULL;
+  nagstatus status = STATE_OK, *port_status;
+  int listen_state = tcp_state_lookup ("LISTEN");
+  char name[32], label[INET6_ADDRSTRLEN], *message;
+  size_t nports, npeers, nlisten = 0, i, worst = 0;
+  unsigned long connections = 0;
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&remote_threshold, remote_warning, remote_critical)
+	 == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  table = tcp_conntable_new ();
+  if (tcp_conntable_read_diag (table, tcp_flags) < 0)
+    {
+      dbg ("cannot dump the sockets with sock_diag: %s\n", strerror (errno));
+      tcp_conntable_read_proc (table, tcp_flags);
+    }
+  nports = tcp_conntable_ports (table, &ports);
+  npeers = tcp_conntable_top_peers (table, top, &peers);
+  tcp_conntable_free (table);
+
+  /* keep the ports with a listening socket only */
+  for (i = 0; i < nports; i++)
+    if (ports[i].state[listen_state] > 0)
+      ports[nlisten++] = ports[i];
+  nports = nlisten;
+
+  port_status = xnmalloc (nports + 1, sizeof (nagstatus));
+  for (i = 0; i < nports; i++)
+    {
+      port_status[i] = get_status (ports[i].state[state], my_threshold);
+      if (status < port_status[i])
+	status = port_status[i];
+      if (port_status[i] > port_status[worst]
+	  || (port_status[i] == port_status[worst]
+	      && ports[i].state[state] > ports[worst].state[state]))
+	worst = i;
+      connections += ports[i].state[state];
+    }
+  for (i = 0; i < npeers; i++)
+    {
+      nagstatus s = get_status (peers[i].connections, remote_threshold);
+      if (status < s)
+	status = s;
+    }
+
+  struct metrics *metrics =
+    metrics_new (program_name_short, (TCP_NSTATES - 2) * nports + npeers + 1);
+  struct metric metric = { .label = "port", .min = "0" };
+
+  for (i = 0; i < nports; i++)
+    {
+      snprintf (label, sizeof label, "port%u", ports[i].port);
+      metric.label_value = label;
+      for (int s = 1; s < TCP_NSTATES; s++)
+	{
+	  char *p;
+
+	  if (s == listen_state)
+	    continue;
+	  snprintf (name, sizeof name, "tcp_%s", tcp_state_name (s));
+	  for (p = name; *p; p++)
+	    *p = tolower ((unsigned char) *p);
+	  metric.name = name;
+	  metric.warning = (s == state) ? warning : NULL;
+	  metric.critical = (s == state) ? critical : NULL;
+	  metrics_add (metrics, &metric, ports[i].state[s]);
+	}
+    }
+
+  metric.label = "remote";
+  metric.name = "connections";
+  metric.warning = remote_warning;
+  metric.critical = remote_critical;
+  for (i = 0; i < npeers; i++)
+    {
+      inet_ntop (peers[i].family, peers[i].addr, label, sizeof label);
+      metric.label_value = label;
+      metrics_add (metrics, &metric, peers[i].connections);
+    }
+
+  if (npeers > 0)
+    inet_ntop (peers[0].family, peers[0].addr, label, sizeof label);
+  else
+    snprintf (label, sizeof label, "none");
+  if (nports > 0)
+    message =
+      xasprintf ("%s %s - %lu %s connections on %zu listening ports, "
+		 "%u on port %u, top remote address %s (%lu connections)",
+		 program_name_short, state_text (status), connections,
+		 tcp_state_name (state), nports, ports[worst].state[state],
+		 ports[worst].port, label,
+		 npeers > 0 ? peers[0].connections : 0);
+  else
+    message =
+      xasprintf ("%s %s - no listening ports, top remote address %s "
+		 "(%lu connections)", program_name_short, state_text (status),
+		 label, npeers > 0 ? peers[0].connections : 0);
+  metrics_write (metrics, status, message);
+
+  free (message);
+  free (port_status);
+  free (ports);
+  free (peers);
+  free (my_threshold);
+  free (remote_threshold);
+
+  exit (status);
+}
+
+/* The connections counted in a network namespace, by state */
+
+struct netns_tcp
+{
+  unsigned int tcp_flags;
+  unsigned long state[TCP_NSTATES];
+  int err;
+  bool valid;
+};
+
+static void
+netns_tcp_read (void *data)
+{
+  struct netns_tcp *ns_tcp = data;
+  struct tcp_conntable *table = tcp_conntable_new ();
+  struct tcp_port_conn *ports;
+  size_t nports, i;
+
+  /* /proc/net/tcp shows the namespace of the main thread only */
+  ns_tcp->err = 0;
+  if (tcp_conntable_read_diag (table, ns_tcp->tcp_flags) < 0)
+    ns_tcp->err = errno;
+
+  nports = tcp_conntable_ports (table, &ports);
+  for (i = 0; i < nports; i++)
+    for (int s = 1; s < TCP_NSTATES; s++)
+      ns_tcp->state[s] += ports[i].state[s];
+
+  free (ports);
+  tcp_conntable_free (table);
+}
+
+/* Count the connections, by state, in each network namespace.  */
+
+static _Noreturn void
+check_netns (unsigned int tcp_flags, char *warning, char *critical)
+{
+  struct netns *netns;
+  struct netns_tcp *ns_tcp;
+  thresholds *my_threshold = NULL;
+  nagstatus status = STATE_OK, s;
+  int established = tcp_state_lookup ("ESTABLISHED");
+  unsigned long connections = 0;
+  char name[32], *message;
+  size_t nnetns, nvalid = 0, i, worst = 0;
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  if (NULL == (netns = netns_list (&nnetns)))
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot list the network namespaces");
+
+  ns_tcp = xnmalloc (nnetns, sizeof (struct netns_tcp));
+  memset (ns_tcp, 0, nnetns * sizeof (struct netns_tcp));
+  for (i = 0; i < nnetns; i++)
+    {
+      ns_tcp[i].tcp_flags = tcp_flags;
+      if (netns_run (&netns[i], netns_tcp_read, &ns_tcp[i]) < 0)
+	{
+	  /* the namespace has gone in the meantime */
+	  if (errno == ENOENT || errno == ESRCH)
+	    continue;
+	  plugin_error (STATE_UNKNOWN, errno,
+			"cannot enter the network namespace %s",
+			netns[i].name);
+	}
+      if (ns_tcp[i].err)
+	plugin_error (STATE_UNKNOWN, ns_tcp[i].err,
+		      "cannot dump the sockets with sock_diag");
+      ns_tcp[i].valid = true;
+      nvalid++;
+    }
+
+  for (i = 0; i < nnetns; i++)
+    {
+      if (!ns_tcp[i].valid)
+	continue;
+      s = get_status (ns_tcp[i].state[established], my_threshold);
+      if (status < s)
+	status = s;
+      if (ns_tcp[i].state[established] > ns_tcp[worst].state[established])
+	worst = i;
+      connections += ns_tcp[i].state[established];
+    }
+
+  struct metrics *metrics =
+    metrics_new (program_name_short, (TCP_NSTATES - 1) * nnetns);
+  struct metric metric = { .label = "netns", .min = "0" };
+
+  for (i = 0; i < nnetns; i++)
+    {
+      if (!ns_tcp[i].valid)
+	continue;
+
+      /* the namespace of the plugin keeps the names of the default mode */
+      metric.label_value = netns[i].self ? NULL : netns[i].name;
+      for (int st = 1; st < TCP_NSTATES; st++)
+	{
+	  char *p;
+
+	  snprintf (name, sizeof name, "tcp_%s", tcp_state_name (st));
+	  for (p = name; *p; p++)
+	    *p = tolower ((unsigned char) *p);
+	  metric.name = name;
+	  metric.warning = (st == established) ? warning : NULL;
+	  metric.critical = (st == established) ? critical : NULL;
+	  metrics_add (metrics, &metric, ns_tcp[i].state[st]);
+	}
+    }
+
+  message =
+    xasprintf ("%s %s - %lu tcp established in %zu network namespaces, "
+	       "%lu in %s", program_name_short, state_text (status),
+	       connections, nvalid, ns_tcp[worst].state[established],
+	       netns[worst].self ? "the namespace of the plugin" : netns[worst].name);
+  metrics_write (metrics, status, message);
+
+  free (message);
+  free (ns_tcp);
+  netns_list_free (netns, nnetns);
+  free (my_threshold);
+
+  exit (status);
+}
+
 int
 main (int argc, char **argv)
 {
   int c, err;
-  bool verbose = false;
+  bool listen = false, by_port = false, all_netns = false, verbose = false;
+  int state = tcp_state_lookup ("ESTABLISHED");
   unsigned int tcp_flags = TCP_UNSET;
-  char *critical = NULL, *warning = NULL;
+  char *critical = NULL, *warning = NULL, *drops_critical = NULL,
+       *drops_warning = NULL, *remote_critical = NULL,
+       *remote_warning = NULL;
+  unsigned long delay = DELAY_DEFAULT, top = 5;
   nagstatus status = STATE_OK;
   thresholds *my_threshold = NULL;
 
@@ -109,9 +565,10 @@ main (int argc, char **argv)
   unsigned long tcp_closing;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
-			   "t6c:w:v" GETOPT_HELP_VERSION_STRING,
+			   "t6ld:ps:n:r:Nc:w:v" GETOPT_HELP_VERSION_STRING,
 			   longopts, NULL)) != -1)
     {
       switch (c)
@@ -124,6 +581,38 @@ main (int argc, char **argv)
 	case '6':
 	  tcp_flags |= TCP_v6;
 	  break;
+	case 'l':
+	  listen = true;
+	  break;
+	case 'd':
+	  drops_warning = xstrdup (optarg);
+	  if (NULL == (drops_critical = strchr (drops_warning, ',')))
+	    usage (stderr);
+	  *drops_critical++ = '\0';
+	  break;
+	case 'p':
+	  by_port = true;
+	  break;
+	case 's':
+	  if ((state = tcp_state_lookup (optarg)) < 0)
+	    plugin_error (STATE_UNKNOWN, 0, "unknown TCP state: %s", optarg);
+	  break;
+	case 'n':
+	  top = strtol_or_err (optarg, "the number of addresses must be an "
+			       "integer");
+	  if ((long) top < 0)
+	    plugin_error (STATE_UNKNOWN, 0, "invalid number of addresses: %s",
+			  optarg);
+	  break;
+	case 'r':
+	  remote_warning = xstrdup (optarg);
+	  if (NULL == (remote_critical = strchr (remote_warning, ',')))
+	    usage (stderr);
+	  *remote_critical++ = '\0';
+	  break;
+	case 'N':
+	  all_netns = true;
+	  break;
 	case 'c':
 	  critical = optarg;
 	  break;
@@ -140,9 +629,39 @@ main (int argc, char **argv)
 	}
     }
 
+  if (listen)
+    {
+      if (optind < argc)
+	{
+	  delay = strtol_or_err (argv[optind++], "failed to parse argument");
+
+	  if (delay < 1)
+	    plugin_error (STATE_UNKNOWN, 0, "delay must be positive integer");
+	  else if (DELAY_MAX < delay)
+	    plugin_error (STATE_UNKNOWN, 0,
+			  "too large delay value (greater than %d)", DELAY_MAX);
+	}
+
+      if (tcp_flags == TCP_UNSET)
+	tcp_flags = TCP_v4 | TCP_v6;
+      check_listen (tcp_flags, delay, warning, critical, drops_warning,
+		    drops_critical);
+    }
+
+  if (by_port)
+    {
+      if (tcp_flags == TCP_UNSET)
+	tcp_flags = TCP_v4 | TCP_v6;
+      check_ports (tcp_flags, state, top, warning, critical, remote_warning,
+		   remote_critical);
+    }
+
   if (tcp_flags == TCP_UNSET)
     tcp_flags = TCP_v4;
 
+  if (all_netns)
+    check_netns (tcp_flags, warning, critical);
+
   if (verbose)
     tcp_flags |= TCP_VERBOSE;
 
@@ -173,16 +692,33 @@ main (int argc, char **argv)
   status = get_status (tcp_established, my_threshold);
   free (my_threshold);
 
-  printf ("%s %s - %lu tcp established | "
-	  "tcp_established=%lu tcp_syn_sent=%lu tcp_syn_recv=%lu "
-	  "tcp_fin_wait1=%lu tcp_fin_wait2=%lu tcp_time_wait=%lu "
-	  "tcp_close=%lu tcp_close_wait=%lu tcp_last_ack=%lu "
-	  "tcp_listen=%lu tcp_closing=%lu\n",
-	  program_name_short, state_text (status), tcp_established,
-	  tcp_established, tcp_syn_sent, tcp_syn_recv,
-	  tcp_fin_wait1, tcp_fin_wait2, tcp_time_wait,
-	  tcp_close, tcp_close_wait, tcp_last_ack,
-	  tcp_listen, tcp_closing);
+  const struct { const char *name; unsigned long value; } samples[] = {
+    { "tcp_established", tcp_established },
+    { "tcp_syn_sent", tcp_syn_sent },
+    { "tcp_syn_recv", tcp_syn_recv },
+    { "tcp_fin_wait1", tcp_fin_wait1 },
+    { "tcp_fin_wait2", tcp_fin_wait2 },
+    { "tcp_time_wait", tcp_time_wait },
+    { "tcp_close", tcp_close },
+    { "tcp_close_wait", tcp_close_wait },
+    { "tcp_last_ack", tcp_last_ack },
+    { "tcp_listen", tcp_listen },
+    { "tcp_closing", tcp_closing }
+  };
+  size_t nsamples = sizeof (samples) / sizeof (samples[0]);
+
+  struct metrics *metrics = metrics_new (program_name_short, nsamples);
+  for (size_t i = 0; i < nsamples; i++)
+    {
+      struct metric metric = { .name = samples[i].name };
+      metrics_add (metrics, &metric, samples[i].value);
+    }
+
+  char *message = xasprintf ("%s %s - %lu tcp established",
+			     program_name_short, state_text (status),
+			     tcp_established);
+  metrics_write (metrics, status, message);
+  free (message);
 
   return status;
 }
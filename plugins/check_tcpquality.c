@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A Nagios plugin that checks the round trip time and the retransmissions
+ * of the established TCP connections.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "histogram.h"
+#include "messages.h"
+#include "metrics.h"
+#include "progname.h"
+#include "progversion.h"
+#include "result_cache.h"
+#include "tcpinfo.h"
+#include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+#include "xstrton.h"
+
+static const char *program_copyright =
+  "Copyright (C) 2026 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
+
+static struct option const longopts[] = {
+  {(char *) "tcp", no_argument, NULL, 't'},
+  {(char *) "tcp6", no_argument, NULL, '6'},
+  {(char *) "sport", required_argument, NULL, 's'},
+  {(char *) "dport", required_argument, NULL, 'd'},
+  {(char *) "retrans", required_argument, NULL, 'r'},
+  {(char *) "critical", required_argument, NULL, 'c'},
+  {(char *) "warning", required_argument, NULL, 'w'},
+  {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
+  {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
+  {NULL, 0, NULL, 0}
+};
+
+static _Noreturn void
+usage (FILE * out)
+{
+  fprintf (out, "%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs ("This plugin checks the round trip time and the retransmissions of "
+	 "the\nestablished TCP connections.\n", out);
+  fputs (program_copyright, out);
+  fputs (USAGE_HEADER, out);
+  fprintf (out, "  %s [--tcp] [--tcp6] [-s PORT] [-d PORT] [-r PERC,PERC] "
+	   "[-w MSEC] [-c MSEC]\n", program_name);
+  fputs (USAGE_OPTIONS, out);
+  fputs ("  -t, --tcp       check the TCP connections\n", out);
+  fputs ("  -6, --tcp6      check the TCPv6 connections "
+	 "(default: both)\n", out);
+  fputs ("  -s, --sport PORT   only the connections with this local port\n",
+	 out);
+  fputs ("  -d, --dport PORT   only the connections with this remote port\n",
+	 out);
+  fputs ("  -r, --retrans=PERC,PERC   warning and critical thresholds on the "
+	 "percentage\n"
+	 "                  of the segments retransmitted\n", out);
+  fputs ("  -w, --warning MSEC   warning threshold on the 99th percentile of "
+	 "the RTT\n", out);
+  fputs ("  -c, --critical MSEC   critical threshold on the 99th percentile "
+	 "of the RTT\n", out);
+  fputs (USAGE_HELP, out);
+  fputs (USAGE_VERSION, out);
+  fputs (USAGE_NOTE, out);
+  fputs ("  The connections are grouped by service port, their local port if "
+	 "a socket\n"
+	 "  listens on it or if --sport is given, and their remote port "
+	 "otherwise.\n"
+	 "  The thresholds apply to each port.\n", out);
+  fputs (USAGE_EXAMPLES, out);
+  fprintf (out, "  %s -w 50 -c 200 -r 1,5\n", program_name);
+  fprintf (out, "  %s --sport 443 -c 100\n", program_name);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static _Noreturn void
+print_version (void)
+{
+  printf ("%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs (program_copyright, stdout);
+  fputs (GPLv3_DISCLAIMER, stdout);
+
+  exit (STATE_OK);
+}
+
+static unsigned int
+port_or_err (const char *str)
+{
+  long port = strtol_or_err (str, "the port must be an integer");
+
+  if (port < 1 || port > 65535)
+    plugin_error (STATE_UNKNOWN, 0, "invalid port: %s", str);
+  return port;
+}
+
+/* The port 0 collects the connections exceeding the ports limit.  */
+
+static const char *
+port_label (const struct tcp_port_quality *port, char *buf, size_t size)
+{
+  if (port->port)
+    snprintf (buf, size, "port%u", port->port);
+  else
+    snprintf (buf, size, "other");
+  return buf;
+}
+
+static double
+retrans_ratio (const struct tcp_port_quality *port)
+{
+  return port->segs_out ? 100.0 * port->retrans / port->segs_out : 0;
+}
+
+int
+main (int argc, char **argv)
+{
+  int c, nports;
+  unsigned int tcp_flags = TCP_UNSET, sport = 0, dport = 0;
+  char *critical = NULL, *warning = NULL, *retrans_critical = NULL,
+       *retrans_warning = NULL, *message;
+  nagstatus status = STATE_OK, *port_status;
+  thresholds *my_threshold = NULL, *retrans_threshold = NULL;
+  struct tcp_port_quality *ports;
+  unsigned long connections = 0;
+  size_t i, worst = 0;
+
+  set_program_name (argv[0]);
+  result_cache_init (argc, argv);
+
+  while ((c = getopt_long (argc, argv,
+			   "t6s:d:r:c:w:" GETOPT_HELP_VERSION_STRING,
+			   longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 't':
+	  tcp_flags |= TCP_v4;
+	  break;
+	case '6':
+	  tcp_flags |= TCP_v6;
+	  break;
+	case 's':
+	  sport = port_or_err (optarg);
+	  break;
+	case 'd':
+	  dport = port_or_err (optarg);
+	  break;
+	case 'r':
+	  retrans_warning = xstrdup (optarg);
+	  if (NULL == (retrans_critical = strchr (retrans_warning, ',')))
+	    usage (stderr);
+	  *retrans_critical++ = '\0';
+	  break;
+	case 'c':
+	  critical = optarg;
+	  break;
+	case 'w':
+	  warning = optarg;
+	  break;
+
+	case_GETOPT_HELP_CHAR
+	case_GETOPT_VERSION_CHAR
+
+	}
+    }
+
+  if (tcp_flags == TCP_UNSET)
+    tcp_flags = TCP_v4 | TCP_v6;
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&retrans_threshold, retrans_warning,
+			 retrans_critical) == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  nports = tcp_quality_read (tcp_flags, sport, dport, &ports);
+  if (nports < 0)
+    plugin_error (STATE_UNKNOWN, errno,
+		  "cannot dump the TCP connections with sock_diag");
+
+  port_status = xnmalloc (nports + 1, sizeof (nagstatus));
+  for (i = 0; i < (size_t) nports; i++)
+    {
+      double rtt_p99 = histogram_quantile (&ports[i].rtt, 0.99) / 1000.0;
+      nagstatus s = get_status (retrans_ratio (&ports[i]), retrans_threshold);
+
+      port_status[i] = get_status (rtt_p99, my_threshold);
+      if (port_status[i] < s)
+	port_status[i] = s;
+      if (status < port_status[i])
+	status = port_status[i];
+      if (port_status[i] > port_status[worst]
+	  || (port_status[i] == port_status[worst]
+	      && ports[i].rtt.max > ports[worst].rtt.max))
+	worst = i;
+      connections += ports[i].connections;
+    }
+
+  struct metrics *metrics = metrics_new (program_name_short, 6 * nports + 1);
+  struct metric metric = { .label = "port", .min = "0" };
+  char label[16];
+
+  for (i = 0; i < (size_t) nports; i++)
+    {
+      const struct tcp_port_quality *p = &ports[i];
+
+      metric.label_value = port_label (p, label, sizeof label);
+
+      metric.name = "connections";
+      metric.unit = NULL;
+      metric.precision = 0;
+      metric.warning = metric.critical = metric.max = NULL;
+      metrics_add (metrics, &metric, p->connections);
+
+      metric.name = "rtt_p50";
+      metric.unit = "ms";
+      metric.precision = 3;
+      metrics_add (metrics, &metric,
+		   histogram_quantile (&p->rtt, 0.50) / 1000.0);
+      metric.name = "rtt_p99";
+      metric.warning = warning;
+      metric.critical = critical;
+      metrics_add (metrics, &metric,
+		   histogram_quantile (&p->rtt, 0.99) / 1000.0);
+
+      metric.name = "retransmitted";
+      metric.unit = "%";
+      metric.precision = 2;
+      metric.warning = retrans_warning;
+      metric.critical = retrans_critical;
+      metric.max = "100";
+      metrics_add (metrics, &metric, retrans_ratio (p));
+
+      metric.name = "unacked_p99";
+      metric.unit = NULL;
+      metric.precision = 0;
+      metric.warning = metric.critical = metric.max = NULL;
+      metrics_add (metrics, &metric, histogram_quantile (&p->unacked, 0.99));
+      metric.name = "cwnd_p50";
+      metrics_add (metrics, &metric, histogram_quantile (&p->cwnd, 0.50));
+    }
+
+  if (nports > 0)
+    message =
+      xasprintf ("%s %s - %lu connections, %s: rtt p50 %.3fms "
+		 "p99 %.3fms, %.2f%% retransmitted", program_name_short,
+		 state_text (status), connections,
+		 port_label (&ports[worst], label, sizeof label),
+		 histogram_quantile (&ports[worst].rtt, 0.50) / 1000.0,
+		 histogram_quantile (&ports[worst].rtt, 0.99) / 1000.0,
+		 retrans_ratio (&ports[worst]));
+  else
+    message = xasprintf ("%s %s - no established connections",
+			 program_name_short, state_text (status));
+  metrics_write (metrics, status, message);
+
+  free (message);
+  free (port_status);
+  free (ports);
+  free (retrans_warning);
+  free (my_threshold);
+  free (retrans_threshold);
+
+  return status;
+}
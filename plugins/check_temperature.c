@@ -34,11 +34,14 @@
 
 #include "common.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "sysfsparser.h"
 #include "thresholds.h"
 #include "xalloc.h"
+#include "xasprintf.h"
 
 enum
 {
@@ -144,6 +147,7 @@ main (int argc, char **argv)
   thresholds *my_threshold = NULL;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "fklt:c:w:v" GETOPT_HELP_VERSION_STRING,
@@ -196,20 +200,33 @@ main (int argc, char **argv)
   status = get_status (real_temp, my_threshold);
   free (my_threshold);
 
-  printf ("%s %s - +%.1f%s (thermal zone: %u [%s], type: \"%s\") | temp=%u%c",
-	  program_name_short, state_text (status), real_temp, scale,
-	  thermal_zone, sysfsparser_thermal_get_device (thermal_zone),
-	  type ? type : "n/a", (unsigned int) real_temp,
-	  (temperature_unit == TEMP_KELVIN) ? 'K' :
-	  (temperature_unit == TEMP_FAHRENHEIT) ? 'F' : 'C');
+  char *status_msg =
+    xasprintf ("%s %s - +%.1f%s (thermal zone: %u [%s], type: \"%s\")",
+	       program_name_short, state_text (status), real_temp, scale,
+	       thermal_zone, sysfsparser_thermal_get_device (thermal_zone),
+	       type ? type : "n/a");
+
+  struct metrics *metrics = metrics_new (program_name_short, 1);
+  struct metric metric = {
+    .name = "temp",
+    .unit = (temperature_unit == TEMP_KELVIN) ? "K" :
+	    (temperature_unit == TEMP_FAHRENHEIT) ? "F" : "C"
+  };
 
   /* check for the related critical temperature, if any */
+  char crit[32];
   int crit_temp =
     sysfsparser_thermal_get_critical_temperature (thermal_zone) / 1000;
   if (crit_temp > 0 && ALL_THERMAL_ZONES != selected_thermal_zone)
-    printf (";0;%d", crit_temp);
+    {
+      snprintf (crit, sizeof crit, "%d", crit_temp);
+      metric.warning = "0";
+      metric.critical = crit;
+    }
 
-  putchar ('\n');
+  metrics_add (metrics, &metric, (unsigned int) real_temp);
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
 
   return status;
 }
@@ -0,0 +1,418 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * A Nagios plugin that checks the CPU throttling of the cgroups limited
+ * by a CFS bandwidth quota (cgroup v2 cpu.max).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cgroup.h"
+#include "common.h"
+#include "logging.h"
+#include "messages.h"
+#include "metrics.h"
+#include "progname.h"
+#include "progversion.h"
+#include "result_cache.h"
+#include "statefile.h"
+#include "string-macros.h"
+#include "system.h"
+#include "thresholds.h"
+#include "xalloc.h"
+#include "xasprintf.h"
+#include "xstrton.h"
+
+#define TOP_DEFAULT  5
+
+static const char *program_copyright =
+  "Copyright (C) 2026 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
+
+static struct option const longopts[] = {
+  {(char *) "cgroup", required_argument, NULL, 'g'},
+  {(char *) "top", required_argument, NULL, 'n'},
+  {(char *) "time", required_argument, NULL, 't'},
+  {(char *) "critical", required_argument, NULL, 'c'},
+  {(char *) "warning", required_argument, NULL, 'w'},
+  {(char *) "help", no_argument, NULL, GETOPT_HELP_CHAR},
+  {(char *) "version", no_argument, NULL, GETOPT_VERSION_CHAR},
+  {NULL, 0, NULL, 0}
+};
+
+static _Noreturn void
+usage (FILE * out)
+{
+  fprintf (out, "%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs ("This plugin checks the CPU throttling of the cgroups limited by a "
+	 "CPU quota.\n", out);
+  fputs (program_copyright, out);
+  fputs (USAGE_HEADER, out);
+  fprintf (out, "  %s [-g PATH] [-n TOP] [-w PERC] [-c PERC] "
+	   "[--time=WMSEC,CMSEC] [delay]\n", program_name);
+  fputs (USAGE_OPTIONS, out);
+  fputs ("  -g, --cgroup=PATH   the subtree to check, relative to "
+	 PATH_SYS_CGROUP "\n"
+	 "                  (default: the whole hierarchy)\n", out);
+  fputs ("  -n, --top=TOP   the number of most throttled cgroups reported "
+	 "(default: 5)\n", out);
+  fputs ("  -w, --warning PERC   warning threshold on the percentage of "
+	 "throttled periods\n", out);
+  fputs ("  -c, --critical PERC   critical threshold on the percentage of "
+	 "throttled periods\n", out);
+  fputs ("  -t, --time=WMSEC,CMSEC   warning and critical thresholds on the "
+	 "throttled time\n"
+	 "                  (in milliseconds per second)\n", out);
+  fputs (USAGE_HELP, out);
+  fputs (USAGE_VERSION, out);
+  fprintf (out, "  \"delay\" is the delay in seconds between two samples "
+	   "(default: %dsec)\n", DELAY_DEFAULT);
+  fputs (USAGE_NOTE, out);
+  fputs (USAGE_STATEFILE, out);
+  fputs (USAGE_EXAMPLES, out);
+  fprintf (out, "  %s -g kubepods.slice -w 10 -c 25\n", program_name);
+  fprintf (out, "  %s -n 3 --time=50,200\n", program_name);
+
+  exit (out == stderr ? STATE_UNKNOWN : STATE_OK);
+}
+
+static _Noreturn void
+print_version (void)
+{
+  printf ("%s (" PACKAGE_NAME ") v%s\n", program_name, program_version);
+  fputs (program_copyright, stdout);
+  fputs (GPLv3_DISCLAIMER, stdout);
+
+  exit (STATE_OK);
+}
+
+/* The counters of cpu.stat saved between two executions */
+enum throttling_counter
+{
+  THROTTLING_NR_PERIODS,
+  THROTTLING_NR_THROTTLED,
+  THROTTLING_THROTTLED_USEC,
+  THROTTLING_COUNTERS
+};
+
+typedef struct throttling_cgroup
+{
+  char *name;			/* relative to the root of the walk */
+  unsigned long long counter[THROTTLING_COUNTERS];
+  double ratio;			/* percentage of throttled periods */
+  double time;			/* throttled milliseconds per second */
+} throttling_cgroup;
+
+typedef struct throttling_walk
+{
+  const char *root;
+  size_t rootlen;
+  throttling_cgroup *cgroups;
+  size_t ncgroups, size;
+  /* the first sample, if the cgroups have been sampled twice */
+  unsigned long long (*prev)[THROTTLING_COUNTERS];
+} throttling_walk;
+
+static void
+throttling_read (const char *path, unsigned long long *counter)
+{
+  struct cgroup_cpu_stat stat;
+
+  if (cgroup_cpu_stat (path, &stat) < 0)
+    {
+      memset (counter, 0, THROTTLING_COUNTERS * sizeof (unsigned long long));
+      return;
+    }
+  counter[THROTTLING_NR_PERIODS] = stat.nr_periods;
+  counter[THROTTLING_NR_THROTTLED] = stat.nr_throttled;
+  counter[THROTTLING_THROTTLED_USEC] = stat.throttled_usec;
+}
+
+/* Collect the counters of a cgroup.  The cgroups with no CPU quota (and
+   their children, unless they have a quota) have no enforcement periods
+   and cannot be throttled: they are skipped.  */
+
+static int
+throttling_collect (const char *path, void *data)
+{
+  throttling_walk *walk = data;
+  throttling_cgroup *cgroup;
+  unsigned long long counter[THROTTLING_COUNTERS];
+  const char *name = path + walk->rootlen;
+
+  throttling_read (path, counter);
+  if (0 == counter[THROTTLING_NR_PERIODS])
+    return 0;
+
+  if (walk->ncgroups == walk->size)
+    {
+      walk->size = walk->size ? walk->size * 2 : 64;
+      walk->cgroups =
+	xrealloc (walk->cgroups, walk->size * sizeof (throttling_cgroup));
+    }
+
+  cgroup = &walk->cgroups[walk->ncgroups++];
+  cgroup->name = xstrdup (*name == '/' ? name + 1 : (*name ? name : "/"));
+  memcpy (cgroup->counter, counter, sizeof counter);
+  cgroup->ratio = cgroup->time = 0;
+
+  return 0;
+}
+
+/* Read again the counters of the cgroups collected.  */
+
+static void
+throttling_resample (void *data)
+{
+  throttling_walk *walk = data;
+
+  walk->prev =
+    xnmalloc (walk->ncgroups ? walk->ncgroups : 1, sizeof (*walk->prev));
+  for (size_t i = 0; i < walk->ncgroups; i++)
+    {
+      char *path = STREQ (walk->cgroups[i].name, "/") ? xstrdup (walk->root)
+	: xasprintf ("%s/%s", walk->root, walk->cgroups[i].name);
+
+      memcpy (walk->prev[i], walk->cgroups[i].counter,
+	      sizeof (walk->prev[i]));
+      throttling_read (path, walk->cgroups[i].counter);
+      free (path);
+    }
+}
+
+/* Compute the throttling of CGROUP, whose counters were PREV ELAPSED
+   seconds ago.  Return false if the counters have been reset.  */
+
+static bool
+throttling_compute (throttling_cgroup *cgroup,
+		    const unsigned long long *prev, double elapsed)
+{
+  unsigned long long periods, throttled, usec;
+
+  if (cgroup->counter[THROTTLING_NR_PERIODS] < prev[THROTTLING_NR_PERIODS]
+      || cgroup->counter[THROTTLING_NR_THROTTLED]
+	 < prev[THROTTLING_NR_THROTTLED]
+      || cgroup->counter[THROTTLING_THROTTLED_USEC]
+	 < prev[THROTTLING_THROTTLED_USEC])
+    return false;
+
+  periods =
+    cgroup->counter[THROTTLING_NR_PERIODS] - prev[THROTTLING_NR_PERIODS];
+  throttled =
+    cgroup->counter[THROTTLING_NR_THROTTLED] - prev[THROTTLING_NR_THROTTLED];
+  usec =
+    cgroup->counter[THROTTLING_THROTTLED_USEC]
+    - prev[THROTTLING_THROTTLED_USEC];
+
+  cgroup->ratio = periods ? 100.0 * throttled / periods : 0;
+  cgroup->time = usec / 1e3 / elapsed;
+  return true;
+}
+
+/* Sort the cgroups, the most throttled first */
+
+static int
+throttling_cmp (const void *a, const void *b)
+{
+  const throttling_cgroup *ca = a, *cb = b;
+
+  if (ca->ratio != cb->ratio)
+    return ca->ratio < cb->ratio ? 1 : -1;
+  if (ca->time != cb->time)
+    return ca->time < cb->time ? 1 : -1;
+  return strcmp (ca->name, cb->name);
+}
+
+int
+main (int argc, char **argv)
+{
+  int c;
+  char *critical = NULL, *warning = NULL, *time_critical = NULL,
+       *time_warning = NULL, *root, *message;
+  const char *subtree = "/";
+  nagstatus status = STATE_OK;
+  thresholds *my_threshold = NULL, *time_threshold = NULL;
+  unsigned long delay, top = TOP_DEFAULT;
+  throttling_walk walk = { 0 };
+  struct statefile *state;
+  double elapsed;
+  size_t i, nthrottled = 0;
+
+  set_program_name (argv[0]);
+  result_cache_init (argc, argv);
+
+  while ((c = getopt_long (argc, argv,
+			   "g:n:t:c:w:" GETOPT_HELP_VERSION_STRING,
+			   longopts, NULL)) != -1)
+    {
+      switch (c)
+	{
+	default:
+	  usage (stderr);
+	case 'g':
+	  subtree = optarg;
+	  break;
+	case 'n':
+	  top = strtol_or_err (optarg, "the top value must be an integer");
+	  if ((long) top < 0)
+	    plugin_error (STATE_UNKNOWN, 0, "invalid top value: %s", optarg);
+	  break;
+	case 't':
+	  time_warning = xstrdup (optarg);
+	  if (NULL == (time_critical = strchr (time_warning, ',')))
+	    usage (stderr);
+	  *time_critical++ = '\0';
+	  break;
+	case 'c':
+	  critical = optarg;
+	  break;
+	case 'w':
+	  warning = optarg;
+	  break;
+
+	case_GETOPT_HELP_CHAR
+	case_GETOPT_VERSION_CHAR
+
+	}
+    }
+
+  delay = DELAY_DEFAULT;
+  if (optind < argc)
+    {
+      delay = strtol_or_err (argv[optind++], "failed to parse argument");
+
+      if (delay < 1)
+	plugin_error (STATE_UNKNOWN, 0, "delay must be positive integer");
+      else if (DELAY_MAX < delay)
+	plugin_error (STATE_UNKNOWN, 0,
+		      "too large delay value (greater than %d)", DELAY_MAX);
+    }
+
+  if (set_thresholds (&my_threshold, warning, critical)
+      == NP_RANGE_UNPARSEABLE
+      || set_thresholds (&time_threshold, time_warning, time_critical)
+	 == NP_RANGE_UNPARSEABLE)
+    usage (stderr);
+
+  if (NULL == (root = cgroup_path (subtree)))
+    plugin_error (STATE_UNKNOWN, 0, "the cgroup v2 hierarchy is not mounted");
+
+  /* a single walk of the hierarchy: with the counters saved by the last
+     execution there is nothing else to read */
+  walk.root = root;
+  walk.rootlen = strlen (root);
+  if (cgroup_walk (root, throttling_collect, &walk) < 0)
+    plugin_error (STATE_UNKNOWN, errno, "error reading %s", root);
+
+  /* the samples saved less than DELAY seconds ago are too close */
+  state = statefile_open (root, THROTTLING_COUNTERS);
+  elapsed = statefile_sample (state, delay, NULL, 0, throttling_resample,
+			      &walk);
+  for (i = 0; i < walk.ncgroups; i++)
+    {
+      const unsigned long long *prev = walk.prev ? walk.prev[i] :
+	statefile_get (state, walk.cgroups[i].name);
+      /* a cgroup created since then: all its periods are new */
+      static const unsigned long long zero[THROTTLING_COUNTERS];
+
+      throttling_compute (&walk.cgroups[i], prev ? prev : zero, elapsed);
+    }
+  free (walk.prev);
+
+  for (i = 0; i < walk.ncgroups; i++)
+    statefile_put (state, walk.cgroups[i].name, walk.cgroups[i].counter);
+  if (statefile_save (state) < 0)
+    dbg ("cannot save the state: %s\n", strerror (errno));
+  statefile_free (state);
+
+  qsort (walk.cgroups, walk.ncgroups, sizeof (throttling_cgroup),
+	 throttling_cmp);
+
+  for (i = 0; i < walk.ncgroups; i++)
+    {
+      nagstatus s = get_status (walk.cgroups[i].ratio, my_threshold),
+	ts = get_status (walk.cgroups[i].time, time_threshold);
+
+      if (walk.cgroups[i].ratio > 0)
+	nthrottled++;
+      if (s < ts)
+	s = ts;
+      if (status < s)
+	status = s;
+    }
+
+  if (top > walk.ncgroups)
+    top = walk.ncgroups;
+  struct metrics *metrics = metrics_new (program_name_short, 2 + 2 * top);
+  struct metric metric = { .name = "cgroups" };
+
+  metrics_add (metrics, &metric, walk.ncgroups);
+  metric.name = "cgroups_throttled";
+  metrics_add (metrics, &metric, nthrottled);
+
+  metric.label = "cgroup";
+  for (i = 0; i < walk.ncgroups && i < top; i++)
+    {
+      metric.label_value = walk.cgroups[i].name;
+      metric.name = "throttled";
+      metric.unit = "%";
+      metric.precision = 2;
+      metric.warning = warning;
+      metric.critical = critical;
+      metric.min = "0";
+      metric.max = "100";
+      metrics_add (metrics, &metric, walk.cgroups[i].ratio);
+
+      metric.name = "throttled_time/s";
+      metric.unit = "ms";
+      metric.warning = time_warning;
+      metric.critical = time_critical;
+      metric.max = NULL;
+      metrics_add (metrics, &metric, walk.cgroups[i].time);
+    }
+
+  if (walk.ncgroups > 0 && walk.cgroups[0].ratio > 0)
+    message =
+      xasprintf ("%s %s - %zu/%zu cgroups throttled in %.0lfs, worst: %s "
+		 "(%.2lf%% of the periods, %.2lfms/s)", program_name_short,
+		 state_text (status), nthrottled, walk.ncgroups, elapsed,
+		 walk.cgroups[0].name, walk.cgroups[0].ratio,
+		 walk.cgroups[0].time);
+  else
+    message =
+      xasprintf ("%s %s - %zu/%zu cgroups throttled in %.0lfs",
+		 program_name_short, state_text (status), nthrottled,
+		 walk.ncgroups, elapsed);
+  metrics_write (metrics, status, message);
+  free (message);
+
+  for (i = 0; i < walk.ncgroups; i++)
+    free (walk.cgroups[i].name);
+  free (walk.cgroups);
+  free (my_threshold);
+  free (time_threshold);
+  free (time_warning);
+  free (root);
+
+  return status;
+}
@@ -32,8 +32,10 @@
 
 #include "common.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
 #include "xasprintf.h"
 
@@ -147,12 +149,13 @@ main (int argc, char **argv)
 {
   int c, uptime_mins, status;
   char *critical = NULL, *warning = NULL;
-  char *status_msg, *perfdata_msg;
+  char *status_msg;
   double uptime_secs;
   thresholds *my_threshold = NULL;
   double (*uptime) ();
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
   uptime = uptime_sysinfo;
 
   while ((c = getopt_long (argc, argv, "mc:w:" GETOPT_HELP_VERSION_STRING,
@@ -193,10 +196,14 @@ main (int argc, char **argv)
   status_msg =
     xasprintf ("%s %s: %s", program_name_short,
 	       state_text (status), sprint_uptime (uptime_secs));
-  perfdata_msg =
-    xasprintf ("uptime=%d;%s;%s;0;", uptime_mins,
-	       warning ? warning : "", critical ? critical : "");
-  printf ("%s | %s\n", status_msg, perfdata_msg);
+
+  struct metrics *metrics = metrics_new (program_name_short, 1);
+  struct metric metric = {
+    .name = "uptime", .warning = warning, .critical = critical, .min = "0"
+  };
+  metrics_add (metrics, &metric, uptime_mins);
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
 
   return status;
 }
@@ -28,9 +28,12 @@
 
 #include "common.h"
 #include "messages.h"
+#include "metrics.h"
 #include "progname.h"
 #include "progversion.h"
+#include "result_cache.h"
 #include "thresholds.h"
+#include "xasprintf.h"
 
 static const char *program_copyright =
   "Copyright (C) 2014,2015 Davide Madrisan <" PACKAGE_BUGREPORT ">\n";
@@ -87,6 +90,7 @@ main (int argc, char **argv)
   thresholds *my_threshold = NULL;
 
   set_program_name (argv[0]);
+  result_cache_init (argc, argv);
 
   while ((c = getopt_long (argc, argv,
 			   "c:w:v" GETOPT_HELP_VERSION_STRING,
@@ -139,9 +143,15 @@ main (int argc, char **argv)
   status = get_status (numuser, my_threshold);
   free (my_threshold);
 
-  printf ("%s %s - %d user%s logged on | logged_users=%d\n",
-	  program_name_short, state_text (status), numuser,
-	  (numuser == 1 ) ? "" : "s", numuser);
+  struct metrics *metrics = metrics_new (program_name_short, 1);
+  struct metric metric = { .name = "logged_users" };
+  metrics_add (metrics, &metric, numuser);
+
+  char *status_msg = xasprintf ("%s %s - %d user%s logged on",
+				program_name_short, state_text (status),
+				numuser, (numuser == 1 ) ? "" : "s");
+  metrics_write (metrics, status, status_msg);
+  free (status_msg);
 
   return status;
 }
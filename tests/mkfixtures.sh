@@ -0,0 +1,319 @@
+#!/bin/bash
+# Generate synthetic proc and sysfs trees for scaled testing and benchmarking
+# Copyright (C) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+#
+# The generated trees can be used by setting the environment variables
+#   NPL_PROC_ROOT=<dir>/proc NPL_SYS_ROOT=<dir>/sys
+# before running a plugin, a test, or a benchmark.
+# The output is deterministic: the same options always produce the same tree.
+
+PROGNAME="${0##*/}"
+REVISION=1
+
+die () { echo "$PROGNAME: error: $1" 1>&2; exit 1; }
+msg () { [ "$quiet" ] || echo "*** info: $1"; }
+
+usage () {
+   cat <<__EOF
+Usage: $PROGNAME [-c <cpus>] [-p <pids>] [-t <sockets>] [-m <mounts>] \
+[-i <ifaces>] [-q] -o <dir>
+       $PROGNAME --small -o <dir>
+       $PROGNAME --help
+       $PROGNAME --version
+
+Where:
+   -c|--cpus    : number of CPUs (default: $cpus)
+   -p|--pids    : number of processes in <dir>/proc (default: $pids)
+   -t|--tcp     : number of TCP sockets, split between tcp and tcp6
+                  (default: $sockets)
+   -m|--mounts  : number of mount points (default: $mounts)
+   -i|--ifaces  : number of network interfaces in <dir>/sys/class/net
+                  (default: $ifaces)
+   -o|--output  : the directory where the trees will be created
+   -q|--quiet   : do not display progress messages
+      --small   : generate a small tree, suitable for the test suite
+
+Example:
+   $PROGNAME -o /tmp/npl-fixtures
+   NPL_PROC_ROOT=/tmp/npl-fixtures/proc NPL_SYS_ROOT=/tmp/npl-fixtures/sys \\
+      plugins/check_nbprocs
+__EOF
+}
+
+cpus=2048
+pids=100000
+sockets=500000
+mounts=5000
+ifaces=10000
+outdir=
+quiet=
+
+while test -n "$1"; do
+   case "$1" in
+      --cpus|-c) cpus="$2"; shift ;;
+      --pids|-p) pids="$2"; shift ;;
+      --tcp|-t) sockets="$2"; shift ;;
+      --mounts|-m) mounts="$2"; shift ;;
+      --ifaces|-i) ifaces="$2"; shift ;;
+      --output|-o) outdir="$2"; shift ;;
+      --quiet|-q) quiet=1 ;;
+      --small) cpus=8; pids=100; sockets=200; mounts=20; ifaces=4 ;;
+      --help|-h) usage; exit 0 ;;
+      --version|-V) echo "$PROGNAME v$REVISION"; exit 0 ;;
+      *) die "unknown switch: $1" ;;
+   esac
+   shift
+done
+
+[ "$outdir" ] || { usage 1>&2; exit 1; }
+for n in "$cpus" "$pids" "$sockets" "$mounts" "$ifaces"; do
+   case "$n" in
+      ''|*[!0-9]*) die "not a number: $n" ;;
+   esac
+done
+[ "$cpus" -gt 0 ] || die "at least one CPU is required"
+
+proc="$outdir/proc"
+sys="$outdir/sys"
+syscpu="$sys/devices/system/cpu"
+
+mkdir -p "$proc/net/stat" "$proc/pressure" "$proc/self" "$proc/sys/vm" \
+   "$syscpu" "$sys/class/net" "$sys/fs/cgroup" ||
+   die "cannot create the directory tree under $outdir"
+
+msg "generating $proc/{stat,interrupts,softirqs,cpuinfo} ($cpus CPUs)..."
+awk -v ncpus="$cpus" -v proc="$proc" 'BEGIN {
+   stat = proc "/stat"
+   printf "cpu  %d %d %d %d %d 0 %d 0 0 0\n",
+      ncpus * 5000, ncpus * 200, ncpus * 2500, ncpus * 200000,
+      ncpus * 3000, ncpus * 20 > stat
+   for (i = 0; i < ncpus; i++)
+      printf "cpu%d %d %d %d %d %d 0 %d 0 0 0\n",
+         i, 5000 + i % 97, 200 + i % 13, 2500 + i % 31, 200000 - i % 101,
+         3000 + i % 7, 20 + i % 3 > stat
+   printf "intr %d", ncpus * 100000 > stat
+   for (i = 0; i < 256; i++) printf " %d", (i * 7919) % 10007 > stat
+   printf "\nctxt %d\nbtime 1700000000\nprocesses %d\n", \
+      ncpus * 1000000, ncpus * 1000 > stat
+   printf "procs_running %d\nprocs_blocked %d\n", 1 + ncpus / 4, ncpus / 64 > stat
+   printf "softirq %d 0 %d 0 %d %d 0 %d %d 0 %d\n", ncpus * 60000,
+      ncpus * 10000, ncpus * 10000, ncpus * 10000, ncpus * 10000,
+      ncpus * 10000, ncpus * 10000 > stat
+   close (stat)
+
+   intr = proc "/interrupts"
+   printf "    " > intr
+   for (i = 0; i < ncpus; i++) printf " %10s", "CPU" i > intr
+   printf "\n" > intr
+   for (irq = 0; irq < 64; irq++) {
+      printf "%3d:", irq > intr
+      for (i = 0; i < ncpus; i++) printf " %10d", (irq * 31 + i * 17) % 100000 > intr
+      printf "  IR-PCI-MSI %d-edge  dev%d\n", irq, irq > intr
+   }
+   split ("NMI LOC SPU PMI IWI RTR RES CAL TLB", names, " ")
+   for (n = 1; n <= 9; n++) {
+      printf "%s:", names[n] > intr
+      for (i = 0; i < ncpus; i++) printf " %10d", (n * 101 + i * 7) % 100000 > intr
+      printf "   %s interrupts\n", names[n] > intr
+   }
+   printf "ERR:          0\nMIS:          0\n" > intr
+   close (intr)
+
+   softirqs = proc "/softirqs"
+   printf "      " > softirqs
+   for (i = 0; i < ncpus; i++) printf " %10s", "CPU" i > softirqs
+   printf "\n" > softirqs
+   split ("HI TIMER NET_TX NET_RX BLOCK IRQ_POLL TASKLET SCHED HRTIMER RCU",
+          names, " ")
+   for (n = 1; n <= 10; n++) {
+      printf "%10s:", names[n] > softirqs
+      for (i = 0; i < ncpus; i++) printf " %10d", (n * 1009 + i * 13) % 1000000 > softirqs
+      printf "\n" > softirqs
+   }
+   close (softirqs)
+
+   cpuinfo = proc "/cpuinfo"
+   for (i = 0; i < ncpus; i++) {
+      printf "processor\t: %d\nvendor_id\t: GenuineIntel\n", i > cpuinfo
+      printf "model name\t: Synthetic CPU @ 2.00GHz\n" > cpuinfo
+      printf "cpu MHz\t\t: 2000.000\nphysical id\t: %d\n", int (i / 64) > cpuinfo
+      printf "core id\t\t: %d\ncpu cores\t: 32\n\n", int (i / 2) % 32 > cpuinfo
+   }
+   close (cpuinfo)
+}' || die "awk failure"
+
+msg "generating $proc/{meminfo,vmstat,pressure}..."
+cat > "$proc/meminfo" <<__EOF
+MemTotal:       1073741824 kB
+MemFree:        536870912 kB
+MemAvailable:   805306368 kB
+Buffers:          1048576 kB
+Cached:         134217728 kB
+SwapCached:            0 kB
+Active:         268435456 kB
+Inactive:       134217728 kB
+Active(anon):   201326592 kB
+Inactive(anon):  16777216 kB
+Active(file):    67108864 kB
+Inactive(file): 117440512 kB
+Unevictable:        65536 kB
+Mlocked:            65536 kB
+SwapTotal:       16777216 kB
+SwapFree:        16777216 kB
+Dirty:              10240 kB
+Writeback:              0 kB
+AnonPages:      218103808 kB
+Mapped:           2097152 kB
+Shmem:             524288 kB
+Slab:             8388608 kB
+SReclaimable:     6291456 kB
+SUnreclaim:       2097152 kB
+PageTables:        524288 kB
+CommitLimit:    553648128 kB
+Committed_AS:   268435456 kB
+HugePages_Total:       0
+HugePages_Free:        0
+Hugepagesize:       2048 kB
+__EOF
+cat > "$proc/vmstat" <<__EOF
+nr_free_pages 134217728
+nr_dirty 2560
+nr_writeback 0
+pgpgin 123456789
+pgpgout 987654321
+pswpin 0
+pswpout 0
+pgalloc_dma 0
+pgalloc_dma32 1234567
+pgalloc_normal 987654321
+pgfree 1098765432
+pgfault 2109876543
+pgmajfault 12345
+pgsteal_kswapd 100000
+pgsteal_direct 1000
+pgscan_kswapd 200000
+pgscan_direct 2000
+__EOF
+echo 262144 > "$proc/sys/vm/min_free_kbytes"
+echo "some avg10=1.50 avg60=1.20 avg300=1.00 total=123456789" \
+   > "$proc/pressure/cpu"
+for f in io memory; do
+   cat > "$proc/pressure/$f" <<__EOF
+some avg10=0.50 avg60=0.40 avg300=0.30 total=23456789
+full avg10=0.10 avg60=0.08 avg300=0.05 total=3456789
+__EOF
+done
+
+msg "generating $proc/<pid>/status ($pids processes)..."
+awk -v npids="$pids" 'BEGIN {
+   for (pid = 1; pid <= npids; pid++) print pid }' |
+   (cd "$proc" && xargs mkdir -p) || die "cannot create the pid directories"
+awk -v npids="$pids" -v proc="$proc" 'BEGIN {
+   split ("systemd sshd bash nginx postgres java python3 kworker", cmds, " ")
+   for (pid = 1; pid <= npids; pid++) {
+      f = proc "/" pid "/status"
+      uid = (pid % 5) * 1000
+      printf "Name:\t%s\nUmask:\t0022\nState:\tS (sleeping)\n", \
+         cmds[1 + pid % 8] > f
+      printf "Tgid:\t%d\nPid:\t%d\nPPid:\t1\n", pid, pid > f
+      printf "Uid:\t%d\t%d\t%d\t%d\nGid:\t%d\t%d\t%d\t%d\n", \
+         uid, uid, uid, uid, uid, uid, uid, uid > f
+      printf "VmRSS:\t%d kB\nThreads:\t%d\n", 1024 + pid % 4096, 1 + pid % 16 > f
+      close (f)
+   }
+}' || die "awk failure"
+
+msg "generating $proc/net/{tcp,tcp6} ($sockets sockets)..."
+awk -v nsockets="$sockets" -v proc="$proc" '
+function header(f) {
+   printf "  sl  local_address rem_address   st tx_queue rx_queue tr " \
+      "tm->when retrnsmt   uid  timeout inode\n" > f
+}
+BEGIN {
+   tcp = proc "/net/tcp"; tcp6 = proc "/net/tcp6"
+   header(tcp); header(tcp6)
+   n4 = int ((nsockets + 1) / 2)
+   for (i = 0; i < nsockets; i++) {
+      # mostly established connections, plus a few sockets in every state
+      st = (i % 10 < 7) ? 1 : 1 + i % 11
+      lport = (st == 10) ? 80 + i % 16 : 443
+      rport = 1024 + i % 60000
+      if (i < n4)
+         printf "%6d: 0100007F:%04X %08X:%04X %02X 00000000:00000000 " \
+            "00:00000000 00000000  1000        0 %d 1 0000000000000000 " \
+            "20 4 30 10 -1\n", i, lport, 167772160 + i % 65536, rport, st, \
+            100000 + i > tcp
+      else
+         printf "%4d: 00000000000000000000000001000000:%04X " \
+            "0000000000000000FFFF0000%08X:%04X %02X 00000000:00000000 " \
+            "00:00000000 00000000  1000        0 %d 1 0000000000000000 " \
+            "20 4 30 10 -1\n", i - n4, lport, 167772160 + i % 65536, rport, \
+            st, 100000 + i > tcp6
+   }
+}' || die "awk failure"
+
+msg "generating $proc/self/mounts ($mounts mount points)..."
+awk -v nmounts="$mounts" 'BEGIN {
+   print "sysfs /sys sysfs rw,nosuid,nodev,noexec,relatime 0 0"
+   print "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0"
+   print "/dev/sda1 / ext4 rw,relatime 0 0"
+   for (i = 0; i < nmounts - 3; i++) {
+      if (i % 4 == 0)
+         printf "server%d:/export/vol%d /mnt/nfs/vol%d nfs4 " \
+            "rw,relatime,vers=4.2,rsize=1048576,wsize=1048576 0 0\n", \
+            i % 16, i, i
+      else if (i % 4 == 1)
+         printf "overlay /var/lib/containers/overlay/%d/merged overlay " \
+            "rw,relatime,lowerdir=/l%d,upperdir=/u%d,workdir=/w%d 0 0\n", \
+            i, i, i, i
+      else if (i % 4 == 2)
+         printf "tmpfs /run/user/%d tmpfs rw,nosuid,nodev,relatime 0 0\n", i
+      else
+         printf "/dev/mapper/vg-lv%d /srv/data%d xfs ro,relatime 0 0\n", i, i
+   }
+}' > "$proc/self/mounts" || die "awk failure"
+
+msg "generating $syscpu ($cpus CPUs)..."
+last=$((cpus - 1))
+echo "0-$last" > "$syscpu/online"
+echo "0-$last" > "$syscpu/present"
+echo "0-$last" > "$syscpu/possible"
+echo "$last" > "$syscpu/kernel_max"
+awk -v ncpus="$cpus" 'BEGIN {
+   for (i = 0; i < ncpus; i++) print "cpu" i "/topology" }' |
+   (cd "$syscpu" && xargs mkdir -p) || die "cannot create the cpu directories"
+awk -v ncpus="$cpus" -v syscpu="$syscpu" 'BEGIN {
+   for (i = 0; i < ncpus; i++) {
+      d = syscpu "/cpu" i
+      if (i > 0) { print 1 > (d "/online"); close (d "/online") }
+      # two threads per core, 32 cores per socket
+      printf "%x\n", 3 > (d "/topology/thread_siblings")
+      close (d "/topology/thread_siblings")
+      printf "%x\n", 4294967295 > (d "/topology/core_siblings")
+      close (d "/topology/core_siblings")
+      print int (i / 64) > (d "/topology/physical_package_id")
+      close (d "/topology/physical_package_id")
+   }
+}' || die "awk failure"
+
+msg "generating $sys/class/net ($ifaces interfaces)..."
+awk -v nifaces="$ifaces" 'BEGIN {
+   for (i = 0; i < nifaces; i++) print "veth" i "/statistics" }' |
+   (cd "$sys/class/net" && xargs mkdir -p) ||
+   die "cannot create the network interface directories"
+awk -v nifaces="$ifaces" -v net="$sys/class/net" 'BEGIN {
+   split ("rx_bytes tx_bytes rx_packets tx_packets rx_errors tx_errors " \
+          "rx_dropped tx_dropped multicast collisions", stats, " ")
+   for (i = 0; i < nifaces; i++) {
+      d = net "/veth" i
+      print "up" > (d "/operstate"); close (d "/operstate")
+      print 10000 > (d "/speed"); close (d "/speed")
+      print 1500 > (d "/mtu"); close (d "/mtu")
+      for (s = 1; s <= 10; s++) {
+         f = d "/statistics/" stats[s]
+         print (i + 1) * s * 1000 > f; close (f)
+      }
+   }
+}' || die "awk failure"
+
+msg "done: use NPL_PROC_ROOT=$proc NPL_SYS_ROOT=$sys"
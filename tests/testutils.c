@@ -36,6 +36,7 @@
 #include "system.h"
 #include "testutils.h"
 #include "xalloc.h"
+#include "xasprintf.h"
 
 static size_t test_counter;
 
@@ -62,6 +63,60 @@ test_use_terminal_colors (void)
   return isatty (STDIN_FILENO);
 }
 
+int
+test_write (const char *basedir, const char *name, const char *content)
+{
+  char *path = xasprintf ("%s/%s", basedir, name);
+  FILE *fp = fopen (path, "w");
+  int err = (fp && fputs (content, fp) >= 0) ? 0 : -1;
+
+  if (fp && fclose (fp) == EOF)
+    err = -1;
+  free (path);
+  return err;
+}
+
+int
+test_tree_create (const char *basedir, const struct test_tree_entry *tree,
+		  size_t nentries)
+{
+  for (size_t i = 0; i < nentries; i++)
+    {
+      char *path = xasprintf ("%s/%s", basedir, tree[i].path), *target;
+      int err;
+
+      if (tree[i].target)
+	{
+	  target = xasprintf ("%s/%s", basedir, tree[i].target);
+	  err = link (target, path);
+	  free (target);
+	}
+      else if (tree[i].content)
+	err = test_write (basedir, tree[i].path, tree[i].content);
+      else
+	err = mkdir (path, S_IRWXU);
+
+      free (path);
+      if (err < 0)
+	return -1;
+    }
+
+  return 0;
+}
+
+void
+test_tree_remove (const char *basedir, const struct test_tree_entry *tree,
+		  size_t nentries)
+{
+  for (size_t i = nentries; i-- > 0;)
+    {
+      char *path = xasprintf ("%s/%s", basedir, tree[i].path);
+      (tree[i].content || tree[i].target ? unlink : rmdir) (path);
+      free (path);
+    }
+  rmdir (basedir);
+}
+
 char *
 test_fstringify (const char * filename)
 {
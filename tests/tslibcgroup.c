@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/cgroup.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/cgroup.c"
+# undef NPL_TESTING
+
+/* A synthetic tree, used as both the proc and the sysfs root.
+ * The entries without content are directories.  */
+static const struct test_tree_entry tree[] = {
+  { "self", NULL },
+  { "self/cgroup", "0::/a/b\n" },
+  { "devices", NULL },
+  { "devices/system", NULL },
+  { "devices/system/cpu", NULL },
+  { "devices/system/cpu/online", "0-7\n" },
+  { "fs", NULL },
+  { "fs/cgroup", NULL },
+  { "fs/cgroup/cgroup.controllers", "cpuset cpu io memory pids\n" },
+  { "fs/cgroup/a", NULL },
+  { "fs/cgroup/a/cpu.max", "150000 100000\n" },
+  { "fs/cgroup/a/b", NULL },
+  { "fs/cgroup/a/b/cpu.max", "max 100000\n" },
+  { "fs/cgroup/a/b/cpuset.cpus.effective", "0-1,4-7\n" },
+  { "fs/cgroup/a/b/cpu.stat",
+    "usage_usec 5000000\nuser_usec 3000000\nsystem_usec 2000000\n"
+    "core_sched.force_idle_usec 0\nnr_periods 400\nnr_throttled 25\n"
+    "throttled_usec 1250000\nnr_bursts 0\nburst_usec 0\n" },
+  { "fs/cgroup/a/b/cpu.pressure",
+    "some avg10=1.50 avg60=0.75 avg300=0.25 total=123456\n"
+    "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n" }
+};
+
+static int
+test_cgroup (const void *tdata)
+{
+  char basedir[] = "/tmp/tslibcgroup_XXXXXX", *cgroup;
+  struct cgroup_cpu_capacity capacity;
+  struct cgroup_cpu_stat stat;
+  struct cgroup_cpu_pressure pressure;
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (basedir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  if (test_tree_create (basedir, tree, TEST_TREE_SIZE (tree)) < 0)
+    {
+      test_tree_remove (basedir, tree, TEST_TREE_SIZE (tree));
+      return EXIT_AM_HARDFAIL;
+    }
+  setenv ("NPL_PROC_ROOT", basedir, 1);
+  setenv ("NPL_SYS_ROOT", basedir, 1);
+
+  cgroup = cgroup_path ("/a");
+  TEST_ASSERT_EQUAL_STRING (cgroup, PATH_SYS_CGROUP "/a");
+  free (cgroup);
+
+  cgroup = cgroup_path (NULL);
+  TEST_ASSERT_EQUAL_STRING (cgroup, PATH_SYS_CGROUP "/a/b");
+
+  /* the quota of the parent cgroup, 1.5 CPUs, is the strictest limit */
+  TEST_ASSERT_EQUAL_NUMERIC (cgroup_cpu_capacity (cgroup, &capacity), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (capacity.quota, 1.5);
+  TEST_ASSERT_EQUAL_NUMERIC (capacity.cpuset, 6);
+  TEST_ASSERT_EQUAL_NUMERIC (capacity.online, 8);
+  TEST_ASSERT_EQUAL_NUMERIC (capacity.capacity, 1.5);
+
+  TEST_ASSERT_EQUAL_NUMERIC (cgroup_cpu_stat (cgroup, &stat), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (stat.usage_usec, 5000000);
+  TEST_ASSERT_EQUAL_NUMERIC (stat.user_usec, 3000000);
+  TEST_ASSERT_EQUAL_NUMERIC (stat.system_usec, 2000000);
+  TEST_ASSERT_EQUAL_NUMERIC (stat.nr_periods, 400);
+  TEST_ASSERT_EQUAL_NUMERIC (stat.nr_throttled, 25);
+  TEST_ASSERT_EQUAL_NUMERIC (stat.throttled_usec, 1250000);
+
+  TEST_ASSERT_EQUAL_NUMERIC (cgroup_cpu_pressure (cgroup, &pressure), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (pressure.avg10, 1.5);
+  TEST_ASSERT_EQUAL_NUMERIC (pressure.avg300, 0.25);
+  TEST_ASSERT_EQUAL_NUMERIC (pressure.total, 123456);
+  free (cgroup);
+
+  /* without limits, the capacity is the number of online CPUs */
+  TEST_ASSERT_EQUAL_NUMERIC (cgroup_cpu_capacity (PATH_SYS_CGROUP,
+						  &capacity), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (capacity.quota, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (capacity.capacity, 8);
+  TEST_ASSERT_EQUAL_NUMERIC (cgroup_cpu_stat (PATH_SYS_CGROUP, &stat), -1);
+
+  unsetenv ("NPL_PROC_ROOT");
+  unsetenv ("NPL_SYS_ROOT");
+  test_tree_remove (basedir, tree, TEST_TREE_SIZE (tree));
+
+  /* no unified hierarchy */
+  setenv ("NPL_SYS_ROOT", basedir, 1);
+  cgroup = cgroup_path (NULL);
+  TEST_ASSERT_EQUAL_NUMERIC (cgroup == NULL, 1);
+  unsetenv ("NPL_SYS_ROOT");
+
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the cgroup v2 cpu controller", test_cgroup, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/conntrack.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/conntrack.c"
+# undef NPL_TESTING
+
+/* two CPUs, the column entries being the same for all of them */
+static const char *nf_conntrack_stat =
+  "entries  clashres found new invalid ignore delete chainlength insert "
+  "insert_failed drop early_drop icmp_error  expect_new expect_create "
+  "expect_delete search_restart\n"
+  "00000123  00000000 00000000 00000000 00000005 00000000 00000000 "
+  "00000000 00000000 00000002 0000000a 00000001 00000000  00000000 "
+  "00000000 00000000 00000010\n"
+  "00000123  00000000 00000000 00000000 00000005 00000000 00000000 "
+  "00000000 00000000 00000003 00000001 00000000 00000000  00000000 "
+  "00000000 00000000 00000001\n";
+
+/* before Linux 4.10, without search_restart */
+static const char *nf_conntrack_stat_old =
+  "entries  searched found new invalid ignore delete delete_list insert "
+  "insert_failed drop early_drop icmp_error  expect_new expect_create "
+  "expect_delete\n"
+  "00000010  00000000 00000000 00000000 00000000 00000000 00000000 "
+  "00000000 00000000 00000000 00000007 00000000 00000000  00000000 "
+  "00000000 00000000\n";
+
+/* A fake proc filesystem.  The entries without content are directories. */
+static const struct test_tree_entry tree[] = {
+  { "sys", NULL },
+  { "sys/net", NULL },
+  { "sys/net/netfilter", NULL },
+  { "sys/net/netfilter/nf_conntrack_count", "291\n" },
+  { "sys/net/netfilter/nf_conntrack_max", "262144\n" },
+  { "net", NULL },
+  { "net/stat", NULL },
+  { "net/stat/nf_conntrack", "" }	/* written by the test */
+};
+
+static int
+test_conntrack_proc (const void *tdata)
+{
+  char dir[] = "/tmp/tslibconntrack_XXXXXX";
+  unsigned long long count = 0, max = 0, counters[CONNTRACK_COUNTERS];
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  if (test_tree_create (dir, tree, TEST_TREE_SIZE (tree)) < 0
+      || test_write (dir, "net/stat/nf_conntrack", nf_conntrack_stat) < 0)
+    {
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return EXIT_AM_HARDFAIL;
+    }
+  setenv ("NPL_PROC_ROOT", dir, 1);
+
+  TEST_ASSERT_EQUAL_NUMERIC (conntrack_usage (&count, &max), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (count, 291);
+  TEST_ASSERT_EQUAL_NUMERIC (max, 262144);
+
+  TEST_ASSERT_EQUAL_NUMERIC (conntrack_stat_read (counters), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[CONNTRACK_INSERT_FAILED], 5);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[CONNTRACK_DROP], 11);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[CONNTRACK_EARLY_DROP], 1);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[CONNTRACK_SEARCH_RESTART], 17);
+
+  if (test_write (dir, "net/stat/nf_conntrack", nf_conntrack_stat_old) < 0)
+    ret = -1;
+  TEST_ASSERT_EQUAL_NUMERIC (conntrack_stat_read (counters), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[CONNTRACK_DROP], 7);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[CONNTRACK_SEARCH_RESTART], 0);
+
+  unsetenv ("NPL_PROC_ROOT");
+  test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+  return ret;
+}
+
+static int
+test_conntrack_names (const void *tdata)
+{
+  int ret = 0;
+  (void) tdata;
+
+  TEST_ASSERT_EQUAL_STRING (conntrack_counter_name (CONNTRACK_EARLY_DROP),
+			    "early_drop");
+  TEST_ASSERT_EQUAL_STRING (conntrack_proto_name (CONNTRACK_PROTO_ICMPV6),
+			    "icmpv6");
+  TEST_ASSERT_EQUAL_STRING (conntrack_tcp_state_name (3), "established");
+  TEST_ASSERT_EQUAL_NUMERIC (
+    conntrack_tcp_state_name (CONNTRACK_TCP_STATES) == NULL, 1);
+
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the conntrack table usage and counters",
+		test_conntrack_proc, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the conntrack names", test_conntrack_names,
+		NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -20,6 +20,10 @@
  *
  */
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
 #include <stdlib.h>
 
 #include "container_docker.h"
@@ -31,6 +35,7 @@ static int docker_get (chunk_t * chunk, const int query);
 static void docker_close (chunk_t * chunk);
 
 #include "../lib/container_docker_count.c"
+#include "../lib/metrics.c"
 
 static int
 docker_get (chunk_t * chunk, const int query)
@@ -75,20 +80,28 @@ test_docker_running_containers (const void *tdata)
 {
   const struct test_data *data = tdata;
   int err, ret = 0;
-  char * perfdata = NULL;
+  struct metrics *metrics = metrics_new ("docker", 0);
+  struct buffer buf;
+  char *perfdata;
   unsigned int containers;
 
-  err = docker_running_containers (&containers, data->image, &perfdata, false);
+  err = docker_running_containers (&containers, data->image, metrics, false);
   if (err != 0)
     {
-      free (perfdata);
+      metrics_free (metrics);
       return err;
     }
 
+  metrics_render (metrics, &buf, STATE_OK, "docker");
+  metrics_free (metrics);
+  /* strip the status line and the trailing newline */
+  perfdata = buf.data + strlen ("docker | ");
+  buf.data[buf.len - 1] = '\0';
+
   TEST_ASSERT_EQUAL_NUMERIC (containers, data->expect_value);
   TEST_ASSERT_EQUAL_STRING (perfdata, data->perfdata);
 
-  free (perfdata);
+  free (buf.data);
   return ret;
 }
 
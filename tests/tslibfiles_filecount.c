@@ -91,6 +91,43 @@ test_files_filecount (const void *tdata)
   return ret;
 }
 
+/* The errors in the subdirectories, that need a user without the
+   capability of bypassing the file permissions */
+
+static int
+test_files_filecount_errors (const void *tdata)
+{
+  const char *basedir = tdata;
+  char *subdir = xasprintf ("%s/a/b", basedir);
+  struct files_types *filecount = NULL;
+  int ret = 0, err;
+
+  if (geteuid () == 0)
+    {
+      free (subdir);
+      return EXIT_AM_SKIP;
+    }
+
+  /* a/b can be read but not searched: the files cannot be stat'ed */
+  chmod (subdir, S_IRUSR | S_IWUSR);
+  err = files_filecount (basedir, FILES_RECURSIVE, 0, 0, NULL, &filecount);
+  TEST_ASSERT_EQUAL_NUMERIC (err, FILES_ERROR_LSTAT);
+
+  /* a/b cannot be opened and is skipped */
+  chmod (subdir, 0);
+  free (filecount);
+  filecount = NULL;
+  err = files_filecount (basedir, FILES_RECURSIVE, 0, 0, NULL, &filecount);
+  TEST_ASSERT_EQUAL_NUMERIC (err, 0);
+  if (filecount)
+    TEST_ASSERT_EQUAL_NUMERIC (filecount->total, 13);
+
+  chmod (subdir, S_IRWXU);
+  free (filecount);
+  free (subdir);
+  return ret;
+}
+
 static int
 test_create_tree (char **basedir)
 {
@@ -221,6 +258,10 @@ mymain (void)
 	   FILES_RECURSIVE | FILES_INCLUDE_HIDDEN | FILES_IGNORE_SYMLINKS,
 	   0, 0, NULL, 17);
 
+  if (test_run ("check function files_filecount (errors)",
+		test_files_filecount_errors, basedir) < 0)
+    ret = -1;
+
   return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/fsstats.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/fsstats.c"
+# undef NPL_TESTING
+
+/* The global XFS statistics, with a line having less columns than usual */
+static const char *xfs_global =
+  "extent_alloc 4 32 5 40\n"
+  "log 900 1800 20 300 12\n"
+  "push_ail 1000 7 3 2 1 0 0 0 0 0\n"
+  "xstrat 2 0\n"
+  "buf 8000 5\n"
+  "xpc 0 0 0\n";
+
+/* A fake proc and sys filesystem sharing the same root.  The entries
+   without content are directories.  */
+static const struct test_tree_entry tree[] = {
+  { "fs", NULL },
+  { "fs/xfs", NULL },
+  { "fs/xfs/sda1", NULL },
+  { "fs/xfs/sda1/stats", NULL },
+  { "fs/xfs/sda1/stats/stats",
+    "log 500 1000 10 200 4\n"
+    "push_ail 600 3 1 1 0 0 0 0 0 0\n"
+    "buf 7000 6900 2 0 0 100 0 0 0\n" },
+  { "fs/ext4", NULL },
+  { "fs/ext4/sdb1", NULL },
+  { "fs/ext4/sdb1/errors_count", "2\n" },
+  { "fs/ext4/sdb1/lifetime_write_kbytes", "123456\n" },
+  { "fs/xfs/stat", "" }		/* written by the test */
+};
+
+static int
+test_fsstats_read (const void *tdata)
+{
+  char dir[] = "/tmp/tslibfsstats_XXXXXX";
+  unsigned long long counters[FSSTATS_COUNTERS];
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  if (test_tree_create (dir, tree, TEST_TREE_SIZE (tree)) < 0
+      || test_write (dir, "fs/xfs/stat", xfs_global) < 0)
+    {
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return EXIT_AM_HARDFAIL;
+    }
+  setenv ("NPL_PROC_ROOT", dir, 1);
+  setenv ("NPL_SYS_ROOT", dir, 1);
+
+  TEST_ASSERT_EQUAL_NUMERIC (fsstats_xfs_read ("sda1", counters), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_LOG_WRITES], 500);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_LOG_FORCES], 200);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_LOG_FORCE_SLEEPS], 4);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_LOGSPACE_SLEEPS], 3);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_BUF_GETS], 7000);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_BUF_MISSES], 100);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_ERRORS], 0);
+
+  TEST_ASSERT_EQUAL_NUMERIC (fsstats_xfs_read (NULL, counters), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_LOG_FORCES], 300);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_LOGSPACE_SLEEPS], 7);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_BUF_GETS], 8000);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_BUF_MISSES], 0);
+
+  TEST_ASSERT_EQUAL_NUMERIC (fsstats_ext4_read ("sdb1", counters), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_ERRORS], 2);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_WRITE_KBYTES], 123456);
+  TEST_ASSERT_EQUAL_NUMERIC (counters[FSSTATS_LOG_FORCES], 0);
+
+  TEST_ASSERT_EQUAL_NUMERIC (fsstats_xfs_read ("sdb1", counters), -1);
+  TEST_ASSERT_EQUAL_NUMERIC (fsstats_ext4_read ("sda1", counters), -1);
+
+  unsetenv ("NPL_PROC_ROOT");
+  unsetenv ("NPL_SYS_ROOT");
+  test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+  return ret;
+}
+
+static int
+test_fsstats_names (const void *tdata)
+{
+  char name[16];
+  int ret = 0;
+  (void) tdata;
+
+  TEST_ASSERT_EQUAL_STRING (fsstats_counter_name (FSSTATS_BUF_MISSES),
+			    "buf_misses");
+  TEST_ASSERT_EQUAL_NUMERIC (fsstats_counter_name (FSSTATS_COUNTERS) == NULL,
+			     1);
+  TEST_ASSERT_EQUAL_STRING (fsstats_devname ("/nonexistent/vg0-data", name,
+					     sizeof name), "vg0-data");
+  TEST_ASSERT_EQUAL_STRING (fsstats_devname ("sdc", name, sizeof name),
+			    "sdc");
+
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the parsing of the XFS and ext4 statistics",
+		test_fsstats_read, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the fsstats names", test_fsstats_names, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/histogram.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/histogram.c"
+# undef NPL_TESTING
+
+static int
+test_histogram_buckets (const void *tdata)
+{
+  int ret = 0;
+  (void) tdata;
+
+  /* the small values have a bucket each */
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_bucket (0), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_bucket (15), 15);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_bucket (16), 16);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_bucket (17), 16);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_bucket (18), 17);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_bucket (~0ULL), HISTOGRAM_BUCKETS - 1);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_bucket_value (16), 16);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_bucket_value (histogram_bucket (1000)),
+			     991);
+
+  return ret;
+}
+
+static int
+test_histogram_quantile (const void *tdata)
+{
+  struct histogram *h = calloc (1, sizeof (struct histogram));
+  unsigned long long p50, p99;
+  int ret = 0;
+  (void) tdata;
+
+  if (NULL == h)
+    return EXIT_AM_HARDFAIL;
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_quantile (h, 0.5), 0);
+
+  for (unsigned long long v = 1; v <= 10000; v++)
+    histogram_add (h, v);
+  p50 = histogram_quantile (h, 0.50);
+  p99 = histogram_quantile (h, 0.99);
+
+  /* the error is lower than 1/16 of the value */
+  TEST_ASSERT_EQUAL_NUMERIC (p50 > 5000 - 5000 / 16 && p50 < 5000 + 5000 / 16,
+			     1);
+  TEST_ASSERT_EQUAL_NUMERIC (p99 > 9900 - 9900 / 16 && p99 <= 10000, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_quantile (h, 1), 10000);
+  TEST_ASSERT_EQUAL_NUMERIC (histogram_quantile (h, 0), 1);
+  TEST_ASSERT_EQUAL_NUMERIC (h->n, 10000);
+
+  free (h);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the histogram buckets", test_histogram_buckets,
+		NULL) < 0)
+    ret = -1;
+  if (test_run ("check the histogram quantiles", test_histogram_quantile,
+		NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
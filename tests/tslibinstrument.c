@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/instrument.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/instrument.c"
+# undef NPL_TESTING
+
+#define TEST_FILE  NPL_TEST_PATH_PODMAN_LISTCONTAINERS_JSON
+
+static int
+test_instrument_fopen (const void *tdata)
+{
+  char *expected, *buf;
+  size_t size, nread;
+  FILE *fp;
+  int ret = 0;
+  (void) tdata;
+
+  if ((expected = test_fstringify (TEST_FILE)) == NULL)
+    return EXIT_AM_HARDFAIL;
+  size = strlen (expected);
+
+  instr.files = instr.syscalls = instr.bytes = 0;
+  if ((fp = instrument_fopen (TEST_FILE)) == NULL)
+    {
+      free (expected);
+      return -1;
+    }
+
+  buf = xmalloc (size + 1);
+  nread = fread (buf, 1, size + 1, fp);
+  fclose (fp);
+
+  TEST_ASSERT_EQUAL_NUMERIC (nread, size);
+  if (memcmp (buf, expected, size))
+    ret = -1;
+  TEST_ASSERT_EQUAL_NUMERIC (instr.files, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (instr.bytes, size);
+  /* open + at least one read + the final read returning 0 + close */
+  if (instr.syscalls < 4)
+    ret = -1;
+
+  free (buf);
+  free (expected);
+  return ret;
+}
+
+static int
+test_instrument_phases (const void *tdata)
+{
+  unsigned int i;
+  int ret = 0;
+  (void) tdata;
+
+  memset (instr.phase_ns, 0, sizeof instr.phase_ns);
+  instr.depth = 0;
+
+  instrument_phase_push (NPL_PHASE_PARSE);
+  TEST_ASSERT_EQUAL_NUMERIC (instrument_current_phase (), NPL_PHASE_PARSE);
+  instrument_phase_push (NPL_PHASE_READ);
+  TEST_ASSERT_EQUAL_NUMERIC (instrument_current_phase (), NPL_PHASE_READ);
+  instrument_phase_pop ();
+  TEST_ASSERT_EQUAL_NUMERIC (instrument_current_phase (), NPL_PHASE_PARSE);
+  instrument_phase_pop ();
+  TEST_ASSERT_EQUAL_NUMERIC (instrument_current_phase (), NPL_PHASE_COMPUTE);
+
+  /* an unbalanced pop must be ignored */
+  instrument_phase_pop ();
+  TEST_ASSERT_EQUAL_NUMERIC (instr.depth, 0);
+
+  /* nesting deeper than the stack size */
+  for (i = 0; i < INSTRUMENT_MAX_DEPTH + 4; i++)
+    instrument_phase_push (i % 2 ? NPL_PHASE_OPEN : NPL_PHASE_PARSE);
+  for (i = 0; i < INSTRUMENT_MAX_DEPTH + 4; i++)
+    instrument_phase_pop ();
+  TEST_ASSERT_EQUAL_NUMERIC (instr.depth, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (instrument_current_phase (), NPL_PHASE_COMPUTE);
+
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  /* enable the instrumentation without registering the exit handler */
+  mode = INSTRUMENT_DEBUG;
+  instr.start_ns = instr.mark_ns = instrument_now_ns ();
+
+  if (test_run ("check instrument_fopen", test_instrument_fopen, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the phases stack", test_instrument_phases, NULL) < 0)
+    ret = -1;
+
+  mode = INSTRUMENT_OFF;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/interrupts.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/interrupts.c"
+# undef NPL_TESTING
+
+/* cpu1 is offline */
+static const char interrupts[] =
+  "           CPU0       CPU2       CPU3       \n"
+  "  0:         46          0          0   IO-APIC    2-edge      timer\n"
+  " 24:       1200         15          0   IR-PCI-MSI 327680-edge      "
+  "xhci_hcd\n"
+  "NMI:          3          1          2   Non-maskable interrupts\n"
+  "LOC:     987654       1000        250   Local timer interrupts\n"
+  "ERR:          0\n";
+
+static const char softirqs[] =
+  "                    CPU0       CPU2       CPU3       \n"
+  "          HI:          1          0          0\n"
+  "       TIMER:      55000         12          7\n";
+
+/* A fake proc filesystem */
+static const struct test_tree_entry tree[] = {
+  { "interrupts", interrupts },
+  { "softirqs", softirqs }
+};
+
+static int
+test_irq_table (const void *tdata)
+{
+  char dir[] = "/tmp/tslibinterrupts_XXXXXX";
+  struct irq_table *table;
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  if (test_tree_create (dir, tree, TEST_TREE_SIZE (tree)) < 0)
+    {
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return EXIT_AM_HARDFAIL;
+    }
+  setenv ("NPL_PROC_ROOT", dir, 1);
+
+  table = proc_interrupts_read ();
+  TEST_ASSERT_EQUAL_NUMERIC (table != NULL, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (table->ncpus, 3);
+  TEST_ASSERT_EQUAL_NUMERIC (table->nrows, 5);
+  TEST_ASSERT_EQUAL_NUMERIC (irq_table_column (table, 1), -1);
+  TEST_ASSERT_EQUAL_NUMERIC (irq_table_column (table, 3), 2);
+  TEST_ASSERT_EQUAL_STRING (table->row[0].device, "timer");
+  TEST_ASSERT_EQUAL_STRING (table->row[1].name, "24");
+  TEST_ASSERT_EQUAL_STRING (table->row[1].device, "xhci_hcd");
+  TEST_ASSERT_EQUAL_NUMERIC (table->row[1].count[1], 15);
+  TEST_ASSERT_EQUAL_STRING (table->row[3].name, "LOC");
+  TEST_ASSERT_EQUAL_NUMERIC (table->row[3].device == NULL, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (table->row[3].count[2], 250);
+  TEST_ASSERT_EQUAL_NUMERIC (table->row[4].count[1], 0);
+  irq_table_free (table);
+
+  table = proc_softirqs_read ();
+  TEST_ASSERT_EQUAL_NUMERIC (table != NULL, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (table->nrows, 2);
+  TEST_ASSERT_EQUAL_STRING (table->row[1].name, "TIMER");
+  TEST_ASSERT_EQUAL_NUMERIC (table->row[1].count[2], 7);
+  irq_table_free (table);
+
+  unsetenv ("NPL_PROC_ROOT");
+  test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the parsing of /proc/interrupts and /proc/softirqs",
+		test_irq_table, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/lazylib.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/utsname.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/lazylib.c"
+# undef NPL_TESTING
+
+/* A table of function pointers, loaded as the ones of libcurl and
+   libvarlink, from the library overriding uname() in the tests */
+static struct
+{
+  __typeof__ (uname) *uname;
+} uname_api;
+
+static int
+test_lazylib_sym (const void *tdata)
+{
+  static const char *const sonames[] = {
+    abs_builddir "/.libs/nonexistent.so",
+    abs_builddir "/.libs/tslibuname.so",
+    NULL
+  };
+  struct utsname name;
+  void *handle;
+  int ret = 0;
+  (void) tdata;
+
+  /* the first library that can be loaded is opened */
+  handle = lazylib_open (sonames);
+  LAZYLIB_SYM (handle, uname_api, uname, "uname");
+
+  memset (&name, 0, sizeof name);
+  TEST_ASSERT_EQUAL_NUMERIC (uname_api.uname (&name), 0);
+  TEST_ASSERT_EQUAL_STRING (name.release, TEST_KERNEL_VERSION);
+
+  dlclose (handle);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the run time loading of a library",
+		test_lazylib_sym, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
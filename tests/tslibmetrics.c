@@ -0,0 +1,159 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/metrics.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/metrics.c"
+# undef NPL_TESTING
+
+typedef struct test_data
+{
+  const char *format;
+  const char *expect_value;
+} test_data;
+
+static struct metrics *
+test_metrics_new (const char *format)
+{
+  struct metrics *metrics;
+  struct metric metric = {
+    .name = "rxbyte/s", .label = "ifname", .label_value = "eth0"
+  };
+
+  if (setenv (NPL_OUTPUT_ENV, format, 1) < 0)
+    return NULL;
+  /* a single sample, so that the buffers are grown */
+  metrics = metrics_new ("network", 1);
+  unsetenv (NPL_OUTPUT_ENV);
+
+  metrics_add (metrics, &metric, 1024);
+  metric.name = "txbyte/s";
+  metric.min = "0";
+  metric.max = "125000000";
+  metrics_add (metrics, &metric, 2048);
+
+  metric.label_value = "wlan\"0";
+  metric.min = metric.max = NULL;
+  metrics_add (metrics, &metric, 10);
+  metric.name = "rxbyte/s";
+  metric.unit = "%";
+  metric.precision = 2;
+  metrics_add (metrics, &metric, 12.345);
+
+  /* a sample with its own perfdata label */
+  metric.name = "containers";
+  metric.label = "image";
+  metric.label_value = "nginx";
+  metric.unit = NULL;
+  metric.precision = 0;
+  metric.perfdata_label = "containers_nginx";
+  metrics_add (metrics, &metric, 3);
+
+  return metrics;
+}
+
+static int
+test_metrics_render (const void *tdata)
+{
+  const struct test_data *data = tdata;
+  struct metrics *metrics;
+  struct buffer buf;
+  int ret = 0;
+
+  if ((metrics = test_metrics_new (data->format)) == NULL)
+    return EXIT_AM_HARDFAIL;
+
+  metrics_render (metrics, &buf, STATE_WARNING, "network WARNING - test");
+  TEST_ASSERT_EQUAL_STRING (buf.data, data->expect_value);
+  TEST_ASSERT_EQUAL_NUMERIC (buf.len, strlen (data->expect_value));
+
+  free (buf.data);
+  metrics_free (metrics);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+#define DO_TEST(FORMAT, EXPECT_VALUE)                                 \
+  do                                                                  \
+    {                                                                 \
+      test_data data = {                                              \
+	.format = FORMAT,                                             \
+	.expect_value = EXPECT_VALUE                                  \
+      };                                                              \
+      if (test_run ("check metrics_render (" FORMAT ")",              \
+		    test_metrics_render, (&data)) < 0)                \
+	ret = -1;                                                     \
+    }                                                                 \
+  while (0)
+
+  DO_TEST ("perfdata",
+	   "network WARNING - test |"
+	   " eth0_rxbyte/s=1024"
+	   " eth0_txbyte/s=2048;;;0;125000000"
+	   " wlan\"0_txbyte/s=10"
+	   " wlan\"0_rxbyte/s=12.35%"
+	   " containers_nginx=3\n");
+  DO_TEST ("openmetrics",
+	   "# TYPE npl_network_status gauge\n"
+	   "npl_network_status{state=\"WARNING\"} 1\n"
+	   "# TYPE npl_network_rxbyte_per_second gauge\n"
+	   "npl_network_rxbyte_per_second{ifname=\"eth0\"} 1024\n"
+	   "# TYPE npl_network_txbyte_per_second gauge\n"
+	   "npl_network_txbyte_per_second{ifname=\"eth0\"} 2048\n"
+	   "npl_network_txbyte_per_second{ifname=\"wlan\\\"0\"} 10\n"
+	   "# TYPE npl_network_rxbyte_percent_per_second gauge\n"
+	   "npl_network_rxbyte_percent_per_second{ifname=\"wlan\\\"0\"} 12.35\n"
+	   "# TYPE npl_network_containers gauge\n"
+	   "npl_network_containers{image=\"nginx\"} 3\n"
+	   "# EOF\n");
+  DO_TEST ("json",
+	   "{\"plugin\":\"network\",\"status\":\"WARNING\",\"code\":1,"
+	   "\"message\":\"network WARNING - test\"}\n"
+	   "{\"plugin\":\"network\",\"metric\":\"rxbyte/s\","
+	   "\"labels\":{\"ifname\":\"eth0\"},\"value\":1024}\n"
+	   "{\"plugin\":\"network\",\"metric\":\"txbyte/s\","
+	   "\"labels\":{\"ifname\":\"eth0\"},\"value\":2048,"
+	   "\"min\":\"0\",\"max\":\"125000000\"}\n"
+	   "{\"plugin\":\"network\",\"metric\":\"txbyte/s\","
+	   "\"labels\":{\"ifname\":\"wlan\\\"0\"},\"value\":10}\n"
+	   "{\"plugin\":\"network\",\"metric\":\"rxbyte/s\","
+	   "\"labels\":{\"ifname\":\"wlan\\\"0\"},\"value\":12.35,"
+	   "\"unit\":\"%\"}\n"
+	   "{\"plugin\":\"network\",\"metric\":\"containers\","
+	   "\"labels\":{\"image\":\"nginx\"},\"value\":3}\n");
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
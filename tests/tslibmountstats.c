@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/mountstats.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+#include "xalloc.h"
+
+# define NPL_TESTING
+#  include "../lib/mountstats.c"
+# undef NPL_TESTING
+
+/* An ext4 mount, a NFSv4 mount on a directory with a space in its name,
+   the statistics of READ without the errors (before Linux 5.4), and a
+   NFSv3 mount with the statistics of LOOKUP only.  */
+static const char *mountstats =
+  "device /dev/sda1 mounted on / with fstype ext4\n"
+  "device srv1:/export mounted on /mnt/my\\040data with fstype nfs4 "
+  "statvers=1.1\n"
+  "\topts:\trw,vers=4.2,rsize=1048576,wsize=1048576\n"
+  "\tage:\t3600\n"
+  "\tevents:\t1 2 3 4 5 6 7 8 9 10\n"
+  "\tbytes:\t1 2 3 4 5 6 7 8\n"
+  "\tRPC iostats version: 1.1  p/v: 100003/4 (nfs)\n"
+  "\txprt:\ttcp 0 1 2 0 0 100 100 0 100 0 2 0 0\n"
+  "\tper-op statistics\n"
+  "\t        NULL: 1 1 0 44 24 0 0 0 0\n"
+  "\t        READ: 100 103 1 16000 2000000 50 400 470\n"
+  "\t       WRITE: 20 20 0 2000000 3200 10 100 115 0\n"
+  "\t     GETATTR: 500 500 0 90000 120000 5 250 260 2\n"
+  "\t      LOOKUP: 40 40 0 8000 9000 2 60 64 4\n"
+  "\t READDIRPLUS: 7 7 0 1000 9000 0 20 21 0\n"
+  "\n"
+  "device proc mounted on /proc with fstype proc\n"
+  "device srv2:/home mounted on /home with fstype nfs statvers=1.1\n"
+  "\tRPC iostats version: 1.1  p/v: 100003/3 (nfs)\n"
+  "\tper-op statistics\n"
+  "\t      LOOKUP: 10 12 2 800 900 30 1000 1040 0\n";
+
+/* A fake proc filesystem.  The entries without content are directories. */
+static const struct test_tree_entry tree[] = {
+  { "self", NULL },
+  { "self/mountstats", "" }		/* written by the test */
+};
+
+/* The mounts reported by mountstats_read(), the strings being copied */
+struct test_mounts
+{
+  size_t nmounts;
+  char *mountdir[4];
+  char *devname[4];
+  char *fstype[4];
+  struct mountstats ms[4];
+};
+
+static void
+test_mounts_add (const struct mountstats *ms, void *data)
+{
+  struct test_mounts *mounts = data;
+  size_t n = mounts->nmounts++;
+
+  if (n >= 4)
+    return;
+  mounts->mountdir[n] = xstrdup (ms->mountdir);
+  mounts->devname[n] = xstrdup (ms->devname);
+  mounts->fstype[n] = xstrdup (ms->fstype);
+  mounts->ms[n] = *ms;
+}
+
+static int
+test_mountstats_read (const void *tdata)
+{
+  char dir[] = "/tmp/tslibmountstats_XXXXXX";
+  struct test_mounts mounts = { 0 };
+  const unsigned long long *op;
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  if (test_tree_create (dir, tree, TEST_TREE_SIZE (tree)) < 0
+      || test_write (dir, "self/mountstats", mountstats) < 0)
+    {
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return EXIT_AM_HARDFAIL;
+    }
+  setenv ("NPL_PROC_ROOT", dir, 1);
+
+  TEST_ASSERT_EQUAL_NUMERIC (mountstats_read (test_mounts_add, &mounts), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (mounts.nmounts, 2);
+  if (mounts.nmounts != 2)
+    {
+      unsetenv ("NPL_PROC_ROOT");
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return -1;
+    }
+
+  TEST_ASSERT_EQUAL_STRING (mounts.devname[0], "srv1:/export");
+  TEST_ASSERT_EQUAL_STRING (mounts.mountdir[0], "/mnt/my data");
+  TEST_ASSERT_EQUAL_STRING (mounts.fstype[0], "nfs4");
+
+  op = mounts.ms[0].counter[MOUNTSTATS_OP_READ];
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_CALLS], 100);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_RETRANS], 3);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_TIMEOUTS], 1);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_QUEUE_MS], 50);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_RTT_MS], 400);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_EXECUTE_MS], 470);
+  op = mounts.ms[0].counter[MOUNTSTATS_OP_GETATTR];
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_CALLS], 500);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_RETRANS], 0);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_EXECUTE_MS], 260);
+
+  TEST_ASSERT_EQUAL_STRING (mounts.mountdir[1], "/home");
+  TEST_ASSERT_EQUAL_STRING (mounts.fstype[1], "nfs");
+  op = mounts.ms[1].counter[MOUNTSTATS_OP_LOOKUP];
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_CALLS], 10);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_RETRANS], 2);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_TIMEOUTS], 2);
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_RTT_MS], 1000);
+  op = mounts.ms[1].counter[MOUNTSTATS_OP_READ];
+  TEST_ASSERT_EQUAL_NUMERIC (op[MOUNTSTATS_CALLS], 0);
+
+  for (size_t i = 0; i < mounts.nmounts; i++)
+    {
+      free (mounts.mountdir[i]);
+      free (mounts.devname[i]);
+      free (mounts.fstype[i]);
+    }
+  unsetenv ("NPL_PROC_ROOT");
+  test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+  return ret;
+}
+
+static int
+test_mountstats_names (const void *tdata)
+{
+  int ret = 0;
+  (void) tdata;
+
+  TEST_ASSERT_EQUAL_STRING (mountstats_op_name (MOUNTSTATS_OP_GETATTR),
+			    "GETATTR");
+  TEST_ASSERT_EQUAL_STRING (mountstats_counter_name (MOUNTSTATS_RTT_MS),
+			    "rtt");
+  TEST_ASSERT_EQUAL_NUMERIC (mountstats_op_name (MOUNTSTATS_OPS) == NULL, 1);
+
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the parsing of /proc/self/mountstats",
+		test_mountstats_read, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the mountstats names", test_mountstats_names,
+		NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/netinfo-private.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/netinfo-private.c"
+#  include "../lib/netinfo.c"
+# undef NPL_TESTING
+
+#define TEST_MSG_SIZE  512
+
+/* Append the attribute TYPE with LEN bytes of DATA to the message H.  */
+
+static struct rtattr *
+test_addattr (struct nlmsghdr *h, unsigned short type, const void *data,
+	      size_t len)
+{
+  struct rtattr *rta =
+    (struct rtattr *) ((char *) h + NLMSG_ALIGN (h->nlmsg_len));
+
+  rta->rta_type = type;
+  rta->rta_len = RTA_LENGTH (len);
+  if (data)
+    memcpy (RTA_DATA (rta), data, len);
+  h->nlmsg_len = NLMSG_ALIGN (h->nlmsg_len) + RTA_ALIGN (rta->rta_len);
+  return rta;
+}
+
+static struct nlmsghdr *
+test_qdisc_msg (char *buf, int ifindex, uint32_t parent, const char *kind)
+{
+  struct nlmsghdr *h = (struct nlmsghdr *) buf;
+  struct tcmsg *tcm = NLMSG_DATA (h);
+
+  memset (buf, 0, TEST_MSG_SIZE);
+  h->nlmsg_len = NLMSG_LENGTH (sizeof (struct tcmsg));
+  h->nlmsg_type = RTM_NEWQDISC;
+  tcm->tcm_ifindex = ifindex;
+  tcm->tcm_parent = parent;
+  tcm->tcm_handle = 0x80000000;
+  test_addattr (h, TCA_KIND, kind, strlen (kind) + 1);
+
+  return h;
+}
+
+static int
+test_qdisc_dump_add (const void *tdata)
+{
+  char buf[TEST_MSG_SIZE] __attribute__ ((aligned (NLMSG_ALIGNTO)));
+  struct qdisc_dump dump = { NULL, 0 };
+  struct gnet_stats_basic basic = { .bytes = 123456, .packets = 789 };
+  struct gnet_stats_queue queue = {
+    .qlen = 3, .backlog = 4500, .drops = 17, .requeues = 2, .overlimits = 5
+  };
+  struct tc_stats stats = {
+    .bytes = 1000, .packets = 10, .drops = 1, .overlimits = 4, .qlen = 2,
+    .backlog = 3000
+  };
+  struct nlmsghdr *h;
+  struct rtattr *nest;
+  int ret = 0;
+  (void) tdata;
+
+  /* a root qdisc with the nested TCA_STATS2 statistics */
+  h = test_qdisc_msg (buf, 2, TC_H_ROOT, "fq_codel");
+  nest = test_addattr (h, TCA_STATS2, NULL, 0);
+  test_addattr (h, TCA_STATS_BASIC, &basic, sizeof (basic));
+  test_addattr (h, TCA_STATS_QUEUE, &queue, sizeof (queue));
+  nest->rta_len = (char *) h + h->nlmsg_len - (char *) nest;
+  qdisc_dump_add (h, &dump);
+
+  /* a child qdisc, to be ignored */
+  h = test_qdisc_msg (buf, 2, TC_H_MAKE (0x80000000, 1), "fq_codel");
+  test_addattr (h, TCA_STATS, &stats, sizeof (stats));
+  qdisc_dump_add (h, &dump);
+
+  /* a root qdisc with the old TCA_STATS statistics only */
+  h = test_qdisc_msg (buf, 3, TC_H_ROOT, "pfifo_fast");
+  test_addattr (h, TCA_STATS, &stats, sizeof (stats));
+  qdisc_dump_add (h, &dump);
+
+  TEST_ASSERT_EQUAL_NUMERIC (dump.nqdiscs, 2);
+  if (dump.nqdiscs == 2)
+    {
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[0].ifindex, 2);
+      TEST_ASSERT_EQUAL_STRING (dump.qdiscs[0].kind, "fq_codel");
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[0].counter[QDISC_BYTES],
+				 123456);
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[0].counter[QDISC_PACKETS], 789);
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[0].counter[QDISC_DROPS], 17);
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[0].counter[QDISC_OVERLIMITS], 5);
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[0].counter[QDISC_REQUEUES], 2);
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[0].backlog, 4500);
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[0].qlen, 3);
+
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[1].ifindex, 3);
+      TEST_ASSERT_EQUAL_STRING (dump.qdiscs[1].kind, "pfifo_fast");
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[1].counter[QDISC_PACKETS], 10);
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[1].counter[QDISC_DROPS], 1);
+      TEST_ASSERT_EQUAL_NUMERIC (dump.qdiscs[1].backlog, 3000);
+    }
+
+  TEST_ASSERT_EQUAL_STRING (qdisc_counter_name (QDISC_OVERLIMITS),
+			    "overlimits");
+  TEST_ASSERT_EQUAL_NUMERIC (qdisc_counter_name (QDISC_COUNTERS) == NULL, 1);
+
+  free (dump.qdiscs);
+  return ret;
+}
+
+/* Prepend to LIST an interface that received RX_BYTES bytes */
+
+static struct iflist *
+test_iflist_add (struct iflist *list, const char *ifname, int ifindex,
+		 unsigned int rx_bytes)
+{
+  struct iflist *ifl = xmalloc (sizeof (struct iflist));
+
+  ifl->ifname = xstrdup (ifname);
+  ifl->ifindex = ifindex;
+  ifl->flags = IFF_UP | IFF_RUNNING;
+  ifl->speed = 0;
+  ifl->stats = xmalloc (sizeof (struct ifstats));
+  ifl->stats->rx_bytes = rx_bytes;
+  ifl->next = list;
+  return ifl;
+}
+
+static int
+test_netinfo_rates (const void *tdata)
+{
+  struct iflist *first = NULL, *second = NULL;
+  unsigned int ninterfaces;
+  int ret = 0;
+  (void) tdata;
+
+  /* veth1 is recreated, veth2 removed, and veth3 added between the two
+     snapshots, that also list lo and eth0 in a different order */
+  first = test_iflist_add (first, "veth2", 6, 100);
+  first = test_iflist_add (first, "veth1", 5, 100);
+  first = test_iflist_add (first, "eth0", 2, 1000);
+  first = test_iflist_add (first, "lo", 1, 500);
+  second = test_iflist_add (second, "veth3", 8, 0);
+  second = test_iflist_add (second, "lo", 1, 700);
+  second = test_iflist_add (second, "eth0", 2, 3000);
+  second = test_iflist_add (second, "veth1", 7, 0);
+
+  netinfo_rates (&first, second, 2, 0, &ninterfaces);
+
+  TEST_ASSERT_EQUAL_NUMERIC (ninterfaces, 2);
+  if (first == NULL || first->next == NULL)
+    return -1;
+  TEST_ASSERT_EQUAL_STRING (first->ifname, "lo");
+  TEST_ASSERT_EQUAL_NUMERIC (first->stats->rx_bytes, 100);
+  TEST_ASSERT_EQUAL_STRING (first->next->ifname, "eth0");
+  TEST_ASSERT_EQUAL_NUMERIC (first->next->stats->rx_bytes, 1000);
+  TEST_ASSERT_EQUAL_NUMERIC (first->next->next == NULL, 1);
+
+  freeiflist (first);
+  freeiflist (second);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the parsing of the qdisc statistics",
+		test_qdisc_dump_add, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the rates of the interfaces changing between the "
+		"snapshots", test_netinfo_rates, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
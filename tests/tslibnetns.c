@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/netns.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+#include "xasprintf.h"
+
+# define NPL_TESTING
+#  include "../lib/netns.c"
+# undef NPL_TESTING
+
+/* A fake procfs filesystem and a fake /run/netns: the process 1 is in the
+   namespace of the plugin, the process 2 in the one bound as "red".  */
+static const struct test_tree_entry tree[] = {
+  { "proc", NULL },
+  { "proc/self", NULL },
+  { "proc/self/ns", NULL },
+  { "proc/1", NULL },
+  { "proc/1/ns", NULL },
+  { "proc/2", NULL },
+  { "proc/2/ns", NULL },
+  { "netns", NULL },
+  { "proc/self/ns/net", "" },
+  { "proc/1/ns/net", NULL, "proc/self/ns/net" },
+  { "proc/2/ns/net", "" },
+  { "netns/blue", "" },
+  { "netns/red", NULL, "proc/2/ns/net" }
+};
+
+static void
+test_netns_fn (void *data)
+{
+  (*(int *) data)++;
+}
+
+static int
+test_netns (const void *tdata)
+{
+  char dir[] = "/tmp/tslibnetns_XXXXXX";
+  char *procdir, *rundir, *label;
+  struct netns *netns, stale;
+  size_t nnetns;
+  int ret = 0, calls = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  if (test_tree_create (dir, tree, TEST_TREE_SIZE (tree)) < 0)
+    {
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return EXIT_AM_HARDFAIL;
+    }
+  procdir = xasprintf ("%s/proc", dir);
+  setenv ("NPL_PROC_ROOT", procdir, 1);
+  free (procdir);
+
+  rundir = xasprintf ("%s/netns", dir);
+  netns = netns_scan (rundir, &nnetns);
+  free (rundir);
+  if (NULL == netns)
+    {
+      unsetenv ("NPL_PROC_ROOT");
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return EXIT_AM_HARDFAIL;
+    }
+
+  /* the process 1 and 2 are in namespaces already found */
+  TEST_ASSERT_EQUAL_NUMERIC (nnetns, 3);
+  TEST_ASSERT_EQUAL_STRING (netns[0].name, "");
+  TEST_ASSERT_EQUAL_NUMERIC (netns[0].self, 1);
+  TEST_ASSERT_EQUAL_STRING (netns[1].name, "blue");
+  TEST_ASSERT_EQUAL_NUMERIC (netns[1].self, 0);
+  TEST_ASSERT_EQUAL_STRING (netns[2].name, "red");
+
+  label = netns_label (&netns[0], "eth0");
+  TEST_ASSERT_EQUAL_STRING (label, "eth0");
+  free (label);
+  label = netns_label (&netns[2], "eth0");
+  TEST_ASSERT_EQUAL_STRING (label, "eth0@red");
+  free (label);
+
+  TEST_ASSERT_EQUAL_NUMERIC (netns_run (&netns[0], test_netns_fn, &calls),
+			     0);
+  TEST_ASSERT_EQUAL_NUMERIC (calls, 1);
+
+  /* a regular file is not a namespace that can be entered */
+  TEST_ASSERT_EQUAL_NUMERIC (netns_run (&netns[1], test_netns_fn, &calls),
+			     -1);
+#ifdef HAVE_SETNS
+  TEST_ASSERT_EQUAL_NUMERIC (errno, EINVAL);
+
+  /* the file has been replaced since the namespaces were listed */
+  stale = netns[1];
+  stale.ino++;
+  TEST_ASSERT_EQUAL_NUMERIC (netns_run (&stale, test_netns_fn, &calls), -1);
+  TEST_ASSERT_EQUAL_NUMERIC (errno, ESRCH);
+#else
+  TEST_ASSERT_EQUAL_NUMERIC (errno, ENOSYS);
+  (void) stale;
+#endif
+  TEST_ASSERT_EQUAL_NUMERIC (calls, 1);
+
+  netns_list_free (netns, nnetns);
+  unsetenv ("NPL_PROC_ROOT");
+  test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the listing and the entering of the namespaces",
+		test_netns, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
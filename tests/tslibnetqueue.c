@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/netqueue.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/netqueue.c"
+# undef NPL_TESTING
+
+/* A fake sysfs filesystem, made of directories only */
+static const struct test_tree_entry tree[] = {
+  { "class", NULL },
+  { "class/net", NULL },
+  { "class/net/eth9", NULL },
+  { "class/net/eth9/queues", NULL },
+  { "class/net/eth9/queues/rx-0", NULL },
+  { "class/net/eth9/queues/rx-1", NULL },
+  { "class/net/eth9/queues/rx-2", NULL },
+  { "class/net/eth9/queues/rx-3", NULL },
+  { "class/net/eth9/queues/tx-0", NULL },
+  { "class/net/eth9/queues/tx-1", NULL }
+};
+
+static int
+test_netqueue_sysfs (const void *tdata)
+{
+  char dir[] = "/tmp/tslibnetqueue_XXXXXX";
+  unsigned int rx_queues, tx_queues;
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  if (test_tree_create (dir, tree, TEST_TREE_SIZE (tree)) < 0)
+    {
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return EXIT_AM_HARDFAIL;
+    }
+  setenv ("NPL_SYS_ROOT", dir, 1);
+
+  netqueue_sysfs_count ("eth9", &rx_queues, &tx_queues);
+  TEST_ASSERT_EQUAL_NUMERIC (rx_queues, 4);
+  TEST_ASSERT_EQUAL_NUMERIC (tx_queues, 2);
+
+  netqueue_sysfs_count ("eth10", &rx_queues, &tx_queues);
+  TEST_ASSERT_EQUAL_NUMERIC (rx_queues, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (tx_queues, 0);
+
+  unsetenv ("NPL_SYS_ROOT");
+  test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+  return ret;
+}
+
+static const struct
+{
+  const char *name;
+  int counter;
+  unsigned int queue;
+} stats[] = {
+  { "rx_queue_0_packets", NETQUEUE_RX_PACKETS, 0 },
+  { "rx_queue_3_drops", NETQUEUE_RX_DROPS, 3 },
+  { "tx_queue_12_packets", NETQUEUE_TX_PACKETS, 12 },
+  { "rx_queue_0_bytes", -1, 0 },
+  { "rx-1.packets", NETQUEUE_RX_PACKETS, 1 },
+  { "tx-2.tx_packets", NETQUEUE_TX_PACKETS, 2 },
+  { "rx7_packets", NETQUEUE_RX_PACKETS, 7 },
+  { "tx5_dropped", NETQUEUE_TX_DROPS, 5 },
+  { "rx0_xdp_drop", -1, 0 },
+  { "rx_packets", -1, 0 },
+  { "rx_dropped", -1, 0 },
+  { "tx_queue_stopped", -1, 0 },
+  { "rx_queue_99999_packets", -1, 0 },
+  { "port.rx_dropped", -1, 0 }
+};
+
+static int
+test_netqueue_parse (const void *tdata)
+{
+  int ret = 0;
+  (void) tdata;
+
+  for (size_t i = 0; i < sizeof (stats) / sizeof (stats[0]); i++)
+    {
+      unsigned int queue = 0;
+      int counter = netqueue_parse_stat (stats[i].name, &queue);
+
+      TEST_ASSERT_EQUAL_NUMERIC (counter, stats[i].counter);
+      if (counter >= 0)
+	TEST_ASSERT_EQUAL_NUMERIC (queue, stats[i].queue);
+    }
+
+  TEST_ASSERT_EQUAL_STRING (netqueue_counter_name (NETQUEUE_TX_DROPS),
+			    "txdrop");
+  TEST_ASSERT_EQUAL_NUMERIC (
+    netqueue_counter_name (NETQUEUE_COUNTERS) == NULL, 1);
+
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the queues of the interfaces in sysfs",
+		test_netqueue_sysfs, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the names of the per-queue ethtool statistics",
+		test_netqueue_parse, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,220 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/npl.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+#include "xasprintf.h"
+
+#if defined (PROC_MEMINFO) && !defined (HAVE_LIBPROCPS)
+
+# define NPL_TESTING
+#  include "../lib/npl.c"
+# undef NPL_TESTING
+
+#define NPL_TEST_PATH_MISSING  abs_srcdir "/ts_missing.data"
+
+static int
+test_npl_sysmem (const void *tdata)
+{
+  struct proc_sysmem *sysmem = NULL;
+  int err, ret = 0;
+  (void) tdata;
+
+  if (npl_sysmem_new (&sysmem) < 0)
+    return EXIT_AM_HARDFAIL;
+  if (setenv ("NPL_TEST_PATH_PROCMEMINFO", NPL_TEST_PATH_PROCMEMINFO, 1) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  err = npl_sysmem_read (sysmem);
+  unsetenv ("NPL_TEST_PATH_PROCMEMINFO");
+
+  TEST_ASSERT_EQUAL_NUMERIC (err, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (npl_sysmem_get (sysmem, NPL_SYSMEM_MAIN_TOTAL),
+			     16384256UL);
+  TEST_ASSERT_EQUAL_NUMERIC (npl_sysmem_get (sysmem, NPL_SYSMEM_SWAP_TOTAL),
+			     8388604UL);
+  TEST_ASSERT_EQUAL_STRING (npl_last_error (), "");
+
+  npl_sysmem_unref (sysmem);
+  return ret;
+}
+
+static int
+test_npl_sysmem_error (const void *tdata)
+{
+  struct proc_sysmem *sysmem = NULL;
+  int err, ret = 0;
+  (void) tdata;
+
+  if (npl_sysmem_new (&sysmem) < 0)
+    return EXIT_AM_HARDFAIL;
+  if (setenv ("NPL_TEST_PATH_PROCMEMINFO", NPL_TEST_PATH_MISSING, 1) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  /* the reader reports the error, that must not exit */
+  err = npl_sysmem_read (sysmem);
+  unsetenv ("NPL_TEST_PATH_PROCMEMINFO");
+
+  TEST_ASSERT_EQUAL_NUMERIC (err, -ENOENT);
+  if (strstr (npl_last_error (), NPL_TEST_PATH_MISSING) == NULL)
+    ret = -1;
+
+  npl_sysmem_unref (sysmem);
+  return ret;
+}
+
+static int
+test_npl_vmem (const void *tdata)
+{
+  struct proc_vmem *vmem = NULL;
+  int err, ret = 0;
+  (void) tdata;
+
+  if (npl_vmem_new (&vmem) < 0)
+    return EXIT_AM_HARDFAIL;
+  if (setenv ("NPL_TEST_PATH_PROCVMSTAT", NPL_TEST_PATH_PROCVMSTAT, 1) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  err = npl_vmem_read (vmem);
+  unsetenv ("NPL_TEST_PATH_PROCVMSTAT");
+
+  TEST_ASSERT_EQUAL_NUMERIC (err, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (npl_vmem_get (vmem, NPL_VMEM_PSWPIN), 10402UL);
+
+  npl_vmem_unref (vmem);
+  return ret;
+}
+
+static int
+test_npl_cpu (const void *tdata)
+{
+  struct npl_cpu_time cputime;
+  struct npl_cpu_counters counters;
+  int err, ret = 0;
+  (void) tdata;
+
+  if (setenv ("NPL_TEST_PATH_PROCSTAT", NPL_TEST_PATH_PROCSTAT, 1) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  err = npl_cpu_time_read (&cputime);
+  TEST_ASSERT_EQUAL_NUMERIC (err, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (cputime.user, 46415ULL);
+  TEST_ASSERT_EQUAL_NUMERIC (cputime.idle, 2025020ULL);
+  TEST_ASSERT_EQUAL_NUMERIC (cputime.iowait, 33466ULL);
+
+  err = npl_cpu_counters_read (&counters);
+  TEST_ASSERT_EQUAL_NUMERIC (err, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (counters.cswch, 13817032ULL);
+  TEST_ASSERT_EQUAL_NUMERIC (counters.intr, 4315363ULL);
+  TEST_ASSERT_EQUAL_NUMERIC (counters.softirq, 5842976ULL);
+
+  if (setenv ("NPL_TEST_PATH_PROCSTAT", NPL_TEST_PATH_MISSING, 1) < 0)
+    return EXIT_AM_HARDFAIL;
+  err = npl_cpu_time_read (&cputime);
+  TEST_ASSERT_EQUAL_NUMERIC (err, -ENOENT);
+
+  unsetenv ("NPL_TEST_PATH_PROCSTAT");
+  return ret;
+}
+
+static int
+test_npl_filecount (const void *tdata)
+{
+  char basedir[] = "/tmp/tslibnpl_XXXXXX", *path;
+  struct npl_filecount count;
+  const char *files[] = { "1", "2", ".3", NULL };
+  int err, fd, ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (basedir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  for (int i = 0; files[i]; i++)
+    {
+      path = xasprintf ("%s/%s", basedir, files[i]);
+      if ((fd = creat (path, 0600)) < 0)
+	return EXIT_AM_HARDFAIL;
+      close (fd);
+      free (path);
+    }
+
+  err = npl_filecount (basedir, NPL_FILES_DEFAULT, 0, 0, NULL, &count);
+  TEST_ASSERT_EQUAL_NUMERIC (err, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (count.total, 2);
+  err = npl_filecount (basedir, NPL_FILES_INCLUDE_HIDDEN, 0, 0, NULL, &count);
+  TEST_ASSERT_EQUAL_NUMERIC (err, 0);
+  TEST_ASSERT_EQUAL_NUMERIC (count.total, 3);
+  TEST_ASSERT_EQUAL_NUMERIC (count.hidden, 1);
+
+  for (int i = 0; files[i]; i++)
+    {
+      path = xasprintf ("%s/%s", basedir, files[i]);
+      unlink (path);
+      free (path);
+    }
+  rmdir (basedir);
+
+  err = npl_filecount (basedir, NPL_FILES_DEFAULT, 0, 0, NULL, &count);
+  TEST_ASSERT_EQUAL_NUMERIC (err, -ENOENT);
+
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check npl_sysmem_read", test_npl_sysmem, NULL) < 0)
+    ret = -1;
+  if (test_run ("check npl_sysmem_read failure", test_npl_sysmem_error,
+		NULL) < 0)
+    ret = -1;
+  if (test_run ("check npl_vmem_read", test_npl_vmem, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the npl_cpu readers", test_npl_cpu, NULL) < 0)
+    ret = -1;
+  if (test_run ("check npl_filecount", test_npl_filecount, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
+
+#else
+
+int
+main (void)
+{
+  return EXIT_AM_SKIP;
+}
+
+#endif
@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/result_cache.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <sys/stat.h>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/result_cache.c"
+# undef NPL_TESTING
+
+#define TEST_OUTPUT  "users WARNING - 3 users | users=3\n"
+
+static int
+test_result_cache_key (const void *tdata)
+{
+  char *argv[] = { "./check_users", "--warning=2", "-c", "5", NULL };
+  const char expect[] =
+    "1000\0check_users\0--warning\0" "2\0-c\0" "5\0"
+    "NPL_OUTPUT=json\0NPL_PROC_ROOT=\0NPL_REPLAY=\0NPL_SYS_ROOT=";
+  char *key;
+  size_t keylen;
+  int ret = 0;
+  (void) tdata;
+
+  if (setenv ("NPL_OUTPUT", "json", 1) < 0)
+    return EXIT_AM_HARDFAIL;
+  unsetenv ("NPL_PROC_ROOT");
+  unsetenv ("NPL_REPLAY");
+  unsetenv ("NPL_SYS_ROOT");
+
+  key = result_cache_key (1000, "check_users", 4, argv, &keylen);
+  unsetenv ("NPL_OUTPUT");
+
+  TEST_ASSERT_EQUAL_NUMERIC (keylen, sizeof (expect));
+  if (memcmp (key, expect, sizeof (expect)) != 0)
+    ret = -1;
+
+  TEST_ASSERT_EQUAL_NUMERIC (result_cache_hash ("", 0),
+			     UINT64_C (0xcbf29ce484222325));
+  TEST_ASSERT_EQUAL_NUMERIC (result_cache_hash ("a", 1),
+			     UINT64_C (0xaf63dc4c8601ec8c));
+
+  free (key);
+  return ret;
+}
+
+/* Store TEST_OUTPUT with the given exit STATUS in PATH.  */
+
+static bool
+test_result_cache_store (const char *path, const char *key, size_t keylen,
+			 int status)
+{
+  struct result_cache cache = {
+    .path = (char *) path, .key = (char *) key, .keylen = keylen
+  };
+  int fd;
+  bool ret;
+
+  if ((fd = open ("/dev/null", O_WRONLY)) < 0)
+    return false;
+  ret = result_cache_capture (&cache, fd)
+    && write_all (fd, TEST_OUTPUT, strlen (TEST_OUTPUT));
+  if (ret)
+    result_cache_commit (&cache, status);
+
+  free (cache.tmppath);
+  close (fd);
+  return ret;
+}
+
+static int
+test_result_cache_roundtrip (const void *tdata)
+{
+  char dir[] = "/tmp/tslibresult_cache_XXXXXX", *path, *out, buf[128];
+  const char key[] = "1000\0check_users", other[] = "1000\0check_userz";
+  struct timespec old[2] = { { 0, UTIME_OMIT }, { 1, 0 } };
+  uid_t uid = geteuid ();
+  int fd, status, ret = 0;
+  ssize_t n;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL || !result_cache_dir_ok (dir, uid))
+    return EXIT_AM_HARDFAIL;
+  path = xasprintf ("%s/check_users", dir);
+  out = xasprintf ("%s/output", dir);
+  if ((fd = open (out, O_CREAT | O_RDWR, 0600)) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  /* UNKNOWN results are not cached */
+  if (!test_result_cache_store (path, key, sizeof key, STATE_UNKNOWN))
+    return EXIT_AM_HARDFAIL;
+  TEST_ASSERT_EQUAL_NUMERIC (access (path, F_OK), -1);
+
+  if (!test_result_cache_store (path, key, sizeof key, STATE_WARNING))
+    return EXIT_AM_HARDFAIL;
+
+  status = result_cache_lookup (path, key, sizeof key, 60, uid, fd);
+  TEST_ASSERT_EQUAL_NUMERIC (status, STATE_WARNING);
+  n = pread (fd, buf, sizeof buf - 1, 0);
+  buf[n < 0 ? 0 : n] = '\0';
+  TEST_ASSERT_EQUAL_STRING (buf, TEST_OUTPUT);
+
+  /* a hash collision */
+  status = result_cache_lookup (path, other, sizeof other, 60, uid, fd);
+  TEST_ASSERT_EQUAL_NUMERIC (status, -1);
+
+  /* an expired result */
+  if (utimensat (AT_FDCWD, path, old, 0) < 0)
+    return EXIT_AM_HARDFAIL;
+  status = result_cache_lookup (path, key, sizeof key, 60, uid, fd);
+  TEST_ASSERT_EQUAL_NUMERIC (status, -1);
+
+  close (fd);
+  unlink (out);
+  unlink (path);
+  rmdir (dir);
+  free (out);
+  free (path);
+  return ret;
+}
+
+static int
+test_result_cache_dir (const void *tdata)
+{
+  char dir[] = "/tmp/tslibresult_cache_XXXXXX";
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL || chmod (dir, 0755) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  TEST_ASSERT_EQUAL_NUMERIC (result_cache_dir_ok (dir, geteuid ()), false);
+
+  rmdir (dir);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check result_cache_key", test_result_cache_key, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the result cache store and lookup",
+		test_result_cache_roundtrip, NULL) < 0)
+    ret = -1;
+  if (test_run ("check a shared cache directory is rejected",
+		test_result_cache_dir, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
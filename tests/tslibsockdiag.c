@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/sockdiag.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/sockdiag.c"
+# undef NPL_TESTING
+
+static int
+test_kind_name (const void *tdata)
+{
+  int ret = 0;
+  (void) tdata;
+
+  TEST_ASSERT_EQUAL_STRING (sock_kind_name (SOCK_KIND_UDP6), "udp6");
+  TEST_ASSERT_EQUAL_STRING (sock_kind_name (SOCK_KIND_UNIX_SEQPACKET),
+			    "unix_seqpacket");
+  TEST_ASSERT_EQUAL_NUMERIC (sock_kind_name (SOCK_KINDS) == NULL, 1);
+
+  return ret;
+}
+
+static int
+test_count_read (const void *tdata)
+{
+  union
+  {
+    struct sockaddr sa;
+    struct sockaddr_in in;
+  } addr;
+  socklen_t addrlen = sizeof (addr);
+  struct sock_count count[SOCK_KINDS];
+  int udp, pair[2], ret = 0;
+  (void) tdata;
+
+  /* a UDP datagram and 5 bytes of a UNIX stream waiting to be read */
+  memset (&addr, 0, sizeof (addr));
+  addr.in.sin_family = AF_INET;
+  addr.in.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  if ((udp = socket (AF_INET, SOCK_DGRAM, 0)) < 0
+      || bind (udp, &addr.sa, sizeof (addr.in)) < 0
+      || getsockname (udp, &addr.sa, &addrlen) < 0
+      || sendto (udp, "ping", 4, 0, &addr.sa, sizeof (addr.in)) != 4
+      || socketpair (AF_UNIX, SOCK_STREAM, 0, pair) < 0
+      || write (pair[0], "hello", 5) != 5)
+    return EXIT_AM_HARDFAIL;
+
+  /* sock_diag may not be available in a container */
+  if (sock_count_read ((1 << SOCK_KIND_UDP) | SOCK_KIND_UNIX, count) < 0)
+    {
+      close (udp);
+      close (pair[0]);
+      close (pair[1]);
+      return EXIT_AM_SKIP;
+    }
+
+  TEST_ASSERT_EQUAL_NUMERIC (count[SOCK_KIND_UDP].sockets >= 1, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (count[SOCK_KIND_UDP].queued >= 1, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (count[SOCK_KIND_UDP].rqueue > 0, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (count[SOCK_KIND_UNIX_STREAM].state[1] >= 2, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (count[SOCK_KIND_UNIX_STREAM].max_rqueue >= 5,
+			     1);
+  /* not requested */
+  TEST_ASSERT_EQUAL_NUMERIC (count[SOCK_KIND_UDP6].sockets, 0);
+
+  close (udp);
+  close (pair[0]);
+  close (pair[1]);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the names of the kinds of sockets", test_kind_name,
+		NULL) < 0)
+    ret = -1;
+  if (test_run ("check the count of the UDP and UNIX sockets",
+		test_count_read, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/statefile.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/statefile.c"
+# undef NPL_TESTING
+
+static int
+test_statefile_roundtrip (const void *tdata)
+{
+  char dir[] = "/tmp/tslibstatefile_XXXXXX", *path;
+  const unsigned long long v1[] = { 1, 2, 3 }, v2[] = { 4, 5, 6 },
+    *values;
+  struct statefile *state;
+  uint32_t nentries = UINT32_MAX;
+  int fd, ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  setenv (NPL_STATE_DIR_ENV, dir, 1);
+
+  /* no previous execution */
+  state = statefile_open ("/sys/fs/cgroup", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_elapsed (state), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_get (state, "c") == NULL, 1);
+  statefile_put (state, "c", v2);
+  statefile_put (state, "a/b", v1);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_save (state), 0);
+  path = xstrdup (state->path);
+  statefile_free (state);
+
+  state = statefile_open ("/sys/fs/cgroup", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_elapsed (state) > 0, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (state->nsaved, 2);
+  values = statefile_get (state, "a/b");
+  TEST_ASSERT_EQUAL_NUMERIC (values && values[0] == 1 && values[2] == 3, 1);
+  values = statefile_get (state, "c");
+  TEST_ASSERT_EQUAL_NUMERIC (values && values[1] == 5, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_get (state, "a") == NULL, 1);
+  statefile_free (state);
+
+  /* the samples of another check, or with a different layout */
+  state = statefile_open ("/sys/fs/cgroup/a", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_elapsed (state), 0);
+  statefile_free (state);
+  state = statefile_open ("/sys/fs/cgroup", 2);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_elapsed (state), 0);
+  statefile_free (state);
+
+  /* a header with more entries than the file can hold */
+  fd = open (path, O_WRONLY);
+  if (fd < 0
+      || pwrite (fd, &nentries, sizeof nentries,
+		 offsetof (struct statefile_header, nentries)) < 0)
+    return EXIT_AM_HARDFAIL;
+  close (fd);
+  state = statefile_open ("/sys/fs/cgroup", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_elapsed (state), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_get (state, "c") == NULL, 1);
+  statefile_free (state);
+
+  /* a truncated file */
+  if (truncate (path, sizeof (struct statefile_header) + 6) < 0)
+    return EXIT_AM_HARDFAIL;
+  state = statefile_open ("/sys/fs/cgroup", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_elapsed (state), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_get (state, "c") == NULL, 1);
+  statefile_free (state);
+
+  unsetenv (NPL_STATE_DIR_ENV);
+  unlink (path);
+  rmdir (dir);
+  free (path);
+  return ret;
+}
+
+static void
+test_resample (void *data)
+{
+  (*(int *) data)++;
+}
+
+static int
+test_statefile_sample (const void *tdata)
+{
+  char dir[] = "/tmp/tslibstatefile_XXXXXX", *path;
+  const char *const keys[] = { "a", NULL, "b" };
+  const unsigned long long v[] = { 1, 2, 3 };
+  struct statefile *state;
+  int ret = 0, resampled = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  setenv (NPL_STATE_DIR_ENV, dir, 1);
+
+  /* no previous execution */
+  state = statefile_open ("sample", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_sample (state, 0, keys, 1,
+					       test_resample, &resampled), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (resampled, 1);
+  statefile_put (state, "a", v);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_save (state), 0);
+  path = xstrdup (state->path);
+  statefile_free (state);
+
+  /* the NULL keys are skipped, and all the others must have been saved */
+  state = statefile_open ("sample", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_sample (state, 0, keys, 2,
+					       test_resample, &resampled) > 0,
+			     1);
+  TEST_ASSERT_EQUAL_NUMERIC (resampled, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_sample (state, 0, keys, 3,
+					       test_resample, &resampled), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (resampled, 2);
+  statefile_free (state);
+
+  unsetenv (NPL_STATE_DIR_ENV);
+  unlink (path);
+  rmdir (dir);
+  free (path);
+  return ret;
+}
+
+static int
+test_statefile_sample_states (const void *tdata)
+{
+  char dir[] = "/tmp/tslibstatefile_XXXXXX", *path;
+  const unsigned long long v[] = { 1, 2, 3 };
+  struct statefile *states[2];
+  double elapsed[2];
+  int ret = 0, resampled = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  setenv (NPL_STATE_DIR_ENV, dir, 1);
+
+  /* the first object has a previous sample, the second one has none:
+     both are sampled again */
+  states[0] = statefile_open ("eth0", 3);
+  statefile_put (states[0], "queues", v);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_save (states[0]), 0);
+  path = xstrdup (states[0]->path);
+  statefile_free (states[0]);
+
+  states[0] = statefile_open ("eth0", 3);
+  states[1] = statefile_open ("eth1", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_sample_states (states, 2, 0, "queues",
+						      elapsed, test_resample,
+						      &resampled), 1);
+  TEST_ASSERT_EQUAL_NUMERIC (resampled, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (elapsed[0] == 0 && elapsed[1] == 0, 1);
+
+  /* all the objects have a previous sample */
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_sample_states (states, 1, 0, "queues",
+						      elapsed, test_resample,
+						      &resampled), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (resampled, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (elapsed[0] > 0, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_sample_states (states, 1, 0, "other",
+						      elapsed, test_resample,
+						      &resampled), 1);
+  TEST_ASSERT_EQUAL_NUMERIC (resampled, 2);
+  statefile_free (states[0]);
+  statefile_free (states[1]);
+
+  unsetenv (NPL_STATE_DIR_ENV);
+  unlink (path);
+  rmdir (dir);
+  free (path);
+  return ret;
+}
+
+static int
+test_statefile_dir (const void *tdata)
+{
+  char dir[] = "/tmp/tslibstatefile_XXXXXX";
+  struct statefile *state;
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL || chmod (dir, 0755) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  /* a directory readable by the other users is not used */
+  setenv (NPL_STATE_DIR_ENV, dir, 1);
+  state = statefile_open ("/sys/fs/cgroup", 3);
+  TEST_ASSERT_EQUAL_NUMERIC (statefile_save (state), -1);
+  statefile_free (state);
+  unsetenv (NPL_STATE_DIR_ENV);
+
+  rmdir (dir);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check statefile save and load", test_statefile_roundtrip,
+		NULL) < 0)
+    ret = -1;
+  if (test_run ("check the choice of the previous sample",
+		test_statefile_sample, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the previous samples shared by several states",
+		test_statefile_sample_states, NULL) < 0)
+    ret = -1;
+  if (test_run ("check statefile directory permissions", test_statefile_dir,
+		NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/sysio.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include "testutils.h"
+
+# define NPL_TESTING
+#  include "../lib/sysio.c"
+# undef NPL_TESTING
+
+#define NPL_PROC_ROOT  "/tmp/fixtures/proc"
+#define NPL_SYS_ROOT   "/tmp/fixtures/sys"
+
+typedef struct test_data
+{
+  const char *path;
+  const char *expect_path;
+} test_data;
+
+static int
+test_sysio_path (const void *tdata)
+{
+  const struct test_data *data = tdata;
+  char buf[PATH_MAX];
+  const char *path;
+  int ret = 0;
+
+  path = sysio_path (data->path, buf, sizeof buf);
+  TEST_ASSERT_EQUAL_STRING (path, data->expect_path);
+
+  return ret;
+}
+
+static int
+test_sysio_path_too_long (const void *tdata)
+{
+  char buf[8];
+  int ret = 0;
+  (void) tdata;
+
+  if (sysio_path ("/proc/meminfo", buf, sizeof buf) != NULL)
+    ret = -1;
+
+  return ret;
+}
+
+static int
+test_sysio_read (const void *tdata)
+{
+  char buf[8];
+  int ret = 0;
+  (void) tdata;
+
+  /* the data is truncated to the size of the buffer */
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_read (NPL_TEST_PATH_PROCSTAT,
+					 buf, sizeof buf), 7);
+  TEST_ASSERT_EQUAL_STRING (buf, "cpu  46");
+
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_read (abs_srcdir "/ts_missing.data",
+					 buf, sizeof buf), -1);
+  TEST_ASSERT_EQUAL_NUMERIC (errno, ENOENT);
+
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+# define DO_TEST(PATH, EXPECT_PATH)                      \
+  do                                                     \
+    {                                                    \
+      test_data data = {                                 \
+        .path = PATH,                                    \
+        .expect_path = EXPECT_PATH,                      \
+      };                                                 \
+      if (test_run("check sysio_path with " PATH,        \
+                   test_sysio_path, (&data)) < 0)        \
+        ret = -1;                                        \
+    }                                                    \
+  while (0)
+
+  /* no redirection at all */
+  unsetenv ("NPL_PROC_ROOT");
+  unsetenv ("NPL_SYS_ROOT");
+  DO_TEST ("/proc/stat", "/proc/stat");
+  DO_TEST ("/sys/devices/system/cpu/online", "/sys/devices/system/cpu/online");
+
+  if (setenv ("NPL_PROC_ROOT", NPL_PROC_ROOT, 1) < 0
+      || setenv ("NPL_SYS_ROOT", NPL_SYS_ROOT, 1) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  DO_TEST ("/proc", NPL_PROC_ROOT);
+  DO_TEST ("/proc/stat", NPL_PROC_ROOT "/stat");
+  DO_TEST ("/proc/1/status", NPL_PROC_ROOT "/1/status");
+  DO_TEST ("/sys", NPL_SYS_ROOT);
+  DO_TEST ("/sys/class/net/eth0/speed", NPL_SYS_ROOT "/class/net/eth0/speed");
+
+  /* paths outside of /proc and /sys are never redirected */
+  DO_TEST ("/procfs/stat", "/procfs/stat");
+  DO_TEST ("/system/file", "/system/file");
+  DO_TEST ("/etc/mtab", "/etc/mtab");
+  DO_TEST ("relative/proc", "relative/proc");
+
+  if (test_run ("check sysio_path with a short buffer",
+		test_sysio_path_too_long, NULL) < 0)
+    ret = -1;
+  if (test_run ("check sysio_read", test_sysio_read, NULL) < 0)
+    ret = -1;
+
+  unsetenv ("NPL_PROC_ROOT");
+  unsetenv ("NPL_SYS_ROOT");
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
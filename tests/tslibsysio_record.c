@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/sysio_record.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "testutils.h"
+#include "xasprintf.h"
+
+# define NPL_TESTING
+#  include "../lib/sysio_record.c"
+# undef NPL_TESTING
+
+#define NPL_TEST_PATH_MISSING  abs_srcdir "/ts_missing.data"
+
+/* Forget the mode and the files used by the previous test.  */
+static void
+test_sysio_record_reset (void)
+{
+  if (record_fd >= 0)
+    close (record_fd);
+  record_fd = -1;
+  record_mode_set = false;
+  if (replay.map)
+    munmap (replay.map, replay.size);
+  free (replay.entries);
+  memset (&replay, 0, sizeof replay);
+}
+
+/* Read the whole stream FP and close it.  */
+static char *
+test_read_stream (FILE *fp)
+{
+  char *data = xmalloc (65536);
+  size_t n = fread (data, 1, 65535, fp);
+
+  data[n] = '\0';
+  fclose (fp);
+  return data;
+}
+
+static int
+test_sysio_record_replay (const void *tdata)
+{
+  char file[] = "/tmp/tslibsysio_record_XXXXXX";
+  char dir[] = "/tmp/tslibsysio_record_dir_XXXXXX";
+  char *expect, *data, *entry, *listing, buf[8];
+  const char *replayed;
+  /* the entries ".", "..", and "rx-0", each one after its type */
+  const size_t listing_len =
+    3 + sizeof (".") + sizeof ("..") + sizeof ("rx-0");
+  size_t len, replayed_len;
+  FILE *fp;
+  int fd, ret = 0;
+  (void) tdata;
+
+  if ((fd = mkstemp (file)) < 0)
+    return EXIT_AM_HARDFAIL;
+  close (fd);
+  unlink (file);
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  entry = xasprintf ("%s/rx-0", dir);
+  if ((fd = creat (entry, 0600)) < 0)
+    return EXIT_AM_HARDFAIL;
+  close (fd);
+
+  if ((fp = fopen (NPL_TEST_PATH_PROCMEMINFO, "r")) == NULL)
+    return EXIT_AM_HARDFAIL;
+  expect = test_read_stream (fp);
+
+  /* record: the file read twice, a missing file, an access check, and
+     two directory listings */
+  setenv (NPL_RECORD_ENV, file, 1);
+  test_sysio_record_reset ();
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_record_mode (), SYSIO_RECORD_ON);
+  for (int i = 0; i < 2; i++)
+    {
+      fp = sysio_record_fopen ("/proc/meminfo", NPL_TEST_PATH_PROCMEMINFO);
+      if (NULL == fp)
+	return EXIT_AM_HARDFAIL;
+      data = test_read_stream (fp);
+      TEST_ASSERT_EQUAL_STRING (data, expect);
+      free (data);
+    }
+  fp = sysio_record_fopen ("/proc/missing", NPL_TEST_PATH_MISSING);
+  TEST_ASSERT_EQUAL_NUMERIC (fp == NULL && errno == ENOENT, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_record_access ("/sys", "/", R_OK), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_record_read ("/proc/stat",
+						NPL_TEST_PATH_PROCSTAT,
+						buf, sizeof buf), 7);
+  listing = sysio_record_listdir ("/sys/class/net/lo/queues", dir, &len);
+  if (NULL == listing)
+    return EXIT_AM_HARDFAIL;
+  TEST_ASSERT_EQUAL_NUMERIC (len, listing_len);
+  TEST_ASSERT_EQUAL_NUMERIC (memmem (listing, len, "rx-0", sizeof ("rx-0"))
+			     != NULL, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_record_listdir ("/sys/missing",
+						   NPL_TEST_PATH_MISSING,
+						   &len) == NULL
+			     && errno == ENOENT, 1);
+  unsetenv (NPL_RECORD_ENV);
+
+  /* replay */
+  setenv (NPL_REPLAY_ENV, file, 1);
+  test_sysio_record_reset ();
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_record_mode (), SYSIO_RECORD_REPLAY);
+  for (int i = 0; i < 3; i++)
+    {
+      /* the last content is served again when the records are exhausted */
+      if ((fp = sysio_replay_fopen ("/proc/meminfo")) == NULL)
+	return EXIT_AM_HARDFAIL;
+      data = test_read_stream (fp);
+      TEST_ASSERT_EQUAL_STRING (data, expect);
+      free (data);
+    }
+  fp = sysio_replay_fopen ("/proc/missing");
+  TEST_ASSERT_EQUAL_NUMERIC (fp == NULL && errno == ENOENT, 1);
+  fp = sysio_replay_fopen ("/proc/vmstat");
+  TEST_ASSERT_EQUAL_NUMERIC (fp == NULL && errno == ENOENT, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_replay_access ("/sys", R_OK), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_replay_access ("/sys", W_OK), -1);
+  TEST_ASSERT_EQUAL_NUMERIC (sysio_replay_read ("/proc/stat",
+						buf, sizeof buf), 7);
+  TEST_ASSERT_EQUAL_STRING (buf, "cpu  46");
+  replayed = sysio_replay_listdir ("/sys/class/net/lo/queues", &replayed_len);
+  TEST_ASSERT_EQUAL_NUMERIC (replayed != NULL
+			     && replayed_len == listing_len
+			     && memcmp (replayed, listing, replayed_len) == 0,
+			     1);
+  replayed = sysio_replay_listdir ("/sys/missing", &replayed_len);
+  TEST_ASSERT_EQUAL_NUMERIC (replayed == NULL && errno == ENOENT, 1);
+  replayed = sysio_replay_listdir ("/proc", &replayed_len);
+  TEST_ASSERT_EQUAL_NUMERIC (replayed == NULL && errno == ENOENT, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (replay.nentries, 7);
+  unsetenv (NPL_REPLAY_ENV);
+
+  test_sysio_record_reset ();
+  unlink (file);
+  unlink (entry);
+  rmdir (dir);
+  free (entry);
+  free (listing);
+  free (expect);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check sysio record and replay", test_sysio_record_replay,
+		NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -0,0 +1,319 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for lib/tcpinfo.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "testutils.h"
+#include "xasprintf.h"
+
+# define NPL_TESTING
+#  include "../lib/tcpinfo.c"
+# undef NPL_TESTING
+
+static const char *netstat =
+  "TcpExt: SyncookiesSent SyncookiesRecv ListenOverflows ListenDrops "
+  "TCPHPHits\n"
+  "TcpExt: 0 0 17 21 5000\n"
+  "IpExt: InNoRoutes InTruncatedPkts\n"
+  "IpExt: 0 0\n";
+
+static int
+test_listen_drops (const void *tdata)
+{
+  char dir[] = "/tmp/tslibtcpinfo_XXXXXX", *netdir, *path;
+  unsigned long long overflows = 0, drops = 0;
+  FILE *fp;
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  netdir = xasprintf ("%s/net", dir);
+  path = xasprintf ("%s/netstat", netdir);
+  if (mkdir (netdir, S_IRWXU) < 0 || (fp = fopen (path, "w")) == NULL)
+    return EXIT_AM_HARDFAIL;
+  fputs (netstat, fp);
+  fclose (fp);
+  setenv ("NPL_PROC_ROOT", dir, 1);
+
+  TEST_ASSERT_EQUAL_NUMERIC (proc_tcp_listen_drops (&overflows, &drops), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (overflows, 17);
+  TEST_ASSERT_EQUAL_NUMERIC (drops, 21);
+
+  unsetenv ("NPL_PROC_ROOT");
+  unlink (path);
+  rmdir (netdir);
+  rmdir (dir);
+  free (path);
+  free (netdir);
+  return ret;
+}
+
+static int
+test_listen_read (const void *tdata)
+{
+  union
+  {
+    struct sockaddr sa;
+    struct sockaddr_in in;
+  } addr;
+  socklen_t addrlen = sizeof (addr);
+  struct tcp_listen_port *ports;
+  int fd, nports, ret = 0;
+  bool found = false;
+  (void) tdata;
+
+  memset (&addr, 0, sizeof (addr));
+  addr.in.sin_family = AF_INET;
+  addr.in.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  if ((fd = socket (AF_INET, SOCK_STREAM, 0)) < 0
+      || bind (fd, &addr.sa, sizeof (addr.in)) < 0
+      || listen (fd, 8) < 0
+      || getsockname (fd, &addr.sa, &addrlen) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  /* sock_diag may not be available in a container */
+  if ((nports = tcp_listen_read (TCP_v4, &ports)) < 0)
+    {
+      close (fd);
+      return EXIT_AM_SKIP;
+    }
+
+  for (int i = 0; i < nports; i++)
+    if (ports[i].port == ntohs (addr.in.sin_port))
+      {
+	found = true;
+	TEST_ASSERT_EQUAL_NUMERIC (ports[i].backlog, 0);
+	TEST_ASSERT_EQUAL_NUMERIC (ports[i].max_backlog, 8);
+      }
+  TEST_ASSERT_EQUAL_NUMERIC (found, 1);
+
+  free (ports);
+  close (fd);
+  return ret;
+}
+
+static int
+test_quality_read (const void *tdata)
+{
+  union
+  {
+    struct sockaddr sa;
+    struct sockaddr_in in;
+  } addr;
+  socklen_t addrlen = sizeof (addr);
+  struct tcp_port_quality *ports;
+  int fd, client, server, nports, ret = 0;
+  (void) tdata;
+
+  memset (&addr, 0, sizeof (addr));
+  addr.in.sin_family = AF_INET;
+  addr.in.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  if ((fd = socket (AF_INET, SOCK_STREAM, 0)) < 0
+      || bind (fd, &addr.sa, sizeof (addr.in)) < 0
+      || listen (fd, 8) < 0
+      || getsockname (fd, &addr.sa, &addrlen) < 0
+      || (client = socket (AF_INET, SOCK_STREAM, 0)) < 0
+      || connect (client, &addr.sa, sizeof (addr.in)) < 0
+      || (server = accept (fd, NULL, NULL)) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  /* the bytecode keeps the server side of the connection only */
+  if ((nports = tcp_quality_read (TCP_v4, ntohs (addr.in.sin_port), 0,
+				  &ports)) < 0)
+    {
+      close (server);
+      close (client);
+      close (fd);
+      return EXIT_AM_SKIP;
+    }
+
+  TEST_ASSERT_EQUAL_NUMERIC (nports, 1);
+  if (nports == 1)
+    {
+      TEST_ASSERT_EQUAL_NUMERIC (ports[0].port, ntohs (addr.in.sin_port));
+      TEST_ASSERT_EQUAL_NUMERIC (ports[0].connections, 1);
+      TEST_ASSERT_EQUAL_NUMERIC (ports[0].rtt.n, 1);
+    }
+  free (ports);
+
+  /* the client side, whose service port is the one of the listener */
+  nports = tcp_quality_read (TCP_v4, 0, ntohs (addr.in.sin_port), &ports);
+  TEST_ASSERT_EQUAL_NUMERIC (nports, 1);
+  if (nports == 1)
+    TEST_ASSERT_EQUAL_NUMERIC (ports[0].port, ntohs (addr.in.sin_port));
+
+  free (ports);
+  close (server);
+  close (client);
+  close (fd);
+  return ret;
+}
+
+static void
+proc_tcp_entry (FILE *fp, const char *laddr, unsigned int lport,
+		const char *raddr, unsigned int rport, unsigned int state)
+{
+  static unsigned int sl;
+
+  fprintf (fp, "%4u: %s:%04X %s:%04X %02X 00000000:00000000 00:00000000 "
+	   "00000000     0        0 %u 1 0000000000000000 100 0 0 10 0\n",
+	   sl, laddr, lport, raddr, rport, state, sl + 1000);
+  sl++;
+}
+
+/* three listening ports, a peer with 3 connections (one of them over
+   IPv6 with an IPv4-mapped address), and 100 peers with one connection */
+
+static void
+write_proc_tcp (FILE *fp, FILE *fp6)
+{
+  const char *header =
+    "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when "
+    "retrnsmt   uid  timeout inode\n";
+
+  fputs (header, fp);
+  fputs (header, fp6);
+  proc_tcp_entry (fp, "00000000", 80, "00000000", 0, 0x0A);
+  proc_tcp_entry (fp, "00000000", 443, "00000000", 0, 0x0A);
+  proc_tcp_entry (fp, "0100007F", 8080, "00000000", 0, 0x0A);
+  /* 10.0.0.1 */
+  proc_tcp_entry (fp, "0100007F", 80, "0100000A", 40000, 0x01);
+  proc_tcp_entry (fp, "0100007F", 80, "0100000A", 40001, 0x08);
+  proc_tcp_entry (fp6, "00000000000000000000000000000000", 443,
+		  "0000000000000000FFFF00000100000A", 40002, 0x01);
+  /* 192.168.1.1 ... 192.168.1.100 */
+  for (unsigned int i = 1; i <= 100; i++)
+    {
+      char addr[9];
+
+      snprintf (addr, sizeof addr, "%02X01A8C0", i);
+      proc_tcp_entry (fp, "0100007F", 443, addr, 50000 + i, 0x01);
+    }
+}
+
+static int
+test_conntable_proc (const void *tdata)
+{
+  char dir[] = "/tmp/tslibtcpinfo_XXXXXX", *netdir, *path, *path6;
+  const struct tcp_port_conn *port;
+  struct tcp_conntable *table;
+  struct tcp_port_conn *ports;
+  struct tcp_peer_conn *peers;
+  FILE *fp, *fp6;
+  size_t nports, npeers;
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  netdir = xasprintf ("%s/net", dir);
+  path = xasprintf ("%s/tcp", netdir);
+  path6 = xasprintf ("%s/tcp6", netdir);
+  if (mkdir (netdir, S_IRWXU) < 0 || (fp = fopen (path, "w")) == NULL
+      || (fp6 = fopen (path6, "w")) == NULL)
+    return EXIT_AM_HARDFAIL;
+  write_proc_tcp (fp, fp6);
+  fclose (fp);
+  fclose (fp6);
+  setenv ("NPL_PROC_ROOT", dir, 1);
+
+  table = tcp_conntable_new ();
+  tcp_conntable_read_proc (table, TCP_v4 | TCP_v6);
+
+  nports = tcp_conntable_ports (table, &ports);
+  TEST_ASSERT_EQUAL_NUMERIC (nports, 3);
+  TEST_ASSERT_EQUAL_NUMERIC (ports[0].port, 80);
+  TEST_ASSERT_EQUAL_NUMERIC (ports[2].port, 8080);
+  free (ports);
+
+  port = tcp_conntable_port (table, 80);
+  TEST_ASSERT_EQUAL_NUMERIC (port != NULL, 1);
+  if (port)
+    {
+      TEST_ASSERT_EQUAL_NUMERIC (port->total, 3);
+      TEST_ASSERT_EQUAL_NUMERIC (port->state[tcp_state_lookup ("listen")], 1);
+      TEST_ASSERT_EQUAL_NUMERIC (
+	port->state[tcp_state_lookup ("CLOSE_WAIT")], 1);
+    }
+  port = tcp_conntable_port (table, 443);
+  TEST_ASSERT_EQUAL_NUMERIC (port ? port->state[TCP_ESTABLISHED] : 0, 101);
+  TEST_ASSERT_EQUAL_NUMERIC (tcp_conntable_port (table, 22) == NULL, 1);
+
+  npeers = tcp_conntable_top_peers (table, 2, &peers);
+  TEST_ASSERT_EQUAL_NUMERIC (npeers, 2);
+  TEST_ASSERT_EQUAL_NUMERIC (peers[0].family, AF_INET);
+  TEST_ASSERT_EQUAL_NUMERIC (peers[0].connections, 3);
+  TEST_ASSERT_EQUAL_NUMERIC (peers[0].addr[0], 10);
+  TEST_ASSERT_EQUAL_NUMERIC (peers[0].addr[3], 1);
+  /* the lower address among the peers with the same connections */
+  TEST_ASSERT_EQUAL_NUMERIC (peers[1].connections, 1);
+  TEST_ASSERT_EQUAL_NUMERIC (peers[1].addr[0], 192);
+  TEST_ASSERT_EQUAL_NUMERIC (peers[1].addr[3], 1);
+  free (peers);
+
+  npeers = tcp_conntable_top_peers (table, 1000, &peers);
+  TEST_ASSERT_EQUAL_NUMERIC (npeers, 101);
+  free (peers);
+  tcp_conntable_free (table);
+
+  unsetenv ("NPL_PROC_ROOT");
+  unlink (path);
+  unlink (path6);
+  rmdir (netdir);
+  rmdir (dir);
+  free (path);
+  free (path6);
+  free (netdir);
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  if (test_run ("check the parsing of the TcpExt counters",
+		test_listen_drops, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the dump of the listening sockets",
+		test_listen_read, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the dump of the connections with a port filter",
+		test_quality_read, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the connections by port and by remote address",
+		test_conntable_proc, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
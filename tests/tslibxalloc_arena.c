@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+/*
+ * License: GPLv3+
+ * Copyright (c) 2026 Davide Madrisan <davide.madrisan@gmail.com>
+ *
+ * Unit test for the bump arena in lib/xmalloc.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE /* activate extra prototypes for glibc */
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "testutils.h"
+
+/* the arena code is always tested, even when not enabled at build time;
+ * the memory allocated here must never be released with free() */
+#undef ENABLE_XALLOC_ARENA
+#define ENABLE_XALLOC_ARENA 1
+
+# define NPL_TESTING
+#  include "../lib/xmalloc.c"
+# undef NPL_TESTING
+
+static bool
+is_zeroed (const char *p, size_t n)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    if (p[i])
+      return false;
+  return true;
+}
+
+static int
+test_arena_alloc (const void *tdata)
+{
+  char *p, *q;
+  int ret = 0;
+  (void) tdata;
+
+  p = xmalloc (100);
+  q = xmalloc (1);
+
+  if (!xalloc_arena_owns (p) || !xalloc_arena_owns (q))
+    return -1;
+  if (!is_zeroed (p, 100) || !is_zeroed (q, 1))
+    ret = -1;
+  if ((uintptr_t) p % XALLOC_ARENA_ALIGN || (uintptr_t) q % XALLOC_ARENA_ALIGN)
+    ret = -1;
+  /* the blocks do not overlap */
+  if (q < p + 100)
+    ret = -1;
+
+  return ret;
+}
+
+static int
+test_arena_realloc (const void *tdata)
+{
+  char *p, *q, *r;
+  int ret = 0;
+  (void) tdata;
+
+  p = xstrdup ("0123456789");
+
+  /* the last block grows in place */
+  q = xrealloc (p, 4096);
+  if (q != p || memcmp (q, "0123456789", 11))
+    ret = -1;
+
+  /* a block followed by another one is moved */
+  r = xmalloc (16);
+  p = xrealloc (q, 8192);
+  if (p == q || !xalloc_arena_owns (p) || memcmp (p, "0123456789", 11))
+    ret = -1;
+  if (!is_zeroed (r, 16))
+    ret = -1;
+
+  /* shrinking never moves the block */
+  q = xrealloc (p, 4);
+  if (q != p)
+    ret = -1;
+
+  return ret;
+}
+
+static int
+test_arena_stats (const void *tdata)
+{
+  struct xalloc_stats before, after;
+  int ret = 0;
+  (void) tdata;
+
+  xalloc_stats_get (&before);
+  xmalloc (10);
+  xmalloc (20);
+  xalloc_stats_get (&after);
+
+  TEST_ASSERT_EQUAL_NUMERIC (after.allocs - before.allocs, 2);
+  TEST_ASSERT_EQUAL_NUMERIC (after.bytes - before.bytes, 30);
+  TEST_ASSERT_EQUAL_NUMERIC (after.arena_bytes - before.arena_bytes,
+			     2 * sizeof (struct xalloc_arena_header) + 16 + 32);
+
+  return ret;
+}
+
+static int
+test_arena_disabled (const void *tdata)
+{
+  char *p;
+  int ret = 0;
+  (void) tdata;
+
+  arena_state = -1;
+  arena_base = arena_next = arena_end = NULL;
+  if (setenv ("NPL_XALLOC_ARENA", "0", 1) < 0)
+    return EXIT_AM_HARDFAIL;
+
+  p = xmalloc (32);
+  if (xalloc_arena_owns (p) || !is_zeroed (p, 32))
+    ret = -1;
+  free (p);
+
+  unsetenv ("NPL_XALLOC_ARENA");
+  return ret;
+}
+
+static int
+mymain (void)
+{
+  int ret = 0;
+
+  unsetenv ("NPL_XALLOC_ARENA");
+
+  if (test_run ("check the arena allocations", test_arena_alloc, NULL) < 0)
+    ret = -1;
+  if (test_run ("check the arena reallocations", test_arena_realloc,
+		NULL) < 0)
+    ret = -1;
+  if (test_run ("check the allocation counters", test_arena_stats, NULL) < 0)
+    ret = -1;
+  if (test_run ("check NPL_XALLOC_ARENA=0", test_arena_disabled, NULL) < 0)
+    ret = -1;
+
+  return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+TEST_MAIN (mymain)
@@ -32,6 +32,9 @@ static void validate_input (int i, double w, double c) __attribute__ ((unused));
 static int loadavg_status (const double *loadavg, const double *wload,
 			   const double *cload, const bool *required)
   __attribute__ ((unused));
+static double cgroup_saturation (const char *cgroup, double capacity,
+				 unsigned long long *throttled)
+  __attribute__ ((unused));
 
 #define NPL_TESTING
 #include "../plugins/check_load.c"
@@ -27,7 +27,10 @@
 static _Noreturn void print_version (void) __attribute__ ((unused));
 static _Noreturn void usage (FILE * out) __attribute__ ((unused));
 static void validate_input (int i, double w, double c) __attribute__ ((unused));
-static void normalize_loadavg (double *loadavg, int numcpus)
+static void normalize_loadavg (double *loadavg, double capacity)
+  __attribute__ ((unused));
+static double cgroup_saturation (const char *cgroup, double capacity,
+				 unsigned long long *throttled)
   __attribute__ ((unused));
 
 #define NPL_TESTING
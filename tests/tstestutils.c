@@ -21,7 +21,11 @@
  */
 
 #include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "testutils.h"
+#include "xasprintf.h"
 
 typedef struct test_data
 {
@@ -45,6 +49,44 @@ test_fstringify_bufsize (const void *tdata)
   return ret;
 }
 
+static const struct test_tree_entry tree[] = {
+  { "a", NULL },
+  { "a/file", "content\n" },
+  { "a/link", NULL, "a/file" }
+};
+
+static int
+test_tree (const void *tdata)
+{
+  char dir[] = "/tmp/tstestutils_XXXXXX", *path, *buffer;
+  struct stat st;
+  int ret = 0;
+  (void) tdata;
+
+  if (mkdtemp (dir) == NULL)
+    return EXIT_AM_HARDFAIL;
+  if (test_tree_create (dir, tree, TEST_TREE_SIZE (tree)) < 0)
+    {
+      test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+      return -1;
+    }
+
+  path = xasprintf ("%s/a/link", dir);
+  buffer = test_fstringify (path);
+  TEST_ASSERT_EQUAL_NUMERIC (buffer != NULL, 1);
+  if (buffer)
+    TEST_ASSERT_EQUAL_STRING (buffer, "content\n");
+  TEST_ASSERT_EQUAL_NUMERIC (stat (path, &st), 0);
+  TEST_ASSERT_EQUAL_NUMERIC (st.st_nlink, 2);
+  free (buffer);
+  free (path);
+
+  test_tree_remove (dir, tree, TEST_TREE_SIZE (tree));
+  TEST_ASSERT_EQUAL_NUMERIC (access (dir, F_OK), -1);
+
+  return ret;
+}
+
 static int
 mymain (void)
 {
@@ -65,6 +107,10 @@ mymain (void)
 
   DO_TEST ("checking test_fstringify ()", filename, 3832);
 
+  if (test_run ("checking test_tree_create () and test_tree_remove ()",
+		test_tree, NULL) < 0)
+    ret = -1;
+
   return ret == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 